@@ -0,0 +1,15 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "FastNoise/VoxelFastNoiseTest.h"
+
+#include "HAL/IConsoleManager.h"
+
+// eg: voxel.noise.TestBatch3D
+static FAutoConsoleCommand TestBatch3DCmd(
+	TEXT("voxel.noise.TestBatch3D"),
+	TEXT("Compare the 3D FastNoise batch functions and their derivatives against the single point ones, and log the time per point of both"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FVoxelFastNoiseTest::TestBatch_3D();
+	}));
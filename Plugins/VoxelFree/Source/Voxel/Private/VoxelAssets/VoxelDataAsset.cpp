@@ -12,6 +12,13 @@
 #include "Engine/Texture2D.h"
 #include "Serialization/LargeMemoryReader.h"
 #include "Serialization/LargeMemoryWriter.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarDataAssetBrickedStorage(
+	TEXT("voxel.dataasset.BrickedStorage"),
+	1,
+	TEXT("If true, data assets are stored as bricks once loaded, with uniform bricks collapsed. If false, they are kept dense"),
+	ECVF_Default);
 
 UVoxelDataAsset::UVoxelDataAsset()
 {
@@ -104,6 +111,16 @@ void UVoxelDataAsset::Load()
 	}
 	ensure(MemoryReader.AtEnd());
 
+	// Assets saved before BrickedStorage are converted here
+	if (CVarDataAssetBrickedStorage.GetValueOnAnyThread())
+	{
+		Data->ConvertToBricks();
+	}
+	else
+	{
+		Data->ConvertToDense();
+	}
+
 	SyncProperties();
 }
 
@@ -124,9 +141,11 @@ void UVoxelDataAsset::SyncProperties()
 {
 	// To access those properties without loading the asset
 	Size = Data->GetSize();
+	// Don't use GetRawValues, it would convert bricked data back to dense
+	const int64 NumVoxels = int64(Size.X) * int64(Size.Y) * int64(Size.Z);
 	UncompressedSizeInMB =
-		Data->GetRawValues().Num() * sizeof(FVoxelValue) / double(1 << 20) +
-		Data->GetRawMaterials().Num() * sizeof(FVoxelMaterial) / double(1 << 20);
+		NumVoxels * sizeof(FVoxelValue) / double(1 << 20) +
+		(Data->HasMaterials() ? NumVoxels * sizeof(FVoxelMaterial) : 0) / double(1 << 20);
 	CompressedSizeInMB = CompressedData.Num() / double(1 << 20);
 }
 
@@ -0,0 +1,199 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelAssets/VoxelDataAsset.h"
+#include "VoxelAssets/VoxelDataAssetData.h"
+#include "VoxelAssets/VoxelDataAssetData.inl"
+#include "VoxelUtilities/VoxelSerializationUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/LargeMemoryWriter.h"
+
+// Compares the bricked storage of data assets against the dense one:
+// load time, memory, stamp placement time and range queries
+namespace FVoxelDataAssetBenchmark
+{
+	constexpr int32 ChunkSize = 32;
+
+	TArray<uint8> Save(FVoxelDataAssetData& Data, FVoxelDataAssetDataVersion::Type Version)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		FLargeMemoryWriter Writer(Data.GetAllocatedSize());
+		Data.Serialize(Writer, GVoxelValueConfigFlag, GVoxelMaterialConfigFlag, Version);
+
+		TArray<uint8> CompressedData;
+		FVoxelSerializationUtilities::CompressData(Writer, CompressedData);
+		return CompressedData;
+	}
+
+	double Load(const TArray<uint8>& CompressedData, FVoxelDataAssetDataVersion::Type Version, bool bConvertToBricks, FVoxelDataAssetData& Data)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray64<uint8> UncompressedData;
+		if (!ensure(FVoxelSerializationUtilities::DecompressData(CompressedData, UncompressedData)))
+		{
+			return 0;
+		}
+
+		FLargeMemoryReader Reader(UncompressedData.GetData(), UncompressedData.Num());
+		Data.Serialize(Reader, GVoxelValueConfigFlag, GVoxelMaterialConfigFlag, Version);
+		ensure(!Reader.IsError());
+
+		if (bConvertToBricks)
+		{
+			Data.ConvertToBricks();
+		}
+
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	// Same sampling as UVoxelAssetTools::ImportDataAssetImpl
+	double Stamp(const FVoxelDataAssetData& Data)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		// Make sure the compiler doesn't skip the sampling
+		float Sum = 0;
+		uint32 MaterialHash = 0;
+
+		const FIntVector Size = Data.GetSize();
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Z = 0; Z < Size.Z; Z++)
+		{
+			for (int32 Y = 0; Y < Size.Y; Y++)
+			{
+				for (int32 X = 0; X < Size.X; X++)
+				{
+					Sum += Data.GetInterpolatedValue(X, Y, Z, FVoxelValue::Empty());
+					if (Data.HasMaterials())
+					{
+						MaterialHash ^= Data.GetInterpolatedMaterial(X, Y, Z).GetColor().ToPackedARGB();
+					}
+				}
+			}
+		}
+		const double Time = FPlatformTime::Seconds() - StartTime;
+
+		LOG_VOXEL(VeryVerbose, TEXT("Data asset benchmark checksum: %f %u"), Sum, MaterialHash);
+		return Time;
+	}
+
+	// Range queries on chunks covering the asset, like the renderer does to skip empty chunks
+	double QueryRanges(const FVoxelDataAssetData& Data, int32& OutNumChunks, int32& OutNumSkippedChunks)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		OutNumChunks = 0;
+		OutNumSkippedChunks = 0;
+
+		const FIntVector NumChunks = FVoxelUtilities::DivideCeil(Data.GetSize(), ChunkSize);
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Z = 0; Z < NumChunks.Z; Z++)
+		{
+			for (int32 Y = 0; Y < NumChunks.Y; Y++)
+			{
+				for (int32 X = 0; X < NumChunks.X; X++)
+				{
+					const FIntVector Min = FIntVector(X, Y, Z) * ChunkSize;
+					const TVoxelRange<v_flt> Range = Data.GetValueRange(FVoxelIntBox(Min, Min + ChunkSize).Extend(1), FVoxelValue::Empty());
+
+					OutNumChunks++;
+					if (Range.Min > 0 || Range.Max < 0)
+					{
+						OutNumSkippedChunks++;
+					}
+				}
+			}
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	void Run(const FVoxelDataAssetData& SourceData, const FString& Name)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		// Copy the data so that we can save it in both formats
+		FVoxelDataAssetData DenseData;
+		const bool bHasMaterials = SourceData.HasMaterials();
+		DenseData.SetSize(SourceData.GetSize(), bHasMaterials);
+		for (int32 Z = 0; Z < SourceData.GetSize().Z; Z++)
+		{
+			for (int32 Y = 0; Y < SourceData.GetSize().Y; Y++)
+			{
+				for (int32 X = 0; X < SourceData.GetSize().X; X++)
+				{
+					DenseData.SetValue(X, Y, Z, SourceData.GetValueUnsafe(X, Y, Z));
+					if (bHasMaterials)
+					{
+						DenseData.SetMaterial(X, Y, Z, SourceData.GetMaterialUnsafe(X, Y, Z));
+					}
+				}
+			}
+		}
+
+		const TArray<uint8> DenseBlob = Save(DenseData, FVoxelDataAssetDataVersion::SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage);
+		const TArray<uint8> BrickedBlob = Save(DenseData, FVoxelDataAssetDataVersion::BrickedStorage);
+
+		const FIntVector Size = SourceData.GetSize();
+		LOG_VOXEL(Log, TEXT("%s (%dx%dx%d): %.2fMB compressed dense, %.2fMB compressed bricked"),
+			*Name,
+			Size.X,
+			Size.Y,
+			Size.Z,
+			DenseBlob.Num() / double(1 << 20),
+			BrickedBlob.Num() / double(1 << 20));
+
+		const auto RunStorage = [&](const TCHAR* Storage, const TArray<uint8>& Blob, FVoxelDataAssetDataVersion::Type Version, bool bConvertToBricks)
+		{
+			FVoxelDataAssetData Data;
+			const double LoadTime = Load(Blob, Version, bConvertToBricks, Data);
+			const double StampTime = Stamp(Data);
+
+			int32 NumChunks = 0;
+			int32 NumSkippedChunks = 0;
+			const double RangeTime = QueryRanges(Data, NumChunks, NumSkippedChunks);
+
+			LOG_VOXEL(Log, TEXT("%s %s: load %.2fms, %.2fMB, stamp %.2fms, range queries %.3fms (%d/%d chunks proven without surface)"),
+				*Name,
+				Storage,
+				LoadTime * 1000,
+				Data.GetAllocatedSize() / double(1 << 20),
+				StampTime * 1000,
+				RangeTime * 1000,
+				NumSkippedChunks,
+				NumChunks);
+		};
+
+		RunStorage(TEXT("dense"), DenseBlob, FVoxelDataAssetDataVersion::SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage, false);
+		RunStorage(TEXT("dense converted on load"), DenseBlob, FVoxelDataAssetDataVersion::SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage, true);
+		RunStorage(TEXT("bricked"), BrickedBlob, FVoxelDataAssetDataVersion::BrickedStorage, false);
+	}
+}
+
+// eg: voxel.dataasset.Benchmark /Game/MyDataAsset
+static FAutoConsoleCommand DataAssetBenchmarkCmd(
+	TEXT("voxel.dataasset.Benchmark"),
+	TEXT("Compare the bricked and dense storages of a data asset, and log the load time, memory, stamp placement time and range query time. Args: [Data asset path]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.dataasset.Benchmark: needs a data asset path"));
+			return;
+		}
+
+		UVoxelDataAsset* Asset = LoadObject<UVoxelDataAsset>(nullptr, *Args[0]);
+		if (!Asset)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.dataasset.Benchmark: invalid data asset %s"), *Args[0]);
+			return;
+		}
+
+		FVoxelDataAssetBenchmark::Run(*Asset->GetData(), Asset->GetName());
+	}));
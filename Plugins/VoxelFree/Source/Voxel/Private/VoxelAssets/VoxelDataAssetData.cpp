@@ -2,6 +2,7 @@
 
 #include "VoxelAssets/VoxelDataAssetData.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
 #include "VoxelFeedbackContext.h"
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataAssetMemory);
@@ -21,6 +22,12 @@ void FVoxelDataAssetData::SetSize(const FIntVector& NewSize, bool bCreateMateria
 	Materials.SetNumUninitialized(bCreateMaterials ? Num : 0);
 
 	Size = NewSize;
+	NumBricks = FVoxelUtilities::DivideCeil(Size, BrickSize);
+	
+	bBricked = false;
+	ValueBricks.Empty();
+	MaterialBricks.Empty();
+	BrickRanges.Empty();
 
 	ensure(Size.GetMin() > 0);
 	ensure(Size.GetMax() > 1); // Else it'll be considered empty
@@ -34,6 +41,24 @@ void FVoxelDataAssetData::Serialize(FArchive& Ar, uint32 ValueConfigFlag, uint32
 	FVoxelScopedSlowTask Serializing(2.f);
 	
 	Ar << Size;
+	NumBricks = FVoxelUtilities::DivideCeil(Size, BrickSize);
+
+	if (Ar.IsLoading())
+	{
+		bBricked = false;
+		ValueBricks.Empty();
+		MaterialBricks.Empty();
+		BrickRanges.Empty();
+	}
+
+	if (Version >= FVoxelDataAssetDataVersion::BrickedStorage)
+	{
+		Serializing.EnterProgressFrame(2.f, VOXEL_LOCTEXT("Serializing bricks"));
+		SerializeBricks(Ar, ValueConfigFlag, MaterialConfigFlag);
+		UpdateStats();
+		return;
+	}
+	check(!Ar.IsSaving() || !bBricked);
 
 	const auto SerializationVersion =
 		Version >= FVoxelDataAssetDataVersion::ValueConfigFlagAndSaveGUIDs
@@ -58,9 +83,341 @@ void FVoxelDataAssetData::Serialize(FArchive& Ar, uint32 ValueConfigFlag, uint32
 	UpdateStats();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDataAssetData::ConvertToBricks()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (bBricked || IsEmpty())
+	{
+		return;
+	}
+
+	NumBricks = FVoxelUtilities::DivideCeil(Size, BrickSize);
+	
+	BuildBricks(Values, ValueBricks);
+	if (Materials.Num() > 0)
+	{
+		BuildBricks(Materials, MaterialBricks);
+	}
+	BuildBrickRanges();
+
+	bBricked = true;
+	Values.Empty();
+	Materials.Empty();
+
+	UpdateStats();
+}
+
+void FVoxelDataAssetData::ConvertToDense()
+{
+	if (!bBricked)
+	{
+		return;
+	}
+	
+	VOXEL_FUNCTION_COUNTER();
+
+	BuildDense(ValueBricks, Values);
+	if (MaterialBricks.Indices.Num() > 0)
+	{
+		BuildDense(MaterialBricks, Materials);
+	}
+
+	bBricked = false;
+	ValueBricks.Empty();
+	MaterialBricks.Empty();
+	BrickRanges.Empty();
+
+	UpdateStats();
+}
+
+TVoxelRange<v_flt> FVoxelDataAssetData::GetValueRange(const FVoxelIntBox& Bounds, FVoxelValue DefaultValue) const
+{
+	const FVoxelIntBox AssetBounds(FIntVector(0), Size);
+	if (!Bounds.Intersect(AssetBounds))
+	{
+		return DefaultValue.ToFloat();
+	}
+	if (!bBricked)
+	{
+		return { -1, 1 };
+	}
+
+	const FVoxelIntBox Overlap = Bounds.Overlap(AssetBounds);
+	const FIntVector MinBrick = FVoxelUtilities::DivideFloor(Overlap.Min, BrickSize);
+	const FIntVector MaxBrick = FVoxelUtilities::DivideCeil(Overlap.Max, BrickSize);
+
+	FVoxelValue Min = FVoxelValue::Empty();
+	FVoxelValue Max = FVoxelValue::Full();
+	for (int32 BrickZ = MinBrick.Z; BrickZ < MaxBrick.Z; BrickZ++)
+	{
+		for (int32 BrickY = MinBrick.Y; BrickY < MaxBrick.Y; BrickY++)
+		{
+			for (int32 BrickX = MinBrick.X; BrickX < MaxBrick.X; BrickX++)
+			{
+				const FBrickRange& Range = BrickRanges[GetBrickIndex(BrickX, BrickY, BrickZ)];
+				Min = FMath::Min(Min, Range.Min);
+				Max = FMath::Max(Max, Range.Max);
+			}
+		}
+	}
+
+	const TVoxelRange<v_flt> Range(Min.ToFloat(), Max.ToFloat());
+	if (AssetBounds.Contains(Bounds))
+	{
+		return Range;
+	}
+	else
+	{
+		return TVoxelRange<v_flt>::Union(Range, DefaultValue.ToFloat());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 void FVoxelDataAssetData::UpdateStats() const
 {
 	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataAssetMemory, AllocatedSize);
-	AllocatedSize = Values.GetAllocatedSize() + Materials.GetAllocatedSize();
+	AllocatedSize =
+		Values.GetAllocatedSize() +
+		Materials.GetAllocatedSize() +
+		ValueBricks.GetAllocatedSize() +
+		MaterialBricks.GetAllocatedSize() +
+		BrickRanges.GetAllocatedSize();
 	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataAssetMemory, AllocatedSize);
+}
+
+void FVoxelDataAssetData::BuildBrickRanges()
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	const int32 Num = ValueBricks.Indices.Num();
+	BrickRanges.Empty(Num);
+	BrickRanges.SetNumUninitialized(Num);
+
+	for (int32 Brick = 0; Brick < Num; Brick++)
+	{
+		FBrickRange& Range = BrickRanges[Brick];
+		
+		const int32 DataIndex = ValueBricks.Indices[Brick];
+		if (DataIndex < 0)
+		{
+			Range.Min = Range.Max = ValueBricks.Uniforms[Brick];
+			continue;
+		}
+
+		// The padding of the bricks on the border is a copy of their first voxel, so it doesn't affect the range
+		const FVoxelValue* RESTRICT const BrickData = ValueBricks.Data.GetData() + DataIndex;
+		Range.Min = Range.Max = BrickData[0];
+		for (int32 Index = 1; Index < BrickNumVoxels; Index++)
+		{
+			Range.Min = FMath::Min(Range.Min, BrickData[Index]);
+			Range.Max = FMath::Max(Range.Max, BrickData[Index]);
+		}
+	}
+}
+
+template<typename T>
+void FVoxelDataAssetData::BuildBricks(const TNoGrowArray<T>& Dense, TBricks<T>& Bricks) const
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(Dense.Num() == Size.X * Size.Y * Size.Z);
+	
+	const int32 Num = NumBricks.X * NumBricks.Y * NumBricks.Z;
+	
+	Bricks.Empty();
+	Bricks.Indices.Empty(Num);
+	Bricks.Indices.SetNumUninitialized(Num);
+	Bricks.Uniforms.Empty(Num);
+	Bricks.Uniforms.SetNumUninitialized(Num);
+
+	const T* RESTRICT const DensePtr = Dense.GetData();
+
+	const auto GetBrickBounds = [&](int32 BrickX, int32 BrickY, int32 BrickZ)
+	{
+		const FIntVector Min = FIntVector(BrickX, BrickY, BrickZ) * BrickSize;
+		return FVoxelIntBox(Min, FVoxelUtilities::ComponentMin(Min + BrickSize, Size));
+	};
+	const auto IsUniform = [&](const FVoxelIntBox& BrickBounds, const T& Value)
+	{
+		for (int32 Z = BrickBounds.Min.Z; Z < BrickBounds.Max.Z; Z++)
+		{
+			for (int32 Y = BrickBounds.Min.Y; Y < BrickBounds.Max.Y; Y++)
+			{
+				for (int32 X = BrickBounds.Min.X; X < BrickBounds.Max.X; X++)
+				{
+					if (!(DensePtr[GetIndex(X, Y, Z)] == Value))
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	};
+
+	int32 NumDenseBricks = 0;
+	for (int32 BrickZ = 0; BrickZ < NumBricks.Z; BrickZ++)
+	{
+		for (int32 BrickY = 0; BrickY < NumBricks.Y; BrickY++)
+		{
+			for (int32 BrickX = 0; BrickX < NumBricks.X; BrickX++)
+			{
+				const int32 Brick = GetBrickIndex(BrickX, BrickY, BrickZ);
+				const FVoxelIntBox BrickBounds = GetBrickBounds(BrickX, BrickY, BrickZ);
+				const T& FirstValue = DensePtr[GetIndex(BrickBounds.Min.X, BrickBounds.Min.Y, BrickBounds.Min.Z)];
+
+				Bricks.Uniforms[Brick] = FirstValue;
+				Bricks.Indices[Brick] = IsUniform(BrickBounds, FirstValue) ? -1 : BrickNumVoxels * NumDenseBricks++;
+			}
+		}
+	}
+
+	Bricks.Data.Empty(BrickNumVoxels * NumDenseBricks);
+	Bricks.Data.SetNumUninitialized(BrickNumVoxels * NumDenseBricks);
+	
+	for (int32 BrickZ = 0; BrickZ < NumBricks.Z; BrickZ++)
+	{
+		for (int32 BrickY = 0; BrickY < NumBricks.Y; BrickY++)
+		{
+			for (int32 BrickX = 0; BrickX < NumBricks.X; BrickX++)
+			{
+				const int32 Brick = GetBrickIndex(BrickX, BrickY, BrickZ);
+				const int32 DataIndex = Bricks.Indices[Brick];
+				if (DataIndex < 0)
+				{
+					continue;
+				}
+
+				T* RESTRICT const BrickData = Bricks.Data.GetData() + DataIndex;
+				
+				// Fill the padding of the bricks on the border with a valid voxel, to keep the saved data deterministic
+				for (int32 Index = 0; Index < BrickNumVoxels; Index++)
+				{
+					BrickData[Index] = Bricks.Uniforms[Brick];
+				}
+				
+				const FVoxelIntBox BrickBounds = GetBrickBounds(BrickX, BrickY, BrickZ);
+				for (int32 Z = BrickBounds.Min.Z; Z < BrickBounds.Max.Z; Z++)
+				{
+					for (int32 Y = BrickBounds.Min.Y; Y < BrickBounds.Max.Y; Y++)
+					{
+						for (int32 X = BrickBounds.Min.X; X < BrickBounds.Max.X; X++)
+						{
+							BrickData[GetIndexInBrick(X, Y, Z)] = DensePtr[GetIndex(X, Y, Z)];
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+template<typename T>
+void FVoxelDataAssetData::BuildDense(const TBricks<T>& Bricks, TNoGrowArray<T>& Dense) const
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	const int32 Num = Size.X * Size.Y * Size.Z;
+	Dense.Empty(Num);
+	Dense.SetNumUninitialized(Num);
+	
+	T* RESTRICT const DensePtr = Dense.GetData();
+	for (int32 Z = 0; Z < Size.Z; Z++)
+	{
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				DensePtr[GetIndex(X, Y, Z)] = GetBrickedVoxel(Bricks, X, Y, Z);
+			}
+		}
+	}
+}
+
+template<typename T>
+bool FVoxelDataAssetData::AreBricksValid(const TBricks<T>& Bricks) const
+{
+	const int32 Num = NumBricks.X * NumBricks.Y * NumBricks.Z;
+	if (Bricks.Indices.Num() != Num || Bricks.Uniforms.Num() != Num)
+	{
+		return false;
+	}
+	for (const int32 DataIndex : Bricks.Indices)
+	{
+		if (DataIndex >= 0 && (DataIndex % BrickNumVoxels != 0 || DataIndex + BrickNumVoxels > Bricks.Data.Num()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FVoxelDataAssetData::SerializeBricks(FArchive& Ar, uint32 ValueConfigFlag, uint32 MaterialConfigFlag)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto SerializationVersion = FVoxelSerializationVersion::SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage;
+
+	bool bHasMaterials = HasMaterials();
+	Ar << bHasMaterials;
+
+	// Dense data is bricked without being converted, as it might still be edited
+	TBricks<FVoxelValue> DenseValueBricks;
+	TBricks<FVoxelMaterial> DenseMaterialBricks;
+	const bool bSaveDense = Ar.IsSaving() && !bBricked;
+	if (bSaveDense)
+	{
+		BuildBricks(Values, DenseValueBricks);
+		if (bHasMaterials)
+		{
+			BuildBricks(Materials, DenseMaterialBricks);
+		}
+	}
+
+	TBricks<FVoxelValue>& ValueBricksToSerialize = bSaveDense ? DenseValueBricks : ValueBricks;
+	TBricks<FVoxelMaterial>& MaterialBricksToSerialize = bSaveDense ? DenseMaterialBricks : MaterialBricks;
+
+	Ar << ValueBricksToSerialize.Indices;
+	FVoxelSerializationUtilities::SerializeValues(Ar, ValueBricksToSerialize.Uniforms, ValueConfigFlag, SerializationVersion);
+	FVoxelSerializationUtilities::SerializeValues(Ar, ValueBricksToSerialize.Data, ValueConfigFlag, SerializationVersion);
+
+	if (bHasMaterials)
+	{
+		Ar << MaterialBricksToSerialize.Indices;
+		FVoxelSerializationUtilities::SerializeMaterials(Ar, MaterialBricksToSerialize.Uniforms, MaterialConfigFlag, SerializationVersion);
+		FVoxelSerializationUtilities::SerializeMaterials(Ar, MaterialBricksToSerialize.Data, MaterialConfigFlag, SerializationVersion);
+	}
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	if (Ar.IsError() ||
+		Size.GetMin() <= 0 ||
+		!AreBricksValid(ValueBricks) ||
+		(bHasMaterials && !AreBricksValid(MaterialBricks)))
+	{
+		Ar.SetError();
+		
+		Size = FIntVector(1, 1, 1);
+		NumBricks = FIntVector(1, 1, 1);
+		ValueBricks.Empty();
+		MaterialBricks.Empty();
+		Values = { FVoxelValue::Empty() };
+		Materials = { FVoxelMaterial::Default() };
+		return;
+	}
+	
+	bBricked = true;
+	Values.Empty();
+	Materials.Empty();
+	BuildBrickRanges();
 }
\ No newline at end of file
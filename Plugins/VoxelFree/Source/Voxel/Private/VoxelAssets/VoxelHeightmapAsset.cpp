@@ -14,10 +14,36 @@
 
 #include "Engine/Texture2D.h"
 #include "Misc/ScopedSlowTask.h"
+#include "HAL/IConsoleManager.h"
 
 #define LANDSCAPE_ASSET_THUMBNAIL_RES 128
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelHeightmapAssetMemory);
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelHeightmapAssetPagesMemory);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Heightmap Pages Paged In"), STAT_VoxelHeightmapPagesPagedIn, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Heightmap Pages Evicted"), STAT_VoxelHeightmapPagesEvicted, STATGROUP_VoxelCounters);
+
+static TAutoConsoleVariable<float> CVarHeightmapPagesBudgetMB(
+	TEXT("voxel.heightmap.PagesBudgetMB"),
+	256.f,
+	TEXT("Max size of the decompressed pages of a heightmap asset, in MB. Least recently used pages are evicted above that"),
+	ECVF_Default);
+
+int64 FVoxelHeightmapAssetPaging::GetMaxResidentPagesSize()
+{
+	return int64(FMath::Max(0.f, CVarHeightmapPagesBudgetMB.GetValueOnAnyThread()) * (1 << 20));
+}
+
+void FVoxelHeightmapAssetPaging::OnPageIn()
+{
+	INC_DWORD_STAT(STAT_VoxelHeightmapPagesPagedIn);
+}
+
+void FVoxelHeightmapAssetPaging::OnPagesEvicted(int32 NumPages)
+{
+	INC_DWORD_STAT_BY(STAT_VoxelHeightmapPagesEvicted, NumPages);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -59,21 +85,17 @@ void UVoxelHeightmapAsset::SaveData(const TVoxelHeightmapAssetData<T>& Data)
 {
 	Modify();
 	
-	FVoxelScopedSlowTask Saving(2.f);
+	FVoxelScopedSlowTask Saving(1.f);
 
 	VoxelCustomVersion = FVoxelHeightmapAssetDataVersion::LatestVersion;
 	MaterialConfigFlag = GVoxelMaterialConfigFlag;
 
-	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Serializing"));
+	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Compressing pages"));
 
-	FLargeMemoryWriter MemoryWriter(Data.GetAllocatedSize());
-	
-	bool bNeedToSave = false;
-	const_cast<TVoxelHeightmapAssetData<T>&>(Data).Serialize(MemoryWriter, MaterialConfigFlag, FVoxelHeightmapAssetDataVersion::Type(VoxelCustomVersion), bNeedToSave);
-	ensure(!bNeedToSave);
-	
-	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Compressing"));
-	FVoxelSerializationUtilities::CompressData(MemoryWriter, CompressedData);
+	// Data might be paged from the current array, don't modify it
+	const auto NewCompressedData = MakeVoxelShared<TArray<uint8>>();
+	Data.SavePaged(*NewCompressedData);
+	CompressedData = NewCompressedData;
 
 	SyncProperties(Data);
 
@@ -87,13 +109,31 @@ void UVoxelHeightmapAsset::SaveData(const TVoxelHeightmapAssetData<T>& Data)
 template<typename T>
 void UVoxelHeightmapAsset::LoadData(TVoxelHeightmapAssetData<T>& Data)
 {
-	if (CompressedData.Num() == 0)
+	if (CompressedData->Num() == 0)
 	{
 		// Nothing to load
 		return;
 	}
+
+	if (VoxelCustomVersion >= FVoxelHeightmapAssetDataVersion::TiledStorage)
+	{
+		VOXEL_SCOPE_COUNTER("Load paged heightmap");
+		
+		if (!Data.LoadPaged(CompressedData))
+		{
+			FVoxelMessages::Error("Failed to load heightmap pages, data is corrupted", this);
+			Data.ClearData();
+			return;
+		}
+
+		SyncProperties(Data);
+		return;
+	}
+
+	// Legacy format: everything was compressed as a single blob
+
 	TArray64<uint8> UncompressedData;
-	if (!FVoxelSerializationUtilities::DecompressData(CompressedData, UncompressedData))
+	if (!FVoxelSerializationUtilities::DecompressData(*CompressedData, UncompressedData))
 	{
 		FVoxelMessages::Error("Decompression failed, data is corrupted", this);
 		return;
@@ -112,10 +152,14 @@ void UVoxelHeightmapAsset::LoadData(TVoxelHeightmapAssetData<T>& Data)
 	}
 	ensure(MemoryReader.AtEnd());
 
-	if (bNeedToSave)
+#if WITH_EDITOR
+	// Resave legacy data in the editor, so that the next loads are paged
+	// Cooked builds can't save it anyways: keep using the flat data there
+	if (!FPlatformProperties::RequiresCookedData())
 	{
 		SaveData(Data);
 	}
+#endif
 
 	SyncProperties(Data);
 }
@@ -158,11 +202,16 @@ void UVoxelHeightmapAsset::Serialize(FArchive& Ar)
 		if (VoxelCustomVersion == FVoxelHeightmapAssetDataVersion::BeforeCustomVersionWasAdded)
 		{
 			Ar << MaterialConfigFlag;
-			Ar << CompressedData;
+			Ar << *CompressedData;
 		}
 		else
 		{
-			CompressedData.BulkSerialize(Ar);
+			if (Ar.IsLoading())
+			{
+				// The data might be paged from the previous array
+				CompressedData = MakeVoxelShared<TArray<uint8>>();
+			}
+			CompressedData->BulkSerialize(Ar);
 		}
 	}
 }
@@ -0,0 +1,175 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelAssets/VoxelHeightmapAsset.h"
+#include "VoxelAssets/VoxelHeightmapAssetData.h"
+#include "VoxelAssets/VoxelHeightmapAssetData.inl"
+
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Async/ParallelFor.h"
+
+// Compares the paged storage of heightmap assets against the flat one:
+// load time, resident memory and sampling throughput, on random positions and on scanlines, single threaded and multithreaded
+namespace FVoxelHeightmapAssetBenchmark
+{
+	// Positions are sampled in blocks, each with its own page cache, like generator queries
+	constexpr int32 SamplesPerBlock = 4096;
+
+	template<typename T>
+	double Sample(const TVoxelHeightmapAssetData<T>& Data, const TArray<FVector2D>& Positions, bool bMultiThreaded)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 NumBlocks = (Positions.Num() + SamplesPerBlock - 1) / SamplesPerBlock;
+
+		// Make sure the compiler doesn't skip the sampling
+		TArray<float> Sums;
+		Sums.SetNumZeroed(NumBlocks);
+
+		const double StartTime = FPlatformTime::Seconds();
+		ParallelFor(NumBlocks, [&](int32 Block)
+		{
+			typename TVoxelHeightmapAssetData<T>::FPageCache PageCache;
+
+			float Sum = 0;
+			for (int32 Index = Block * SamplesPerBlock; Index < FMath::Min(Positions.Num(), (Block + 1) * SamplesPerBlock); Index++)
+			{
+				Sum += Data.GetHeight(float(Positions[Index].X), float(Positions[Index].Y), EVoxelSamplerMode::Clamp, PageCache);
+			}
+			Sums[Block] = Sum;
+		}, !bMultiThreaded);
+		const double Time = FPlatformTime::Seconds() - StartTime;
+
+		float Sum = 0;
+		for (const float BlockSum : Sums)
+		{
+			Sum += BlockSum;
+		}
+		LOG_VOXEL(VeryVerbose, TEXT("Heightmap benchmark checksum: %f"), Sum);
+		return Time;
+	}
+
+	template<typename T>
+	void Run(const TVoxelHeightmapAssetData<T>& SourceData, const FString& Name, int32 NumSamples)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const auto Blob = MakeVoxelShared<TArray<uint8>>();
+		SourceData.SavePaged(*Blob);
+
+		const int64 Width = SourceData.GetWidth();
+		const int64 Height = SourceData.GetHeight();
+
+		TArray<FVector2D> RandomPositions;
+		TArray<FVector2D> ScanlinePositions;
+		{
+			FRandomStream Stream(1337);
+			RandomPositions.Reserve(NumSamples);
+			for (int32 Index = 0; Index < NumSamples; Index++)
+			{
+				RandomPositions.Emplace(Stream.FRandRange(0, Width - 1), Stream.FRandRange(0, Height - 1));
+			}
+
+			// Like a generator querying a 1024x1024 area voxel by voxel
+			const int32 AreaSize = FMath::Min<int64>(1024, FMath::Min(Width, Height));
+			ScanlinePositions.Reserve(NumSamples);
+			for (int32 Index = 0; Index < NumSamples; Index++)
+			{
+				const int32 Pixel = Index % (AreaSize * AreaSize);
+				ScanlinePositions.Emplace(Pixel % AreaSize + 0.5f, Pixel / AreaSize + 0.5f);
+			}
+		}
+
+		const auto Log = [&](const TCHAR* Storage, double LoadTime, int64 Memory, int64 ResidentAfterSampling, bool bMultiThreaded, double RandomTime, double ScanlineTime)
+		{
+			LOG_VOXEL(Log, TEXT("%s (%lldx%lld) %s: load %.2fms, %.2fMB resident after load, %.2fMB after sampling. %s: random: %.2f MSamples/s. Scanlines: %.2f MSamples/s"),
+				*Name,
+				Width,
+				Height,
+				Storage,
+				LoadTime * 1000,
+				Memory / double(1 << 20),
+				ResidentAfterSampling / double(1 << 20),
+				bMultiThreaded ? TEXT("Multithreaded") : TEXT("Single threaded"),
+				RandomTime > 0 ? NumSamples / RandomTime / 1e6 : 0,
+				ScanlineTime > 0 ? NumSamples / ScanlineTime / 1e6 : 0);
+		};
+
+		LOG_VOXEL(Log, TEXT("%s: %.2fMB compressed"), *Name, Blob->Num() / double(1 << 20));
+
+		{
+			TVoxelHeightmapAssetData<T> Data;
+
+			const double StartTime = FPlatformTime::Seconds();
+			const bool bSuccess = Data.LoadPaged(Blob);
+			const double LoadTime = FPlatformTime::Seconds() - StartTime;
+
+			if (!ensure(bSuccess))
+			{
+				return;
+			}
+
+			const int64 Memory = Data.GetAllocatedSize() + Data.GetResidentPagesSize();
+			for (const bool bMultiThreaded : { false, true })
+			{
+				const double RandomTime = Sample(Data, RandomPositions, bMultiThreaded);
+				const double ScanlineTime = Sample(Data, ScanlinePositions, bMultiThreaded);
+				Log(TEXT("paged"), LoadTime, Memory, Data.GetAllocatedSize() + Data.GetResidentPagesSize(), bMultiThreaded, RandomTime, ScanlineTime);
+			}
+		}
+		{
+			TVoxelHeightmapAssetData<T> Data;
+
+			// Decompressing all the pages at once costs the same as the flat storage load
+			const double StartTime = FPlatformTime::Seconds();
+			const bool bSuccess = Data.LoadPaged(Blob);
+			Data.Unpage();
+			const double LoadTime = FPlatformTime::Seconds() - StartTime;
+
+			if (!ensure(bSuccess))
+			{
+				return;
+			}
+
+			const int64 Memory = Data.GetAllocatedSize();
+			for (const bool bMultiThreaded : { false, true })
+			{
+				const double RandomTime = Sample(Data, RandomPositions, bMultiThreaded);
+				const double ScanlineTime = Sample(Data, ScanlinePositions, bMultiThreaded);
+				Log(TEXT("flat"), LoadTime, Memory, Data.GetAllocatedSize(), bMultiThreaded, RandomTime, ScanlineTime);
+			}
+		}
+	}
+}
+
+// eg: voxel.heightmap.Benchmark /Game/MyHeightmap 4000000
+static FAutoConsoleCommand HeightmapBenchmarkCmd(
+	TEXT("voxel.heightmap.Benchmark"),
+	TEXT("Compare the paged and flat storages of a heightmap asset, and log the load time, resident memory and single threaded and multithreaded sampling throughput. Args: [Heightmap asset path] [Num samples = 4000000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.heightmap.Benchmark: needs a heightmap asset path"));
+			return;
+		}
+
+		UVoxelHeightmapAsset* Asset = LoadObject<UVoxelHeightmapAsset>(nullptr, *Args[0]);
+		if (!Asset)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.heightmap.Benchmark: invalid heightmap asset %s"), *Args[0]);
+			return;
+		}
+
+		const int32 NumSamples = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4000000;
+
+		if (auto* UINT16Asset = Cast<UVoxelHeightmapAssetUINT16>(Asset))
+		{
+			FVoxelHeightmapAssetBenchmark::Run(UINT16Asset->GetData(), Asset->GetName(), NumSamples);
+		}
+		else if (auto* FloatAsset = Cast<UVoxelHeightmapAssetFloat>(Asset))
+		{
+			FVoxelHeightmapAssetBenchmark::Run(FloatAsset->GetData(), Asset->GetName(), NumSamples);
+		}
+	}));
@@ -309,33 +309,7 @@ UVoxelNoClippingComponent::FAsyncResult UVoxelNoClippingComponent::AsyncTask(con
 	FAsyncResult Result;
 	Result.bInsideSurface = true;
 
-	float BestDistance = 1e9;
-
-	// Somewhat suboptimal: we could query the voxels in "circles" instead
-	// It's so fast that it's probably not worth the hassle
-	const auto Values = Data.GetValues(Bounds);
-	const FIntVector Size = Bounds.Size();
-	for (int32 X = 0; X < Size.X; X++)
-	{
-		for (int32 Y = 0; Y < Size.Y; Y++)
-		{
-			for (int32 Z = 0; Z < Size.Z; Z++)
-			{
-				if (!Values[X + Size.X * Y + Size.X * Size.Y * Z].IsEmpty())
-				{
-					continue;
-				}
-
-				const FIntVector Position = Bounds.Min + FIntVector(X, Y, Z);
-				const float Distance = FVoxelVector::Distance(FVoxelVector(Position), ComponentLocation);
-				if (Distance < BestDistance)
-				{
-					BestDistance = Distance;
-					Result.ClosestSafeLocation = Position;
-				}
-			}
-		}
-	}
+	Result.ClosestSafeLocation = FVoxelDataUtilities::FindClosestVoxel(Data, ComponentLocation, SearchRange, true);
 	
 	const double EndTime = FPlatformTime::Seconds();
 
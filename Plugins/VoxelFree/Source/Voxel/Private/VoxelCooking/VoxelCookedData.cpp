@@ -19,7 +19,31 @@ bool FVoxelCookedDataImpl::Serialize(FArchive& Ar)
 
 		Ar << Version;
 		Ar << Guid;
-		Ar << Chunks;		
+
+		if (Version >= FVoxelCookedDataVersion::AddChunkPositionsAndFormat)
+		{
+			Ar << Format;
+		}
+		else
+		{
+			Format = EVoxelCookedDataFormat::PhysX;
+		}
+
+		int32 NumChunks = Chunks.Num();
+		Ar << NumChunks;
+		if (Ar.IsLoading())
+		{
+			Chunks.Reset();
+			Chunks.SetNum(NumChunks);
+		}
+		for (FChunk& Chunk : Chunks)
+		{
+			if (Version >= FVoxelCookedDataVersion::AddChunkPositionsAndFormat)
+			{
+				Ar << Chunk.Position;
+			}
+			Chunk.Data.BulkSerialize(Ar);
+		}
 		
 		UpdateAllocatedSize();
 	}
@@ -5,7 +5,10 @@
 #include "VoxelWorld.h"
 #include "VoxelMessages.h"
 #include "VoxelDefaultPool.h"
+#include "VoxelGenerators/VoxelGeneratorSnapshot.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.h"
 #include "VoxelData/VoxelDataIncludes.h"
+#include "VoxelData/VoxelSaveUtilities.h"
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelRender/Renderers/VoxelDefaultRenderer.h"
 #include "VoxelWorldRootComponent.h"
@@ -21,11 +24,29 @@
 #include "Engine/Private/PhysicsEngine/PhysXSupport.h" // For FPhysXInputStream
 
 #if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+#define VOXEL_COOKING_SUPPORTED 1
+static constexpr EVoxelCookedDataFormat CookedDataFormat = EVoxelCookedDataFormat::PhysX;
+#elif WITH_CHAOS
+#include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker_Chaos.h"
+#include "Chaos/ChaosArchive.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#define VOXEL_COOKING_SUPPORTED 1
+static constexpr EVoxelCookedDataFormat CookedDataFormat = EVoxelCookedDataFormat::Chaos;
+#else
+#define VOXEL_COOKING_SUPPORTED 0
+#endif
+
+#if VOXEL_COOKING_SUPPORTED
 struct FVoxelCookingTaskData
 {
 	IVoxelRenderer& Renderer;
 	FVoxelCookedDataImpl& CookedData;
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 	IPhysXCooking& PhysXCooking;
+#endif
 	
 	const int32 NumChunksToBuild;
 	const FVoxelCookingSettings CookingSettings;
@@ -39,7 +60,9 @@ struct FVoxelCookingTaskData
 	FVoxelCookingTaskData(IVoxelRenderer& Renderer, FVoxelCookedDataImpl& CookedData, int32 NumChunksToBuild, const FVoxelCookingSettings& CookingSettings)
 		: Renderer(Renderer)
 		, CookedData(CookedData)
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 		, PhysXCooking(*GetPhysXCookingModule()->GetPhysXCooking())
+#endif
 		, NumChunksToBuild(NumChunksToBuild)
 		, CookingSettings(CookingSettings)
 		, DoneEvent(FPlatformProcess::GetSynchEventFromPool())
@@ -52,7 +75,7 @@ struct FVoxelCookingTaskData
 		FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
 	}
 
-	void ChunkDone(TArray<uint8>&& Data)
+	void ChunkDone(const FIntVector& ChunkPosition, TArray<uint8>&& Data)
 	{
 		const int32 NumBuilt = NumChunksBuilt.Increment();
 		if (CookingSettings.bLogProgress)
@@ -60,7 +83,9 @@ struct FVoxelCookingTaskData
 			LOG_VOXEL(Log, TEXT("VOXEL COOKING: %d/%d"), NumBuilt, NumChunksToBuild);
 		}
 
-		CookedData.GetChunk(NumBuilt - 1).Data = MoveTemp(Data);
+		auto& Chunk = CookedData.GetChunk(NumBuilt - 1);
+		Chunk.Position = ChunkPosition;
+		Chunk.Data = MoveTemp(Data);
 
 		if (NumBuilt == NumChunksToBuild)
 		{
@@ -100,6 +125,15 @@ public:
 		TArray<uint8> Buffer;
 		if (Indices.Num() > 0)
 		{
+			check(Indices.Num() % 3 == 0);
+			
+			// Put the chunk in global space, as tri meshes don't support individual transforms
+			for (auto& Vertex : Vertices)
+			{
+				Vertex = (Vertex + FVector(ChunkPosition)) * TaskData.CookingSettings.VoxelSize;
+			}
+			
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 			static const FName PhysXFormat = FPlatformProperties::GetPhysicsFormat();
 			
 			EPhysXMeshCookFlags CookFlags = EPhysXMeshCookFlags::Default;
@@ -112,18 +146,10 @@ public:
 				CookFlags |= EPhysXMeshCookFlags::FastCook;
 			}
 
-			check(Indices.Num() % 3 == 0);
-			
 			TArray<FTriIndices> TriIndices;
 			TriIndices.SetNumUninitialized(Indices.Num() / 3);
 			FMemory::Memcpy(TriIndices.GetData(), Indices.GetData(), Indices.Num() * sizeof(int32));
 
-			// Put the chunk in global space, as tri meshes don't support individual transforms
-			for (auto& Vertex : Vertices)
-			{
-				Vertex = (Vertex + FVector(ChunkPosition)) * TaskData.CookingSettings.VoxelSize;
-			}
-			
 			constexpr bool bFlipNormals = true; // Always true due to the order of the vertices (clock wise vs not)
 
 			bool bResult;
@@ -135,6 +161,26 @@ public:
 				const uint64 EndTime = FPlatformTime::Cycles64();
 				TaskData.CollisionTime.Add(EndTime - StartTime);
 			}
+#else
+			bool bResult;
+			{
+				VOXEL_ASYNC_SCOPE_COUNTER("Cooking collision");
+			
+				const uint64 StartTime = FPlatformTime::Cycles64();
+				
+				TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> TriMesh = FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh(Vertices, Indices);
+				bResult = TriMesh.IsValid();
+				if (bResult)
+				{
+					FMemoryWriter Writer(Buffer);
+					Chaos::FChaosArchive ChaosArchive(Writer);
+					ChaosArchive << TriMesh;
+				}
+				
+				const uint64 EndTime = FPlatformTime::Cycles64();
+				TaskData.CollisionTime.Add(EndTime - StartTime);
+			}
+#endif
 
 			if (!bResult)
 			{
@@ -143,7 +189,7 @@ public:
 			}
 		}
 
-		TaskData.ChunkDone(MoveTemp(Buffer));
+		TaskData.ChunkDone(ChunkPosition, MoveTemp(Buffer));
 		delete this;
 	}
 	virtual void Abandon() override
@@ -157,7 +203,7 @@ public:
 };
 #endif
 
-FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save)
+FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save, const FVoxelCookedDataImpl* PreviousCookedData)
 {
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
@@ -205,33 +251,110 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 		return {};
 	}
 
-	const double StartTime = FPlatformTime::Seconds();
-	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Starting cooking with %lld tasks"), TotalNumChunks);
-
 	FVoxelCookedData CookedData;
 	
-#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
-	FVoxelCookingTaskData TaskData(*Renderer, CookedData.Mutable(), TotalNumChunks, Settings);
+#if VOXEL_COOKING_SUPPORTED
+	if (PreviousCookedData)
+	{
+		if (!PreviousCookedData->HasChunkPositions())
+		{
+			LOG_VOXEL(Warning, TEXT("VOXEL COOKING: Previous cooked data is too old to be updated incrementally, doing a full cook"));
+			PreviousCookedData = nullptr;
+		}
+		else if (PreviousCookedData->GetFormat() != CookedDataFormat)
+		{
+			LOG_VOXEL(Warning, TEXT("VOXEL COOKING: Previous cooked data was cooked for another physics engine, doing a full cook"));
+			PreviousCookedData = nullptr;
+		}
+	}
+
+	// In incremental mode, only the chunks touched by the save edits are re-cooked
+	// Map each edited leaf to the render chunks it touches, so that we don't test every chunk against every leaf
+	TSet<FIntVector> EditedChunks;
+	if (PreviousCookedData && Save)
+	{
+		const FVoxelSaveLoader Loader(*Save);
+		for (int32 Index = 0; Index < Loader.NumChunks(); Index++)
+		{
+			// Chunk positions are the leaves centers
+			const FIntVector LeafMin = Loader.GetChunkPosition(Index) - DATA_CHUNK_SIZE / 2;
+			// Meshers read a few voxels outside of their chunk: extend so that neighbors are re-cooked too
+			const FVoxelIntBox EditedBounds = FVoxelIntBox(LeafMin, LeafMin + DATA_CHUNK_SIZE).Extend(2).Overlap(Data->WorldBounds);
+
+			const FIntVector ChunksMin = FVoxelUtilities::DivideFloor(EditedBounds.Min - Min, RENDER_CHUNK_SIZE);
+			const FIntVector ChunksMax = FVoxelUtilities::DivideCeil(EditedBounds.Max - Min, RENDER_CHUNK_SIZE);
+			for (int32 X = ChunksMin.X; X < ChunksMax.X; X++)
+			{
+				for (int32 Y = ChunksMin.Y; Y < ChunksMax.Y; Y++)
+				{
+					for (int32 Z = ChunksMin.Z; Z < ChunksMax.Z; Z++)
+					{
+						EditedChunks.Add(Min + FIntVector(X, Y, Z) * RENDER_CHUNK_SIZE);
+					}
+				}
+			}
+		}
+	}
+	const auto IsChunkEdited = [&](const FIntVector& ChunkPosition)
+	{
+		return !PreviousCookedData || EditedChunks.Contains(ChunkPosition);
+	};
 
-	for (int32 X = Min.X; X < Max.X; X += RENDER_CHUNK_SIZE)
+	TArray<FIntVector> ChunksToCook;
+	if (PreviousCookedData)
 	{
-		for (int32 Y = Min.Y; Y < Max.Y; Y += RENDER_CHUNK_SIZE)
+		ChunksToCook = EditedChunks.Array();
+	}
+	else
+	{
+		for (int32 X = Min.X; X < Max.X; X += RENDER_CHUNK_SIZE)
 		{
-			for (int32 Z = Min.Z; Z < Max.Z; Z += RENDER_CHUNK_SIZE)
+			for (int32 Y = Min.Y; Y < Max.Y; Y += RENDER_CHUNK_SIZE)
 			{
-				const FIntVector ChunkPosition = FIntVector(X, Y, Z);
-				auto* Task = new FVoxelCookingTask(ChunkPosition, TaskData);
-				Pool->QueueTask({}, Task);
+				for (int32 Z = Min.Z; Z < Max.Z; Z += RENDER_CHUNK_SIZE)
+				{
+					ChunksToCook.Add(FIntVector(X, Y, Z));
+				}
 			}
 		}
 	}
 
+	const double StartTime = FPlatformTime::Seconds();
+	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Starting cooking with %d tasks"), ChunksToCook.Num());
+
+	FVoxelCookingTaskData TaskData(*Renderer, CookedData.Mutable(), ChunksToCook.Num(), Settings);
+	TaskData.CookedData.SetFormat(CookedDataFormat);
+
+	for (const FIntVector& ChunkPosition : ChunksToCook)
+	{
+		auto* Task = new FVoxelCookingTask(ChunkPosition, TaskData);
+		Pool->QueueTask({}, Task);
+	}
+
 	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Waiting for tasks"));
-	TaskData.DoneEvent->Wait();
+	if (ChunksToCook.Num() > 0)
+	{
+		TaskData.DoneEvent->Wait();
+	}
 	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Done"));
 
 	const double EndTime = FPlatformTime::Seconds();
 
+	if (PreviousCookedData)
+	{
+		// Keep the previous result for chunks that weren't touched
+		int32 NumReused = 0;
+		for (auto& Chunk : PreviousCookedData->GetChunks())
+		{
+			if (!IsChunkEdited(Chunk.Position))
+			{
+				TaskData.CookedData.AddChunk(Chunk);
+				NumReused++;
+			}
+		}
+		LOG_VOXEL(Log, TEXT("VOXEL COOKING: Reused %d chunks from previous cooked data"), NumReused);
+	}
+
 	TaskData.CookedData.RemoveEmptyChunks();
 	TaskData.CookedData.UpdateAllocatedSize();
 
@@ -254,6 +377,40 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 	return CookedData;
 }
 
+bool UVoxelCookingLibrary::BakeGeneratorSnapshot(AVoxelWorld* World, int32 ThreadCount)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!World)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Invalid Voxel World"));
+		return false;
+	}
+	if (!World->Generator.IsValid())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Invalid generator"));
+		return false;
+	}
+	if (World->GeneratorSnapshotPath.FilePath.IsEmpty())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Generator Snapshot Path is empty"));
+		return false;
+	}
+
+	const FVoxelGeneratorInit GeneratorInit = World->GetGeneratorInit();
+	const auto Generator = World->Generator.GetInstance(true);
+	Generator->Init(GeneratorInit);
+
+	FVoxelGeneratorSnapshot::FBakeStats Stats;
+	return FVoxelGeneratorSnapshot::Bake(
+		*Generator,
+		FVoxelGeneratorSnapshot::ComputeGeneratorHash(World->Generator, GeneratorInit),
+		World->GetWorldBounds(),
+		ThreadCount,
+		FVoxelGeneratorSnapshot::GetFullPath(World->GeneratorSnapshotPath.FilePath),
+		Stats);
+}
+
 FVoxelCookingSettings UVoxelCookingLibrary::MakeVoxelCookingSettingsFromVoxelWorld(AVoxelWorld* World, int32 ThreadCount)
 {
 	if (!World)
@@ -291,6 +448,14 @@ void UVoxelCookingLibrary::LoadCookedVoxelData(FVoxelCookedData CookedData, AVox
 
 	const auto& Chunks = CookedData.Const().GetChunks();
 
+#if VOXEL_COOKING_SUPPORTED
+	if (CookedData.Const().GetFormat() != CookedDataFormat)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Cooked data was cooked for another physics engine!"));
+		return;
+	}
+#endif
+
 #if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 	TArray<physx::PxTriangleMesh*> TriMeshes;
 	TriMeshes.Reserve(Chunks.Num());
@@ -305,6 +470,28 @@ void UVoxelCookingLibrary::LoadCookedVoxelData(FVoxelCookedData CookedData, AVox
 		}
 	}
 
+	WorldRoot.SetCookedTriMeshes(TriMeshes);
+#elif WITH_CHAOS
+	TArray<TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>> TriMeshes;
+	TriMeshes.Reserve(Chunks.Num());
+	
+	for (auto& Chunk : Chunks)
+	{
+		if (ensure(Chunk.Data.Num() > 0))
+		{
+			FMemoryReader Reader(Chunk.Data);
+			Chaos::FChaosArchive ChaosArchive(Reader);
+			
+			TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> TriMesh;
+			ChaosArchive << TriMesh;
+			
+			if (ensure(TriMesh.IsValid()))
+			{
+				TriMeshes.Add(TriMesh);
+			}
+		}
+	}
+
 	WorldRoot.SetCookedTriMeshes(TriMeshes);
 #else
 	ensure(false);
@@ -13,6 +13,7 @@
 #include "VoxelWorld.h"
 #include "VoxelQueryZone.h"
 #include "VoxelGenerators/VoxelGeneratorHelpers.h"
+#include "VoxelGenerators/VoxelGeneratorSnapshot.h"
 #include "VoxelPlaceableItems/VoxelPlaceableItem.h"
 
 #include "Misc/ScopeLock.h"
@@ -41,8 +42,13 @@ DEFINE_STAT(STAT_NumVoxelDataItems);
 
 inline auto CreateGenerator(const AVoxelWorld* World)
 {
-	auto GeneratorInstance = World->Generator.GetInstance(true);
+	TVoxelSharedRef<FVoxelGeneratorInstance> GeneratorInstance = World->Generator.GetInstance(true);
 	GeneratorInstance->Init(World->GetGeneratorInit());
+	if (!World->GeneratorSnapshotPath.FilePath.IsEmpty())
+	{
+		const uint32 GeneratorHash = FVoxelGeneratorSnapshot::ComputeGeneratorHash(World->Generator, World->GetGeneratorInit());
+		GeneratorInstance = FVoxelGeneratorSnapshot::CreateInstance(GeneratorInstance, GeneratorHash, World->GeneratorSnapshotPath.FilePath);
+	}
 	return GeneratorInstance;
 }
 
@@ -0,0 +1,114 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelData/VoxelDataUtilities.h"
+#include "VoxelData/VoxelDataIncludes.h"
+
+TOptional<FIntVector> FVoxelDataUtilities::FindClosestVoxel(const FVoxelData& Data, const FVoxelVector& Position, int32 SearchRange, bool bSearchEmpty)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const FVoxelIntBox SearchBounds = FVoxelIntBox(Position).Extend(FMath::Max(1, SearchRange));
+	if (!SearchBounds.Intersect(Data.WorldBounds))
+	{
+		return {};
+	}
+	const FVoxelIntBox Bounds = SearchBounds.Overlap(Data.WorldBounds);
+
+	// Closest voxel to Position inside CellBounds. Distances are separable, so we can clamp each axis independently
+	const auto GetClosestVoxelInBounds = [&](const FVoxelIntBox& CellBounds)
+	{
+		return FIntVector(
+			FMath::Clamp<int32>(FMath::RoundToInt(Position.X), CellBounds.Min.X, CellBounds.Max.X - 1),
+			FMath::Clamp<int32>(FMath::RoundToInt(Position.Y), CellBounds.Min.Y, CellBounds.Max.Y - 1),
+			FMath::Clamp<int32>(FMath::RoundToInt(Position.Z), CellBounds.Min.Z, CellBounds.Max.Z - 1));
+	};
+	const auto GetDistanceSquared = [&](const FIntVector& Voxel)
+	{
+		return FVoxelVector::DistSquared(FVoxelVector(Voxel), Position);
+	};
+
+	struct FCell
+	{
+		FVoxelIntBox Bounds;
+		float MinDistanceSquared;
+	};
+
+	// Split the search bounds along the data chunks, so that single value leaves map to entire cells
+	TArray<FCell> Cells;
+	{
+		const FIntVector CellsMin = FVoxelUtilities::DivideFloor(Bounds.Min, DATA_CHUNK_SIZE);
+		const FIntVector CellsMax = FVoxelUtilities::DivideCeil(Bounds.Max, DATA_CHUNK_SIZE);
+		Cells.Reserve((CellsMax - CellsMin).X * (CellsMax - CellsMin).Y * (CellsMax - CellsMin).Z);
+
+		for (int32 X = CellsMin.X; X < CellsMax.X; X++)
+		{
+			for (int32 Y = CellsMin.Y; Y < CellsMax.Y; Y++)
+			{
+				for (int32 Z = CellsMin.Z; Z < CellsMax.Z; Z++)
+				{
+					const FIntVector CellMin = FIntVector(X, Y, Z) * DATA_CHUNK_SIZE;
+					const FVoxelIntBox CellBounds = FVoxelIntBox(CellMin, CellMin + DATA_CHUNK_SIZE).Overlap(Bounds);
+					Cells.Add({ CellBounds, GetDistanceSquared(GetClosestVoxelInBounds(CellBounds)) });
+				}
+			}
+		}
+	}
+
+	// Visit the cells in shells of increasing distance
+	Cells.Sort([](const FCell& A, const FCell& B) { return A.MinDistanceSquared < B.MinDistanceSquared; });
+
+	TOptional<FIntVector> BestVoxel;
+	float BestDistanceSquared = MAX_flt;
+
+	TArray<FVoxelValue> Values;
+	for (const FCell& Cell : Cells)
+	{
+		if (Cell.MinDistanceSquared >= BestDistanceSquared)
+		{
+			// All the remaining cells are further away
+			break;
+		}
+
+		// Uses single value leaves and generator ranges
+		const TVoxelRange<FVoxelValue> Range = Data.GetValueRange(Cell.Bounds, 0);
+		if (Range.Min.IsEmpty() == Range.Max.IsEmpty())
+		{
+			if (Range.Min.IsEmpty() == bSearchEmpty)
+			{
+				// The whole cell matches: the closest voxel is the best one, and no other cell can be closer
+				BestVoxel = GetClosestVoxelInBounds(Cell.Bounds);
+				break;
+			}
+			continue;
+		}
+
+		Values.SetNumUninitialized(Cell.Bounds.Count(), false);
+		TVoxelQueryZone<FVoxelValue> QueryZone(Cell.Bounds, Values);
+		Data.Get(QueryZone, 0);
+
+		const FIntVector Size = Cell.Bounds.Size();
+		for (int32 Z = 0; Z < Size.Z; Z++)
+		{
+			for (int32 Y = 0; Y < Size.Y; Y++)
+			{
+				for (int32 X = 0; X < Size.X; X++)
+				{
+					if (Values[X + Size.X * Y + Size.X * Size.Y * Z].IsEmpty() != bSearchEmpty)
+					{
+						continue;
+					}
+
+					const FIntVector Voxel = Cell.Bounds.Min + FIntVector(X, Y, Z);
+					const float DistanceSquared = GetDistanceSquared(Voxel);
+					if (DistanceSquared < BestDistanceSquared)
+					{
+						BestDistanceSquared = DistanceSquared;
+						BestVoxel = Voxel;
+					}
+				}
+			}
+		}
+	}
+
+	return BestVoxel;
+}
@@ -0,0 +1,135 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelData/VoxelDataUtilities.h"
+#include "VoxelData/VoxelDataIncludes.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+// Compares FindClosestVoxel against copying the search box and scanning every voxel, like UVoxelNoClippingComponent used to
+namespace FVoxelFindClosestVoxelBenchmark
+{
+	TOptional<FIntVector> FindClosestVoxelBruteForce(const FVoxelData& Data, const FVoxelVector& Position, int32 SearchRange, bool bSearchEmpty)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FVoxelIntBox SearchBounds = FVoxelIntBox(Position).Extend(FMath::Max(1, SearchRange));
+		if (!SearchBounds.Intersect(Data.WorldBounds))
+		{
+			return {};
+		}
+		const FVoxelIntBox Bounds = SearchBounds.Overlap(Data.WorldBounds);
+
+		TOptional<FIntVector> Result;
+		double BestDistance = 1e9;
+
+		const TArray<FVoxelValue> Values = Data.GetValues(Bounds);
+		const FIntVector Size = Bounds.Size();
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			for (int32 Y = 0; Y < Size.Y; Y++)
+			{
+				for (int32 Z = 0; Z < Size.Z; Z++)
+				{
+					if (Values[X + Size.X * Y + Size.X * Size.Y * Z].IsEmpty() != bSearchEmpty)
+					{
+						continue;
+					}
+
+					const FIntVector Voxel = Bounds.Min + FIntVector(X, Y, Z);
+					const double Distance = FVoxelVector::Distance(FVoxelVector(Voxel), Position);
+					if (Distance < BestDistance)
+					{
+						BestDistance = Distance;
+						Result = Voxel;
+					}
+				}
+			}
+		}
+		return Result;
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 16;
+		const int32 Extent = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 64;
+
+		const FVoxelData& Data = World.GetData();
+
+		FRandomStream Stream(0);
+		TArray<FVoxelVector> Positions;
+		for (int32 Index = 0; Index < NumQueries; Index++)
+		{
+			Positions.Add(FVoxelVector(
+				Stream.FRandRange(-Extent, Extent),
+				Stream.FRandRange(-Extent, Extent),
+				Stream.FRandRange(-Extent, Extent)));
+		}
+
+		for (const int32 SearchRange : { 8, 32, 128 })
+		{
+			for (const bool bSearchEmpty : { true, false })
+			{
+				double Time = 0;
+				double BruteForceTime = 0;
+				int32 NumFound = 0;
+				int32 NumDifferent = 0;
+
+				for (const FVoxelVector& Position : Positions)
+				{
+					FVoxelReadScopeLock Lock(Data, FVoxelIntBox(Position).Extend(SearchRange), FUNCTION_FNAME);
+
+					double StartTime = FPlatformTime::Seconds();
+					const TOptional<FIntVector> Result = FVoxelDataUtilities::FindClosestVoxel(Data, Position, SearchRange, bSearchEmpty);
+					Time += FPlatformTime::Seconds() - StartTime;
+
+					StartTime = FPlatformTime::Seconds();
+					const TOptional<FIntVector> BruteForceResult = FindClosestVoxelBruteForce(Data, Position, SearchRange, bSearchEmpty);
+					BruteForceTime += FPlatformTime::Seconds() - StartTime;
+
+					NumFound += Result.IsSet();
+
+					// Several voxels can be at the same distance: only compare the distances
+					if (Result.IsSet() != BruteForceResult.IsSet() ||
+						(Result.IsSet() && !FMath::IsNearlyEqual(
+							FVoxelVector::Distance(FVoxelVector(Result.GetValue()), Position),
+							FVoxelVector::Distance(FVoxelVector(BruteForceResult.GetValue()), Position),
+							1e-3)))
+					{
+						NumDifferent++;
+					}
+				}
+
+				LOG_VOXEL(Log, TEXT("Search range %d, searching %s voxels: %d/%d found. Shells: %.3fms per query. Brute force: %.3fms per query. Speedup: %.1fx%s"),
+					SearchRange,
+					bSearchEmpty ? TEXT("empty") : TEXT("non empty"),
+					NumFound,
+					NumQueries,
+					Time / NumQueries * 1000,
+					BruteForceTime / NumQueries * 1000,
+					Time > 0 ? BruteForceTime / Time : 0,
+					NumDifferent > 0 ? *FString::Printf(TEXT(". FAILED: %d results differ"), NumDifferent) : TEXT(""));
+			}
+		}
+	}
+}
+
+// eg: voxel.data.BenchmarkFindClosestVoxel 32 64
+static FAutoConsoleCommandWithWorldAndArgs FindClosestVoxelBenchmarkCmd(
+	TEXT("voxel.data.BenchmarkFindClosestVoxel"),
+	TEXT("Find the closest empty and non empty voxels to random positions at search ranges 8, 32 and 128 in all the voxel worlds in the scene, and compare the latency against a brute force scan. Args: [Num queries = 16] [Positions extent = 64]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelFindClosestVoxelBenchmark::Run(**It, Args);
+			}
+		}
+	}));
@@ -6,6 +6,8 @@
 #include "VoxelWorld.h"
 #include "VoxelMinimal.h"
 
+#include "Async/ParallelFor.h"
+
 DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Num Voxel Events"), STAT_NumVoxelEvents, STATGROUP_VoxelCounters);
 DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Event Manager - Num active or generated chunks"), STAT_VoxelEventManager_NumActiveOrGeneratedChunks, STATGROUP_VoxelCounters);
 
@@ -17,6 +19,12 @@ static TAutoConsoleVariable<int32> CVarShowEventsBounds(
 	TEXT("If true, will show event updates bounds"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarEventsMultiThreadingThreshold(
+	TEXT("voxel.events.MultiThreadingThreshold"),
+	4096,
+	TEXT("Number of chunk columns above which invoker updates are multi threaded"),
+	ECVF_Default);
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -256,6 +264,141 @@ void FVoxelEventManager::Update()
 	}
 }
 
+FVoxelEventManager::FInvokerChunks::FInvokerChunks(const FIntVector& Position, int32 ChunkSize, int32 DistanceInChunks, const FVoxelIntBox& WorldBounds)
+{
+	const int32 Radius = ChunkSize * DistanceInChunks;
+	const uint64 SquaredRadius = FMath::Square<uint64>(Radius);
+	
+	const FIntVector MinChunkPosition = FVoxelUtilities::ComponentMax(
+		FVoxelUtilities::DivideFloor(Position - Radius, ChunkSize),
+		FVoxelUtilities::DivideFloor(WorldBounds.Min, ChunkSize));
+	// Max is exclusive, since this is the coordinate of the Bounds.Min of the chunk
+	const FIntVector MaxChunkPosition = FVoxelUtilities::ComponentMin(
+		FVoxelUtilities::DivideCeil(Position + Radius, ChunkSize),
+		FVoxelUtilities::DivideCeil(WorldBounds.Max, ChunkSize));
+
+	if (MinChunkPosition.X >= MaxChunkPosition.X ||
+		MinChunkPosition.Y >= MaxChunkPosition.Y ||
+		MinChunkPosition.Z >= MaxChunkPosition.Z)
+	{
+		return;
+	}
+
+	Min = FIntPoint(MinChunkPosition.X, MinChunkPosition.Y);
+	Max = FIntPoint(MaxChunkPosition.X, MaxChunkPosition.Y);
+	ZRanges.SetNumUninitialized(NumColumns());
+
+	// Same as FVoxelIntBox::ComputeSquaredDistanceFromBoxToPoint, for a single axis
+	const auto GetAxisDistance = [&](int32 Chunk, int32 Point) -> int64
+	{
+		const int32 ChunkMin = Chunk * ChunkSize;
+		const int32 ChunkMax = (Chunk + 1) * ChunkSize;
+		if (Point < ChunkMin) return ChunkMin - Point;
+		if (Point > ChunkMax) return Point - ChunkMax;
+		return 0;
+	};
+	
+	for (int32 Y = Min.Y; Y < Max.Y; Y++)
+	{
+		const uint64 DistanceY = FMath::Square<uint64>(GetAxisDistance(Y, Position.Y));
+		for (int32 X = Min.X; X < Max.X; X++)
+		{
+			FIntPoint& ZRange = ZRanges[(X - Min.X) + (Y - Min.Y) * (Max.X - Min.X)];
+			
+			const uint64 DistanceXY = DistanceY + FMath::Square<uint64>(GetAxisDistance(X, Position.X));
+			if (DistanceXY > SquaredRadius)
+			{
+				ZRange = FIntPoint(0, 0);
+				continue;
+			}
+
+			// Largest Z distance allowed in this column
+			const uint64 RemainingSquaredDistance = SquaredRadius - DistanceXY;
+			int64 DistanceZ = FMath::FloorToInt(FMath::Sqrt(double(RemainingSquaredDistance)));
+			while (DistanceZ > 0 && uint64(DistanceZ * DistanceZ) > RemainingSquaredDistance) DistanceZ--;
+			while (uint64((DistanceZ + 1) * (DistanceZ + 1)) <= RemainingSquaredDistance) DistanceZ++;
+
+			// A chunk is in range if Chunk * ChunkSize <= Position + DistanceZ and (Chunk + 1) * ChunkSize >= Position - DistanceZ
+			ZRange.X = FMath::Max(MinChunkPosition.Z, FVoxelUtilities::DivideCeil(Position.Z - int32(DistanceZ), ChunkSize) - 1);
+			ZRange.Y = FMath::Min(MaxChunkPosition.Z, FVoxelUtilities::DivideFloor(Position.Z + int32(DistanceZ), ChunkSize) + 1);
+		}
+	}
+}
+
+void FVoxelEventManager::GetInvokerChunksDelta(const FInvokerChunks& Old, const FInvokerChunks& New, TArray<FIntVector>& Added, TArray<FIntVector>& Removed)
+{
+	const auto GetUnion = [](const FInvokerChunks& A, const FInvokerChunks& B, FIntPoint& OutMin, FIntPoint& OutMax)
+	{
+		if (A.NumColumns() == 0) { OutMin = B.Min; OutMax = B.Max; return; }
+		if (B.NumColumns() == 0) { OutMin = A.Min; OutMax = A.Max; return; }
+		OutMin = FIntPoint(FMath::Min(A.Min.X, B.Min.X), FMath::Min(A.Min.Y, B.Min.Y));
+		OutMax = FIntPoint(FMath::Max(A.Max.X, B.Max.X), FMath::Max(A.Max.Y, B.Max.Y));
+	};
+
+	FIntPoint UnionMin;
+	FIntPoint UnionMax;
+	GetUnion(Old, New, UnionMin, UnionMax);
+	
+	const int32 MultiThreadingThreshold = CVarEventsMultiThreadingThreshold.GetValueOnGameThread();
+	const int32 NumX = UnionMax.X - UnionMin.X;
+	const bool bMultiThreaded = NumX > 0 && NumX * (UnionMax.Y - UnionMin.Y) >= MultiThreadingThreshold;
+
+	TArray<TArray<FIntVector>> LocalAdded;
+	TArray<TArray<FIntVector>> LocalRemoved;
+	LocalAdded.SetNum(FMath::Max(0, NumX));
+	LocalRemoved.SetNum(FMath::Max(0, NumX));
+
+	ParallelFor(FMath::Max(0, NumX), [&](int32 Index)
+	{
+		const int32 X = UnionMin.X + Index;
+		const auto AddRange = [&](TArray<FIntVector>& Array, int32 Y, int32 ZMin, int32 ZMax)
+		{
+			for (int32 Z = ZMin; Z < ZMax; Z++)
+			{
+				Array.Emplace(X, Y, Z);
+			}
+		};
+		
+		for (int32 Y = UnionMin.Y; Y < UnionMax.Y; Y++)
+		{
+			const FIntPoint OldRange = Old.GetZRange(X, Y);
+			const FIntPoint NewRange = New.GetZRange(X, Y);
+			const bool bOldEmpty = OldRange.X >= OldRange.Y;
+			const bool bNewEmpty = NewRange.X >= NewRange.Y;
+
+			if (bOldEmpty && bNewEmpty)
+			{
+				continue;
+			}
+			if (bOldEmpty)
+			{
+				AddRange(LocalAdded[Index], Y, NewRange.X, NewRange.Y);
+				continue;
+			}
+			if (bNewEmpty)
+			{
+				AddRange(LocalRemoved[Index], Y, OldRange.X, OldRange.Y);
+				continue;
+			}
+
+			// Only the two ends of the ranges can differ
+			AddRange(LocalAdded[Index], Y, NewRange.X, FMath::Min(NewRange.Y, OldRange.X));
+			AddRange(LocalAdded[Index], Y, FMath::Max(NewRange.X, OldRange.Y), NewRange.Y);
+			AddRange(LocalRemoved[Index], Y, OldRange.X, FMath::Min(OldRange.Y, NewRange.X));
+			AddRange(LocalRemoved[Index], Y, FMath::Max(OldRange.X, NewRange.Y), OldRange.Y);
+		}
+	}, !bMultiThreaded);
+
+	for (auto& Array : LocalAdded)
+	{
+		Added.Append(Array);
+	}
+	for (auto& Array : LocalRemoved)
+	{
+		Removed.Append(Array);
+	}
+}
+
 void FVoxelEventManager::UpdateInvokers(const TArray<TPair<FEventKey, TArray<FIntVector>>>& InvokersToUpdate)
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -273,108 +416,118 @@ void FVoxelEventManager::UpdateInvokers(const TArray<TPair<FEventKey, TArray<FIn
 			return FVoxelIntBox(Chunk * EventInfo.ChunkSize, (Chunk + 1) * EventInfo.ChunkSize);
 		};
 
-		TSet<FIntVector> NewActiveChunks;
+		// Chunks whose ref count went from or to 0
+		TSet<FIntVector> ChangedChunks;
 		{
-			VOXEL_SCOPE_COUNTER("Find NewActiveChunks");
+			VOXEL_SCOPE_COUNTER("Update ChunkRefCounts");
 
-			// NOTE: This part could be multi threaded
+			// Invokers are matched by index: since we are only tracking ref counts, it doesn't matter which invoker moved where
+			const int32 NumInvokers = FMath::Max(InvokerPositions.Num(), EventInfo.InvokersChunks.Num());
 			
-			// Iterate every position and add all chunks within activation radius
-			for (const FIntVector& InvokerPosition : InvokerPositions)
-			{
-				const FIntVector MinChunkPosition = FVoxelUtilities::DivideFloor(InvokerPosition - EventInfo.ChunkSize * EventInfo.DistanceInChunks, EventInfo.ChunkSize);
-				// Max is exclusive, since this is the coordinate of the Bounds.Min of the chunk
-				const FIntVector MaxChunkPosition = FVoxelUtilities::DivideCeil(InvokerPosition + EventInfo.ChunkSize * EventInfo.DistanceInChunks, EventInfo.ChunkSize);
+			TArray<FInvokerChunks> NewInvokersChunks;
+			NewInvokersChunks.SetNum(InvokerPositions.Num());
 
-				if (!Settings.WorldBounds.Intersect(FVoxelIntBox(MinChunkPosition, MaxChunkPosition)))
+			const FInvokerChunks EmptyChunks;
+			TArray<FIntVector> Added;
+			TArray<FIntVector> Removed;
+			for (int32 Index = 0; Index < NumInvokers; Index++)
+			{
+				const FInvokerChunks& OldChunks = EventInfo.InvokersChunks.IsValidIndex(Index) ? EventInfo.InvokersChunks[Index] : EmptyChunks;
+				if (InvokerPositions.IsValidIndex(Index))
 				{
-					continue;
+					NewInvokersChunks[Index] = FInvokerChunks(InvokerPositions[Index], EventInfo.ChunkSize, EventInfo.DistanceInChunks, Settings.WorldBounds);
 				}
+				const FInvokerChunks& NewChunks = InvokerPositions.IsValidIndex(Index) ? NewInvokersChunks[Index] : EmptyChunks;
+				
+				Added.Reset();
+				Removed.Reset();
+				GetInvokerChunksDelta(OldChunks, NewChunks, Added, Removed);
 
-				const uint64 SquaredDistanceInVoxels = FMath::Square(EventInfo.DistanceInChunks * EventInfo.ChunkSize);
-
-				for (int32 X = MinChunkPosition.X; X < MaxChunkPosition.X; X++)
+				for (const FIntVector& Chunk : Added)
 				{
-					for (int32 Y = MinChunkPosition.Y; Y < MaxChunkPosition.Y; Y++)
+					int32& RefCount = EventInfo.ChunkRefCounts.FindOrAdd(Chunk);
+					if (RefCount++ == 0)
 					{
-						for (int32 Z = MinChunkPosition.Z; Z < MaxChunkPosition.Z; Z++)
-						{
-							const FIntVector Chunk = FIntVector(X, Y, Z);
-							const FVoxelIntBox ChunkBounds = GetChunkBounds(Chunk);
-							
-							if (ChunkBounds.ComputeSquaredDistanceFromBoxToPoint(InvokerPosition) <= SquaredDistanceInVoxels &&
-								ChunkBounds.Intersect(Settings.WorldBounds))
-							{
-								NewActiveChunks.Add(Chunk);
-							}
-						}
+						ChangedChunks.Add(Chunk);
+					}
+				}
+				for (const FIntVector& Chunk : Removed)
+				{
+					int32* RefCount = EventInfo.ChunkRefCounts.Find(Chunk);
+					if (!ensureVoxelSlow(RefCount))
+					{
+						continue;
+					}
+					if (--*RefCount == 0)
+					{
+						EventInfo.ChunkRefCounts.Remove(Chunk);
+						ChangedChunks.Add(Chunk);
 					}
 				}
 			}
+
+			EventInfo.InvokersChunks = MoveTemp(NewInvokersChunks);
 		}
 
 		{
 			VOXEL_SCOPE_COUNTER("Fire Delegates");
 
-			if (EventInfo.Flags & EVoxelEventFlags::GenerationEvent)
+			// Generation event: trigger all chunks not already triggered
+			// Normal event: activate new chunks, deactivate old chunks
+			TArray<FIntVector> ActivatedChunks;
+			TArray<FIntVector> DeactivatedChunks;
+			for (const FIntVector& Chunk : ChangedChunks)
 			{
-				// Generation event: trigger all chunks not already triggered
-				ensure(!EventInfo.OnDeactivate.IsBound());
-				if (ensure(EventInfo.OnActivate.IsBound()))
+				if (EventInfo.ChunkRefCounts.Contains(Chunk))
 				{
-					for (auto& Chunk : NewActiveChunks)
+					bool bAlreadyInSet;
+					EventInfo.ActiveOrGeneratedChunks.Add(Chunk, &bAlreadyInSet);
+					if (!bAlreadyInSet)
 					{
-						bool bAlreadyInSet;
-						EventInfo.ActiveOrGeneratedChunks.Add(Chunk, &bAlreadyInSet);
-						if (!bAlreadyInSet)
-						{
-							const FVoxelIntBox Bounds = GetChunkBounds(Chunk);
-							EventInfo.OnActivate.Broadcast(Bounds);
-
-							if (bDebug)
-							{
-								UVoxelDebugUtilities::DrawDebugIntBox(Settings.VoxelWorldInterface.Get(), Bounds, 1.f, 0, FColor::Yellow);
-							}
-						}
+						ActivatedChunks.Add(Chunk);
+					}
+				}
+				else if (!(EventInfo.Flags & EVoxelEventFlags::GenerationEvent))
+				{
+					if (EventInfo.ActiveOrGeneratedChunks.Remove(Chunk) > 0)
+					{
+						DeactivatedChunks.Add(Chunk);
 					}
 				}
 			}
-			else
+			
+			if (EventInfo.Flags & EVoxelEventFlags::GenerationEvent)
+			{
+				ensure(!EventInfo.OnDeactivate.IsBound());
+				ensure(EventInfo.OnActivate.IsBound());
+			}
+			
+			if (EventInfo.OnActivate.IsBound())
 			{
-				// Normal event: activate new chunks, deactivate old chunks
-				if (EventInfo.OnActivate.IsBound())
+				const FColor Color = (EventInfo.Flags & EVoxelEventFlags::GenerationEvent) ? FColor::Yellow : FColor::Blue;
+				for (const FIntVector& Chunk : ActivatedChunks)
 				{
-					for (auto& Chunk : NewActiveChunks)
+					const FVoxelIntBox Bounds = GetChunkBounds(Chunk);
+					EventInfo.OnActivate.Broadcast(Bounds);
+
+					if (bDebug)
 					{
-						if (!EventInfo.ActiveOrGeneratedChunks.Contains(Chunk))
-						{
-							const FVoxelIntBox Bounds = GetChunkBounds(Chunk);
-							EventInfo.OnActivate.Broadcast(Bounds);
-
-							if (bDebug)
-							{
-								UVoxelDebugUtilities::DrawDebugIntBox(Settings.VoxelWorldInterface.Get(), Bounds, 1.f, 0, FColor::Blue);
-							}
-						}
+						UVoxelDebugUtilities::DrawDebugIntBox(Settings.VoxelWorldInterface.Get(), Bounds, 1.f, 0, Color);
 					}
 				}
-				if (EventInfo.OnDeactivate.IsBound())
+			}
+			if (EventInfo.OnDeactivate.IsBound())
+			{
+				for (const FIntVector& Chunk : DeactivatedChunks)
 				{
-					for (auto& Chunk : EventInfo.ActiveOrGeneratedChunks)
+					const FVoxelIntBox Bounds = GetChunkBounds(Chunk);
+					EventInfo.OnDeactivate.Broadcast(Bounds);
+
+					if (bDebug)
 					{
-						if (!NewActiveChunks.Contains(Chunk))
-						{
-							const FVoxelIntBox Bounds = GetChunkBounds(Chunk);
-							EventInfo.OnDeactivate.Broadcast(Bounds);
-
-							if (bDebug)
-							{
-								UVoxelDebugUtilities::DrawDebugIntBox(Settings.VoxelWorldInterface.Get(), Bounds, 1.f, 0, FColor::Red);
-							}
-						}
+						UVoxelDebugUtilities::DrawDebugIntBox(Settings.VoxelWorldInterface.Get(), Bounds, 1.f, 0, FColor::Red);
 					}
 				}
-				EventInfo.ActiveOrGeneratedChunks = NewActiveChunks;
 			}
 		}
 	}
@@ -0,0 +1,162 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelEvents/VoxelEventManager.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+// Moves invokers in a line and compares the incremental invoker update against rebuilding the set of active chunks on every update,
+// the way FVoxelEventManager::UpdateInvokers used to
+class FVoxelEventManagerBenchmark
+{
+public:
+	static constexpr int32 ChunkSize = 32;
+	static constexpr int32 NumUpdates = 32;
+
+	// Returns the number of chunks activated or deactivated
+	static int32 UpdateActiveChunksReference(const TArray<FIntVector>& InvokerPositions, int32 DistanceInChunks, const FVoxelIntBox& WorldBounds, TSet<FIntVector>& ActiveChunks)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TSet<FIntVector> NewActiveChunks;
+		for (const FIntVector& InvokerPosition : InvokerPositions)
+		{
+			const FIntVector MinChunkPosition = FVoxelUtilities::DivideFloor(InvokerPosition - ChunkSize * DistanceInChunks, ChunkSize);
+			const FIntVector MaxChunkPosition = FVoxelUtilities::DivideCeil(InvokerPosition + ChunkSize * DistanceInChunks, ChunkSize);
+			if (!WorldBounds.Intersect(FVoxelIntBox(MinChunkPosition, MaxChunkPosition)))
+			{
+				continue;
+			}
+			const uint64 SquaredDistanceInVoxels = FMath::Square(DistanceInChunks * ChunkSize);
+
+			for (int32 X = MinChunkPosition.X; X < MaxChunkPosition.X; X++)
+			{
+				for (int32 Y = MinChunkPosition.Y; Y < MaxChunkPosition.Y; Y++)
+				{
+					for (int32 Z = MinChunkPosition.Z; Z < MaxChunkPosition.Z; Z++)
+					{
+						const FIntVector Chunk = FIntVector(X, Y, Z);
+						const FVoxelIntBox ChunkBounds(Chunk * ChunkSize, (Chunk + 1) * ChunkSize);
+						if (ChunkBounds.ComputeSquaredDistanceFromBoxToPoint(InvokerPosition) <= SquaredDistanceInVoxels &&
+							ChunkBounds.Intersect(WorldBounds))
+						{
+							NewActiveChunks.Add(Chunk);
+						}
+					}
+				}
+			}
+		}
+
+		int32 NumChanges = 0;
+		for (const FIntVector& Chunk : NewActiveChunks)
+		{
+			NumChanges += !ActiveChunks.Contains(Chunk);
+		}
+		for (const FIntVector& Chunk : ActiveChunks)
+		{
+			NumChanges += !NewActiveChunks.Contains(Chunk);
+		}
+		ActiveChunks = MoveTemp(NewActiveChunks);
+		return NumChanges;
+	}
+
+	static void RunCase(AVoxelWorld& World, int32 NumInvokers, int32 DistanceInChunks, float ChunksPerUpdate)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const TVoxelSharedRef<FVoxelEventManager> Manager = FVoxelEventManager::Create(FVoxelEventManagerSettings(&World, EVoxelPlayType::Game));
+
+		int32 NumChanges = 0;
+		const FChunkDelegate CountChanges = FChunkDelegate::CreateLambda([&](FVoxelIntBox) { NumChanges++; });
+		const FVoxelEventHandle Handle = Manager->BindEvent(false, ChunkSize, DistanceInChunks, CountChanges, CountChanges);
+		const FVoxelEventManager::FEventKey Key{ ChunkSize, DistanceInChunks, EVoxelEventFlags::None };
+
+		TSet<FIntVector> ReferenceActiveChunks;
+		int32 NumReferenceChanges = 0;
+
+		double Time = 0;
+		double ReferenceTime = 0;
+		int32 NumMismatches = 0;
+
+		for (int32 Update = 0; Update < NumUpdates; Update++)
+		{
+			// Invokers spread along Y, all flying along X
+			TArray<FIntVector> Positions;
+			for (int32 Index = 0; Index < NumInvokers; Index++)
+			{
+				Positions.Add(FIntVector(
+					FMath::RoundToInt(Update * ChunksPerUpdate * ChunkSize),
+					(Index - NumInvokers / 2) * DistanceInChunks * ChunkSize,
+					0));
+			}
+
+			TArray<TPair<FVoxelEventManager::FEventKey, TArray<FIntVector>>> InvokersToUpdate;
+			InvokersToUpdate.Emplace(Key, Positions);
+
+			double StartTime = FPlatformTime::Seconds();
+			Manager->UpdateInvokers(InvokersToUpdate);
+			Time += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			NumReferenceChanges += UpdateActiveChunksReference(Positions, DistanceInChunks, Manager->Settings.WorldBounds, ReferenceActiveChunks);
+			ReferenceTime += FPlatformTime::Seconds() - StartTime;
+
+			const TSet<FIntVector>& ActiveChunks = Manager->Events[Key]->ActiveOrGeneratedChunks;
+			if (ActiveChunks.Num() != ReferenceActiveChunks.Num() || ActiveChunks.Difference(ReferenceActiveChunks).Num() > 0)
+			{
+				NumMismatches++;
+			}
+		}
+
+		Manager->UnbindEvent(Handle);
+		Manager->Destroy();
+
+		LOG_VOXEL(Log, TEXT("%2d invokers, distance %2d chunks, speed %.2f chunks/update: %d chunk events. Incremental: %.3fms/update. Rebuild: %.3fms/update. Speedup: %.1fx%s"),
+			NumInvokers,
+			DistanceInChunks,
+			ChunksPerUpdate,
+			NumChanges,
+			Time / NumUpdates * 1000,
+			ReferenceTime / NumUpdates * 1000,
+			Time > 0 ? ReferenceTime / Time : 0,
+			NumMismatches > 0 || NumChanges != NumReferenceChanges
+			? *FString::Printf(TEXT(". FAILED: active chunks differ on %d updates, %d events instead of %d"), NumMismatches, NumChanges, NumReferenceChanges)
+			: TEXT(""));
+	}
+
+	static void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 MaxInvokers = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 16) : 16;
+
+		for (int32 NumInvokers = 1; NumInvokers <= MaxInvokers; NumInvokers *= 2)
+		{
+			for (const int32 DistanceInChunks : { 4, 8, 16 })
+			{
+				for (const float ChunksPerUpdate : { 0.25f, 1.f, 4.f })
+				{
+					RunCase(World, NumInvokers, DistanceInChunks, ChunksPerUpdate);
+				}
+			}
+		}
+	}
+};
+
+// eg: voxel.events.Benchmark 16
+static FAutoConsoleCommandWithWorldAndArgs EventManagerBenchmarkCmd(
+	TEXT("voxel.events.Benchmark"),
+	TEXT("Move 1 to N invokers at various speeds and distances in an event manager of the voxel worlds in the scene, check the active chunks against a full rebuild and log the update timings of both. Args: [Max num invokers = 16]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelEventManagerBenchmark::Run(**It, Args);
+			}
+		}
+	}));
@@ -0,0 +1,292 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelGenerators/VoxelGenerator.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "VoxelGenerators/VoxelGeneratorInit.h"
+#include "VoxelQueryZone.h"
+#include "VoxelItemStack.h"
+#include "VoxelRange.h"
+
+#include "UObject/UObjectIterator.h"
+#include "UObject/Package.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+// Queries generators in isolation, without any voxel world: unlike FVoxelMesherTimes, the timings don't include meshing
+// Can be run headless, eg: -nullrhi -ExecCmds="voxel.generator.Benchmark 4 /Game/MyHeightmap /Game/MyDataAsset"
+namespace FVoxelGeneratorBenchmark
+{
+	constexpr int32 LODs[] = { 0, 2, 4 };
+	constexpr int32 BlockSizes[] = { 16, 32, 64 };
+	constexpr int32 NumUpVectors = 1 << 16;
+
+	// Blocks of BlockSize^3 voxels at LOD, centered on the origin so that most generators have a surface in them
+	TArray<FVoxelIntBox> GetBlocks(int32 BlocksPerAxis, int32 BlockSize, int32 LOD)
+	{
+		const int32 Size = BlockSize << LOD;
+
+		TArray<FVoxelIntBox> Blocks;
+		Blocks.Reserve(BlocksPerAxis * BlocksPerAxis * BlocksPerAxis);
+		for (int32 X = 0; X < BlocksPerAxis; X++)
+		{
+			for (int32 Y = 0; Y < BlocksPerAxis; Y++)
+			{
+				for (int32 Z = 0; Z < BlocksPerAxis; Z++)
+				{
+					const FIntVector Min = (FIntVector(X, Y, Z) - FIntVector(BlocksPerAxis / 2)) * Size;
+					Blocks.Add(FVoxelIntBox(Min, Min + Size));
+				}
+			}
+		}
+		return Blocks;
+	}
+
+	template<typename TLambda>
+	double Measure(int32 Num, bool bMultiThreaded, TLambda Lambda)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		ParallelFor(Num, Lambda, !bMultiThreaded);
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	template<typename T>
+	double QueryBlocks(const FVoxelGeneratorInstance& Instance, const TArray<FVoxelIntBox>& Blocks, int32 BlockSize, int32 LOD, bool bMultiThreaded)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		return Measure(Blocks.Num(), bMultiThreaded, [&](int32 Index)
+		{
+			// Allocated per block like the meshers do
+			TArray<T> Data;
+			Data.SetNumUninitialized(BlockSize * BlockSize * BlockSize);
+
+			TVoxelQueryZone<T> QueryZone(Blocks[Index], FIntVector(BlockSize), LOD, Data);
+			Instance.Get<T>(QueryZone, LOD, FVoxelItemStack::Empty);
+		});
+	}
+
+	double QueryRanges(const FVoxelGeneratorInstance& Instance, const TArray<FVoxelIntBox>& Blocks, int32 LOD, bool bMultiThreaded, int32& OutNumSkippedBlocks)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		FThreadSafeCounter NumSkippedBlocks;
+		const double Time = Measure(Blocks.Num(), bMultiThreaded, [&](int32 Index)
+		{
+			const TVoxelRange<v_flt> Range = Instance.GetValueRange(Blocks[Index], LOD, FVoxelItemStack::Empty);
+			if (Range.Min > 0 || Range.Max < 0)
+			{
+				NumSkippedBlocks.Increment();
+			}
+		});
+		OutNumSkippedBlocks = NumSkippedBlocks.GetValue();
+		return Time;
+	}
+
+	double QueryUpVectors(const FVoxelGeneratorInstance& Instance, const TArray<FVector>& Points, bool bMultiThreaded)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		// Make sure the compiler doesn't skip the queries
+		TArray<float> Checksums;
+		Checksums.SetNumZeroed(Points.Num());
+
+		const double Time = Measure(Points.Num(), bMultiThreaded, [&](int32 Index)
+		{
+			const FVector& Point = Points[Index];
+			Checksums[Index] = Instance.GetUpVector(Point.X, Point.Y, Point.Z).Z;
+		});
+
+		float Checksum = 0;
+		for (float Value : Checksums)
+		{
+			Checksum += Value;
+		}
+		LOG_VOXEL(VeryVerbose, TEXT("Generator benchmark up vectors checksum: %f"), Checksum);
+
+		return Time;
+	}
+
+	TSharedRef<FJsonObject> MakeTimings(double SingleThreadedTime, double MultiThreadedTime, int64 Num, const TCHAR* Unit)
+	{
+		const auto Result = MakeShared<FJsonObject>();
+		Result->SetNumberField(TEXT("SingleThreadedMs"), SingleThreadedTime * 1000);
+		Result->SetNumberField(TEXT("MultiThreadedMs"), MultiThreadedTime * 1000);
+		Result->SetNumberField(FString::Printf(TEXT("SingleThreadedNsPer%s"), Unit), Num > 0 ? SingleThreadedTime / Num * 1e9 : 0);
+		Result->SetNumberField(FString::Printf(TEXT("MultiThreadedNsPer%s"), Unit), Num > 0 ? MultiThreadedTime / Num * 1e9 : 0);
+		Result->SetNumberField(TEXT("Speedup"), MultiThreadedTime > 0 ? SingleThreadedTime / MultiThreadedTime : 0);
+		return Result;
+	}
+
+	TSharedRef<FJsonObject> RunGenerator(UVoxelGenerator& Generator, int32 BlocksPerAxis)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const double InitStartTime = FPlatformTime::Seconds();
+		const TVoxelSharedRef<FVoxelGeneratorInstance> Instance = Generator.GetInstance();
+		Instance->Init(FVoxelGeneratorInit());
+		const double InitTime = FPlatformTime::Seconds() - InitStartTime;
+
+		TArray<TSharedPtr<FJsonValue>> Queries;
+		for (const int32 LOD : LODs)
+		{
+			for (const int32 BlockSize : BlockSizes)
+			{
+				const TArray<FVoxelIntBox> Blocks = GetBlocks(BlocksPerAxis, BlockSize, LOD);
+				const int64 NumVoxels = int64(Blocks.Num()) * BlockSize * BlockSize * BlockSize;
+
+				const double ValuesTime = QueryBlocks<FVoxelValue>(*Instance, Blocks, BlockSize, LOD, false);
+				const double ValuesTimeMT = QueryBlocks<FVoxelValue>(*Instance, Blocks, BlockSize, LOD, true);
+				const double MaterialsTime = QueryBlocks<FVoxelMaterial>(*Instance, Blocks, BlockSize, LOD, false);
+				const double MaterialsTimeMT = QueryBlocks<FVoxelMaterial>(*Instance, Blocks, BlockSize, LOD, true);
+
+				int32 NumSkippedBlocks = 0;
+				const double RangesTime = QueryRanges(*Instance, Blocks, LOD, false, NumSkippedBlocks);
+				const double RangesTimeMT = QueryRanges(*Instance, Blocks, LOD, true, NumSkippedBlocks);
+
+				const auto Query = MakeShared<FJsonObject>();
+				Query->SetNumberField(TEXT("LOD"), LOD);
+				Query->SetNumberField(TEXT("BlockSize"), BlockSize);
+				Query->SetNumberField(TEXT("Blocks"), Blocks.Num());
+				Query->SetNumberField(TEXT("Voxels"), NumVoxels);
+				Query->SetObjectField(TEXT("GetValues"), MakeTimings(ValuesTime, ValuesTimeMT, NumVoxels, TEXT("Voxel")));
+				Query->SetObjectField(TEXT("GetMaterials"), MakeTimings(MaterialsTime, MaterialsTimeMT, NumVoxels, TEXT("Voxel")));
+				Query->SetObjectField(TEXT("GetValueRange"), MakeTimings(RangesTime, RangesTimeMT, Blocks.Num(), TEXT("Query")));
+				Query->SetNumberField(TEXT("BlocksProvenWithoutSurface"), NumSkippedBlocks);
+				Queries.Add(MakeShared<FJsonValueObject>(Query));
+
+				LOG_VOXEL(Log, TEXT("%s LOD %d, %d^3 blocks: values %.1fns/voxel (%.1fx on %d threads), materials %.1fns/voxel, ranges %.1fns/query (%d/%d blocks proven without surface)"),
+					*Generator.GetName(),
+					LOD,
+					BlockSize,
+					ValuesTime / NumVoxels * 1e9,
+					ValuesTimeMT > 0 ? ValuesTime / ValuesTimeMT : 0,
+					FTaskGraphInterface::Get().GetNumWorkerThreads() + 1,
+					MaterialsTime / NumVoxels * 1e9,
+					RangesTime / Blocks.Num() * 1e9,
+					NumSkippedBlocks,
+					Blocks.Num());
+			}
+		}
+
+		// Same area as the LOD 0 blocks
+		const float Extent = BlocksPerAxis * BlockSizes[0] / 2.f;
+		FRandomStream Stream(0);
+		TArray<FVector> Points;
+		Points.Reserve(NumUpVectors);
+		for (int32 Index = 0; Index < NumUpVectors; Index++)
+		{
+			Points.Add(FVector(
+				Stream.FRandRange(-Extent, Extent),
+				Stream.FRandRange(-Extent, Extent),
+				Stream.FRandRange(-Extent, Extent)));
+		}
+		const double UpVectorsTime = QueryUpVectors(*Instance, Points, false);
+		const double UpVectorsTimeMT = QueryUpVectors(*Instance, Points, true);
+
+		const auto Result = MakeShared<FJsonObject>();
+		Result->SetStringField(TEXT("Name"), Generator.GetName());
+		Result->SetStringField(TEXT("Class"), Generator.GetClass()->GetName());
+		Result->SetStringField(TEXT("Path"), Generator.GetPathName());
+		Result->SetNumberField(TEXT("InitMs"), InitTime * 1000);
+		Result->SetArrayField(TEXT("Queries"), Queries);
+		Result->SetObjectField(TEXT("GetUpVector"), MakeTimings(UpVectorsTime, UpVectorsTimeMT, Points.Num(), TEXT("Query")));
+		return Result;
+	}
+
+	// All the native generators that can be created without an asset: flat, empty, graphs compiled to C++...
+	TArray<UVoxelGenerator*> GetBuiltInGenerators()
+	{
+		TArray<UVoxelGenerator*> Generators;
+		for (TObjectIterator<UClass> It; It; ++It)
+		{
+			UClass* Class = *It;
+			if (!Class->IsChildOf<UVoxelGenerator>() ||
+				!Class->HasAnyClassFlags(CLASS_Native) ||
+				// Asset based generators, eg heightmaps, data assets and graphs, are HideDropdown
+				Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists | CLASS_HideDropDown))
+			{
+				continue;
+			}
+			Generators.Add(NewObject<UVoxelGenerator>(GetTransientPackage(), Class));
+		}
+		Generators.Sort([](const UVoxelGenerator& A, const UVoxelGenerator& B) { return A.GetClass()->GetName() < B.GetClass()->GetName(); });
+		return Generators;
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		int32 BlocksPerAxis = 4;
+		FString Path = FPaths::ProjectSavedDir() / TEXT("VoxelBenchmarks") / FString::Printf(TEXT("Generators_%s.json"), *FDateTime::Now().ToString());
+		TArray<UVoxelGenerator*> Generators = GetBuiltInGenerators();
+
+		for (int32 Index = 0; Index < Args.Num(); Index++)
+		{
+			const FString& Arg = Args[Index];
+			if (Index == 0 && Arg.IsNumeric())
+			{
+				BlocksPerAxis = FMath::Clamp(FCString::Atoi(*Arg), 1, 16);
+			}
+			else if (Arg.EndsWith(TEXT(".json")))
+			{
+				Path = Arg;
+			}
+			else if (UVoxelGenerator* Generator = LoadObject<UVoxelGenerator>(nullptr, *Arg))
+			{
+				Generators.Add(Generator);
+			}
+			else
+			{
+				LOG_VOXEL(Error, TEXT("voxel.generator.Benchmark: invalid generator %s"), *Arg);
+			}
+		}
+
+		LOG_VOXEL(Log, TEXT("Generator benchmark: %d generators, %d^3 blocks per query, %d task graph workers"),
+			Generators.Num(),
+			BlocksPerAxis,
+			FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+		TArray<TSharedPtr<FJsonValue>> Results;
+		for (UVoxelGenerator* Generator : Generators)
+		{
+			Results.Add(MakeShared<FJsonValueObject>(RunGenerator(*Generator, BlocksPerAxis)));
+		}
+
+		const auto Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("Date"), FDateTime::Now().ToIso8601());
+		Root->SetNumberField(TEXT("Threads"), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+		Root->SetNumberField(TEXT("BlocksPerAxis"), BlocksPerAxis);
+		Root->SetArrayField(TEXT("Generators"), Results);
+
+		FString Json;
+		const auto Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		if (FFileHelper::SaveStringToFile(Json, *Path))
+		{
+			LOG_VOXEL(Log, TEXT("Generator benchmark written to %s"), *Path);
+		}
+		else
+		{
+			LOG_VOXEL(Error, TEXT("Failed to write generator benchmark to %s"), *Path);
+		}
+	}
+}
+
+static FAutoConsoleCommand GeneratorBenchmarkCmd(
+	TEXT("voxel.generator.Benchmark"),
+	TEXT("Query all the built-in generators and the given generator assets across LODs and block sizes, single and multi threaded, and write the timings as JSON. ")
+	TEXT("Args: [Blocks per axis = 4] [Output path ending with .json] [Generator asset paths, eg heightmaps, data assets or graphs]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelGeneratorBenchmark::Run(Args);
+	}));
@@ -2,14 +2,44 @@
 
 #include "VoxelGenerators/VoxelGeneratorCache.h"
 #include "VoxelGenerators/VoxelGeneratorInstance.h"
-#include "VoxelGenerators/VoxelGeneratorTools.h"
+#include "VoxelGenerators/VoxelGeneratorInstanceCache.h"
+#include "VoxelGenerators/VoxelGeneratorInstanceWrapper.h"
+#include "VoxelMessages.h"
+
+UVoxelGeneratorCache::UVoxelGeneratorCache()
+	: InstanceCache(MakeVoxelShared<FVoxelGeneratorInstanceCache>(FVoxelGeneratorInit()))
+{
+#if WITH_EDITOR
+	if (!HasAnyFlags(RF_ClassDefaultObject))
+	{
+		FCoreUObjectDelegates::OnObjectPropertyChanged.AddWeakLambda(this, [=](UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+		{
+			if (PropertyChangedEvent.ChangeType == EPropertyChangeType::Interactive)
+			{
+				return;
+			}
+			if (Object && Object->IsA<UVoxelGenerator>())
+			{
+				InvalidateGenerator(Object);
+			}
+		});
+	}
+#endif
+}
 
 UVoxelGeneratorInstanceWrapper* UVoxelGeneratorCache::MakeGeneratorInstance(FVoxelGeneratorPicker Picker) const
 {
 	auto*& Instance = Cache.FindOrAdd(Picker);
 	if (!Instance)
 	{
-		Instance = UVoxelGeneratorTools::MakeGeneratorInstance(Picker, GeneratorInit);
+		if (!Picker.IsValid())
+		{
+			FVoxelMessages::Error(FUNCTION_ERROR("Invalid generator"));
+			return nullptr;
+		}
+		
+		Instance = NewObject<UVoxelGeneratorInstanceWrapper>();
+		Instance->Instance = InstanceCache->GetInstance(Picker);
 	}
 	return Instance;
 }
@@ -19,7 +49,66 @@ UVoxelTransformableGeneratorInstanceWrapper* UVoxelGeneratorCache::MakeTransform
 	auto*& Instance = TransformableCache.FindOrAdd(Picker);
 	if (!Instance)
 	{
-		Instance = UVoxelGeneratorTools::MakeTransformableGeneratorInstance(Picker, GeneratorInit);
+		if (!Picker.IsValid())
+		{
+			FVoxelMessages::Error(FUNCTION_ERROR("Invalid generator"));
+			return nullptr;
+		}
+		
+		Instance = NewObject<UVoxelTransformableGeneratorInstanceWrapper>();
+		Instance->Instance = InstanceCache->GetTransformableInstance(Picker);
 	}
 	return Instance;
-}
\ No newline at end of file
+}
+
+void UVoxelGeneratorCache::InvalidateGenerator(UObject* Generator)
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	InstanceCache->Invalidate(Generator);
+
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().GetObject() == Generator)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = TransformableCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().GetObject() == Generator)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void UVoxelGeneratorCache::SetGeneratorInit(const FVoxelGeneratorInit& NewInit)
+{
+	GeneratorInit = NewInit;
+
+	// The instances are initialized with the previous init
+	ClearCache();
+	InstanceCache = MakeVoxelShared<FVoxelGeneratorInstanceCache>(GeneratorInit);
+}
+
+void UVoxelGeneratorCache::ClearCache()
+{
+	Cache.Reset();
+	TransformableCache.Reset();
+	InstanceCache->Clear();
+}
+
+void UVoxelGeneratorCache::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+
+	// Instances added to the instance cache directly, eg by WarmUp, are not in the UPROPERTY maps: keep their generators alive
+	TArray<UObject*> Objects;
+	CastChecked<UVoxelGeneratorCache>(InThis)->InstanceCache->GetReferencedObjects(Objects);
+	Collector.AddReferencedObjects(Objects);
+}
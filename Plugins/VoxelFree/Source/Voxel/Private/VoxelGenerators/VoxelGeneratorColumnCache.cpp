@@ -0,0 +1,267 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelGenerators/VoxelGeneratorColumnCache.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelGeneratorColumnCacheMemory);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Column Cache Hits"), STAT_VoxelGeneratorColumnCacheHits, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Column Cache Misses"), STAT_VoxelGeneratorColumnCacheMisses, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Column Cache Evictions"), STAT_VoxelGeneratorColumnCacheEvictions, STATGROUP_VoxelCounters);
+
+static TAutoConsoleVariable<int32> CVarEnableColumnCache(
+	TEXT("voxel.generator.ColumnCache"),
+	1,
+	TEXT("If true, generators will cache the data they compute per column (eg the XY stage of graphs) and reuse it across queries"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarColumnCacheSizeMB(
+	TEXT("voxel.generator.ColumnCache.SizeMB"),
+	16.f,
+	TEXT("Max size of the column cache of a generator instance, in MB. Least recently used tiles are evicted above that"),
+	ECVF_Default);
+
+// Sum of all the caches, used by the benchmark
+static FThreadSafeCounter64 GlobalHits;
+static FThreadSafeCounter64 GlobalMisses;
+static FThreadSafeCounter64 GlobalEvictions;
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelGeneratorColumnCache::~FVoxelGeneratorColumnCache()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorColumnCacheMemory, Tiles.GetValuesAllocatedSize());
+}
+
+bool FVoxelGeneratorColumnCache::IsEnabled()
+{
+	return CVarEnableColumnCache.GetValueOnAnyThread() != 0;
+}
+
+void FVoxelGeneratorColumnCache::Clear()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto Changes = Tiles.Empty();
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorColumnCacheMemory, Changes.RemovedSize);
+}
+
+FVoxelGeneratorColumnCache::FStats FVoxelGeneratorColumnCache::GetStats() const
+{
+	FStats Stats;
+	Stats.Hits = Hits.GetValue();
+	Stats.Misses = Misses.GetValue();
+	Stats.Evictions = Evictions.GetValue();
+	Stats.NumTiles = Tiles.Num();
+	Stats.AllocatedSize = Tiles.GetValuesAllocatedSize();
+	return Stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<const FVoxelGeneratorColumnCache::FTile> FVoxelGeneratorColumnCache::Find(const FKey& Key)
+{
+	const TVoxelSharedPtr<const FTile> Tile = Tiles.Find(Key);
+	if (!Tile.IsValid())
+	{
+		Misses.Increment();
+		GlobalMisses.Increment();
+		INC_DWORD_STAT(STAT_VoxelGeneratorColumnCacheMisses);
+		return nullptr;
+	}
+
+	Hits.Increment();
+	GlobalHits.Increment();
+	INC_DWORD_STAT(STAT_VoxelGeneratorColumnCacheHits);
+	return Tile;
+}
+
+TVoxelSharedRef<const FVoxelGeneratorColumnCache::FTile> FVoxelGeneratorColumnCache::Add(const FKey& Key, const TVoxelSharedRef<const FTile>& Tile)
+{
+	const int64 MaxSize = int64(FMath::Max(0.f, CVarColumnCacheSizeMB.GetValueOnAnyThread()) * (1 << 20));
+
+	TVoxelLRUCache<FKey, FTile>::FChanges Changes;
+	const TVoxelSharedRef<const FTile> Result = Tiles.Add(Key, Tile, MaxSize, Changes);
+
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorColumnCacheMemory, Changes.AddedSize);
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorColumnCacheMemory, Changes.RemovedSize);
+
+	Evictions.Add(Changes.NumEvicted);
+	GlobalEvictions.Add(Changes.NumEvicted);
+	INC_DWORD_STAT_BY(STAT_VoxelGeneratorColumnCacheEvictions, Changes.NumEvicted);
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Queries the generator of a voxel world with and without the column cache:
+// - Tall: columns of chunks stacked vertically, all at LOD 0
+// - MultiLOD: the same area at every LOD from MaxLOD to 0 and back, like when flying over an area and leaving it
+namespace FVoxelGeneratorColumnCacheBenchmark
+{
+	struct FResult
+	{
+		double Time = 0;
+		int64 NumVoxels = 0;
+		int64 Hits = 0;
+		int64 Misses = 0;
+		int64 Evictions = 0;
+	};
+
+	template<typename TLambda>
+	FResult Measure(bool bEnableCache, TLambda Lambda)
+	{
+		IConsoleVariable* CVar = CVarEnableColumnCache.AsVariable();
+		const int32 OldValue = CVar->GetInt();
+		CVar->Set(bEnableCache ? 1 : 0);
+
+		const int64 StartHits = GlobalHits.GetValue();
+		const int64 StartMisses = GlobalMisses.GetValue();
+		const int64 StartEvictions = GlobalEvictions.GetValue();
+		const double StartTime = FPlatformTime::Seconds();
+
+		FResult Result;
+		Result.NumVoxels = Lambda();
+
+		Result.Time = FPlatformTime::Seconds() - StartTime;
+		Result.Hits = GlobalHits.GetValue() - StartHits;
+		Result.Misses = GlobalMisses.GetValue() - StartMisses;
+		Result.Evictions = GlobalEvictions.GetValue() - StartEvictions;
+
+		CVar->Set(OldValue);
+		return Result;
+	}
+
+	int64 QueryChunk(const FVoxelGeneratorInstance& Generator, const FIntVector& Position, int32 LOD, TArray<FVoxelValue>& Values)
+	{
+		const int32 Size = 32;
+		const FVoxelIntBox Bounds(Position, Position + (Size << LOD));
+
+		Values.SetNumUninitialized(Size * Size * Size);
+		TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, FIntVector(Size), LOD, Values);
+		Generator.GetValues(QueryZone, LOD, FVoxelItemStack::Empty);
+
+		return Size * Size * Size;
+	}
+
+	void LogResults(const TCHAR* Name, const FResult& Uncached, const FResult& Cached)
+	{
+		const auto VoxelsPerSecond = [](const FResult& Result)
+		{
+			return Result.Time > 0 ? Result.NumVoxels / Result.Time / 1e6 : 0;
+		};
+		const int64 NumQueries = Cached.Hits + Cached.Misses;
+		LOG_VOXEL(Log, TEXT("%s: uncached %.2fms (%.2f MVoxels/s), cached %.2fms (%.2f MVoxels/s), %lld hits, %lld misses (%.1f%% hit rate), %lld evictions"),
+			Name,
+			Uncached.Time * 1000,
+			VoxelsPerSecond(Uncached),
+			Cached.Time * 1000,
+			VoxelsPerSecond(Cached),
+			Cached.Hits,
+			Cached.Misses,
+			NumQueries > 0 ? 100. * Cached.Hits / NumQueries : 0.,
+			Cached.Evictions);
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 Radius = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 8;
+		const int32 MaxLOD = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 0, 8) : 2;
+
+		TArray<FVoxelValue> Values;
+
+		// Use new instances so that the cache of the world isn't reused
+		const auto MakeGenerator = [&]()
+		{
+			const auto Generator = World.Generator.GetInstance(false);
+			Generator->Init(World.GetGeneratorInit());
+			return Generator;
+		};
+
+		const auto Tall = [&]()
+		{
+			const auto Generator = MakeGenerator();
+			int64 NumVoxels = 0;
+			for (int32 X = -Radius; X < Radius; X++)
+			{
+				for (int32 Y = -Radius; Y < Radius; Y++)
+				{
+					for (int32 Z = -Height / 2; Z < Height - Height / 2; Z++)
+					{
+						NumVoxels += QueryChunk(*Generator, FIntVector(X, Y, Z) * 32, 0, Values);
+					}
+				}
+			}
+			return NumVoxels;
+		};
+
+		const auto MultiLOD = [&]()
+		{
+			const auto Generator = MakeGenerator();
+			const int32 AreaSize = 32 * Radius << MaxLOD;
+
+			TArray<int32> LODs;
+			for (int32 LOD = MaxLOD; LOD >= 0; LOD--)
+			{
+				LODs.Add(LOD);
+			}
+			for (int32 LOD = 1; LOD <= MaxLOD; LOD++)
+			{
+				LODs.Add(LOD);
+			}
+
+			int64 NumVoxels = 0;
+			for (const int32 LOD : LODs)
+			{
+				const int32 ChunkSize = 32 << LOD;
+				for (int32 X = -AreaSize; X < AreaSize; X += ChunkSize)
+				{
+					for (int32 Y = -AreaSize; Y < AreaSize; Y += ChunkSize)
+					{
+						for (int32 Z = -ChunkSize; Z < ChunkSize; Z += ChunkSize)
+						{
+							NumVoxels += QueryChunk(*Generator, FIntVector(X, Y, Z), LOD, Values);
+						}
+					}
+				}
+			}
+			return NumVoxels;
+		};
+
+		LOG_VOXEL(Log, TEXT("Column cache benchmark on %s (generator: %s)"),
+			*World.GetName(),
+			World.Generator.GetObject() ? *World.Generator.GetObject()->GetName() : TEXT("None"));
+
+		LogResults(TEXT("Tall"), Measure(false, Tall), Measure(true, Tall));
+		LogResults(TEXT("MultiLOD"), Measure(false, MultiLOD), Measure(true, MultiLOD));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ColumnCacheBenchmarkCmd(
+	TEXT("voxel.generator.BenchmarkColumnCache"),
+	TEXT("Query the generators of all the voxel worlds in the scene with and without the column cache, and log the throughput. Args: [Radius in chunks = 2] [Height in chunks = 8] [Max LOD = 2]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelGeneratorColumnCacheBenchmark::Run(**It, Args);
+			}
+		}
+	}));
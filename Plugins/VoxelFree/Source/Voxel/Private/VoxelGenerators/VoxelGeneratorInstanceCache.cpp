@@ -0,0 +1,274 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelGenerators/VoxelGeneratorInstanceCache.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Instance Cache Misses"), STAT_VoxelGeneratorInstanceCacheMisses, STATGROUP_VoxelCounters);
+
+FVoxelGeneratorInstanceCache::FVoxelGeneratorInstanceCache(const FVoxelGeneratorInit& GeneratorInit)
+	: GeneratorInit(GeneratorInit)
+{
+}
+
+TVoxelSharedRef<FVoxelGeneratorInstance> FVoxelGeneratorInstanceCache::GetInstance(const FVoxelGeneratorPicker& Picker)
+{
+	return GetInstanceImpl(Shards, Picker);
+}
+
+TVoxelSharedRef<FVoxelTransformableGeneratorInstance> FVoxelGeneratorInstanceCache::GetTransformableInstance(const FVoxelTransformableGeneratorPicker& Picker)
+{
+	return GetInstanceImpl(TransformableShards, Picker);
+}
+
+TVoxelSharedPtr<FVoxelGeneratorInstance> FVoxelGeneratorInstanceCache::FindInstance(const FVoxelGeneratorPicker& Picker) const
+{
+	return FindInstanceImpl(Shards, Picker);
+}
+
+TVoxelSharedPtr<FVoxelTransformableGeneratorInstance> FVoxelGeneratorInstanceCache::FindTransformableInstance(const FVoxelTransformableGeneratorPicker& Picker) const
+{
+	return FindInstanceImpl(TransformableShards, Picker);
+}
+
+void FVoxelGeneratorInstanceCache::WarmUp(const TArray<FVoxelGeneratorPicker>& Pickers)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	for (const FVoxelGeneratorPicker& Picker : Pickers)
+	{
+		if (Picker.IsValid())
+		{
+			GetInstance(Picker);
+		}
+	}
+}
+
+void FVoxelGeneratorInstanceCache::Invalidate(const UObject* Generator)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	Generation.Increment();
+
+	InvalidateShards(Shards, Generator);
+	InvalidateShards(TransformableShards, Generator);
+}
+
+void FVoxelGeneratorInstanceCache::Clear()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	Generation.Increment();
+
+	for (auto& Shard : Shards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_Write);
+		Shard.Instances.Empty();
+	}
+	for (auto& Shard : TransformableShards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_Write);
+		Shard.Instances.Empty();
+	}
+}
+
+FVoxelGeneratorInstanceCache::FStats FVoxelGeneratorInstanceCache::GetStats() const
+{
+	FStats Stats;
+	for (auto& Shard : Shards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+		Stats.NumInstances += Shard.Instances.Num();
+	}
+	for (auto& Shard : TransformableShards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+		Stats.NumTransformableInstances += Shard.Instances.Num();
+	}
+	return Stats;
+}
+
+void FVoxelGeneratorInstanceCache::GetReferencedObjects(TArray<UObject*>& OutObjects) const
+{
+	for (auto& Shard : Shards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+		for (auto& It : Shard.Instances)
+		{
+			OutObjects.Add(It.Key.GetObject());
+		}
+	}
+	for (auto& Shard : TransformableShards)
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+		for (auto& It : Shard.Instances)
+		{
+			OutObjects.Add(It.Key.GetObject());
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename TPicker>
+TVoxelSharedRef<typename TPicker::FGeneratorInstance> FVoxelGeneratorInstanceCache::GetInstanceImpl(TShard<TPicker>* InShards, const TPicker& Picker)
+{
+	TShard<TPicker>& Shard = InShards[GetTypeHash(Picker) % NumShards];
+	{
+		FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+		if (const auto* Instance = Shard.Instances.Find(Picker))
+		{
+			return *Instance;
+		}
+	}
+
+	VOXEL_FUNCTION_COUNTER();
+	INC_DWORD_STAT(STAT_VoxelGeneratorInstanceCacheMisses);
+
+	// Creating the instance reads the generator UObject, and graphs might load or create objects in their Init
+	check(IsInGameThread());
+
+	const int32 StartGeneration = Generation.GetValue();
+
+	const auto Instance = Picker.GetInstance(true);
+	Instance->Init(GeneratorInit);
+
+	FRWScopeLock Lock(Shard.Lock, SLT_Write);
+	if (const auto* ExistingInstance = Shard.Instances.Find(Picker))
+	{
+		// Added by a nested Init, eg a graph merging this generator with itself
+		return *ExistingInstance;
+	}
+	// If invalidated while we were creating the instance, it might have been created with outdated parameters
+	if (Generation.GetValue() == StartGeneration)
+	{
+		Shard.Instances.Add(Picker, Instance);
+	}
+	return Instance;
+}
+
+template<typename TPicker>
+TVoxelSharedPtr<typename TPicker::FGeneratorInstance> FVoxelGeneratorInstanceCache::FindInstanceImpl(const TShard<TPicker>* InShards, const TPicker& Picker)
+{
+	const TShard<TPicker>& Shard = InShards[GetTypeHash(Picker) % NumShards];
+
+	FRWScopeLock Lock(Shard.Lock, SLT_ReadOnly);
+	if (const auto* Instance = Shard.Instances.Find(Picker))
+	{
+		return *Instance;
+	}
+	return nullptr;
+}
+
+template<typename TPicker>
+void FVoxelGeneratorInstanceCache::InvalidateShards(TShard<TPicker>* InShards, const UObject* Generator)
+{
+	for (int32 Index = 0; Index < NumShards; Index++)
+	{
+		TShard<TPicker>& Shard = InShards[Index];
+
+		FRWScopeLock Lock(Shard.Lock, SLT_Write);
+		for (auto It = Shard.Instances.CreateIterator(); It; ++It)
+		{
+			if (It.Key().GetObject() == Generator)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the lookup cost of the sharded cache against a single map behind a critical section
+namespace FVoxelGeneratorInstanceCacheBenchmark
+{
+	template<typename TLookup>
+	double Measure(int32 NumThreads, int32 NumLookups, TLookup Lookup)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const double StartTime = FPlatformTime::Seconds();
+		ParallelFor(NumThreads, [&](int32 ThreadIndex)
+		{
+			for (int32 Index = 0; Index < NumLookups; Index++)
+			{
+				Lookup();
+			}
+		});
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 NumThreads = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 16;
+		const int32 NumLookups = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100000;
+
+		const FVoxelGeneratorPicker Picker = World.Generator;
+
+		// Use a new cache so that the one of the world isn't affected
+		FVoxelGeneratorInstanceCache Cache(World.GetGeneratorInit());
+		Cache.WarmUp({ Picker });
+
+		FCriticalSection Section;
+		TMap<FVoxelGeneratorPicker, TVoxelSharedRef<FVoxelGeneratorInstance>> LockedMap;
+		LockedMap.Add(Picker, Cache.GetInstance(Picker));
+
+		// Both return a new reference, like a caller keeping the instance alive would
+		const auto CacheLookup = [&]()
+		{
+			return Cache.FindInstance(Picker);
+		};
+		const auto LockedMapLookup = [&]()
+		{
+			FScopeLock Lock(&Section);
+			return LockedMap.FindChecked(Picker);
+		};
+
+		const auto LogResults = [&](const TCHAR* Name, int32 Threads, double Time)
+		{
+			const int64 Total = int64(Threads) * NumLookups;
+			LOG_VOXEL(Log, TEXT("%s, %d threads: %.2fms, %.1fns per lookup, %.2f MLookups/s"),
+				Name,
+				Threads,
+				Time * 1000,
+				Time * 1e9 * Threads / Total,
+				Time > 0 ? Total / Time / 1e6 : 0);
+		};
+
+		LOG_VOXEL(Log, TEXT("Generator instance cache benchmark on %s (generator: %s, %d task graph workers)"),
+			*World.GetName(),
+			Picker.GetObject() ? *Picker.GetObject()->GetName() : TEXT("None"),
+			FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+		LogResults(TEXT("Sharded cache"), 1, Measure(1, NumLookups, CacheLookup));
+		LogResults(TEXT("Locked map"), 1, Measure(1, NumLookups, LockedMapLookup));
+		LogResults(TEXT("Sharded cache"), NumThreads, Measure(NumThreads, NumLookups, CacheLookup));
+		LogResults(TEXT("Locked map"), NumThreads, Measure(NumThreads, NumLookups, LockedMapLookup));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GeneratorInstanceCacheBenchmarkCmd(
+	TEXT("voxel.generator.BenchmarkInstanceCache"),
+	TEXT("Look up the generators of all the voxel worlds in the scene from several threads, and log the cost per lookup. Args: [Num threads = 16] [Num lookups per thread = 100000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelGeneratorInstanceCacheBenchmark::Run(**It, Args);
+			}
+		}
+	}));
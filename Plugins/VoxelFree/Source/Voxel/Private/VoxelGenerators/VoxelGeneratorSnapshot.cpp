@@ -0,0 +1,1129 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelGenerators/VoxelGeneratorSnapshot.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "VoxelGenerators/VoxelGeneratorPicker.h"
+#include "VoxelGenerators/VoxelGeneratorInit.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+#include "VoxelRender/MaterialCollections/VoxelMaterialCollectionBase.h"
+#include "VoxelCooking/VoxelCookingLibrary.h"
+#include "VoxelDefaultPool.h"
+#include "VoxelQueuedWork.h"
+#include "VoxelQueryZone.h"
+#include "VoxelItemStack.h"
+#include "VoxelRange.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/ObjectWriter.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelGeneratorSnapshotLeavesMemory);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Snapshot Leaves Decompressed"), STAT_VoxelGeneratorSnapshotLeavesDecompressed, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Generator Snapshot Leaves Evicted"), STAT_VoxelGeneratorSnapshotLeavesEvicted, STATGROUP_VoxelCounters);
+
+static TAutoConsoleVariable<float> CVarGeneratorSnapshotCacheSizeMB(
+	TEXT("voxel.snapshot.CacheSizeMB"),
+	256.f,
+	TEXT("Max size of the decompressed leaves of a generator snapshot, in MB. Least recently used leaves are evicted above that"),
+	ECVF_Default);
+
+namespace FVoxelGeneratorSnapshotFormat
+{
+	// VXSN
+	constexpr uint32 Magic = 0x4E535856;
+	constexpr int32 Version = 1;
+
+	constexpr int32 VoxelsPerLeaf = DATA_CHUNK_SIZE * DATA_CHUNK_SIZE * DATA_CHUNK_SIZE;
+	// Size of the blocks of leaves baked by a single task, in leaves
+	constexpr int32 TaskSize = 8;
+}
+
+FVoxelGeneratorSnapshot::FVoxelGeneratorSnapshot() = default;
+
+FVoxelGeneratorSnapshot::~FVoxelGeneratorSnapshot()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorSnapshotLeavesMemory, CachedLeaves.GetValuesAllocatedSize());
+}
+
+uint32 FVoxelGeneratorSnapshot::ComputeGeneratorHash(const FVoxelGeneratorPicker& Picker, const FVoxelGeneratorInit& Init)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	uint32 Hash = GetTypeHash(Picker.GetObject() ? Picker.GetObject()->GetPathName() : FString());
+
+	// So that editing the generator invalidates the snapshots baked from it
+	if (UVoxelGenerator* Generator = Picker.GetGenerator())
+	{
+		TArray<uint8> Bytes;
+		FObjectWriter Writer(Generator, Bytes);
+		Hash = HashCombine(Hash, FCrc::MemCrc32(Bytes.GetData(), Bytes.Num()));
+	}
+
+	// Sort the parameters so that the hash doesn't depend on the map order
+	TArray<FName> Names;
+	Picker.Parameters.GetKeys(Names);
+	Names.Sort(FNameLexicalLess());
+	for (const FName& Name : Names)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Name.ToString()));
+		Hash = HashCombine(Hash, GetTypeHash(Picker.Parameters[Name]));
+	}
+
+	Hash = HashCombine(Hash, GetTypeHash(Init.VoxelSize));
+	Hash = HashCombine(Hash, GetTypeHash(Init.WorldSize));
+	Hash = HashCombine(Hash, GetTypeHash(uint8(Init.RenderType)));
+	Hash = HashCombine(Hash, GetTypeHash(uint8(Init.MaterialConfig)));
+	Hash = HashCombine(Hash, GetTypeHash(Init.MaterialCollection ? Init.MaterialCollection->GetPathName() : FString()));
+
+PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	TArray<FName> SeedNames;
+	Init.Seeds.GetKeys(SeedNames);
+	SeedNames.Sort(FNameLexicalLess());
+	for (const FName& Name : SeedNames)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Name.ToString()));
+		Hash = HashCombine(Hash, GetTypeHash(Init.Seeds[Name]));
+	}
+PRAGMA_ENABLE_DEPRECATION_WARNINGS
+
+	return Hash;
+}
+
+FString FVoxelGeneratorSnapshot::GetFullPath(const FString& Path)
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Path);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct FVoxelGeneratorSnapshotBakedLeaf
+{
+	FVoxelGeneratorSnapshot::FLeafEntry Entry;
+	TArray<uint8> Payload;
+};
+
+struct FVoxelGeneratorSnapshotBakeData
+{
+	const FVoxelGeneratorInstance& Generator;
+	// In leaves
+	const FIntVector GridMin;
+	const FIntVector GridSize;
+	const int32 NumTasks;
+
+	// One ELeafState per leaf. Each leaf is written by a single task
+	TArray<uint8> States;
+
+	FCriticalSection BakedLeavesSection;
+	TArray<FVoxelGeneratorSnapshotBakedLeaf> BakedLeaves;
+
+	FEvent* const DoneEvent;
+	FThreadSafeCounter NumTasksDone;
+
+	FThreadSafeCounter64 SamplingTime;
+	FThreadSafeCounter64 CompressionTime;
+
+	FVoxelGeneratorSnapshotBakeData(const FVoxelGeneratorInstance& Generator, const FIntVector& GridMin, const FIntVector& GridSize, int32 NumTasks)
+		: Generator(Generator)
+		, GridMin(GridMin)
+		, GridSize(GridSize)
+		, NumTasks(NumTasks)
+		, DoneEvent(FPlatformProcess::GetSynchEventFromPool())
+	{
+		States.SetNumZeroed(GridSize.X * GridSize.Y * GridSize.Z);
+	}
+	~FVoxelGeneratorSnapshotBakeData()
+	{
+		check(NumTasksDone.GetValue() == NumTasks);
+		FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
+	}
+
+	int32 GetLeafIndex(const FIntVector& Leaf) const
+	{
+		const FIntVector Local = Leaf - GridMin;
+		return Local.X + GridSize.X * (Local.Y + GridSize.Y * Local.Z);
+	}
+
+	void TaskDone(TArray<FVoxelGeneratorSnapshotBakedLeaf>&& TaskBakedLeaves)
+	{
+		{
+			FScopeLock Lock(&BakedLeavesSection);
+			BakedLeaves.Append(MoveTemp(TaskBakedLeaves));
+		}
+
+		if (NumTasksDone.Increment() == NumTasks)
+		{
+			DoneEvent->Trigger();
+		}
+	}
+};
+
+class FVoxelGeneratorSnapshotBakeTask : public IVoxelQueuedWork
+{
+public:
+	// In leaves
+	const FIntVector Min;
+	const FIntVector Max;
+	FVoxelGeneratorSnapshotBakeData& BakeData;
+
+	FVoxelGeneratorSnapshotBakeTask(const FIntVector& Min, const FIntVector& Max, FVoxelGeneratorSnapshotBakeData& BakeData)
+		: IVoxelQueuedWork(STATIC_FNAME("Generator Snapshot Bake Task"), 0)
+		, Min(Min)
+		, Max(Max)
+		, BakeData(BakeData)
+	{
+	}
+
+	virtual void DoThreadedWork() override
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		ProcessLeaves(Min, Max);
+
+		BakeData.TaskDone(MoveTemp(BakedLeaves));
+		delete this;
+	}
+	virtual void Abandon() override
+	{
+		check(false);
+	}
+	virtual uint32 GetPriority() const override
+	{
+		return 0;
+	}
+
+private:
+	TArray<FVoxelGeneratorSnapshotBakedLeaf> BakedLeaves;
+
+	// Subdivide until the range analysis proves the leaves empty or full, or until reaching a single leaf
+	void ProcessLeaves(const FIntVector& LeavesMin, const FIntVector& LeavesMax)
+	{
+		const FVoxelIntBox Bounds(LeavesMin * DATA_CHUNK_SIZE, LeavesMax * DATA_CHUNK_SIZE);
+		const TVoxelRange<v_flt> Range = BakeData.Generator.GetValueRange(Bounds, 0, FVoxelItemStack::Empty);
+
+		// FVoxelValue clamps to [-1, 1]: all the values of these leaves are exactly Empty() or Full()
+		if (Range.Min >= 1 || Range.Max <= -1)
+		{
+			const auto State = Range.Min >= 1 ? FVoxelGeneratorSnapshot::ELeafState::Empty : FVoxelGeneratorSnapshot::ELeafState::Full;
+			for (int32 Z = LeavesMin.Z; Z < LeavesMax.Z; Z++)
+			{
+				for (int32 Y = LeavesMin.Y; Y < LeavesMax.Y; Y++)
+				{
+					for (int32 X = LeavesMin.X; X < LeavesMax.X; X++)
+					{
+						BakeData.States[BakeData.GetLeafIndex(FIntVector(X, Y, Z))] = uint8(State);
+					}
+				}
+			}
+			return;
+		}
+
+		const FIntVector Size = LeavesMax - LeavesMin;
+		if (Size == FIntVector(1))
+		{
+			BakeLeaf(LeavesMin);
+			return;
+		}
+
+		const FIntVector Mid = LeavesMin + FVoxelUtilities::DivideCeil(Size, 2);
+		for (int32 Index = 0; Index < 8; Index++)
+		{
+			const FIntVector ChildMin(
+				(Index & 1) ? Mid.X : LeavesMin.X,
+				(Index & 2) ? Mid.Y : LeavesMin.Y,
+				(Index & 4) ? Mid.Z : LeavesMin.Z);
+			const FIntVector ChildMax(
+				(Index & 1) ? LeavesMax.X : Mid.X,
+				(Index & 2) ? LeavesMax.Y : Mid.Y,
+				(Index & 4) ? LeavesMax.Z : Mid.Z);
+
+			if (ChildMin.X < ChildMax.X && ChildMin.Y < ChildMax.Y && ChildMin.Z < ChildMax.Z)
+			{
+				ProcessLeaves(ChildMin, ChildMax);
+			}
+		}
+	}
+
+	template<typename T>
+	static bool IsUniform(const TArray<T>& Array)
+	{
+		for (const T& Value : Array)
+		{
+			if (!(Value == Array[0]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void BakeLeaf(const FIntVector& Leaf)
+	{
+		using FVoxelGeneratorSnapshotFormat::VoxelsPerLeaf;
+
+		const FVoxelIntBox Bounds(Leaf * DATA_CHUNK_SIZE, (Leaf + 1) * DATA_CHUNK_SIZE);
+
+		TArray<FVoxelValue> Values;
+		TArray<FVoxelMaterial> Materials;
+		{
+			const uint64 StartTime = FPlatformTime::Cycles64();
+
+			Values.SetNumUninitialized(VoxelsPerLeaf);
+			Materials.SetNumUninitialized(VoxelsPerLeaf);
+
+			TVoxelQueryZone<FVoxelValue> ValuesQueryZone(Bounds, Values);
+			BakeData.Generator.GetValues(ValuesQueryZone, 0, FVoxelItemStack::Empty);
+
+			TVoxelQueryZone<FVoxelMaterial> MaterialsQueryZone(Bounds, Materials);
+			BakeData.Generator.GetMaterials(MaterialsQueryZone, 0, FVoxelItemStack::Empty);
+
+			BakeData.SamplingTime.Add(FPlatformTime::Cycles64() - StartTime);
+		}
+
+		const uint64 StartTime = FPlatformTime::Cycles64();
+
+		FVoxelGeneratorSnapshotBakedLeaf& BakedLeaf = BakedLeaves.Emplace_GetRef();
+
+		// Padding is written to the file: keep it deterministic
+		FVoxelGeneratorSnapshot::FLeafEntry& Entry = BakedLeaf.Entry;
+		FMemory::Memzero(Entry);
+
+		Entry.LeafIndex = BakeData.GetLeafIndex(Leaf);
+		Entry.bUniformValue = IsUniform(Values);
+		Entry.bUniformMaterial = IsUniform(Materials);
+		Entry.UniformValue = Values[0];
+		Entry.UniformMaterial = Materials[0];
+
+		TArray<uint8> UncompressedPayload;
+		if (!Entry.bUniformValue)
+		{
+			UncompressedPayload.Append(reinterpret_cast<const uint8*>(Values.GetData()), Values.Num() * sizeof(FVoxelValue));
+		}
+		if (!Entry.bUniformMaterial)
+		{
+			UncompressedPayload.Append(reinterpret_cast<const uint8*>(Materials.GetData()), Materials.Num() * sizeof(FVoxelMaterial));
+		}
+		Entry.UncompressedPayloadSize = UncompressedPayload.Num();
+
+		if (UncompressedPayload.Num() > 0)
+		{
+			int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedPayload.Num());
+			BakedLeaf.Payload.SetNumUninitialized(CompressedSize);
+			verify(FCompression::CompressMemory(NAME_Zlib, BakedLeaf.Payload.GetData(), CompressedSize, UncompressedPayload.GetData(), UncompressedPayload.Num()));
+			BakedLeaf.Payload.SetNum(CompressedSize);
+		}
+
+		BakeData.States[Entry.LeafIndex] = uint8(FVoxelGeneratorSnapshot::ELeafState::Baked);
+		BakeData.CompressionTime.Add(FPlatformTime::Cycles64() - StartTime);
+	}
+};
+
+bool FVoxelGeneratorSnapshot::Bake(const FVoxelGeneratorInstance& Generator, uint32 GeneratorHash, const FVoxelIntBox& Bounds, int32 ThreadCount, const FString& Path, FBakeStats& OutStats)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	using FVoxelGeneratorSnapshotFormat::TaskSize;
+
+	OutStats = {};
+
+	const FIntVector GridMin = FVoxelUtilities::DivideFloor(Bounds.Min, DATA_CHUNK_SIZE);
+	const FIntVector GridSize = FVoxelUtilities::DivideCeil(Bounds.Max, DATA_CHUNK_SIZE) - GridMin;
+	const int64 NumLeaves = int64(GridSize.X) * int64(GridSize.Y) * int64(GridSize.Z);
+
+	if (NumLeaves <= 0 || NumLeaves > MAX_int32)
+	{
+		LOG_VOXEL(Error, TEXT("VOXEL SNAPSHOT: Invalid bounds or depth too high: %s"), *Bounds.ToString());
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const FIntVector NumTasksPerAxis = FVoxelUtilities::DivideCeil(GridSize, TaskSize);
+	const int32 NumTasks = NumTasksPerAxis.X * NumTasksPerAxis.Y * NumTasksPerAxis.Z;
+
+	LOG_VOXEL(Log, TEXT("VOXEL SNAPSHOT: Baking %lld leaves with %d tasks on %d threads"), NumLeaves, NumTasks, ThreadCount);
+
+	FVoxelGeneratorSnapshotBakeData BakeData(Generator, GridMin, GridSize, NumTasks);
+	{
+		const auto Pool = FVoxelDefaultPool::Create(FMath::Max(1, ThreadCount), true, {}, {});
+		for (int32 Z = 0; Z < NumTasksPerAxis.Z; Z++)
+		{
+			for (int32 Y = 0; Y < NumTasksPerAxis.Y; Y++)
+			{
+				for (int32 X = 0; X < NumTasksPerAxis.X; X++)
+				{
+					const FIntVector Min = GridMin + FIntVector(X, Y, Z) * TaskSize;
+					const FIntVector Max = FVoxelUtilities::ComponentMin(Min + TaskSize, GridMin + GridSize);
+					Pool->QueueTask({}, new FVoxelGeneratorSnapshotBakeTask(Min, Max, BakeData));
+				}
+			}
+		}
+		BakeData.DoneEvent->Wait();
+	}
+
+	const double GenerationEndTime = FPlatformTime::Seconds();
+
+	auto& BakedLeaves = BakeData.BakedLeaves;
+	BakedLeaves.Sort([](const FVoxelGeneratorSnapshotBakedLeaf& A, const FVoxelGeneratorSnapshotBakedLeaf& B) { return A.Entry.LeafIndex < B.Entry.LeafIndex; });
+
+	TArray<uint8> PackedStates;
+	PackedStates.SetNumZeroed(int32((NumLeaves + 3) / 4));
+	for (int32 Index = 0; Index < NumLeaves; Index++)
+	{
+		const uint8 State = BakeData.States[Index];
+		PackedStates[Index >> 2] |= State << (2 * (Index & 3));
+
+		OutStats.NumEmptyLeaves += State == uint8(ELeafState::Empty);
+		OutStats.NumFullLeaves += State == uint8(ELeafState::Full);
+	}
+	OutStats.NumLeaves = NumLeaves;
+	OutStats.NumBakedLeaves = BakedLeaves.Num();
+
+	FHeader Header;
+	Header.Magic = FVoxelGeneratorSnapshotFormat::Magic;
+	Header.Version = FVoxelGeneratorSnapshotFormat::Version;
+	Header.GeneratorHash = GeneratorHash;
+	Header.ValueConfigFlag = GVoxelValueConfigFlag;
+	Header.MaterialConfigFlag = GVoxelMaterialConfigFlag;
+	Header.LeafEntrySize = sizeof(FLeafEntry);
+	Header.GridMin = GridMin;
+	Header.GridSize = GridSize;
+	Header.NumEntries = BakedLeaves.Num();
+	Header.StatesOffset = Align(int64(sizeof(FHeader)), 8);
+	Header.EntriesOffset = Align(Header.StatesOffset + PackedStates.Num(), 8);
+
+	int64 PayloadOffset = Header.EntriesOffset + Header.NumEntries * sizeof(FLeafEntry);
+	for (auto& BakedLeaf : BakedLeaves)
+	{
+		BakedLeaf.Entry.PayloadOffset = PayloadOffset;
+		BakedLeaf.Entry.PayloadSize = BakedLeaf.Payload.Num();
+		PayloadOffset += BakedLeaf.Payload.Num();
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Write");
+
+		const TUniquePtr<FArchive> Writer = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Path));
+		if (!Writer)
+		{
+			LOG_VOXEL(Error, TEXT("VOXEL SNAPSHOT: Failed to write %s"), *Path);
+			return false;
+		}
+
+		const auto Pad = [&](int64 Offset)
+		{
+			uint8 Zeros[8] = {};
+			check(Offset - Writer->Tell() < 8);
+			Writer->Serialize(Zeros, Offset - Writer->Tell());
+		};
+
+		Writer->Serialize(&Header, sizeof(FHeader));
+		Pad(Header.StatesOffset);
+		Writer->Serialize(PackedStates.GetData(), PackedStates.Num());
+		Pad(Header.EntriesOffset);
+		for (auto& BakedLeaf : BakedLeaves)
+		{
+			Writer->Serialize(&BakedLeaf.Entry, sizeof(FLeafEntry));
+		}
+		for (auto& BakedLeaf : BakedLeaves)
+		{
+			Writer->Serialize(BakedLeaf.Payload.GetData(), BakedLeaf.Payload.Num());
+		}
+
+		OutStats.FileSize = Writer->Tell();
+		if (!Writer->Close())
+		{
+			LOG_VOXEL(Error, TEXT("VOXEL SNAPSHOT: Failed to write %s"), *Path);
+			return false;
+		}
+	}
+
+	const double EndTime = FPlatformTime::Seconds();
+	OutStats.Time = EndTime - StartTime;
+
+	const double GenerationTime = GenerationEndTime - StartTime;
+	const double SamplingTime = BakeData.SamplingTime.GetValue() * FPlatformTime::GetSecondsPerCycle64();
+	const double CompressionTime = BakeData.CompressionTime.GetValue() * FPlatformTime::GetSecondsPerCycle64();
+	const double NumVoxels = double(NumLeaves) * FVoxelGeneratorSnapshotFormat::VoxelsPerLeaf;
+	const double NumSampledVoxels = double(OutStats.NumBakedLeaves) * FVoxelGeneratorSnapshotFormat::VoxelsPerLeaf;
+
+	LOG_VOXEL(Log, TEXT("VOXEL SNAPSHOT: Baked %s: %lld leaves, %lld proven empty, %lld proven full, %lld sampled. %.2fMB"),
+		*Path,
+		OutStats.NumLeaves,
+		OutStats.NumEmptyLeaves,
+		OutStats.NumFullLeaves,
+		OutStats.NumBakedLeaves,
+		OutStats.FileSize / double(1 << 20));
+	LOG_VOXEL(Log, TEXT("VOXEL SNAPSHOT: Total time: %.2fs, generation: %.2fs (%.1f MVoxels/s over the bounds, %.1f MVoxels/s sampled)"),
+		OutStats.Time,
+		GenerationTime,
+		GenerationTime > 0 ? NumVoxels / GenerationTime / 1e6 : 0,
+		GenerationTime > 0 ? NumSampledVoxels / GenerationTime / 1e6 : 0);
+	LOG_VOXEL(Log, TEXT("VOXEL SNAPSHOT: Async Thread sampling time: %.2fs, compression time: %.2fs"), SamplingTime, CompressionTime);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<FVoxelGeneratorSnapshot> FVoxelGeneratorSnapshot::Load(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto Snapshot = MakeVoxelShared<FVoxelGeneratorSnapshot>();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	Snapshot->MappedFile = TUniquePtr<IMappedFileHandle>(PlatformFile.OpenMapped(*Path));
+	if (Snapshot->MappedFile)
+	{
+		Snapshot->MappedRegion = TUniquePtr<IMappedFileRegion>(Snapshot->MappedFile->MapRegion());
+	}
+
+	if (Snapshot->MappedRegion)
+	{
+		Snapshot->FileData = Snapshot->MappedRegion->GetMappedPtr();
+		Snapshot->FileSize = Snapshot->MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		// Not supported by this platform, or the file is in a pak
+		Snapshot->MappedFile.Reset();
+
+		if (!FFileHelper::LoadFileToArray(Snapshot->LoadedFile, *Path, FILEREAD_Silent))
+		{
+			LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: Failed to open %s"), *Path);
+			return nullptr;
+		}
+		Snapshot->FileData = Snapshot->LoadedFile.GetData();
+		Snapshot->FileSize = Snapshot->LoadedFile.Num();
+	}
+
+	if (!Snapshot->InitFromFileData(Path))
+	{
+		return nullptr;
+	}
+
+	return Snapshot;
+}
+
+TVoxelSharedRef<FVoxelGeneratorInstance> FVoxelGeneratorSnapshot::CreateInstance(const TVoxelSharedRef<FVoxelGeneratorInstance>& Generator, uint32 GeneratorHash, const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const FString FullPath = GetFullPath(Path);
+	const TVoxelSharedPtr<FVoxelGeneratorSnapshot> Snapshot = Load(FullPath);
+	if (!Snapshot)
+	{
+		return Generator;
+	}
+	if (Snapshot->GetGeneratorHash() != GeneratorHash)
+	{
+		LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: %s was baked from another generator or with other settings, ignoring it. Use voxel.snapshot.Bake to bake it again"), *FullPath);
+		return Generator;
+	}
+
+	LOG_VOXEL(Log, TEXT("VOXEL SNAPSHOT: Using %s: %lld baked leaves, %.2fMB, %s"),
+		*FullPath,
+		Snapshot->GetNumBakedLeaves(),
+		Snapshot->GetFileSize() / double(1 << 20),
+		Snapshot->IsMapped() ? TEXT("memory mapped") : TEXT("loaded in memory"));
+
+	return MakeVoxelShared<FVoxelGeneratorSnapshotInstance>(Generator, Snapshot.ToSharedRef());
+}
+
+bool FVoxelGeneratorSnapshot::InitFromFileData(const FString& Path)
+{
+	if (FileSize < int64(sizeof(FHeader)))
+	{
+		LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: %s is corrupted"), *Path);
+		return false;
+	}
+	FMemory::Memcpy(&Header, FileData, sizeof(FHeader));
+
+	if (Header.Magic != FVoxelGeneratorSnapshotFormat::Magic ||
+		Header.Version != FVoxelGeneratorSnapshotFormat::Version)
+	{
+		LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: %s is not a snapshot, or was baked with another version of the plugin"), *Path);
+		return false;
+	}
+	if (Header.ValueConfigFlag != GVoxelValueConfigFlag ||
+		Header.MaterialConfigFlag != GVoxelMaterialConfigFlag ||
+		Header.LeafEntrySize != sizeof(FLeafEntry))
+	{
+		LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: %s was baked with another voxel value or material config"), *Path);
+		return false;
+	}
+
+	const int64 NumLeaves = int64(Header.GridSize.X) * int64(Header.GridSize.Y) * int64(Header.GridSize.Z);
+	if (Header.GridSize.GetMin() <= 0 ||
+		NumLeaves > MAX_int32 ||
+		Header.NumEntries < 0 ||
+		Header.NumEntries > NumLeaves ||
+		Header.StatesOffset < int64(sizeof(FHeader)) ||
+		Header.StatesOffset + (NumLeaves + 3) / 4 > FileSize ||
+		Header.EntriesOffset < Header.StatesOffset ||
+		Header.EntriesOffset + Header.NumEntries * int64(sizeof(FLeafEntry)) > FileSize)
+	{
+		LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: %s is corrupted"), *Path);
+		return false;
+	}
+
+	States = FileData + Header.StatesOffset;
+	Bounds = FVoxelIntBox(Header.GridMin * DATA_CHUNK_SIZE, (Header.GridMin + Header.GridSize) * DATA_CHUNK_SIZE);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedRef<const FVoxelGeneratorSnapshot::FLeafData> FVoxelGeneratorSnapshot::GetLeaf(const FIntVector& Leaf) const
+{
+	checkVoxelSlow(GetLeafState(Leaf) == ELeafState::Baked);
+
+	const int64 EntryIndex = FindEntry(GetLeafIndex(Leaf));
+	if (!ensureMsgf(EntryIndex != -1, TEXT("Generator snapshot leaf %s has no entry, data is corrupted"), *Leaf.ToString()))
+	{
+		const auto EmptyLeaf = MakeVoxelShared<FLeafData>();
+		EmptyLeaf->UniformValue = FVoxelValue::Empty();
+		EmptyLeaf->UniformMaterial = FVoxelMaterial::Default();
+		return EmptyLeaf;
+	}
+
+	if (const TVoxelSharedPtr<const FLeafData> CachedLeaf = CachedLeaves.Find(EntryIndex))
+	{
+		return CachedLeaf.ToSharedRef();
+	}
+
+	const TVoxelSharedRef<const FLeafData> NewLeaf = DecompressLeaf(GetEntry(EntryIndex));
+
+	const int64 MaxSize = int64(FMath::Max(0.f, CVarGeneratorSnapshotCacheSizeMB.GetValueOnAnyThread()) * (1 << 20));
+
+	TVoxelLRUCache<int64, FLeafData>::FChanges Changes;
+	const TVoxelSharedRef<const FLeafData> CachedLeaf = CachedLeaves.Add(EntryIndex, NewLeaf, MaxSize, Changes);
+
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorSnapshotLeavesMemory, Changes.AddedSize);
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelGeneratorSnapshotLeavesMemory, Changes.RemovedSize);
+	INC_DWORD_STAT_BY(STAT_VoxelGeneratorSnapshotLeavesEvicted, Changes.NumEvicted);
+
+	return CachedLeaf;
+}
+
+FVoxelGeneratorSnapshot::FLeafEntry FVoxelGeneratorSnapshot::GetEntry(int64 EntryIndex) const
+{
+	checkVoxelSlow(0 <= EntryIndex && EntryIndex < Header.NumEntries);
+
+	// The entries aren't necessarily aligned in the file
+	FLeafEntry Entry;
+	FMemory::Memcpy(&Entry, FileData + Header.EntriesOffset + EntryIndex * sizeof(FLeafEntry), sizeof(FLeafEntry));
+	return Entry;
+}
+
+int64 FVoxelGeneratorSnapshot::FindEntry(int64 LeafIndex) const
+{
+	const auto GetEntryLeafIndex = [&](int64 EntryIndex)
+	{
+		int64 EntryLeafIndex;
+		FMemory::Memcpy(&EntryLeafIndex, FileData + Header.EntriesOffset + EntryIndex * sizeof(FLeafEntry) + STRUCT_OFFSET(FLeafEntry, LeafIndex), sizeof(int64));
+		return EntryLeafIndex;
+	};
+
+	int64 Min = 0;
+	int64 Max = Header.NumEntries;
+	while (Min < Max)
+	{
+		const int64 Mid = (Min + Max) / 2;
+		if (GetEntryLeafIndex(Mid) < LeafIndex)
+		{
+			Min = Mid + 1;
+		}
+		else
+		{
+			Max = Mid;
+		}
+	}
+
+	return Min < Header.NumEntries && GetEntryLeafIndex(Min) == LeafIndex ? Min : -1;
+}
+
+TVoxelSharedRef<FVoxelGeneratorSnapshot::FLeafData> FVoxelGeneratorSnapshot::DecompressLeaf(const FLeafEntry& Entry) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	INC_DWORD_STAT(STAT_VoxelGeneratorSnapshotLeavesDecompressed);
+
+	using FVoxelGeneratorSnapshotFormat::VoxelsPerLeaf;
+
+	const auto Leaf = MakeVoxelShared<FLeafData>();
+	Leaf->UniformValue = Entry.UniformValue;
+	Leaf->UniformMaterial = Entry.UniformMaterial;
+
+	if (Entry.UncompressedPayloadSize == 0)
+	{
+		return Leaf;
+	}
+
+	const int64 ValuesSize = Entry.bUniformValue ? 0 : VoxelsPerLeaf * sizeof(FVoxelValue);
+	const int64 MaterialsSize = Entry.bUniformMaterial ? 0 : VoxelsPerLeaf * sizeof(FVoxelMaterial);
+
+	TArray<uint8> UncompressedPayload;
+	UncompressedPayload.SetNumUninitialized(Entry.UncompressedPayloadSize);
+
+	if (!ensureMsgf(
+		ValuesSize + MaterialsSize == Entry.UncompressedPayloadSize &&
+		Entry.PayloadOffset >= Header.EntriesOffset &&
+		Entry.PayloadOffset + Entry.PayloadSize <= FileSize &&
+		FCompression::UncompressMemory(NAME_Zlib, UncompressedPayload.GetData(), UncompressedPayload.Num(), FileData + Entry.PayloadOffset, Entry.PayloadSize),
+		TEXT("Failed to decompress generator snapshot leaf %lld, data is corrupted"), Entry.LeafIndex))
+	{
+		Leaf->UniformValue = FVoxelValue::Empty();
+		Leaf->UniformMaterial = FVoxelMaterial::Default();
+		return Leaf;
+	}
+
+	if (!Entry.bUniformValue)
+	{
+		Leaf->Values.SetNumUninitialized(VoxelsPerLeaf);
+		FMemory::Memcpy(Leaf->Values.GetData(), UncompressedPayload.GetData(), ValuesSize);
+	}
+	if (!Entry.bUniformMaterial)
+	{
+		Leaf->Materials.SetNumUninitialized(VoxelsPerLeaf);
+		FMemory::Memcpy(Leaf->Materials.GetData(), UncompressedPayload.GetData() + ValuesSize, MaterialsSize);
+	}
+
+	return Leaf;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace FVoxelGeneratorSnapshotUtilities
+{
+	// A leaf containing samples of a query zone, along one axis
+	struct FAxisCell
+	{
+		int32 Leaf;
+		// Bounds of the samples in the leaf
+		int32 Min;
+		int32 Max;
+	};
+	using FAxisCells = TArray<FAxisCell, TInlineAllocator<32>>;
+
+	// Min and Max are the query zone bounds, and are multiple of Step
+	inline void GetAxisCells(int32 Min, int32 Max, int32 Step, FAxisCells& OutCells)
+	{
+		for (int32 Position = Min; Position < Max;)
+		{
+			const int32 Leaf = FVoxelUtilities::DivideFloor(Position, DATA_CHUNK_SIZE);
+			// First sample after the leaf
+			const int32 Next = FMath::Min(Max, Min + FVoxelUtilities::DivideCeil((Leaf + 1) * DATA_CHUNK_SIZE - Min, Step) * Step);
+			OutCells.Add({ Leaf, Position, Next });
+			Position = Next;
+		}
+	}
+
+	// The leaves proven empty or full only have their values in the snapshot
+	inline bool GetUniform(FVoxelGeneratorSnapshot::ELeafState State, FVoxelValue& OutValue)
+	{
+		OutValue = State == FVoxelGeneratorSnapshot::ELeafState::Empty ? FVoxelValue::Empty() : FVoxelValue::Full();
+		return true;
+	}
+	inline bool GetUniform(FVoxelGeneratorSnapshot::ELeafState State, FVoxelMaterial& OutMaterial)
+	{
+		return false;
+	}
+}
+
+template<>
+const TArray<FName>& FVoxelGeneratorSnapshotInstance::GetForwardedOutputs<v_flt>() const
+{
+	return FloatOutputs;
+}
+
+template<>
+const TArray<FName>& FVoxelGeneratorSnapshotInstance::GetForwardedOutputs<int32>() const
+{
+	return IntOutputs;
+}
+
+template<>
+const TArray<FName>& FVoxelGeneratorSnapshotInstance::GetForwardedOutputs<FColor>() const
+{
+	return ColorOutputs;
+}
+
+template<typename T, int32 Index>
+T FVoxelGeneratorSnapshotInstance::ForwardCustomOutput(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+{
+	// The default value is never used: the output exists in Source
+	return Source->GetCustomOutput<T>(T{}, GetForwardedOutputs<T>()[Index], X, Y, Z, LOD, Items);
+}
+
+template<int32 Index>
+TVoxelRange<v_flt> FVoxelGeneratorSnapshotInstance::ForwardCustomOutputRange(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const
+{
+	return Source->GetCustomOutputRange<v_flt>(TVoxelRange<v_flt>::Infinite(), FloatRangeOutputs[Index], Bounds, LOD, Items);
+}
+
+template<typename T, int32... Indices>
+void FVoxelGeneratorSnapshotInstance::AddForwardedOutputs(const TMap<FName, TOutputFunctionPtr<T>>& SourcePtrs, TMap<FName, TOutputFunctionPtr<T>>& OutPtrs, TIntegerSequence<int32, Indices...>)
+{
+	const TOutputFunctionPtr<T> Functions[] = { static_cast<TOutputFunctionPtr<T>>(&FVoxelGeneratorSnapshotInstance::ForwardCustomOutput<T, Indices>)... };
+
+	int32 Index = 0;
+	for (auto& It : SourcePtrs)
+	{
+		if (Index == MaxForwardedCustomOutputs)
+		{
+			LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: More than %d custom outputs, %s won't be available"), MaxForwardedCustomOutputs, *It.Key.ToString());
+			continue;
+		}
+		OutPtrs.Add(It.Key, Functions[Index++]);
+	}
+}
+
+template<int32... Indices>
+void FVoxelGeneratorSnapshotInstance::AddForwardedRangeOutputs(const TMap<FName, TRangeOutputFunctionPtr<v_flt>>& SourcePtrs, TMap<FName, TRangeOutputFunctionPtr<v_flt>>& OutPtrs, TIntegerSequence<int32, Indices...>)
+{
+	const TRangeOutputFunctionPtr<v_flt> Functions[] = { static_cast<TRangeOutputFunctionPtr<v_flt>>(&FVoxelGeneratorSnapshotInstance::ForwardCustomOutputRange<Indices>)... };
+
+	int32 Index = 0;
+	for (auto& It : SourcePtrs)
+	{
+		if (Index == MaxForwardedCustomOutputs)
+		{
+			LOG_VOXEL(Warning, TEXT("VOXEL SNAPSHOT: More than %d custom range outputs, %s won't be available"), MaxForwardedCustomOutputs, *It.Key.ToString());
+			continue;
+		}
+		OutPtrs.Add(It.Key, Functions[Index++]);
+	}
+}
+
+FVoxelGeneratorInstance::FCustomFunctionPtrs FVoxelGeneratorSnapshotInstance::MakeCustomPtrs(const FVoxelGeneratorInstance& Source)
+{
+	FCustomFunctionPtrs Ptrs;
+	AddForwardedOutputs<v_flt>(Source.CustomPtrs.Float, Ptrs.Float, TMakeIntegerSequence<int32, MaxForwardedCustomOutputs>());
+	AddForwardedOutputs<int32>(Source.CustomPtrs.Int, Ptrs.Int, TMakeIntegerSequence<int32, MaxForwardedCustomOutputs>());
+	AddForwardedOutputs<FColor>(Source.CustomPtrs.Color, Ptrs.Color, TMakeIntegerSequence<int32, MaxForwardedCustomOutputs>());
+	AddForwardedRangeOutputs(Source.CustomPtrs.FloatRange, Ptrs.FloatRange, TMakeIntegerSequence<int32, MaxForwardedCustomOutputs>());
+	return Ptrs;
+}
+
+FVoxelGeneratorSnapshotInstance::FVoxelGeneratorSnapshotInstance(const TVoxelSharedRef<FVoxelGeneratorInstance>& Source, const TVoxelSharedRef<const FVoxelGeneratorSnapshot>& Snapshot)
+	: FVoxelGeneratorInstance(
+		Source->Class,
+		Source->Object.Get(),
+		FBaseFunctionPtrs
+		{
+			static_cast<TOutputFunctionPtr<v_flt>>(&FVoxelGeneratorSnapshotInstance::GetValueImpl),
+			static_cast<TOutputFunctionPtr<FVoxelMaterial>>(&FVoxelGeneratorSnapshotInstance::GetMaterialImpl),
+			static_cast<TRangeOutputFunctionPtr<v_flt>>(&FVoxelGeneratorSnapshotInstance::GetValueRangeImpl),
+		},
+		MakeCustomPtrs(*Source))
+	, Source(Source)
+	, Snapshot(Snapshot)
+{
+	// Same order as MakeCustomPtrs
+	const auto AddNames = [](const auto& Ptrs, TArray<FName>& OutNames)
+	{
+		for (auto& It : Ptrs)
+		{
+			if (OutNames.Num() == MaxForwardedCustomOutputs)
+			{
+				break;
+			}
+			OutNames.Add(It.Key);
+		}
+	};
+	AddNames(Source->CustomPtrs.Float, FloatOutputs);
+	AddNames(Source->CustomPtrs.Int, IntOutputs);
+	AddNames(Source->CustomPtrs.Color, ColorOutputs);
+	AddNames(Source->CustomPtrs.FloatRange, FloatRangeOutputs);
+}
+
+void FVoxelGeneratorSnapshotInstance::Init(const FVoxelGeneratorInit& InitStruct)
+{
+	Source->Init(InitStruct);
+}
+
+void FVoxelGeneratorSnapshotInstance::InitArea(const FVoxelIntBox& Bounds, int32 LOD)
+{
+	Source->InitArea(Bounds, LOD);
+}
+
+void FVoxelGeneratorSnapshotInstance::SetupMaterialInstance(int32 ChunkLOD, const FVoxelIntBox& ChunkBounds, UMaterialInstanceDynamic* Instance)
+{
+	Source->SetupMaterialInstance(ChunkLOD, ChunkBounds, Instance);
+}
+
+void FVoxelGeneratorSnapshotInstance::GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const
+{
+	GetFromSnapshot(QueryZone, LOD, Items);
+}
+
+void FVoxelGeneratorSnapshotInstance::GetMaterials(TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const
+{
+	GetFromSnapshot(QueryZone, LOD, Items);
+}
+
+FVector FVoxelGeneratorSnapshotInstance::GetUpVector(v_flt X, v_flt Y, v_flt Z) const
+{
+	return Source->GetUpVector(X, Y, Z);
+}
+
+v_flt FVoxelGeneratorSnapshotInstance::GetValueImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+{
+	// Single voxel queries can be at any position, and need the exact generator value: don't use the snapshot
+	// FVoxelValue(value) is still the same as the baked value, so data reads are consistent
+	return Source->GetValue(X, Y, Z, LOD, Items);
+}
+
+FVoxelMaterial FVoxelGeneratorSnapshotInstance::GetMaterialImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+{
+	return Source->GetMaterial(X, Y, Z, LOD, Items);
+}
+
+TVoxelRange<v_flt> FVoxelGeneratorSnapshotInstance::GetValueRangeImpl(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const
+{
+	return Source->GetValueRange(Bounds, LOD, Items);
+}
+
+template<typename T>
+void FVoxelGeneratorSnapshotInstance::GetFromSnapshot(TVoxelQueryZone<T>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const
+{
+	using namespace FVoxelGeneratorSnapshotUtilities;
+
+	// Data items are applied by the generator: they aren't in the snapshot
+	if (!Items.IsEmpty() || !Snapshot->GetBounds().Intersect(QueryZone.Bounds))
+	{
+		Source->Get<T>(QueryZone, LOD, Items);
+		return;
+	}
+
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const int32 Step = QueryZone.Step;
+
+	FAxisCells CellsX;
+	FAxisCells CellsY;
+	FAxisCells CellsZ;
+	GetAxisCells(QueryZone.Bounds.Min.X, QueryZone.Bounds.Max.X, Step, CellsX);
+	GetAxisCells(QueryZone.Bounds.Min.Y, QueryZone.Bounds.Max.Y, Step, CellsY);
+	GetAxisCells(QueryZone.Bounds.Min.Z, QueryZone.Bounds.Max.Z, Step, CellsZ);
+
+	for (const FAxisCell& CellZ : CellsZ)
+	{
+		for (const FAxisCell& CellY : CellsY)
+		{
+			for (const FAxisCell& CellX : CellsX)
+			{
+				const FIntVector Leaf(CellX.Leaf, CellY.Leaf, CellZ.Leaf);
+				const FVoxelIntBox CellBounds(FIntVector(CellX.Min, CellY.Min, CellZ.Min), FIntVector(CellX.Max, CellY.Max, CellZ.Max));
+
+				if (Snapshot->IsInGrid(Leaf))
+				{
+					const FVoxelGeneratorSnapshot::ELeafState State = Snapshot->GetLeafState(Leaf);
+					if (State == FVoxelGeneratorSnapshot::ELeafState::Baked)
+					{
+						const auto LeafData = Snapshot->GetLeaf(Leaf);
+						const FIntVector LeafMin = Leaf * DATA_CHUNK_SIZE;
+
+						for (int32 Z = CellBounds.Min.Z; Z < CellBounds.Max.Z; Z += Step)
+						{
+							for (int32 Y = CellBounds.Min.Y; Y < CellBounds.Max.Y; Y += Step)
+							{
+								for (int32 X = CellBounds.Min.X; X < CellBounds.Max.X; X += Step)
+								{
+									T Value;
+									LeafData->Get(FVoxelGeneratorSnapshot::GetIndexInLeaf(X - LeafMin.X, Y - LeafMin.Y, Z - LeafMin.Z), Value);
+									QueryZone.Set(X, Y, Z, Value);
+								}
+							}
+						}
+						continue;
+					}
+
+					T UniformValue;
+					if (GetUniform(State, UniformValue))
+					{
+						for (int32 Z = CellBounds.Min.Z; Z < CellBounds.Max.Z; Z += Step)
+						{
+							for (int32 Y = CellBounds.Min.Y; Y < CellBounds.Max.Y; Y += Step)
+							{
+								for (int32 X = CellBounds.Min.X; X < CellBounds.Max.X; X += Step)
+								{
+									QueryZone.Set(X, Y, Z, UniformValue);
+								}
+							}
+						}
+						continue;
+					}
+				}
+
+				auto CellQueryZone = QueryZone.ShrinkTo(CellBounds);
+				Source->Get<T>(CellQueryZone, LOD, Items);
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the chunk generation time with and without the snapshot of a voxel world, as a proxy for its startup time
+namespace FVoxelGeneratorSnapshotBenchmark
+{
+	template<typename T>
+	double Measure(const FVoxelGeneratorInstance& Generator, const TArray<FIntVector>& Chunks, int32 LOD)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		// Same size as the renderer queries
+		const int32 Size = RENDER_CHUNK_SIZE + 1;
+		const int32 Step = 1 << LOD;
+
+		const double StartTime = FPlatformTime::Seconds();
+		ParallelFor(Chunks.Num(), [&](int32 Index)
+		{
+			TArray<T> Data;
+			Data.SetNumUninitialized(Size * Size * Size);
+
+			TVoxelQueryZone<T> QueryZone(FVoxelIntBox(Chunks[Index], Chunks[Index] + Size * Step), FIntVector(Size), LOD, Data);
+			Generator.Get<T>(QueryZone, LOD, FVoxelItemStack::Empty);
+		});
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 MaxNumChunks = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 512;
+		const int32 LOD = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 0, 8) : 0;
+
+		if (World.GeneratorSnapshotPath.FilePath.IsEmpty())
+		{
+			LOG_VOXEL(Error, TEXT("voxel.snapshot.Benchmark: %s has no generator snapshot path"), *World.GetName());
+			return;
+		}
+
+		const FVoxelGeneratorInit GeneratorInit = World.GetGeneratorInit();
+		const auto Generator = World.Generator.GetInstance(true);
+		Generator->Init(GeneratorInit);
+
+		const FString Path = FVoxelGeneratorSnapshot::GetFullPath(World.GeneratorSnapshotPath.FilePath);
+
+		const double LoadStartTime = FPlatformTime::Seconds();
+		const auto Snapshot = FVoxelGeneratorSnapshot::Load(Path);
+		const double LoadTime = FPlatformTime::Seconds() - LoadStartTime;
+
+		if (!Snapshot)
+		{
+			return;
+		}
+		if (Snapshot->GetGeneratorHash() != FVoxelGeneratorSnapshot::ComputeGeneratorHash(World.Generator, GeneratorInit))
+		{
+			LOG_VOXEL(Error, TEXT("voxel.snapshot.Benchmark: %s was baked from another generator or with other settings"), *Path);
+			return;
+		}
+
+		// Chunks containing baked leaves, like the ones with a surface the renderer would create on startup
+		TArray<FIntVector> Chunks;
+		{
+			const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
+			TSet<FIntVector> ChunkSet;
+
+			const FIntVector LeavesMin = Snapshot->GetBounds().Min / DATA_CHUNK_SIZE;
+			const FIntVector LeavesMax = Snapshot->GetBounds().Max / DATA_CHUNK_SIZE;
+			for (int32 Z = LeavesMin.Z; Z < LeavesMax.Z && ChunkSet.Num() < MaxNumChunks; Z++)
+			{
+				for (int32 Y = LeavesMin.Y; Y < LeavesMax.Y && ChunkSet.Num() < MaxNumChunks; Y++)
+				{
+					for (int32 X = LeavesMin.X; X < LeavesMax.X && ChunkSet.Num() < MaxNumChunks; X++)
+					{
+						const FIntVector Leaf(X, Y, Z);
+						if (Snapshot->GetLeafState(Leaf) == FVoxelGeneratorSnapshot::ELeafState::Baked)
+						{
+							ChunkSet.Add(FVoxelUtilities::DivideFloor(Leaf * DATA_CHUNK_SIZE, ChunkSize) * ChunkSize);
+						}
+					}
+				}
+			}
+			Chunks = ChunkSet.Array();
+		}
+
+		const auto SnapshotInstance = MakeVoxelShared<FVoxelGeneratorSnapshotInstance>(Generator, Snapshot.ToSharedRef());
+
+		// The first snapshot pass decompresses the leaves
+		const double SnapshotColdValuesTime = Measure<FVoxelValue>(*SnapshotInstance, Chunks, LOD);
+		const double SnapshotValuesTime = Measure<FVoxelValue>(*SnapshotInstance, Chunks, LOD);
+		const double SnapshotMaterialsTime = Measure<FVoxelMaterial>(*SnapshotInstance, Chunks, LOD);
+		const double GeneratorValuesTime = Measure<FVoxelValue>(*Generator, Chunks, LOD);
+		const double GeneratorMaterialsTime = Measure<FVoxelMaterial>(*Generator, Chunks, LOD);
+
+		LOG_VOXEL(Log, TEXT("Generator snapshot benchmark on %s: %d chunks at LOD %d. Snapshot %s in %.2fms, %.2fMB, %.2fMB of leaves decompressed"),
+			*World.GetName(),
+			Chunks.Num(),
+			LOD,
+			Snapshot->IsMapped() ? TEXT("mapped") : TEXT("loaded"),
+			LoadTime * 1000,
+			Snapshot->GetFileSize() / double(1 << 20),
+			Snapshot->GetResidentLeavesSize() / double(1 << 20));
+
+		const auto LogResults = [&](const TCHAR* Name, double Time)
+		{
+			LOG_VOXEL(Log, TEXT("%s: %.2fms, %.3fms per chunk"), Name, Time * 1000, Chunks.Num() > 0 ? Time * 1000 / Chunks.Num() : 0);
+		};
+		LogResults(TEXT("Generator values"), GeneratorValuesTime);
+		LogResults(TEXT("Snapshot values, including load and decompression"), LoadTime + SnapshotColdValuesTime);
+		LogResults(TEXT("Snapshot values, decompressed"), SnapshotValuesTime);
+		LogResults(TEXT("Generator materials"), GeneratorMaterialsTime);
+		LogResults(TEXT("Snapshot materials"), SnapshotMaterialsTime);
+	}
+}
+
+// eg: voxel.snapshot.Bake 8
+static FAutoConsoleCommandWithWorldAndArgs GeneratorSnapshotBakeCmd(
+	TEXT("voxel.snapshot.Bake"),
+	TEXT("Bake the generator of all the voxel worlds in the scene to their generator snapshot path. The worlds need to be recreated to use it. Args: [Num threads = num cores]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 ThreadCount = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			UVoxelCookingLibrary::BakeGeneratorSnapshot(*It, ThreadCount);
+		}
+	}));
+
+// eg: voxel.snapshot.Benchmark 256 1
+static FAutoConsoleCommandWithWorldAndArgs GeneratorSnapshotBenchmarkCmd(
+	TEXT("voxel.snapshot.Benchmark"),
+	TEXT("Generate chunks with and without the generator snapshot of all the voxel worlds in the scene, and log the time taken. Args: [Max num chunks = 512] [LOD = 0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelGeneratorSnapshotBenchmark::Run(**It, Args);
+			}
+		}
+	}));
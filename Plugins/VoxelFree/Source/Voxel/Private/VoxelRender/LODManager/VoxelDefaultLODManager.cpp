@@ -16,6 +16,20 @@ static TAutoConsoleVariable<int32> CVarFreezeLODs(
 	TEXT("Stops LOD manager tick"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<float> CVarLODPredictionTime(
+	TEXT("voxel.lod.PredictionTime"),
+	0.f,
+	TEXT("If > 0, the LODs and the task priorities will also be computed around where the invokers are expected to be in that many seconds, based on their velocity. ")
+	TEXT("Avoids low resolution chunks in front of fast moving invokers"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSkipChunksWithoutSurface(
+	TEXT("voxel.lod.SkipChunksWithoutSurface"),
+	1,
+	TEXT("If true, the render octree will use range analysis on the data to find the chunks that are all empty or all full, and no mesher task will be queued for them. ")
+	TEXT("The number of skipped tasks is logged once the world is loaded"),
+	ECVF_Default);
+
 TVoxelSharedRef<FVoxelDefaultLODManager> FVoxelDefaultLODManager::Create(
 	const FVoxelLODSettings& LODSettings,
 	TWeakObjectPtr<const AVoxelWorldInterface> VoxelWorldInterface,
@@ -67,6 +81,11 @@ int32 FVoxelDefaultLODManager::UpdateBounds(const FVoxelIntBox& Bounds, const FV
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
 
+	if (Octree.IsValid() || bAsyncTaskWorking)
+	{
+		RangeDirtyBounds.Add(Bounds);
+	}
+
 	if (!Octree.IsValid())
 	{
 		return 0;
@@ -82,6 +101,11 @@ int32 FVoxelDefaultLODManager::UpdateBounds(const TArray<FVoxelIntBox>& Bounds,
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
 
+	if (Octree.IsValid() || bAsyncTaskWorking)
+	{
+		RangeDirtyBounds.Append(Bounds);
+	}
+
 	if (!Octree.IsValid() || Bounds.Num() == 0)
 	{
 		return 0;
@@ -167,6 +191,19 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 			
 			Octree = Task->NewOctree;
 
+			if (RangeDirtyBounds.Num() > 0)
+			{
+				// These edits happened while the task was working: its value ranges might be outdated
+				for (auto& ChunkUpdate : Task->ChunkUpdates)
+				{
+					if (ChunkUpdate.bNoSurface && RangeDirtyBounds.ContainsByPredicate([&](const FVoxelIntBox& DirtyBounds) { return DirtyBounds.Intersect(ChunkUpdate.Bounds.Extend(2 << ChunkUpdate.LOD)); }))
+					{
+						ChunkUpdate.bNoSurface = false;
+					}
+				}
+			}
+			TaskRangeDirtyBounds.Reset();
+
 			INC_DWORD_STAT_BY(STAT_VoxelChunkUpdates, Task->ChunkUpdates.Num());
 			Settings.Renderer->UpdateLODs(Octree->UpdateIndex, Task->ChunkUpdates);
 
@@ -180,6 +217,11 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 				StopTicking();
 			}
 		}
+		else
+		{
+			// The octree wasn't used: need to reset its value ranges next time
+			RangeDirtyBounds.Append(MoveTemp(TaskRangeDirtyBounds));
+		}
 		bAsyncTaskWorking = false;
 	}
 }
@@ -211,6 +253,10 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerInfo> NewInvokerComponentsInfos;
 	NewInvokerComponentsInfos.Reserve(NewSortedInvokerComponents.Num());
 	
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerMotion> NewInvokerMotions;
+	NewInvokerMotions.Reserve(NewSortedInvokerComponents.Num());
+	
+	const double Time = FPlatformTime::Seconds();
 	const uint64 SquaredDistanceThreshold = FMath::Square(FMath::Max(DynamicSettings->InvokerDistanceThreshold / Settings.VoxelSize, 0.f)); // Truncate
 	for (const auto& InvokerComponent : NewSortedInvokerComponents)
 	{
@@ -221,6 +267,7 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 		
 		FVoxelInvokerInfo Info;
 		Info.LocalPosition = InvokerPosition;
+		Info.PredictedOffset = UpdateInvokerMotion(InvokerComponent, InvokerPosition, InvokerSettings, Time, NewInvokerMotions);
 		Info.Settings = InvokerSettings;
 
 		NewInvokerComponentsInfos.Add(InvokerComponent, Info);
@@ -257,6 +304,11 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component moved"));
 					bNeedUpdate = true;
 				}
+				else if (FVoxelUtilities::SquaredSize(ExistingInfo->PredictedOffset - Info.PredictedOffset) > SquaredDistanceThreshold)
+				{
+					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component predicted position moved"));
+					bNeedUpdate = true;
+				}
 			}
 		}
 	}
@@ -277,6 +329,11 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 			if (It.Key->bUseForPriorities)
 			{
 				InvokersPositionsForPriorities.Add(It.Value.LocalPosition);
+				if (It.Value.PredictedOffset != FIntVector::ZeroValue)
+				{
+					// Chunks along the path are as important as the ones around the invoker
+					InvokersPositionsForPriorities.Add(It.Value.LocalPosition + It.Value.PredictedOffset);
+				}
 			}
 		}
 		Settings.Renderer->SetInvokersPositionsForPriorities(InvokersPositionsForPriorities);
@@ -284,7 +341,8 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 
 	ensure(SortedInvokerComponents.Num() == InvokerComponentsInfos.Num());
 
-	const double Time = FPlatformTime::Seconds();
+	InvokerMotions = MoveTemp(NewInvokerMotions);
+
 	if (bLODUpdateQueued && Task->IsDone() && Time - LastLODUpdateTime > Settings.MinDelayBetweenLODUpdates)
 	{
 		bLODUpdateQueued = false;
@@ -293,6 +351,45 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 	}
 }
 
+FIntVector FVoxelDefaultLODManager::UpdateInvokerMotion(
+	const TWeakObjectPtr<UVoxelInvokerComponentBase>& InvokerComponent,
+	const FIntVector& InvokerPosition,
+	const FVoxelInvokerSettings& InvokerSettings,
+	double Time,
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerMotion>& NewInvokerMotions) const
+{
+	FVoxelInvokerMotion Motion;
+	Motion.LastPosition = InvokerPosition;
+	Motion.LastTime = Time;
+
+	if (const FVoxelInvokerMotion* ExistingMotion = InvokerMotions.Find(InvokerComponent))
+	{
+		const double DeltaTime = Time - ExistingMotion->LastTime;
+		if (DeltaTime > SMALL_NUMBER)
+		{
+			const FVector InstantVelocity = FVector(InvokerPosition - ExistingMotion->LastPosition) / DeltaTime;
+			// Smooth out jitter from the invoker position being rounded to voxels
+			Motion.Velocity = FMath::Lerp(ExistingMotion->Velocity, InstantVelocity, 0.5f);
+		}
+		else
+		{
+			Motion.Velocity = ExistingMotion->Velocity;
+		}
+	}
+	NewInvokerMotions.Add(InvokerComponent, Motion);
+	
+	const float PredictionTime = CVarLODPredictionTime.GetValueOnGameThread();
+	if (PredictionTime <= 0 || !InvokerSettings.bUseForLOD)
+	{
+		return FIntVector::ZeroValue;
+	}
+
+	// Clamp to the LOD bounds size: no need to look further, and avoids subdividing far away when teleporting
+	const float MaxDistance = FMath::Max(InvokerSettings.LODBounds.Size().GetMax(), 0);
+	const FVector Offset = (Motion.Velocity * PredictionTime).GetClampedToMaxSize(MaxDistance);
+	return FIntVector(FMath::RoundToInt(Offset.X), FMath::RoundToInt(Offset.Y), FMath::RoundToInt(Offset.Z));
+}
+
 void FVoxelDefaultLODManager::UpdateLODs()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -313,6 +410,15 @@ void FVoxelDefaultLODManager::UpdateLODs()
 		{
 			OctreeSettings.Invokers.Add(It.Value.Settings);
 		}
+		if (It.Value.Settings.bUseForLOD && It.Value.PredictedOffset != FIntVector::ZeroValue)
+		{
+			// Pre-subdivide where the invoker is going
+			FVoxelInvokerSettings PredictedSettings;
+			PredictedSettings.bUseForLOD = true;
+			PredictedSettings.LODToSet = It.Value.Settings.LODToSet;
+			PredictedSettings.LODBounds = It.Value.Settings.LODBounds.Translate(It.Value.PredictedOffset);
+			OctreeSettings.Invokers.Add(PredictedSettings);
+		}
 	}
 
 	OctreeSettings.ChunksCullingLOD = DynamicSettings->ChunksCullingLOD;
@@ -329,6 +435,13 @@ void FVoxelDefaultLODManager::UpdateLODs()
 	OctreeSettings.bComputeVisibleChunksNavmesh = DynamicSettings->bComputeVisibleChunksNavmesh;
 	OctreeSettings.VisibleChunksNavmeshMaxLOD = DynamicSettings->VisibleChunksNavmeshMaxLOD;
 
+	if (CVarSkipChunksWithoutSurface.GetValueOnGameThread())
+	{
+		OctreeSettings.Data = Settings.Renderer->Settings.Data;
+	}
+	TaskRangeDirtyBounds = MoveTemp(RangeDirtyBounds);
+	OctreeSettings.DirtyBounds = TaskRangeDirtyBounds;
+
 	Task->Init(OctreeSettings, Octree);
 	Settings.Pool->QueueTask(EVoxelTaskType::RenderOctree, Task.Get());
 	bAsyncTaskWorking = true;
@@ -338,4 +451,5 @@ void FVoxelDefaultLODManager::ClearInvokerComponents()
 {
 	SortedInvokerComponents.Reset();
 	InvokerComponentsInfos.Reset();
+	InvokerMotions.Reset();
 }
\ No newline at end of file
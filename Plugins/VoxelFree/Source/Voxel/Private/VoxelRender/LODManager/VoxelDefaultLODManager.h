@@ -75,17 +75,40 @@ private:
 	struct FVoxelInvokerInfo
 	{
 		FIntVector LocalPosition{ForceInit};
+		// Where the invoker is expected to be in voxel.lod.PredictionTime seconds, relative to LocalPosition
+		FIntVector PredictedOffset{ForceInit};
 		FVoxelInvokerSettings Settings;
 	};
 	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerInfo> InvokerComponentsInfos;
+
+	// Updated every UpdateInvokers, unlike InvokerComponentsInfos
+	struct FVoxelInvokerMotion
+	{
+		FIntVector LastPosition{ForceInit};
+		double LastTime = 0;
+		// In voxels per second, smoothed
+		FVector Velocity{ForceInit};
+	};
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerMotion> InvokerMotions;
 	TArray<TWeakObjectPtr<UVoxelInvokerComponentBase>> SortedInvokerComponents;
 
+	// Edited bounds, to reset the value ranges cached in the octree on the next update
+	TArray<FVoxelIntBox> RangeDirtyBounds;
+	// The ones given to the task currently working
+	TArray<FVoxelIntBox> TaskRangeDirtyBounds;
+
 	bool bAsyncTaskWorking = false;
 	bool bLODUpdateQueued = true;
 	double LastLODUpdateTime = 0;
 	double LastInvokersUpdateTime = 0;
 
 	void UpdateInvokers();
+	FIntVector UpdateInvokerMotion(
+		const TWeakObjectPtr<UVoxelInvokerComponentBase>& InvokerComponent,
+		const FIntVector& InvokerPosition,
+		const FVoxelInvokerSettings& InvokerSettings,
+		double Time,
+		TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerMotion>& NewInvokerMotions) const;
 	void UpdateLODs();
 
 	void ClearInvokerComponents();
@@ -2,10 +2,12 @@
 
 #include "VoxelRenderOctree.h"
 #include "VoxelDebug/VoxelDebugManager.h"
+#include "VoxelData/VoxelDataLock.h"
 #include "VoxelMessages.h"
 #include "Async/Async.h"
 
 DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Render Octrees Count"), STAT_VoxelRenderOctreesCount, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Render Octree Value Range Queries"), STAT_VoxelRenderOctreeValueRangeQueries, STATGROUP_VoxelCounters);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelRenderOctreesMemory);
 
 static TAutoConsoleVariable<int32> CVarMaxRenderOctreeChunks(
@@ -20,6 +22,12 @@ static TAutoConsoleVariable<int32> CVarLogRenderOctreeBuildTime(
 	TEXT("If true, will log the render octree build times"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarRenderOctreeNeighborsWorklist(
+	TEXT("voxel.renderer.RenderOctreeNeighborsWorklist"),
+	1,
+	TEXT("If true, the render octree will propagate the neighbors subdivisions using a worklist instead of iterating on the entire octree until nothing changes"),
+	ECVF_Default);
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -104,6 +112,13 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 		LOG_TIME("ResetDivisionType");
 	}
 
+	if (OctreeSettings.DirtyBounds.Num() > 0)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("ResetValueRanges");
+		NewOctree->ResetValueRanges(OctreeSettings.DirtyBounds);
+		LOG_TIME("ResetValueRanges");
+	}
+
 	bool bChanged;
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("UpdateSubdividedByDistance");
@@ -115,10 +130,19 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 	if (bChanged)
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("UpdateSubdividedByNeighbors");
-		int32 UpdateSubdividedByNeighborsCounter = 0;
-		while (NewOctree->UpdateSubdividedByNeighbors(OctreeSettings)) { UpdateSubdividedByNeighborsCounter++; }
-		LOG_TIME("UpdateSubdividedByNeighbors");
-		Log += "; Iterations: " + FString::FromInt(UpdateSubdividedByNeighborsCounter);
+		if (CVarRenderOctreeNeighborsWorklist.GetValueOnAnyThread())
+		{
+			const int32 NumSubdivided = NewOctree->UpdateSubdividedByNeighborsWorklist(OctreeSettings);
+			LOG_TIME("UpdateSubdividedByNeighbors");
+			Log += "; Subdivided: " + FString::FromInt(NumSubdivided);
+		}
+		else
+		{
+			int32 UpdateSubdividedByNeighborsCounter = 0;
+			while (NewOctree->UpdateSubdividedByNeighbors(OctreeSettings)) { UpdateSubdividedByNeighborsCounter++; }
+			LOG_TIME("UpdateSubdividedByNeighbors");
+			Log += "; Iterations: " + FString::FromInt(UpdateSubdividedByNeighborsCounter);
+		}
 	}
 	else
 	{
@@ -142,6 +166,13 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 		VOXEL_ASYNC_SCOPE_COUNTER("GetUpdates");
 		NewOctree->GetUpdates(NewOctree->UpdateIndex + 1, bChanged, OctreeSettings, ChunkUpdates);
 		LOG_TIME("GetUpdates");
+
+		int32 NumNoSurface = 0;
+		for (auto& ChunkUpdate : ChunkUpdates)
+		{
+			NumNoSurface += ChunkUpdate.bNoSurface;
+		}
+		Log += "; Updates: " + FString::FromInt(ChunkUpdates.Num()) + "; Without surface: " + FString::FromInt(NumNoSurface);
 	}
 	
 	{
@@ -192,6 +223,8 @@ uint32 FVoxelRenderOctreeAsyncBuilder::GetPriority() const
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+inline bool IsVisibleParent(const FVoxelRenderOctree* Chunk);
+
 #define CHECK_MAX_CHUNKS_COUNT_IMPL(ReturnValue) if (IsCanceled()) { return ReturnValue; }
 #define CHECK_MAX_CHUNKS_COUNT() CHECK_MAX_CHUNKS_COUNT_IMPL(;)
 #define CHECK_MAX_CHUNKS_COUNT_BOOL() CHECK_MAX_CHUNKS_COUNT_IMPL(false)
@@ -345,6 +378,72 @@ bool FVoxelRenderOctree::UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSet
 	return bShouldContinue;
 }
 
+int32 FVoxelRenderOctree::UpdateSubdividedByNeighborsWorklist(const FVoxelRenderOctreeSettings& Settings)
+{
+	check(Root == this);
+
+	// Start with all the visible chunks
+	TArray<FVoxelRenderOctree*> Worklist;
+	{
+		TArray<FVoxelRenderOctree*> Stack;
+		Stack.Add(this);
+		while (Stack.Num() > 0)
+		{
+			FVoxelRenderOctree* Chunk = Stack.Pop(false);
+			if (IsVisibleParent(Chunk))
+			{
+				for (auto& Child : Chunk->GetChildren())
+				{
+					Stack.Add(&Child);
+				}
+			}
+			else
+			{
+				Worklist.Add(Chunk);
+			}
+		}
+	}
+
+	// Subdivisions are never undone, so the order doesn't matter: this converges to the same octree as UpdateSubdividedByNeighbors
+	int32 NumSubdivided = 0;
+	while (Worklist.Num() > 0)
+	{
+		CHECK_MAX_CHUNKS_COUNT_IMPL(NumSubdivided);
+
+		FVoxelRenderOctree* Chunk = Worklist.Pop(false);
+		if (Chunk->ChunkSettings.DivisionType != EDivisionType::Uninitialized || !Chunk->ShouldSubdivideByNeighbors(Settings))
+		{
+			continue;
+		}
+
+		Chunk->ChunkSettings.DivisionType = EDivisionType::ByNeighbors;
+		if (!Chunk->HasChildren())
+		{
+			Chunk->CreateChildren();
+		}
+		NumSubdivided++;
+
+		// The children might be too big compared to their own neighbors
+		for (auto& Child : Chunk->GetChildren())
+		{
+			Worklist.Add(&Child);
+		}
+		// Bigger neighbors might now be too big compared to the children
+		for (int32 DirectionIndex = 0; DirectionIndex < 6; DirectionIndex++)
+		{
+			const auto Direction = EVoxelDirectionFlag::Type(1 << DirectionIndex);
+			// Index does not matter for bigger chunks
+			const FVoxelRenderOctree* AdjacentChunk = Chunk->GetVisibleAdjacentChunk(Direction, 0);
+			if (AdjacentChunk && AdjacentChunk->Height > Chunk->Height)
+			{
+				Worklist.Add(const_cast<FVoxelRenderOctree*>(AdjacentChunk));
+			}
+		}
+	}
+
+	return NumSubdivided;
+}
+
 void FVoxelRenderOctree::ReuseOldNeighbors()
 {
 	if (ChunkSettings.OldDivisionType == EDivisionType::ByNeighbors)
@@ -425,6 +524,30 @@ void FVoxelRenderOctree::DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates)
 	}
 }
 
+void FVoxelRenderOctree::ResetValueRanges(const TArray<FVoxelIntBox>& DirtyBounds)
+{
+	if (ChunkSettings.ValueRangeState == EValueRangeState::Unknown && !HasChildren())
+	{
+		return;
+	}
+
+	const FVoxelIntBox Bounds = GetValueRangeBounds();
+	if (!DirtyBounds.ContainsByPredicate([&](const FVoxelIntBox& DirtyBox) { return DirtyBox.Intersect(Bounds); }))
+	{
+		return;
+	}
+
+	ChunkSettings.ValueRangeState = EValueRangeState::Unknown;
+
+	if (!!HasChildren())
+	{
+		for (auto& Child : GetChildren())
+		{
+			Child.ResetValueRanges(DirtyBounds);
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void FVoxelRenderOctree::GetUpdates(
@@ -432,7 +555,8 @@ void FVoxelRenderOctree::GetUpdates(
 	bool bRecomputeTransitionMasks,
 	const FVoxelRenderOctreeSettings& Settings,
 	TArray<FVoxelChunkUpdate>& ChunkUpdates,
-	bool bInVisible)
+	bool bInVisible,
+	EValueRangeState ParentValueRangeState)
 {
 	CHECK_MAX_CHUNKS_COUNT();
 
@@ -444,6 +568,8 @@ void FVoxelRenderOctree::GetUpdates(
 		return;
 	}
 
+	UpdateValueRangeState(Settings, ParentValueRangeState);
+
 	FVoxelChunkSettings NewSettings{};
 	
 	// NOTE: we DO want bEnableRender = false to disable VisibleChunks settings
@@ -471,7 +597,7 @@ void FVoxelRenderOctree::GetUpdates(
 
 		for (auto& Child : GetChildren())
 		{
-			Child.GetUpdates(UpdateIndex, bRecomputeTransitionMasks, Settings, ChunkUpdates, bChildrenVisible);
+			Child.GetUpdates(UpdateIndex, bRecomputeTransitionMasks, Settings, ChunkUpdates, bChildrenVisible, ChunkSettings.ValueRangeState);
 		}
 	}
 
@@ -540,7 +666,10 @@ void FVoxelRenderOctree::GetUpdates(
 				OctreeBounds,
 				ChunkSettings.Settings,
 				NewSettings,
-				{}
+				{},
+				// Data is null when voxel.lod.SkipChunksWithoutSurface is off: ignore the states computed before it was turned off
+				Settings.Data.IsValid() &&
+				(ChunkSettings.ValueRangeState == EValueRangeState::Empty || ChunkSettings.ValueRangeState == EValueRangeState::Full)
 			});
 	}
 	
@@ -702,6 +831,52 @@ bool FVoxelRenderOctree::ShouldSubdivideByOthers(const FVoxelRenderOctreeSetting
 
 ///////////////////////////////////////////////////////////////////////////////
 
+FVoxelIntBox FVoxelRenderOctree::GetValueRangeBounds() const
+{
+	// Same margin as the meshers, that need the neighbors for the normals and the end edges
+	return OctreeBounds.Extend(2 << Height);
+}
+
+void FVoxelRenderOctree::UpdateValueRangeState(const FVoxelRenderOctreeSettings& Settings, EValueRangeState ParentValueRangeState)
+{
+	auto& State = ChunkSettings.ValueRangeState;
+	
+	if (ParentValueRangeState == EValueRangeState::Empty || ParentValueRangeState == EValueRangeState::Full)
+	{
+		// Our bounds are included in the parent ones
+		State = ParentValueRangeState;
+		return;
+	}
+	if (State != EValueRangeState::Unknown)
+	{
+		// Still valid, as it's reset when editing
+		return;
+	}
+	if (!Settings.Data.IsValid())
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_VoxelRenderOctreeValueRangeQueries);
+
+	const FVoxelData& Data = *Settings.Data;
+	const FVoxelIntBox Bounds = GetValueRangeBounds();
+
+	FVoxelReadScopeLock Lock(Data, Bounds, STATIC_FNAME("Render Octree Value Range"));
+	const TVoxelRange<FVoxelValue> Range = Data.GetValueRange(Bounds, Height);
+
+	if (Range.Min.IsEmpty() != Range.Max.IsEmpty())
+	{
+		State = EValueRangeState::Mixed;
+	}
+	else
+	{
+		State = Range.Min.IsEmpty() ? EValueRangeState::Empty : EValueRangeState::Full;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 inline bool IsVisibleParent(const FVoxelRenderOctree* Chunk)
 {
 	return Chunk->ChunkSettings.DivisionType == FVoxelRenderOctree::EDivisionType::ByDistance || Chunk->ChunkSettings.DivisionType == FVoxelRenderOctree::EDivisionType::ByNeighbors;
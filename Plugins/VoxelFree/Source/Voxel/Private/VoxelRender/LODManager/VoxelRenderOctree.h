@@ -16,6 +16,7 @@
 class FVoxelRenderOctree;
 struct FVoxelLODSettings;
 class FVoxelDebugManager;
+class FVoxelData;
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FVoxelOnChunkUpdate, FVoxelIntBox);
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Render Octrees Memory"), STAT_VoxelRenderOctreesMemory, STATGROUP_VoxelMemory, VOXEL_API);
@@ -41,6 +42,11 @@ struct FVoxelRenderOctreeSettings
 	bool bEnableNavmesh;
 	bool bComputeVisibleChunksNavmesh;
 	int32 VisibleChunksNavmeshMaxLOD;
+
+	// If set, used to find the chunks without any surface using range analysis
+	TVoxelSharedPtr<const FVoxelData> Data;
+	// Bounds edited since the last build: the value ranges cached in the octree are outdated there
+	TArray<FVoxelIntBox> DirtyBounds;
 };
 
 class FVoxelRenderOctreeAsyncBuilder : public FVoxelAsyncWork
@@ -103,11 +109,22 @@ public:
 		ByOthers      = 3
 	};
 
+	// Computed top-down from the data value range, and kept until the chunk is edited
+	enum class EValueRangeState : uint8
+	{
+		Unknown = 0,
+		// Might have a surface
+		Mixed   = 1,
+		Empty   = 2,
+		Full    = 3
+	};
+
 	struct FChunkSettings
 	{
 		FVoxelChunkSettings Settings{};
 		EDivisionType DivisionType = EDivisionType::Uninitialized;
 		EDivisionType OldDivisionType = EDivisionType::Uninitialized;
+		EValueRangeState ValueRangeState = EValueRangeState::Unknown;
 	}; 
 	FChunkSettings ChunkSettings;
 	int32 CurrentChunksCount = 0;
@@ -126,16 +143,21 @@ public:
 	void ResetDivisionType();
 	bool UpdateSubdividedByDistance(const FVoxelRenderOctreeSettings& Settings);
 	bool UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSettings& Settings);
+	// Same result as calling UpdateSubdividedByNeighbors until it returns false, but only visits the chunks affected by each subdivision
+	// Must be called on the root
+	int32 UpdateSubdividedByNeighborsWorklist(const FVoxelRenderOctreeSettings& Settings);
 	void ReuseOldNeighbors();
 	void UpdateSubdividedByOthers(const FVoxelRenderOctreeSettings& Settings);
 	void DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates);
+	void ResetValueRanges(const TArray<FVoxelIntBox>& DirtyBounds);
 
 	void GetUpdates(
 		uint32 InUpdateIndex,
 		bool bRecomputeTransitionMasks,
 		const FVoxelRenderOctreeSettings& Settings, 
 		TArray<FVoxelChunkUpdate>& ChunkUpdates, 
-		bool bVisible = true);
+		bool bVisible = true,
+		EValueRangeState ParentValueRangeState = EValueRangeState::Unknown);
 
 	void GetChunksToUpdateForBounds(const FVoxelIntBox& Bounds, TArray<uint64>& ChunksToUpdate, const FVoxelOnChunkUpdate& OnChunkUpdate) const;
 	void GetVisibleChunksOverlappingBounds(const FVoxelIntBox& Bounds, TArray<uint64, TInlineAllocator<8>>& VisibleChunks) const;
@@ -146,6 +168,9 @@ private:
 	bool ShouldSubdivideByDistance(const FVoxelRenderOctreeSettings& Settings) const;
 	bool ShouldSubdivideByNeighbors(const FVoxelRenderOctreeSettings& Settings) const;
 	bool ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings) const;
+
+	FVoxelIntBox GetValueRangeBounds() const;
+	void UpdateValueRangeState(const FVoxelRenderOctreeSettings& Settings, EValueRangeState ParentValueRangeState);
 	
 	const FVoxelRenderOctree* GetVisibleAdjacentChunk(EVoxelDirectionFlag::Type Direction, int32 Index) const;
 
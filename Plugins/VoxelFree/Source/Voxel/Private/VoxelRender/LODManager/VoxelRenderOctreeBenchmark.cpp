@@ -0,0 +1,143 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelRenderOctree.h"
+#include "VoxelUtilities/VoxelMathUtilities.h"
+
+#include "HAL/IConsoleManager.h"
+
+// Moves a LOD 0 invoker in octrees of depth 8 to 12, and compares propagating the neighbors subdivisions with a worklist
+// against calling UpdateSubdividedByNeighbors until nothing changes
+namespace FVoxelRenderOctreeBenchmark
+{
+	FVoxelRenderOctreeSettings MakeSettings(int32 Depth, const FIntVector& InvokerPosition)
+	{
+		FVoxelRenderOctreeSettings Settings{};
+		Settings.MinLOD = 0;
+		Settings.MaxLOD = Depth;
+		Settings.WorldBounds = FVoxelUtilities::GetBoundsFromDepth<RENDER_CHUNK_SIZE>(Depth);
+		Settings.ChunksCullingLOD = Depth;
+		Settings.bEnableRender = true;
+
+		FVoxelInvokerSettings Invoker;
+		Invoker.bUseForLOD = true;
+		Invoker.LODToSet = 0;
+		Invoker.LODBounds = FVoxelIntBox(InvokerPosition).Extend(4 * RENDER_CHUNK_SIZE);
+		Settings.Invokers.Add(Invoker);
+
+		return Settings;
+	}
+
+	// Returns the number of chunks whose division differs
+	int32 Compare(const FVoxelRenderOctree& A, const FVoxelRenderOctree& B)
+	{
+		if (A.ChunkSettings.DivisionType != B.ChunkSettings.DivisionType ||
+			A.HasChildren() != B.HasChildren())
+		{
+			return 1;
+		}
+		int32 NumDifferent = 0;
+		if (A.HasChildren())
+		{
+			for (int32 Index = 0; Index < 8; Index++)
+			{
+				NumDifferent += Compare(A.GetChild(Index), B.GetChild(Index));
+			}
+		}
+		return NumDifferent;
+	}
+
+	// Clones Previous and subdivides it by distance, like FVoxelRenderOctreeAsyncBuilder
+	TVoxelSharedRef<FVoxelRenderOctree> Prepare(const FVoxelRenderOctree& Previous, const FVoxelRenderOctreeSettings& Settings)
+	{
+		const TVoxelSharedRef<FVoxelRenderOctree> Octree = MakeVoxelShared<FVoxelRenderOctree>(&Previous);
+		Octree->ResetDivisionType();
+		Octree->UpdateSubdividedByDistance(Settings);
+		return Octree;
+	}
+
+	void RunCase(int32 Depth, int32 MoveInVoxels, int32 Iterations, bool& bOutFailed)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FIntVector StartPosition(0);
+		const FIntVector EndPosition(MoveInVoxels, MoveInVoxels / 2, 0);
+
+		// Octree of the previous update, built around the start position
+		const TVoxelSharedRef<FVoxelRenderOctree> Previous = MakeVoxelShared<FVoxelRenderOctree>(uint8(Depth));
+		{
+			const FVoxelRenderOctreeSettings StartSettings = MakeSettings(Depth, StartPosition);
+			Previous->ResetDivisionType();
+			Previous->UpdateSubdividedByDistance(StartSettings);
+			Previous->UpdateSubdividedByNeighborsWorklist(StartSettings);
+		}
+
+		const FVoxelRenderOctreeSettings Settings = MakeSettings(Depth, EndPosition);
+
+		double WorklistTime = 0;
+		double SweepTime = 0;
+		int32 NumSubdivided = 0;
+		int32 NumIterations = 0;
+		int32 NumDifferent = 0;
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const TVoxelSharedRef<FVoxelRenderOctree> WorklistOctree = Prepare(*Previous, Settings);
+			const TVoxelSharedRef<FVoxelRenderOctree> SweepOctree = Prepare(*Previous, Settings);
+
+			double StartTime = FPlatformTime::Seconds();
+			NumSubdivided = WorklistOctree->UpdateSubdividedByNeighborsWorklist(Settings);
+			WorklistTime += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			NumIterations = 0;
+			while (SweepOctree->UpdateSubdividedByNeighbors(Settings)) { NumIterations++; }
+			SweepTime += FPlatformTime::Seconds() - StartTime;
+
+			NumDifferent = Compare(*WorklistOctree, *SweepOctree);
+		}
+		WorklistTime /= Iterations;
+		SweepTime /= Iterations;
+
+		bOutFailed |= NumDifferent > 0;
+
+		LOG_VOXEL(Log, TEXT("Depth %2d, move %7d voxels: %d chunks, %d subdivided by neighbors. Worklist: %.3fms. Full sweep: %.3fms (%d iterations). Speedup: %.1fx. %s"),
+			Depth,
+			MoveInVoxels,
+			Previous->CurrentChunksCount,
+			NumSubdivided,
+			WorklistTime * 1000,
+			SweepTime * 1000,
+			NumIterations,
+			WorklistTime > 0 ? SweepTime / WorklistTime : 0,
+			NumDifferent > 0 ? *FString::Printf(TEXT("FAILED: %d chunks differ"), NumDifferent) : TEXT("Identical"));
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3;
+
+		bool bFailed = false;
+		for (int32 Depth = 8; Depth <= 12; Depth++)
+		{
+			// Small move: one chunk. Large move: a quarter of the world
+			RunCase(Depth, RENDER_CHUNK_SIZE, Iterations, bFailed);
+			RunCase(Depth, (RENDER_CHUNK_SIZE << Depth) / 4, Iterations, bFailed);
+		}
+
+		if (bFailed)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.renderer.BenchmarkRenderOctree: the worklist octree differs from the full sweep one"));
+		}
+	}
+}
+
+// eg: voxel.renderer.BenchmarkRenderOctree 5
+static FAutoConsoleCommand RenderOctreeBenchmarkCmd(
+	TEXT("voxel.renderer.BenchmarkRenderOctree"),
+	TEXT("Move a LOD 0 invoker by one chunk and by a quarter of the world in render octrees of depth 8 to 12, check that the worklist neighbors propagation gives the same octree as the full sweep and log the timings of both. Args: [Iterations = 3]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelRenderOctreeBenchmark::Run(Args);
+	}));
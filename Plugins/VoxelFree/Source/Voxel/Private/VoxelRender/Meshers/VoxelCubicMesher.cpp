@@ -4,6 +4,13 @@
 #include "VoxelRender/Meshers/VoxelMesherUtilities.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelData/VoxelDataIncludes.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGreedyCubicMeshing(
+	TEXT("voxel.mesher.GreedyCubicMeshing"),
+	0,
+	TEXT("If true, cubic meshers will merge coplanar faces with the same material into bigger quads. Reduces triangle count a lot for flat worlds"),
+	ECVF_Default);
 
 struct FVoxelCubicFullVertex : FVoxelMesherVertex
 {
@@ -65,11 +72,13 @@ struct FVoxelCubicGeometryVertex : FVector
 };
 static_assert(sizeof(FVoxelCubicGeometryVertex) == sizeof(FVector), "");
 
+// Size: number of voxels covered by the face along each axis. Must be 1 along the face normal
 template<EVoxelDirectionFlag::Type Direction, typename TVertex, typename TMesher>
 FORCEINLINE void AddFace(
 	TMesher& Mesher, int32 Step, FVoxelMaterial Material, 
 	int32 X, int32 Y, int32 Z, 
-	TArray<uint32>& Indices, TArray<TVertex>& Vertices)
+	TArray<uint32>& Indices, TArray<TVertex>& Vertices,
+	const FIntVector& Size = FIntVector(1, 1, 1))
 {
 	if (TVertex::bComputeMaterial && Mesher.Settings.bOneMaterialPerCubeSide)
 	{
@@ -162,7 +171,7 @@ FORCEINLINE void AddFace(
 	int32 PositionsIndices[4];
 	for (int32 Index = 0; Index < 4; Index++)
 	{
-		const FVector VertexPositionInCube = Positions[Index];
+		const FVector VertexPositionInCube = Positions[Index] * FVector(Size);
 		const FVector VertexPosition = (VertexPositionInCube + FVector(X, Y, Z)) * Step - FVector(0.5f);
 		
 		TVertex Vertex;
@@ -204,7 +213,8 @@ FORCEINLINE void AddFace(
 			}
 			else if (Mesher.Settings.UVConfig == EVoxelUVConfig::PackWorldUpInUVs)
 			{
-				TextureCoordinate = FVoxelMesherUtilities::GetUVs(Mesher, FVector(X, Y, Z));
+				// Use the voxel at the corner of the face
+				TextureCoordinate = FVoxelMesherUtilities::GetUVs(Mesher, FVector(X, Y, Z) + Positions[Index] * FVector(Size - FIntVector(1)));
 			}
 			else
 			{
@@ -250,6 +260,62 @@ FORCEINLINE void AddFace(
 	Indices.Add(PositionsIndices[0]);
 }
 
+// Greedily merges the faces of a Size * Size grid into maximal rectangles of faces with the same material
+// Lambda(Material, X, Y, SizeX, SizeY) is called for each rectangle. Faces is emptied.
+template<typename T>
+void GreedyMergeFaces(int32 Size, TArray<TOptional<FVoxelMaterial>>& Faces, T Lambda)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(Faces.Num() == Size * Size);
+	
+	for (int32 Y = 0; Y < Size; Y++)
+	{
+		for (int32 X = 0; X < Size; X++)
+		{
+			const TOptional<FVoxelMaterial> Face = Faces[X + Y * Size];
+			if (!Face.IsSet())
+			{
+				continue;
+			}
+
+			int32 SizeX = 1;
+			while (X + SizeX < Size && Faces[X + SizeX + Y * Size] == Face)
+			{
+				SizeX++;
+			}
+
+			int32 SizeY = 1;
+			while (Y + SizeY < Size)
+			{
+				bool bCanGrow = true;
+				for (int32 Index = X; Index < X + SizeX; Index++)
+				{
+					if (Faces[Index + (Y + SizeY) * Size] != Face)
+					{
+						bCanGrow = false;
+						break;
+					}
+				}
+				if (!bCanGrow)
+				{
+					break;
+				}
+				SizeY++;
+			}
+
+			for (int32 LY = Y; LY < Y + SizeY; LY++)
+			{
+				for (int32 LX = X; LX < X + SizeX; LX++)
+				{
+					Faces[LX + LY * Size].Reset();
+				}
+			}
+
+			Lambda(Face.GetValue(), X, Y, SizeX, SizeY);
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -302,6 +368,12 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 	TVoxelQueryZone<FVoxelValue> QueryZone(GetBoundsToCheckIsEmptyOn(), FIntVector(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS), LOD, CachedValues);
 	MESHER_TIME_VALUES(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS, Data.Get<FVoxelValue>(QueryZone, LOD));
 	
+	if (CVarGreedyCubicMeshing.GetValueOnAnyThread() != 0)
+	{
+		CreateGreedyGeometry(Times, Indices, Vertices);
+		return;
+	}
+	
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Iteration");
 		for (int32 X = 0; X < RENDER_CHUNK_SIZE; X++)
@@ -347,6 +419,128 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 	}
 }
 
+template<typename T>
+void FVoxelCubicMesher::CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	constexpr int32 Size = RENDER_CHUNK_SIZE;
+	const auto GetIndex = [&](const FIntVector& Position)
+	{
+		return Position.X + Position.Y * Size + Position.Z * Size * Size;
+	};
+	
+	// First find all the faces & their materials
+	TArray<uint8> FaceFlags;
+	TArray<FVoxelMaterial> Materials;
+	FaceFlags.SetNumZeroed(Size * Size * Size);
+	if (T::bComputeMaterial)
+	{
+		Materials.SetNumUninitialized(Size * Size * Size);
+	}
+	
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Iteration");
+		for (int32 Z = 0; Z < Size; Z++)
+		{
+			for (int32 Y = 0; Y < Size; Y++)
+			{
+				for (int32 X = 0; X < Size; X++)
+				{
+					const FVoxelValue Value = GetValue(X, Y, Z);
+					if (Value.IsEmpty()) continue;
+
+					const uint8 Flag =
+						(GetValue(X - 1, Y, Z).IsEmpty() << 0) |
+						(GetValue(X + 1, Y, Z).IsEmpty() << 1) |
+						(GetValue(X, Y - 1, Z).IsEmpty() << 2) |
+						(GetValue(X, Y + 1, Z).IsEmpty() << 3) |
+						(GetValue(X, Y, Z - 1).IsEmpty() << 4) |
+						(GetValue(X, Y, Z + 1).IsEmpty() << 5);
+
+					if (!Flag) continue;
+
+					const int32 Index = GetIndex(FIntVector(X, Y, Z));
+					FaceFlags[Index] = Flag;
+					
+					if (T::bComputeMaterial)
+					{
+						Materials[Index] = MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(
+							X + ChunkPosition.X,
+							Y + ChunkPosition.Y,
+							Z + ChunkPosition.Z,
+							LOD));
+					}
+				}
+			}
+		}
+	}
+
+	// Then merge them slice by slice
+	TArray<TOptional<FVoxelMaterial>> SliceFaces;
+	SliceFaces.SetNum(Size * Size);
+	
+	const auto MergeFaces = [&](auto Direction)
+	{
+		constexpr EVoxelDirectionFlag::Type StaticDirection = decltype(Direction)::Value;
+		constexpr int32 NormalAxis =
+			StaticDirection == EVoxelDirectionFlag::XMin || StaticDirection == EVoxelDirectionFlag::XMax
+			? 0
+			: StaticDirection == EVoxelDirectionFlag::YMin || StaticDirection == EVoxelDirectionFlag::YMax
+			? 1
+			: 2;
+		constexpr int32 AxisU = NormalAxis == 0 ? 1 : 0;
+		constexpr int32 AxisV = NormalAxis == 2 ? 1 : 2;
+
+		for (int32 Slice = 0; Slice < Size; Slice++)
+		{
+			bool bHasFaces = false;
+			for (int32 V = 0; V < Size; V++)
+			{
+				for (int32 U = 0; U < Size; U++)
+				{
+					FIntVector Position;
+					Position[NormalAxis] = Slice;
+					Position[AxisU] = U;
+					Position[AxisV] = V;
+
+					const int32 Index = GetIndex(Position);
+					if (FaceFlags[Index] & StaticDirection)
+					{
+						SliceFaces[U + V * Size] = T::bComputeMaterial ? Materials[Index] : FVoxelMaterial(ForceInit);
+						bHasFaces = true;
+					}
+				}
+			}
+			if (!bHasFaces)
+			{
+				continue;
+			}
+
+			GreedyMergeFaces(Size, SliceFaces, [&](const FVoxelMaterial& Material, int32 U, int32 V, int32 SizeU, int32 SizeV)
+			{
+				FIntVector Position;
+				Position[NormalAxis] = Slice;
+				Position[AxisU] = U;
+				Position[AxisV] = V;
+
+				FIntVector FaceSize(1);
+				FaceSize[AxisU] = SizeU;
+				FaceSize[AxisV] = SizeV;
+
+				AddFace<StaticDirection>(*this, Step, Material, Position.X, Position.Y, Position.Z, Indices, Vertices, FaceSize);
+			});
+		}
+	};
+
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::XMin>());
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::XMax>());
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::YMin>());
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::YMax>());
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::ZMin>());
+	MergeFaces(TIntegralConstant<EVoxelDirectionFlag::Type, EVoxelDirectionFlag::ZMax>());
+}
+
 FORCEINLINE FVoxelValue FVoxelCubicMesher::GetValue(int32 X, int32 Y, int32 Z) const
 {
 	checkVoxelSlow(
@@ -430,6 +624,16 @@ void FVoxelCubicTransitionsMesher::CreateTransitionsForDirection(FVoxelMesherTim
 {
 	if (!(TransitionsMask & Direction)) return;
 
+	// When merging faces, they are first stored in these grids
+	const bool bGreedy = CVarGreedyCubicMeshing.GetValueOnAnyThread() != 0;
+	TArray<TOptional<FVoxelMaterial>> BigFaces;
+	TArray<TOptional<FVoxelMaterial>> SmallFaces;
+	if (bGreedy)
+	{
+		BigFaces.SetNum(RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE);
+		SmallFaces.SetNum(4 * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE);
+	}
+
 	for (int32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
 	{
 		for (int32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
@@ -478,7 +682,14 @@ void FVoxelCubicTransitionsMesher::CreateTransitionsForDirection(FVoxelMesherTim
 				constexpr EVoxelDirectionFlag::Type FaceDirection = Direction;
 				
 				const auto Material = MESHER_TIME_RETURN_MATERIALS(1, GetMaterial<Direction>(Step, LX * Step, LY * Step, 0));
-				Add2DFace<Direction, FaceDirection>(Step, Material, LX, LY, Vertices, Indices);
+				if (bGreedy)
+				{
+					BigFaces[LX + LY * RENDER_CHUNK_SIZE] = Material;
+				}
+				else
+				{
+					Add2DFace<Direction, FaceDirection>(Step, Material, LX, LY, 1, 1, Vertices, Indices);
+				}
 			}
 			else
 			{
@@ -526,25 +737,48 @@ void FVoxelCubicTransitionsMesher::CreateTransitionsForDirection(FVoxelMesherTim
 				constexpr EVoxelDirectionFlag::Type FaceDirection = InverseVoxelDirection<Direction>();
 				
 				const auto Material = MESHER_TIME_RETURN_MATERIALS(1, GetMaterial<Direction>(Step, LX * Step, LY * Step, -HalfStep));
+				const auto AddSmallFace = [&](int32 SmallX, int32 SmallY)
+				{
+					if (bGreedy)
+					{
+						SmallFaces[SmallX + SmallY * 2 * RENDER_CHUNK_SIZE] = Material;
+					}
+					else
+					{
+						Add2DFace<Direction, FaceDirection>(HalfStep, Material, SmallX, SmallY, 1, 1, Vertices, Indices);
+					}
+				};
 				if (AreBothFull & 0x1)
 				{
-					Add2DFace<Direction, FaceDirection>(HalfStep, Material, 2 * LX + 0, 2 * LY + 0, Vertices, Indices);
+					AddSmallFace(2 * LX + 0, 2 * LY + 0);
 				}
 				if (AreBothFull & 0x2)
 				{
-					Add2DFace<Direction, FaceDirection>(HalfStep, Material, 2 * LX + 1, 2 * LY + 0, Vertices, Indices);
+					AddSmallFace(2 * LX + 1, 2 * LY + 0);
 				}
 				if (AreBothFull & 0x4)
 				{
-					Add2DFace<Direction, FaceDirection>(HalfStep, Material, 2 * LX + 0, 2 * LY + 1, Vertices, Indices);
+					AddSmallFace(2 * LX + 0, 2 * LY + 1);
 				}
 				if (AreBothFull & 0x8)
 				{
-					Add2DFace<Direction, FaceDirection>(HalfStep, Material, 2 * LX + 1, 2 * LY + 1, Vertices, Indices);
+					AddSmallFace(2 * LX + 1, 2 * LY + 1);
 				}
 			}
 		}
 	}
+
+	if (bGreedy)
+	{
+		GreedyMergeFaces(RENDER_CHUNK_SIZE, BigFaces, [&](const FVoxelMaterial& Material, int32 LX, int32 LY, int32 SizeX, int32 SizeY)
+		{
+			Add2DFace<Direction, Direction>(Step, Material, LX, LY, SizeX, SizeY, Vertices, Indices);
+		});
+		GreedyMergeFaces(2 * RENDER_CHUNK_SIZE, SmallFaces, [&](const FVoxelMaterial& Material, int32 LX, int32 LY, int32 SizeX, int32 SizeY)
+		{
+			Add2DFace<Direction, InverseVoxelDirection<Direction>()>(HalfStep, Material, LX, LY, SizeX, SizeY, Vertices, Indices);
+		});
+	}
 }
 
 template<EVoxelDirectionFlag::Type Direction>
@@ -572,6 +806,7 @@ void FVoxelCubicTransitionsMesher::Add2DFace(
 	int32 InStep, 
 	const FVoxelMaterial& Material, 
 	int32 LX, int32 LY, 
+	int32 SizeX, int32 SizeY,
 	TArray<TVertex>& Vertices, TArray<uint32>& Indices)
 {
 	const int32 LZ = IsDirectionMax<FaceDirection>()
@@ -579,7 +814,9 @@ void FVoxelCubicTransitionsMesher::Add2DFace(
 		: 0;
 
 	const FIntVector P = Local2DToGlobal<Direction>(Step / InStep * RENDER_CHUNK_SIZE, LX, LY, LZ);
-	AddFace<FaceDirection>(*this, InStep, Material, P.X, P.Y, P.Z, Indices, Vertices);
+	// Only LZ is flipped by Local2DToGlobal: the size along the normal is 0 here, and must be 1
+	const FIntVector Size = FVoxelUtilities::ComponentMax(Local2DToGlobal<Direction>(0, SizeX, SizeY, 0), FIntVector(1));
+	AddFace<FaceDirection>(*this, InStep, Material, P.X, P.Y, P.Z, Indices, Vertices, Size);
 }
 
 template<EVoxelDirectionFlag::Type Direction>
@@ -28,6 +28,9 @@ private:
 private:
 	template<typename T>
 	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
+	// Merges coplanar faces with the same material. Requires CachedValues to be set
+	template<typename T>
+	void CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
 
 private:
 	FVoxelValue GetValue(int32 X, int32 Y, int32 Z) const;
@@ -57,11 +60,13 @@ private:
 	FVoxelMaterial GetMaterial(int32 InStep, int32 X, int32 Y, int32 Z) const;
 
 	// LX * HalfStep = GX
+	// SizeX, SizeY: number of InStep voxels covered by the face
 	template<EVoxelDirectionFlag::Type Direction, EVoxelDirectionFlag::Type FaceDirection, typename TVertex>
 	void Add2DFace(
 		int32 InStep, 
 		const FVoxelMaterial& Material, 
 		int32 LX, int32 LY, 
+		int32 SizeX, int32 SizeY,
 		TArray<TVertex>& Vertices, TArray<uint32>& Indices);
 	
 	template<EVoxelDirectionFlag::Type Direction>
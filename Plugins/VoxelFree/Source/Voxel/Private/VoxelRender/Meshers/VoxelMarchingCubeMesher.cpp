@@ -21,6 +21,19 @@ static TAutoConsoleVariable<int32> CVarRandomizeTangents(
 	TEXT("If true, will randomize voxel tangents to help debug materials that should not be using them"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarGridGradientNormals(
+	TEXT("voxel.mesher.GridGradientNormals"),
+	0,
+	TEXT("If true, LOD > 0 marching cubes gradient normals will be interpolated from gradients computed on the chunk grid, instead of querying 6 values per vertex. ")
+	TEXT("Much faster as each grid value is shared between many vertices, but normals will be slightly smoother"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBatchedMaterials(
+	TEXT("voxel.mesher.BatchedMaterials"),
+	1,
+	TEXT("If true, marching cubes will fetch the materials of the vertices on the chunk grid with a single query over the active cells, instead of one accelerator query per vertex"),
+	ECVF_Default);
+
 class FMarchingCubeHelpers
 {
 public:
@@ -40,21 +53,123 @@ public:
 		return MesherVertices;
 	}
 	
+	// Gathers the material positions of all the vertices, and fetches each distinct position once
+	// Positions on the chunk grid are fetched with a single query zone, the other ones through the accelerator
+	template<typename TMesher>
+	class TMaterialCache
+	{
+	public:
+		explicit TMaterialCache(TMesher& Mesher)
+			: Mesher(Mesher)
+		{
+			GridIndices.SetNumUninitialized(GridSize * GridSize * GridSize);
+			FMemory::Memset(GridIndices.GetData(), 0xFF, GridIndices.Num() * GridIndices.GetTypeSize());
+		}
+
+		int32 Add(const FIntVector& Position)
+		{
+			const FIntVector GridPosition = Position / Mesher.Step;
+			if (GridPosition * Mesher.Step != Position ||
+				GridPosition.GetMin() < 0 ||
+				GridPosition.GetMax() >= GridSize)
+			{
+				return Positions.Add({ Position, false });
+			}
+
+			int32& Index = GridIndices[GridPosition.X + GridPosition.Y * GridSize + GridPosition.Z * GridSize * GridSize];
+			if (Index == -1)
+			{
+				Index = Positions.Add({ Position, true });
+				GridMin = FVoxelUtilities::ComponentMin(GridMin, GridPosition);
+				GridMax = FVoxelUtilities::ComponentMax(GridMax, GridPosition);
+				NumGridPositions++;
+			}
+			return Index;
+		}
+
+		void Fetch()
+		{
+			VOXEL_ASYNC_FUNCTION_COUNTER();
+			
+			Materials.SetNumUninitialized(Positions.Num());
+
+			const FIntVector BlockSize = GridMax - GridMin + 1;
+			const int64 BlockCount = int64(BlockSize.X) * BlockSize.Y * BlockSize.Z;
+			
+			// Only query the bounds of the active cells, and only if they are dense enough:
+			// a sparse surface in a big box is cheaper through the accelerator
+			TArray<FVoxelMaterial> BlockMaterials;
+			if (!Mesher.bIsTransitions &&
+				NumGridPositions > 0 &&
+				CVarBatchedMaterials.GetValueOnAnyThread() != 0 &&
+				BlockCount <= int64(NumGridPositions) * MaxBlockCountPerPosition)
+			{
+				const FVoxelIntBox Bounds(
+					Mesher.ChunkPosition + GridMin * Mesher.Step,
+					Mesher.ChunkPosition + (GridMax + 1) * Mesher.Step);
+
+				BlockMaterials.SetNumUninitialized(BlockCount);
+				TVoxelQueryZone<FVoxelMaterial> QueryZone(Bounds, BlockSize, Mesher.LOD, BlockMaterials);
+				Mesher.Data.template Get<FVoxelMaterial>(QueryZone, Mesher.LOD);
+			}
+
+			for (int32 Index = 0; Index < Positions.Num(); Index++)
+			{
+				const FPosition& Position = Positions[Index];
+				if (BlockMaterials.Num() > 0 && Position.bOnGrid)
+				{
+					const FIntVector BlockPosition = Position.Position / Mesher.Step - GridMin;
+					Materials[Index] = BlockMaterials[BlockPosition.X + BlockPosition.Y * BlockSize.X + BlockPosition.Z * BlockSize.X * BlockSize.Y];
+				}
+				else
+				{
+					Materials[Index] = Mesher.Accelerator->GetMaterial(Position.Position + Mesher.ChunkPosition, Mesher.LOD);
+				}
+			}
+		}
+
+		FORCEINLINE const FVoxelMaterial& Get(int32 Index) const
+		{
+			return Materials[Index];
+		}
+
+	private:
+		static constexpr int32 GridSize = CHUNK_SIZE_WITH_END_EDGE;
+		static constexpr int32 MaxBlockCountPerPosition = 8;
+
+		struct FPosition
+		{
+			FIntVector Position;
+			bool bOnGrid;
+		};
+
+		TMesher& Mesher;
+		TArray<int32> GridIndices;
+		TArray<FPosition> Positions;
+		TArray<FVoxelMaterial> Materials;
+
+		FIntVector GridMin = FIntVector(MAX_int32);
+		FIntVector GridMax = FIntVector(MIN_int32);
+		int32 NumGridPositions = 0;
+	};
+	
 	template<typename T, typename TMesher>
 	static void ComputeMaterials(TMesher& Mesher, TArray<FVoxelMesherVertex>& MesherVertices, TArray<T>& Vertices)
 	{
 		VOXEL_ASYNC_FUNCTION_COUNTER();
 	
-		const auto GetMaterial = [&](const FIntVector& P)
-		{
-			return Mesher.Accelerator->GetMaterial(
-				P.X + Mesher.ChunkPosition.X,
-				P.Y + Mesher.ChunkPosition.Y, 
-				P.Z + Mesher.ChunkPosition.Z, 
-				Mesher.LOD);
-		};
+		TMaterialCache<TMesher> Cache(Mesher);
 		if (Mesher.Settings.bInterpolateColors || Mesher.Settings.bInterpolateUVs)
 		{
+			TArray<TPair<int32, int32>> MaterialIndices;
+			MaterialIndices.SetNumUninitialized(Vertices.Num());
+			for (int32 Index = 0; Index < Vertices.Num(); Index++)
+			{
+				MaterialIndices[Index].Key = Cache.Add(FVoxelUtilities::FloorToInt(MesherVertices[Index].Position));
+				MaterialIndices[Index].Value = Cache.Add(FVoxelUtilities::CeilToInt(MesherVertices[Index].Position));
+			}
+			Cache.Fetch();
+			
 			for (int32 Index = 0; Index < Vertices.Num(); Index++)
 			{
 				auto& Vertex = Vertices[Index];
@@ -63,8 +178,8 @@ public:
 				const auto PositionA = FVoxelUtilities::FloorToInt(MesherVertex.Position);
 				const auto PositionB = FVoxelUtilities::CeilToInt(MesherVertex.Position);
 
-				const auto MaterialA = GetMaterial(PositionA);
-				const auto MaterialB = GetMaterial(PositionB);
+				const FVoxelMaterial& MaterialA = Cache.Get(MaterialIndices[Index].Key);
+				const FVoxelMaterial& MaterialB = Cache.Get(MaterialIndices[Index].Value);
 				
 				ensureVoxelSlowNoSideEffects(Vertex.MaterialPosition == PositionA || Vertex.MaterialPosition == PositionB);
 				MesherVertex.Material = Vertex.MaterialPosition == PositionA ? MaterialA : MaterialB;
@@ -113,12 +228,17 @@ public:
 		}
 		else
 		{
+			TArray<int32> MaterialIndices;
+			MaterialIndices.SetNumUninitialized(Vertices.Num());
 			for (int32 Index = 0; Index < Vertices.Num(); Index++)
 			{
-				auto& Vertex = Vertices[Index];
-				auto& MesherVertex = MesherVertices[Index];
-
-				MesherVertex.Material = GetMaterial(Vertex.MaterialPosition);
+				MaterialIndices[Index] = Cache.Add(Vertices[Index].MaterialPosition);
+			}
+			Cache.Fetch();
+			
+			for (int32 Index = 0; Index < Vertices.Num(); Index++)
+			{
+				MesherVertices[Index].Material = Cache.Get(MaterialIndices[Index]);
 			}
 		}
 	}
@@ -164,8 +284,88 @@ public:
 	{
 		VOXEL_ASYNC_FUNCTION_COUNTER();
 
+		// Float values on the chunk grid, padded by 1 on each side for the central differences
+		// Computed lazily, as only the values around the surface are needed
+		constexpr int32 GridSize = CHUNK_SIZE_WITH_NORMALS;
+		enum class EGridValueState : uint8
+		{
+			NotComputed,
+			Generator,
+			Edited
+		};
+		
+		const bool bUseGridGradients = Mesher.LOD > 0 && CVarGridGradientNormals.GetValueOnAnyThread() != 0;
+		TArray<float> GridValues;
+		TArray<EGridValueState> GridValueStates;
+		if (bUseGridGradients)
+		{
+			GridValues.SetNumUninitialized(GridSize * GridSize * GridSize);
+			GridValueStates.SetNumZeroed(GridSize * GridSize * GridSize);
+		}
+
+		const auto GetGridValue = [&](int32 X, int32 Y, int32 Z, bool& bIsGeneratorValue)
+		{
+			checkVoxelSlow(-1 <= X && X < GridSize - 1);
+			checkVoxelSlow(-1 <= Y && Y < GridSize - 1);
+			checkVoxelSlow(-1 <= Z && Z < GridSize - 1);
+			const int32 Index = (X + 1) + (Y + 1) * GridSize + (Z + 1) * GridSize * GridSize;
+
+			EGridValueState& State = GridValueStates[Index];
+			if (State == EGridValueState::NotComputed)
+			{
+				bool bIsGenerator = true;
+				GridValues[Index] = Mesher.Accelerator->GetFloatValue(
+					Mesher.ChunkPosition.X + X * Mesher.Step,
+					Mesher.ChunkPosition.Y + Y * Mesher.Step,
+					Mesher.ChunkPosition.Z + Z * Mesher.Step,
+					Mesher.LOD,
+					&bIsGenerator);
+				State = bIsGenerator ? EGridValueState::Generator : EGridValueState::Edited;
+			}
+			
+			bIsGeneratorValue &= State == EGridValueState::Generator;
+			return GridValues[Index];
+		};
+		const auto GetGridGradient = [&](int32 X, int32 Y, int32 Z, bool& bIsGeneratorValue)
+		{
+			return FVector(
+				GetGridValue(X + 1, Y, Z, bIsGeneratorValue) - GetGridValue(X - 1, Y, Z, bIsGeneratorValue),
+				GetGridValue(X, Y + 1, Z, bIsGeneratorValue) - GetGridValue(X, Y - 1, Z, bIsGeneratorValue),
+				GetGridValue(X, Y, Z + 1, bIsGeneratorValue) - GetGridValue(X, Y, Z - 1, bIsGeneratorValue));
+		};
+
 		const auto GetGradient = [&](const FVector& Position)
 		{
+			if (bUseGridGradients)
+			{
+				const FVector GridPosition = Position / Mesher.Step;
+				const FIntVector Min(
+					FMath::Clamp(FMath::FloorToInt(GridPosition.X), 0, RENDER_CHUNK_SIZE - 1),
+					FMath::Clamp(FMath::FloorToInt(GridPosition.Y), 0, RENDER_CHUNK_SIZE - 1),
+					FMath::Clamp(FMath::FloorToInt(GridPosition.Z), 0, RENDER_CHUNK_SIZE - 1));
+				const FVector Alpha = GridPosition - FVector(Min);
+
+				bool bIsGeneratorValue = true;
+				const FVector Gradient = FVoxelUtilities::TrilinearInterpolation(
+					GetGridGradient(Min.X + 0, Min.Y + 0, Min.Z + 0, bIsGeneratorValue),
+					GetGridGradient(Min.X + 1, Min.Y + 0, Min.Z + 0, bIsGeneratorValue),
+					GetGridGradient(Min.X + 0, Min.Y + 1, Min.Z + 0, bIsGeneratorValue),
+					GetGridGradient(Min.X + 1, Min.Y + 1, Min.Z + 0, bIsGeneratorValue),
+					GetGridGradient(Min.X + 0, Min.Y + 0, Min.Z + 1, bIsGeneratorValue),
+					GetGridGradient(Min.X + 1, Min.Y + 0, Min.Z + 1, bIsGeneratorValue),
+					GetGridGradient(Min.X + 0, Min.Y + 1, Min.Z + 1, bIsGeneratorValue),
+					GetGridGradient(Min.X + 1, Min.Y + 1, Min.Z + 1, bIsGeneratorValue),
+					Alpha.X,
+					Alpha.Y,
+					Alpha.Z);
+
+				if (bIsGeneratorValue)
+				{
+					return Gradient.GetSafeNormal();
+				}
+				// Edited values are FVoxelValues: use the same fallback as GetGradientFromGetFloatValue
+			}
+			
 			if (Mesher.LOD == 0)
 			{
 				// For LOD 0, we used the cached data
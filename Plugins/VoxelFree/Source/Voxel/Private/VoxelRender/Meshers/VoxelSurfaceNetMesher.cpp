@@ -162,28 +162,10 @@ void FVoxelSurfaceNetMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TA
 	};
 	constexpr uint32 EdgeFirstCornerIndex[12] = { 0, 2, 4, 6, 0, 1, 4, 5, 0, 1, 2, 3 };
 	constexpr uint32 EdgeSecondCornerIndex[12] = { 1, 3, 5, 7, 2, 3, 6, 7, 4, 5, 6, 7 };
-	// TODO: Replace buffer by simple math
-	const FVector Corners[8] =
+	// Corner Index has its X offset in bit 0, Y in bit 1 and Z in bit 2
+	const auto GetCorner = [](uint32 Index)
 	{
-		{0,0,0},
-		{1,0,0},
-		{0,1,0},
-		{1,1,0},
-		{0,0,1},
-		{1,0,1},
-		{0,1,1},
-		{1,1,1}
-	};
-	const FVector ParentCorners[8] =
-	{
-		{0,0,0},
-		{2,0,0},
-		{0,2,0},
-		{2,2,0},
-		{0,0,2},
-		{2,0,2},
-		{0,2,2},
-		{2,2,2}
+		return FVector((Index >> 0) & 0x1, (Index >> 1) & 0x1, (Index >> 2) & 0x1);
 	};
 	constexpr uint32 Offsets[3] = { 1, SN_EXTENDED_CHUNK_SIZE, SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE };
 	const FIntVector icorners[3] = { {1,0,0},{0,1,0},{0,0,1} };
@@ -312,234 +294,229 @@ void FVoxelSurfaceNetMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TA
 		}
 	}
 
+	// Only two slices of vertex indices are kept: quads of the cells of a slice are generated as soon as the vertices of the next one are
+	const auto GetVertexIndex = [&](uint32 LX, uint32 LY, uint32 LZ) -> uint32&
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Generate Vertices");
-
-		// generate the vertices and store the indices for the next step
-		for (uint32 LZ = 0; LZ < SN_CHUNK_SIZE; LZ++)
+		checkVoxelSlow(LX < SN_CHUNK_SIZE && LY < SN_CHUNK_SIZE);
+		return VertexIndices[LX + LY * SN_CHUNK_SIZE + (LZ & 0x1) * SN_CHUNK_SIZE * SN_CHUNK_SIZE];
+	};
+	const auto GetVertexSNCase = [&](uint32 LX, uint32 LY, uint32 LZ) -> uint8&
+	{
+		checkVoxelSlow(LX < SN_CHUNK_SIZE && LY < SN_CHUNK_SIZE);
+		return VertexSNCases[LX + LY * SN_CHUNK_SIZE + (LZ & 0x1) * SN_CHUNK_SIZE * SN_CHUNK_SIZE];
+	};
+	
+	const auto GenerateVerticesSlice = [&](uint32 LZ)
+	{
+		for (uint32 LY = 0; LY < SN_CHUNK_SIZE; LY++)
 		{
-			for (uint32 LY = 0; LY < SN_CHUNK_SIZE; LY++)
+			for (uint32 LX = 0; LX < SN_CHUNK_SIZE; LX++)
 			{
-				for (uint32 LX = 0; LX < SN_CHUNK_SIZE; LX++)
+				const uint32 VoxelIndex = LX + LY * SN_EXTENDED_CHUNK_SIZE + LZ * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
+
+				FVoxelValue VoxelValues[8];
+				VoxelValues[0] = CachedValues[VoxelIndex];
+				VoxelValues[1] = CachedValues[VoxelIndex + 1];
+				VoxelValues[2] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE];
+				VoxelValues[3] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE + 1];
+				VoxelValues[4] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE];
+				VoxelValues[5] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE + 1];
+				VoxelValues[6] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE];
+				VoxelValues[7] = CachedValues[VoxelIndex + SN_EXTENDED_CHUNK_SIZE + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE + 1];
+
+				// Branchless: IsEmpty is a sign test
+				const uint32 MarchingCubesCase =
+					(VoxelValues[0].IsEmpty() << 0) |
+					(VoxelValues[1].IsEmpty() << 1) |
+					(VoxelValues[2].IsEmpty() << 2) |
+					(VoxelValues[3].IsEmpty() << 3) |
+					(VoxelValues[4].IsEmpty() << 4) |
+					(VoxelValues[5].IsEmpty() << 5) |
+					(VoxelValues[6].IsEmpty() << 6) |
+					(VoxelValues[7].IsEmpty() << 7);
+
+				// Corners 3, 5, 6 and 7
+				GetVertexSNCase(LX, LY, LZ) =
+					((MarchingCubesCase >> 3) & 0x1) |
+					((MarchingCubesCase >> 4) & 0xE);
+
+				if ((MarchingCubesCase == 0) || (MarchingCubesCase == 255)) //cell is empty
 				{
-					const uint32 VoxelIndex = LX + LY * SN_EXTENDED_CHUNK_SIZE + LZ * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
-					const uint32 VertexIndex = LX + LY * SN_CHUNK_SIZE + LZ * SN_CHUNK_SIZE * SN_CHUNK_SIZE;
-
-					uint32 VoxelIndices[8];
-					VoxelIndices[0] = VoxelIndex;
-					VoxelIndices[1] = VoxelIndex + 1;
-					VoxelIndices[2] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE;
-					VoxelIndices[3] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE + 1;
-					VoxelIndices[4] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
-					VoxelIndices[5] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE + 1;
-					VoxelIndices[6] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
-					VoxelIndices[7] = VoxelIndex + SN_EXTENDED_CHUNK_SIZE + SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE + 1;
-
-					FVoxelValue VoxelValues[8];
-					VoxelValues[0] = CachedValues[VoxelIndices[0]];
-					VoxelValues[1] = CachedValues[VoxelIndices[1]];
-					VoxelValues[2] = CachedValues[VoxelIndices[2]];
-					VoxelValues[3] = CachedValues[VoxelIndices[3]];
-					VoxelValues[4] = CachedValues[VoxelIndices[4]];
-					VoxelValues[5] = CachedValues[VoxelIndices[5]];
-					VoxelValues[6] = CachedValues[VoxelIndices[6]];
-					VoxelValues[7] = CachedValues[VoxelIndices[7]];
-
-					float VoxelFloats[8];
-					VoxelFloats[0] = VoxelValues[0].ToFloat();
-					VoxelFloats[1] = VoxelValues[1].ToFloat();
-					VoxelFloats[2] = VoxelValues[2].ToFloat();
-					VoxelFloats[3] = VoxelValues[3].ToFloat();
-					VoxelFloats[4] = VoxelValues[4].ToFloat();
-					VoxelFloats[5] = VoxelValues[5].ToFloat();
-					VoxelFloats[6] = VoxelValues[6].ToFloat();
-					VoxelFloats[7] = VoxelValues[7].ToFloat();
-
-					const uint32 MarchingCubesCase =
-						(VoxelValues[0].IsEmpty() << 0) |
-						(VoxelValues[1].IsEmpty() << 1) |
-						(VoxelValues[2].IsEmpty() << 2) |
-						(VoxelValues[3].IsEmpty() << 3) |
-						(VoxelValues[4].IsEmpty() << 4) |
-						(VoxelValues[5].IsEmpty() << 5) |
-						(VoxelValues[6].IsEmpty() << 6) |
-						(VoxelValues[7].IsEmpty() << 7);
-
-					const uint8 SurfaceNetsCase =
-						(VoxelValues[3].IsEmpty() << 0) |
-						(VoxelValues[5].IsEmpty() << 1) |
-						(VoxelValues[6].IsEmpty() << 2) |
-						(VoxelValues[7].IsEmpty() << 3);
-
-					VertexSNCases[VertexIndex] = SurfaceNetsCase;
-
-					if ((MarchingCubesCase == 0) || (MarchingCubesCase == 255)) //cell is empty
-					{
-						VertexIndices[VertexIndex] = -1;
-						continue;
-					}
-
-					VertexIndices[VertexIndex] = Vertices.Num();
+					GetVertexIndex(LX, LY, LZ) = -1;
+					continue;
+				}
 
+				GetVertexIndex(LX, LY, LZ) = Vertices.Num();
 
-					const uint32 VoxelEdgeIndex = VoxelIndex * 3;
-					FVector CrossingTotal = FVector(0, 0, 0);
-					uint32 CrossingCount = 0;
+				const uint32 VoxelEdgeIndex = VoxelIndex * 3;
+				FVector CrossingTotal = FVector(0, 0, 0);
+				uint32 CrossingCount = 0;
 
-					constexpr int32 RemoveFirstBit = 0xFFFE; // TODO: what if more than 64k vertices
-					const FIntVector ParentPosition((LX & RemoveFirstBit), (LY & RemoveFirstBit), (LZ & RemoveFirstBit));
-					const uint32 ParentVoxelIndex = ParentPosition.X + ParentPosition.Y * SN_EXTENDED_CHUNK_SIZE + ParentPosition.Z * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
-					const uint32 ParentVoxelEdgeIndex = ParentVoxelIndex * 3;
-					FVector ParentCrossingTotal = FVector(0, 0, 0);
-					uint32 ParentCrossingCount = 0;
+				// Parent cells are aligned on even positions
+				const FIntVector ParentPosition(LX & ~1u, LY & ~1u, LZ & ~1u);
+				const uint32 ParentVoxelIndex = ParentPosition.X + ParentPosition.Y * SN_EXTENDED_CHUNK_SIZE + ParentPosition.Z * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE;
+				const uint32 ParentVoxelEdgeIndex = ParentVoxelIndex * 3;
+				FVector ParentCrossingTotal = FVector(0, 0, 0);
+				uint32 ParentCrossingCount = 0;
 
-					for (uint32 Edge = 0; Edge < 12; Edge++)
+				for (uint32 Edge = 0; Edge < 12; Edge++)
+				{
+					const FVector MinCorner = GetCorner(EdgeFirstCornerIndex[Edge]);
+					const FVector MaxCorner = GetCorner(EdgeSecondCornerIndex[Edge]);
+					
+					// if this edge has a crossing, find the point and add it to the avg total, increment count
+					const float EdgeFactor = EdgeFactors[VoxelEdgeIndex + EdgeIndexOffsets[Edge]];
+					if (EdgeFactor >= 0)
 					{
-						// if this edge has a crossing, find the point and add it to the avg total, increment count
-						const float EdgeFactor = EdgeFactors[VoxelEdgeIndex + EdgeIndexOffsets[Edge]];
-						if (EdgeFactor >= 0)
-						{
-							const FVector MinPosition = Corners[EdgeFirstCornerIndex[Edge]];
-							const FVector MaxPosition = Corners[EdgeSecondCornerIndex[Edge]];
-							const FVector MidPosition = FMath::Lerp(MinPosition, MaxPosition, EdgeFactor); // blend between corners
-							CrossingTotal += MidPosition;
-							CrossingCount++;
-						}
+						const FVector MidPosition = FMath::Lerp(MinCorner, MaxCorner, EdgeFactor); // blend between corners
+						CrossingTotal += MidPosition;
+						CrossingCount++;
+					}
 
-						// find crossings of parent cell
-						const float ParentEdgeFactorMin = EdgeFactors[ParentVoxelEdgeIndex + ParentEdgeIndexOffsetsMin[Edge]];
-						const float ParentEdgeFactorMax = EdgeFactors[ParentVoxelEdgeIndex + ParentEdgeIndexOffsetsMax[Edge]];
-						if ((ParentEdgeFactorMin >= 0) || (ParentEdgeFactorMax >= 0))
-						{
-							const float ParentEdgeFactor =
-								((ParentEdgeFactorMin >= 0) ? 0.5f * ParentEdgeFactorMin : 0.5f) +
-								((ParentEdgeFactorMax >= 0) ? 0.5f * ParentEdgeFactorMax : 0);
-							const FVector MinPosition = ParentCorners[EdgeFirstCornerIndex[Edge]];
-							const FVector MaxPosition = ParentCorners[EdgeSecondCornerIndex[Edge]];
-							const FVector MidPosition = FMath::Lerp(MinPosition, MaxPosition, ParentEdgeFactor); // blend between corners
-							ParentCrossingTotal += MidPosition;
-							ParentCrossingCount++;
-						}
+					// find crossings of parent cell
+					const float ParentEdgeFactorMin = EdgeFactors[ParentVoxelEdgeIndex + ParentEdgeIndexOffsetsMin[Edge]];
+					const float ParentEdgeFactorMax = EdgeFactors[ParentVoxelEdgeIndex + ParentEdgeIndexOffsetsMax[Edge]];
+					if ((ParentEdgeFactorMin >= 0) || (ParentEdgeFactorMax >= 0))
+					{
+						const float ParentEdgeFactor =
+							((ParentEdgeFactorMin >= 0) ? 0.5f * ParentEdgeFactorMin : 0.5f) +
+							((ParentEdgeFactorMax >= 0) ? 0.5f * ParentEdgeFactorMax : 0);
+						const FVector MidPosition = FMath::Lerp(2 * MinCorner, 2 * MaxCorner, ParentEdgeFactor); // blend between corners
+						ParentCrossingTotal += MidPosition;
+						ParentCrossingCount++;
 					}
+				}
 
-					ensureVoxelSlowNoSideEffects(CrossingCount > 0);
-					const FVector Offset = CrossingTotal / CrossingCount;
+				ensureVoxelSlowNoSideEffects(CrossingCount > 0);
+				const FVector Offset = CrossingTotal / CrossingCount;
 
-					const FVector ParentOffset = ParentCrossingCount == 0 ? FVector::ZeroVector : ParentCrossingTotal / ParentCrossingCount;
+				const FVector ParentOffset = ParentCrossingCount == 0 ? FVector::ZeroVector : ParentCrossingTotal / ParentCrossingCount;
 
 
-					const FIntVector CellPosition(LX * Step, LY * Step, LZ * Step);
-					const FVector CornerPosition{ CellPosition };
-					const FVector FinalPosition = CornerPosition + Offset * Step;
+				const FIntVector CellPosition(LX * Step, LY * Step, LZ * Step);
+				const FVector CornerPosition{ CellPosition };
+				const FVector FinalPosition = CornerPosition + Offset * Step;
 
-					const FIntVector ParentCellPosition = ParentPosition * Step;
-					const FVector ParentCornerPosition{ ParentCellPosition };
-					const FVector ParentFinalPosition = ParentCornerPosition + ParentOffset * Step;
-					
-					TVertex Vertex;
-					Vertex.SetPosition(FinalPosition);
-					if (TVertex::bComputeParentPosition)
-					{
-						Vertex.SetParentPosition((ParentFinalPosition - FinalPosition) / Step); // Divide by Step to avoid overflowing the tangent
-					}
-					if (TVertex::bComputeNormal)
-					{
-						Vertex.SetNormal(MESHER_TIME_RETURN(Normals, GetNormal(VoxelFloats, Offset)));
-					}
-					if (TVertex::bComputeMaterial)
-					{
-						Vertex.SetMaterial(MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(MaterialPositions[VoxelIndex] * Step + ChunkPosition, LOD)));
-					}
-					if (TVertex::bComputeTextureCoordinate)
+				const FIntVector ParentCellPosition = ParentPosition * Step;
+				const FVector ParentCornerPosition{ ParentCellPosition };
+				const FVector ParentFinalPosition = ParentCornerPosition + ParentOffset * Step;
+				
+				TVertex Vertex;
+				Vertex.SetPosition(FinalPosition);
+				if (TVertex::bComputeParentPosition)
+				{
+					Vertex.SetParentPosition((ParentFinalPosition - FinalPosition) / Step); // Divide by Step to avoid overflowing the tangent
+				}
+				if (TVertex::bComputeNormal)
+				{
+					float VoxelFloats[8];
+					for (int32 Index = 0; Index < 8; Index++)
 					{
-						Vertex.SetTextureCoordinate(MESHER_TIME_RETURN(UVs, FVoxelMesherUtilities::GetUVs(*this, FinalPosition)));
+						VoxelFloats[Index] = VoxelValues[Index].ToFloat();
 					}
-					Vertices.Add(Vertex);
+					Vertex.SetNormal(MESHER_TIME_RETURN(Normals, GetNormal(VoxelFloats, Offset)));
+				}
+				if (TVertex::bComputeMaterial)
+				{
+					Vertex.SetMaterial(MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(MaterialPositions[VoxelIndex] * Step + ChunkPosition, LOD)));
 				}
+				if (TVertex::bComputeTextureCoordinate)
+				{
+					Vertex.SetTextureCoordinate(MESHER_TIME_RETURN(UVs, FVoxelMesherUtilities::GetUVs(*this, FinalPosition)));
+				}
+				Vertices.Add(Vertex);
 			}
 		}
-	}
-
-	UnlockData();
+	};
 
+	// Needs the vertex indices of LZ and LZ + 1
+	const auto GenerateMeshSlice = [&](uint32 LZ)
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Generate Mesh");
-
-		// generate the mesh indices
-		for (uint32 LZ = 0; LZ < RENDER_CHUNK_SIZE; LZ++)
+		checkVoxelSlow(LZ < RENDER_CHUNK_SIZE);
+		
+		for (uint32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
 		{
-			for (uint32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
+			for (uint32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
 			{
-				for (uint32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
+				const uint8 SurfaceNetCase = GetVertexSNCase(LX, LY, LZ);
+
+				// Quad corner Index has its X offset in bit 0, Y in bit 1 and Z in bit 2
+				constexpr uint32 QuadsCorners[8] = { 0, 2, 3, 1, 4, 6, 7, 5 };
+				constexpr uint32 QuadsPositions[6][4] =
 				{
-					const uint32 VoxelIndex = LX + LY * SN_CHUNK_SIZE + LZ * SN_CHUNK_SIZE * SN_CHUNK_SIZE;
-					const uint8 SurfaceNetCase = VertexSNCases[VoxelIndex];
-
-					constexpr uint32 QuadsOffsets[8] = 
-					{ 
-						0, 
-						SN_CHUNK_SIZE, 
-						SN_CHUNK_SIZE + 1, 
-						1, 
-						SN_CHUNK_SIZE * SN_CHUNK_SIZE, 
-						SN_CHUNK_SIZE * SN_CHUNK_SIZE + SN_CHUNK_SIZE,
-						SN_CHUNK_SIZE * SN_CHUNK_SIZE + SN_CHUNK_SIZE + 1,
-						SN_CHUNK_SIZE * SN_CHUNK_SIZE + 1 
-					};
-					constexpr uint32 QuadsPositions[6][4] =
-					{
-						{ 0, 1, 3, 2 },
-						{ 0, 3, 4, 7 },
-						{ 0, 4, 1, 5 },
-						{ 0, 3, 1, 2 },
-						{ 0, 4, 3, 7 },
-						{ 0, 1, 4, 5 }
-					};
-
-					uint32 QuadsIndices[3] = { 0, 0, 0 }; //indexing into quads array
-					uint32 QuadCount = 0;
-
-					switch (SurfaceNetCase) //surface nets polygonization
-					{
-					case  0: QuadCount = 0; break;
-					case  1: QuadCount = 1; QuadsIndices[0] = 0; break;
-					case  2: QuadCount = 1; QuadsIndices[0] = 1; break;
-					case  3: QuadCount = 2; QuadsIndices[0] = 0; QuadsIndices[1] = 1; break;
-					case  4: QuadCount = 1; QuadsIndices[0] = 2; break;
-					case  5: QuadCount = 2; QuadsIndices[0] = 0; QuadsIndices[1] = 2; break;
-					case  6: QuadCount = 2; QuadsIndices[0] = 1; QuadsIndices[1] = 2; break;
-					case  7: QuadCount = 3; QuadsIndices[0] = 0; QuadsIndices[1] = 1; QuadsIndices[2] = 2; break; //^^ forward cases
-					case  8: QuadCount = 3; QuadsIndices[0] = 3; QuadsIndices[1] = 4; QuadsIndices[2] = 5; break; //vv complement cases
-					case  9: QuadCount = 2; QuadsIndices[0] = 4; QuadsIndices[1] = 5; break;
-					case 10: QuadCount = 2; QuadsIndices[0] = 3; QuadsIndices[1] = 5; break;
-					case 11: QuadCount = 1; QuadsIndices[0] = 5; break;
-					case 12: QuadCount = 2; QuadsIndices[0] = 3; QuadsIndices[1] = 4; break;
-					case 13: QuadCount = 1; QuadsIndices[0] = 4; break;
-					case 14: QuadCount = 1; QuadsIndices[0] = 3; break;
-					case 15: QuadCount = 0; break;
-					default: checkVoxelSlow(false);
-					}
+					{ 0, 1, 3, 2 },
+					{ 0, 3, 4, 7 },
+					{ 0, 4, 1, 5 },
+					{ 0, 3, 1, 2 },
+					{ 0, 4, 3, 7 },
+					{ 0, 1, 4, 5 }
+				};
+
+				uint32 QuadsIndices[3] = { 0, 0, 0 }; //indexing into quads array
+				uint32 QuadCount = 0;
+
+				switch (SurfaceNetCase) //surface nets polygonization
+				{
+				case  0: QuadCount = 0; break;
+				case  1: QuadCount = 1; QuadsIndices[0] = 0; break;
+				case  2: QuadCount = 1; QuadsIndices[0] = 1; break;
+				case  3: QuadCount = 2; QuadsIndices[0] = 0; QuadsIndices[1] = 1; break;
+				case  4: QuadCount = 1; QuadsIndices[0] = 2; break;
+				case  5: QuadCount = 2; QuadsIndices[0] = 0; QuadsIndices[1] = 2; break;
+				case  6: QuadCount = 2; QuadsIndices[0] = 1; QuadsIndices[1] = 2; break;
+				case  7: QuadCount = 3; QuadsIndices[0] = 0; QuadsIndices[1] = 1; QuadsIndices[2] = 2; break; //^^ forward cases
+				case  8: QuadCount = 3; QuadsIndices[0] = 3; QuadsIndices[1] = 4; QuadsIndices[2] = 5; break; //vv complement cases
+				case  9: QuadCount = 2; QuadsIndices[0] = 4; QuadsIndices[1] = 5; break;
+				case 10: QuadCount = 2; QuadsIndices[0] = 3; QuadsIndices[1] = 5; break;
+				case 11: QuadCount = 1; QuadsIndices[0] = 5; break;
+				case 12: QuadCount = 2; QuadsIndices[0] = 3; QuadsIndices[1] = 4; break;
+				case 13: QuadCount = 1; QuadsIndices[0] = 4; break;
+				case 14: QuadCount = 1; QuadsIndices[0] = 3; break;
+				case 15: QuadCount = 0; break;
+				default: checkVoxelSlow(false);
+				}
 
-					for (uint32 QuadIndex = 0; QuadIndex < QuadCount; QuadIndex++)
-					{
-						const uint32* Positions = QuadsPositions[QuadsIndices[QuadIndex]];
-						const uint32 Index0 = VertexIndices[VoxelIndex + QuadsOffsets[Positions[0]]];
-						const uint32 Index1 = VertexIndices[VoxelIndex + QuadsOffsets[Positions[1]]];
-						const uint32 Index2 = VertexIndices[VoxelIndex + QuadsOffsets[Positions[2]]];
-						const uint32 Index3 = VertexIndices[VoxelIndex + QuadsOffsets[Positions[3]]];
-
-						Indices.Add(Index0);
-						Indices.Add(Index2);
-						Indices.Add(Index3);
-
-						Indices.Add(Index3);
-						Indices.Add(Index1);
-						Indices.Add(Index0);
-					}
+				const auto GetQuadVertexIndex = [&](uint32 Position)
+				{
+					const uint32 Corner = QuadsCorners[Position];
+					return GetVertexIndex(LX + ((Corner >> 0) & 0x1), LY + ((Corner >> 1) & 0x1), LZ + ((Corner >> 2) & 0x1));
+				};
+
+				for (uint32 QuadIndex = 0; QuadIndex < QuadCount; QuadIndex++)
+				{
+					const uint32* Positions = QuadsPositions[QuadsIndices[QuadIndex]];
+					const uint32 Index0 = GetQuadVertexIndex(Positions[0]);
+					const uint32 Index1 = GetQuadVertexIndex(Positions[1]);
+					const uint32 Index2 = GetQuadVertexIndex(Positions[2]);
+					const uint32 Index3 = GetQuadVertexIndex(Positions[3]);
+					checkVoxelSlow(Index0 != uint32(-1) && Index1 != uint32(-1) && Index2 != uint32(-1) && Index3 != uint32(-1));
+
+					Indices.Add(Index0);
+					Indices.Add(Index2);
+					Indices.Add(Index3);
+
+					Indices.Add(Index3);
+					Indices.Add(Index1);
+					Indices.Add(Index0);
 				}
 			}
 		}
+	};
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Generate Vertices and Mesh");
+
+		for (uint32 LZ = 0; LZ < SN_CHUNK_SIZE; LZ++)
+		{
+			GenerateVerticesSlice(LZ);
+			if (LZ > 0)
+			{
+				GenerateMeshSlice(LZ - 1);
+			}
+		}
 	}
+
+	UnlockData();
 }
 
 TVoxelSharedPtr<FVoxelChunkMesh> FVoxelSurfaceNetMesher::CreateFullChunkImpl(FVoxelMesherTimes& Times)
@@ -30,8 +30,9 @@ private:
 
 	FVoxelValue CachedValues[SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE];
 	float EdgeFactors[SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * 3]; // edge blending factors for each cell, X,Y,Z
-	uint32 VertexIndices[SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE]; // final vertex indices, per voxel. 65535 if no vertex
-	uint8 VertexSNCases[SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE]; // surface net voxel cases for each cell
+	// Two slices rolling along Z
+	uint32 VertexIndices[SN_CHUNK_SIZE * SN_CHUNK_SIZE * 2]; // final vertex indices, per voxel. -1 if no vertex
+	uint8 VertexSNCases[SN_CHUNK_SIZE * SN_CHUNK_SIZE * 2]; // surface net voxel cases for each cell
 
 	// The material position is detected in a first step
 	TVoxelStaticArray<FIntVector, SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE> MaterialPositions;
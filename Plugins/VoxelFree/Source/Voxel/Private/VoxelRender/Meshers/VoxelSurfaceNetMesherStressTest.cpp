@@ -0,0 +1,205 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelRender/Meshers/VoxelSurfaceNetMesher.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelRender/VoxelRenderUtilities.h"
+#include "VoxelGenerators/VoxelEmptyGenerator.h"
+#include "VoxelData/VoxelDataIncludes.h"
+#include "VoxelDebug/VoxelDebugManager.h"
+#include "VoxelDefaultPool.h"
+#include "VoxelWorld.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+// Meshes chunks where every cell has a vertex, and merges them into sections with more than 65536 vertices
+// Checks that the rolling vertex index cache of the surface nets mesher never outputs a stale or out of range index,
+// and that merged sections use 32 bit indices when they need them
+namespace FVoxelSurfaceNetMesherStressTest
+{
+	// Surface nets vertices are within their cell, and quads only join vertices of cells sharing an edge
+	constexpr double MaxEdgeLength = 3.01;
+
+	// Returns the number of errors
+	int32 CheckBuffers(const FVoxelChunkMeshBuffers& Buffers)
+	{
+		int32 NumErrors = 0;
+		for (int32 Index = 0; Index + 2 < Buffers.Indices.Num(); Index += 3)
+		{
+			const uint32 A = Buffers.Indices[Index + 0];
+			const uint32 B = Buffers.Indices[Index + 1];
+			const uint32 C = Buffers.Indices[Index + 2];
+
+			if (A >= uint32(Buffers.Positions.Num()) ||
+				B >= uint32(Buffers.Positions.Num()) ||
+				C >= uint32(Buffers.Positions.Num()))
+			{
+				NumErrors++;
+				continue;
+			}
+			if (A == B || B == C || A == C)
+			{
+				NumErrors++;
+				continue;
+			}
+
+			const FVector& PA = Buffers.Positions[A];
+			const FVector& PB = Buffers.Positions[B];
+			const FVector& PC = Buffers.Positions[C];
+			if (FVector::Distance(PA, PB) > MaxEdgeLength ||
+				FVector::Distance(PB, PC) > MaxEdgeLength ||
+				FVector::Distance(PA, PC) > MaxEdgeLength)
+			{
+				// An index from the wrong slice
+				NumErrors++;
+			}
+		}
+		return NumErrors;
+	}
+
+	bool RunCase(const FVoxelRendererSettings& Settings, FVoxelData& Data, const TCHAR* PatternName, int32 NumChunks, TFunctionRef<bool(int32, int32, int32)> IsFull)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FVoxelIntBox Bounds(FIntVector(0), FIntVector(NumChunks * RENDER_CHUNK_SIZE, RENDER_CHUNK_SIZE, RENDER_CHUNK_SIZE) + 2);
+		{
+			FVoxelWriteScopeLock Lock(Data, Bounds, FUNCTION_FNAME);
+			Data.Set<FVoxelValue>(Bounds, [&](int32 X, int32 Y, int32 Z, FVoxelValue& Value)
+			{
+				Value = IsFull(X, Y, Z) ? FVoxelValue::Full() : FVoxelValue::Empty();
+			});
+		}
+
+		int32 NumErrors = 0;
+		int32 MaxChunkVertices = 0;
+		int64 NumIndices = 0;
+
+		TArray<FVoxelChunkMeshSection> Sections;
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ChunkIndex++)
+		{
+			const FIntVector ChunkPosition(ChunkIndex * RENDER_CHUNK_SIZE, 0, 0);
+
+			const TVoxelSharedPtr<FVoxelChunkMesh> Chunk = MakeUnique<FVoxelSurfaceNetMesher>(0, ChunkPosition, Settings)->CreateFullChunk();
+			if (!Chunk.IsValid() || Chunk->IsEmpty())
+			{
+				NumErrors++;
+				continue;
+			}
+
+			Chunk->IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffers)
+			{
+				MaxChunkVertices = FMath::Max(MaxChunkVertices, Buffers.GetNumVertices());
+				NumIndices += Buffers.Indices.Num();
+				NumErrors += CheckBuffers(Buffers);
+
+				FVoxelChunkMeshSection Section(0, ChunkPosition, false, false, 0);
+				Section.MainChunk = TVoxelSharedPtr<const FVoxelChunkMeshBuffers>(Chunk, &Buffers);
+				Sections.Add(Section);
+			});
+
+			// The collision path uses the same cache
+			FVoxelChunkMeshBuffers Geometry;
+			MakeUnique<FVoxelSurfaceNetMesher>(0, ChunkPosition, Settings)->CreateGeometry(Geometry.Indices, Geometry.Positions);
+			NumErrors += CheckBuffers(Geometry);
+		}
+
+		int32 NumMergedVertices = 0;
+		bool bMerged32Bit = false;
+		if (Sections.Num() > 0)
+		{
+			const TUniquePtr<FVoxelProcMeshBuffers> MergedBuffers = FVoxelRenderUtilities::MergeSections_AnyThread(Settings, Sections, FIntVector(0));
+			if (MergedBuffers.IsValid())
+			{
+				NumMergedVertices = MergedBuffers->GetNumVertices();
+				bMerged32Bit = MergedBuffers->IndexBuffer.Is32Bit();
+
+				const FVoxelRawStaticIndexBuffer& IndexBuffer = MergedBuffers->IndexBuffer;
+				NumErrors += IndexBuffer.GetNumIndices() != NumIndices;
+				NumErrors += NumMergedVertices > 65536 && !bMerged32Bit;
+				for (int32 Index = 0; Index < IndexBuffer.GetNumIndices(); Index++)
+				{
+					NumErrors += IndexBuffer.GetIndex(Index) >= uint32(NumMergedVertices);
+				}
+			}
+			else
+			{
+				NumErrors++;
+			}
+		}
+
+		LOG_VOXEL(Log, TEXT("Surface nets stress test, %s, %d chunks: max %d vertices per chunk, %d merged vertices with %s bit indices. %s"),
+			PatternName,
+			NumChunks,
+			MaxChunkVertices,
+			NumMergedVertices,
+			bMerged32Bit ? TEXT("32") : TEXT("16"),
+			NumErrors > 0 ? *FString::Printf(TEXT("FAILED: %d errors"), NumErrors) : TEXT("OK"));
+
+		return NumErrors == 0;
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+		check(IsInGameThread());
+
+		// 33^3 cells of a checkerboard chunk each have a vertex: 4 chunks are enough to go over 65536 vertices
+		const int32 NumChunks = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 64) : 4;
+
+		AVoxelWorld* VoxelWorld = NewObject<AVoxelWorld>();
+		VoxelWorld->RenderType = EVoxelRenderType::SurfaceNets;
+		VoxelWorld->Generator = UVoxelEmptyGenerator::StaticClass();
+
+		const auto Pool = FVoxelDefaultPool::Create(1, true, {}, {});
+		const auto Data = FVoxelData::Create(FVoxelDataSettings(VoxelWorld, EVoxelPlayType::Game));
+		const auto DebugManager = FVoxelDebugManager::Create(FVoxelDebugManagerSettings(VoxelWorld, EVoxelPlayType::Game, Pool, Data));
+
+		const FVoxelRendererSettings Settings(
+			VoxelWorld,
+			EVoxelPlayType::Game,
+			nullptr,
+			Data,
+			Pool,
+			nullptr,
+			DebugManager,
+			false);
+
+		bool bSuccess = true;
+		bSuccess &= RunCase(Settings, *Data, TEXT("checkerboard"), NumChunks, [](int32 X, int32 Y, int32 Z)
+		{
+			return ((X + Y + Z) & 1) == 0;
+		});
+
+		FRandomStream Stream(0);
+		const FIntVector Size = FIntVector(NumChunks * RENDER_CHUNK_SIZE, RENDER_CHUNK_SIZE, RENDER_CHUNK_SIZE) + 2;
+		TArray<bool> RandomValues;
+		RandomValues.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+		for (bool& Value : RandomValues)
+		{
+			Value = Stream.FRand() < 0.5f;
+		}
+		bSuccess &= RunCase(Settings, *Data, TEXT("random"), NumChunks, [&](int32 X, int32 Y, int32 Z)
+		{
+			return RandomValues[X + Size.X * Y + Size.X * Size.Y * Z];
+		});
+
+		DebugManager->Destroy();
+
+		if (!bSuccess)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.mesher.SurfaceNetsStressTest failed"));
+		}
+	}
+}
+
+// eg: voxel.mesher.SurfaceNetsStressTest 8
+static FAutoConsoleCommand SurfaceNetsStressTestCmd(
+	TEXT("voxel.mesher.SurfaceNetsStressTest"),
+	TEXT("Mesh checkerboard and random chunks with the surface nets mesher, merge them into sections with more than 65536 vertices and check all the indices. Args: [Num chunks = 4]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelSurfaceNetMesherStressTest::Run(Args);
+	}));
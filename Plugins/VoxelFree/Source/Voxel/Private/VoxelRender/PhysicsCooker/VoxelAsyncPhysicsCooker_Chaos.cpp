@@ -53,18 +53,9 @@ void FVoxelAsyncPhysicsCooker_Chaos::CookMesh()
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh()
+template<typename TFill>
+static TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> CreateTriMeshImpl(int32 NumIndices, int32 NumVertices, TFill Fill)
 {
-	VOXEL_ASYNC_FUNCTION_COUNTER();
-				
-	int32 NumIndices = 0;
-	int32 NumVertices = 0;
-	for (auto& Buffer : Buffers)
-	{
-		NumIndices += Buffer->GetNumIndices();
-		NumVertices += Buffer->GetNumVertices();
-	}
-
 	const auto Process = [&](auto& Triangles)
 	{
 		Chaos::TParticles<Chaos::FRealSingle, 3> Particles;
@@ -79,83 +70,125 @@ void FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh()
 				Particles.AddParticles(NumVertices);
 			}
 
-			int32 IndexIndex = 0;
-			int32 VertexIndex = 0;
-			for (int32 SectionIndex = 0; SectionIndex < Buffers.Num(); SectionIndex++)
-			{
-				auto& Buffer = *Buffers[SectionIndex];
-
-				const int32 VertexOffset = VertexIndex;
-
-				{
-					VOXEL_ASYNC_SCOPE_COUNTER("Copy vertices");
-					
-					auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
-					for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
-					{
-						Particles.X(VertexIndex++) = PositionBuffer.VertexPosition(Index);
-					}
-				}
-
-				{
-					VOXEL_ASYNC_SCOPE_COUNTER("Copy triangles");
-					
-					auto& IndexBuffer = Buffer.IndexBuffer;
-
-					ensure(IndexBuffer.GetNumIndices() % 3 == 0);
-					const int32 NumTriangles = IndexBuffer.GetNumIndices() / 3;
-
-					const auto Lambda = [&](const auto* RESTRICT Data)
-					{
-						for (int32 Index = 0; Index < NumTriangles; Index++)
-						{
-							checkVoxelSlow(3 * Index + 2 < IndexBuffer.GetNumIndices());
-
-							const Chaos::TVector<int32, 3> Triangle{
-									int32(Data[3 * Index + 2]) + VertexOffset,
-									int32(Data[3 * Index + 1]) + VertexOffset,
-									int32(Data[3 * Index + 0]) + VertexOffset
-							};
-
-							FVoxelUtilities::Get(Triangles, IndexIndex++) = Triangle;
-
-	#if VOXEL_DEBUG
-							const auto A = Particles.X(Triangle.X);
-							const auto B = Particles.X(Triangle.Y);
-							const auto C = Particles.X(Triangle.Z);
-//							ensure(Chaos::FConvexBuilder::IsValidTriangle(A, B, C));
-	#endif
-						}
-					};
-					if (IndexBuffer.Is32Bit())
-					{
-						Lambda(IndexBuffer.GetData_32());
-					}
-					else
-					{
-						Lambda(IndexBuffer.GetData_16());
-					}
-				}
-			}
-			check(IndexIndex == Triangles.Num());
-			check(VertexIndex == Particles.Size());
+			Fill(Particles, Triangles);
 		}
 
 		TArray<uint16> MaterialIndices;
 		
 		VOXEL_ASYNC_SCOPE_COUNTER("Build Tri Mesh");
-		TriMeshes.Emplace(new Chaos::FTriangleMeshImplicitObject(MoveTemp(Particles), MoveTemp(Triangles), MoveTemp(MaterialIndices)));
+		return TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>(new Chaos::FTriangleMeshImplicitObject(MoveTemp(Particles), MoveTemp(Triangles), MoveTemp(MaterialIndices)));
 	};
 	
 	if (NumVertices < TNumericLimits<uint16>::Max())
 	{
 		TArray<Chaos::TVector<uint16, 3>> TrianglesSmallIdx;
-		Process(TrianglesSmallIdx);
+		return Process(TrianglesSmallIdx);
 	}
 	else
 	{
 		TArray<Chaos::TVector<int32, 3>> TrianglesLargeIdx;
-		Process(TrianglesLargeIdx);
+		return Process(TrianglesLargeIdx);
 	}
 }
+
+TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh(const TArray<FVector>& Vertices, const TArray<uint32>& Indices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	return CreateTriMeshImpl(Indices.Num(), Vertices.Num(), [&](auto& Particles, auto& Triangles)
+	{
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			Particles.X(Index) = FVector3f(Vertices[Index]);
+		}
+
+		const int32 NumTriangles = Indices.Num() / 3;
+		for (int32 Index = 0; Index < NumTriangles; Index++)
+		{
+			const Chaos::TVector<int32, 3> Triangle{
+				int32(Indices[3 * Index + 2]),
+				int32(Indices[3 * Index + 1]),
+				int32(Indices[3 * Index + 0])
+			};
+			FVoxelUtilities::Get(Triangles, Index) = Triangle;
+		}
+	});
+}
+
+void FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+				
+	int32 NumIndices = 0;
+	int32 NumVertices = 0;
+	for (auto& Buffer : Buffers)
+	{
+		NumIndices += Buffer->GetNumIndices();
+		NumVertices += Buffer->GetNumVertices();
+	}
+
+	TriMeshes.Add(CreateTriMeshImpl(NumIndices, NumVertices, [&](auto& Particles, auto& Triangles)
+	{
+		int32 IndexIndex = 0;
+		int32 VertexIndex = 0;
+		for (int32 SectionIndex = 0; SectionIndex < Buffers.Num(); SectionIndex++)
+		{
+			auto& Buffer = *Buffers[SectionIndex];
+
+			const int32 VertexOffset = VertexIndex;
+
+			{
+				VOXEL_ASYNC_SCOPE_COUNTER("Copy vertices");
+				
+				auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
+				for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
+				{
+					Particles.X(VertexIndex++) = PositionBuffer.VertexPosition(Index);
+				}
+			}
+
+			{
+				VOXEL_ASYNC_SCOPE_COUNTER("Copy triangles");
+				
+				auto& IndexBuffer = Buffer.IndexBuffer;
+
+				ensure(IndexBuffer.GetNumIndices() % 3 == 0);
+				const int32 NumTriangles = IndexBuffer.GetNumIndices() / 3;
+
+				const auto Lambda = [&](const auto* RESTRICT Data)
+				{
+					for (int32 Index = 0; Index < NumTriangles; Index++)
+					{
+						checkVoxelSlow(3 * Index + 2 < IndexBuffer.GetNumIndices());
+
+						const Chaos::TVector<int32, 3> Triangle{
+								int32(Data[3 * Index + 2]) + VertexOffset,
+								int32(Data[3 * Index + 1]) + VertexOffset,
+								int32(Data[3 * Index + 0]) + VertexOffset
+						};
+
+						FVoxelUtilities::Get(Triangles, IndexIndex++) = Triangle;
+
+#if VOXEL_DEBUG
+						const auto A = Particles.X(Triangle.X);
+						const auto B = Particles.X(Triangle.Y);
+						const auto C = Particles.X(Triangle.Z);
+//						ensure(Chaos::FConvexBuilder::IsValidTriangle(A, B, C));
+#endif
+					}
+				};
+				if (IndexBuffer.Is32Bit())
+				{
+					Lambda(IndexBuffer.GetData_32());
+				}
+				else
+				{
+					Lambda(IndexBuffer.GetData_16());
+				}
+			}
+		}
+		check(IndexIndex == Triangles.Num());
+		check(VertexIndex == Particles.Size());
+	}));
+}
 #endif
\ No newline at end of file
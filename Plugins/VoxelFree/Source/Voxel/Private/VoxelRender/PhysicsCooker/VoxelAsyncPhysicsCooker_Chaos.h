@@ -18,6 +18,9 @@ class FVoxelAsyncPhysicsCooker_Chaos : public IVoxelAsyncPhysicsCooker
 public:
 	explicit FVoxelAsyncPhysicsCooker_Chaos(UVoxelProceduralMeshComponent* Component);
 
+	// Used by the cooking library. Indices are expected in the same winding order as the proc mesh buffers
+	static TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> CreateTriMesh(const TArray<FVector>& Vertices, const TArray<uint32>& Indices);
+
 private:
 	~FVoxelAsyncPhysicsCooker_Chaos() = default;
 
@@ -23,6 +23,20 @@ static TAutoConsoleVariable<int32> CVarFreezeRenderer(
 	TEXT("Stops renderer tick"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarPrioritizeMeshUpdates(
+	TEXT("voxel.renderer.PrioritizeMeshUpdates"),
+	1,
+	TEXT("If true, finished mesh tasks will be applied closest to the invokers first, and an update will not be started if its estimated cost (from its vertex count) doesn't fit in MeshUpdatesBudget. ")
+	TEXT("If false, they are applied in the order they finished"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLogLatencies(
+	TEXT("voxel.renderer.LogLatencies"),
+	0.f,
+	TEXT("If > 0, every that many seconds the renderer will log the percentiles of the time between a chunk turning visible and its first mesh being applied, and of the time spent applying mesh updates per tick. ")
+	TEXT("Useful to compare scheduling settings such as voxel.lod.PredictionTime or voxel.renderer.PrioritizeMeshUpdates while moving through a world"),
+	ECVF_Default);
+
 FVoxelDefaultRenderer::FVoxelDefaultRenderer(const FVoxelRendererSettings& Settings)
 	: IVoxelRenderer(Settings)
 	, MeshHandler(Settings.bMergeChunks ? Settings.bDoNotMergeCollisionsAndNavmesh
@@ -102,6 +116,8 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 	{
 		auto& Chunk = ChunksMap.FindChecked(ChunkId);
 		Chunk.PendingUpdates.Add({ Time, FinishDelegate });
+		// The values changed, range analysis needs to be done again
+		Chunk.bNoSurface = false;
 		// Trigger tasks if not already triggered: if they are, they will trigger new ones when their callback will be processed in Tick
 		StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(Chunk);
 		StartTask<EMainOrTransitions::Transitions, EIfTaskExists::DoNothing>(Chunk);
@@ -214,6 +230,11 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 	UpdateIndex++;
 	if (!ensure(UpdateIndex == InUpdateIndex)) return;
 
+	if (UpdateIndex == 1)
+	{
+		FirstUpdateLODsTime = FPlatformTime::Seconds();
+	}
+
 	// Map used to know which chunks to wait for before dithering out
 	TMap<uint64, TArray<uint64, TInlineAllocator<8>>> OldChunksToNewChunks;
 	// Need to do it after the main pass, else OldChunksToNewChunks wouldn't be filled
@@ -243,6 +264,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 		};
 
 		FChunk& Chunk = GetChunk();
+		Chunk.bNoSurface = ChunkUpdate.bNoSurface;
 		// Can only have pending settings if dithering out (force visible = true) or waiting for new chunks (force visible = true, force collisions/navmesh)
 		ensure(
 			Chunk.Settings == Chunk.PendingSettings ||
@@ -374,6 +396,11 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 
 				// Set UpdateIndex as we are being showed
 				Chunk.UpdateIndex = UpdateIndex;
+
+				if (!Chunk.BuiltData.MainChunk.IsValid())
+				{
+					Chunk.VisibleRequestTime = FPlatformTime::Seconds();
+				}
 				
 				Chunk.SetState(Settings.bDitherChunks ? EChunkState::DitheringIn : EChunkState::Showed, STATIC_FNAME("Turned visible"));
 				if (!Chunk.MeshId.IsValid())
@@ -717,19 +744,32 @@ void FVoxelDefaultRenderer::Tick(float)
 	}
 	
 	ProcessChunksToRemoveOrShow();
-	ProcessMeshUpdates(MaxTime);
+	{
+		const double ProcessMeshUpdatesStartTime = FPlatformTime::Seconds();
+		ProcessMeshUpdates(MaxTime);
+		LatencyStats.ProcessMeshUpdatesTimes.Add(FPlatformTime::Seconds() - ProcessMeshUpdatesStartTime);
+		LatencyStats.NumPendingMeshUpdates += PendingMeshUpdates.Num();
+	}
 	FlushQueuedTasks();
 
-	if (!OnWorldLoadedFired && UpdateIndex > 0 && TaskCount.GetValue() == 0 && TasksCallbacksQueue.IsEmpty())
+	if (!OnWorldLoadedFired && UpdateIndex > 0 && TaskCount.GetValue() == 0 && TasksCallbacksQueue.IsEmpty() && PendingMeshUpdates.Num() == 0)
 	{
 		OnWorldLoaded.Broadcast();
 		OnWorldLoadedFired = true;
+
+		static IConsoleVariable* const SkipChunksWithoutSurface = IConsoleManager::Get().FindConsoleVariable(TEXT("voxel.lod.SkipChunksWithoutSurface"));
+		LOG_VOXEL(Log, TEXT("World loaded in %fs: %d mesher tasks queued, %d skipped as range analysis proved they had no surface (voxel.lod.SkipChunksWithoutSurface %d)"),
+			FPlatformTime::Seconds() - FirstUpdateLODsTime,
+			NumQueuedTasks,
+			NumTasksSkippedNoSurface,
+			SkipChunksWithoutSurface ? SkipChunksWithoutSurface->GetInt() : -1);
 	}
 
+	LogLatencies();
 	UpdateAllocatedSize();
 	
 	Settings.DebugManager->ReportMeshTaskCount(TaskCount.GetValue());
-	Settings.DebugManager->ReportMeshTasksCallbacksQueueNum(TasksCallbacksQueue.Num());
+	Settings.DebugManager->ReportMeshTasksCallbacksQueueNum(TasksCallbacksQueue.Num() + PendingMeshUpdates.Num());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -800,6 +840,16 @@ void FVoxelDefaultRenderer::StartTask(FChunk& Chunk)
 		Chunk.Bounds,
 		MainOrTransitions == EMainOrTransitions::Transitions,
 		MainOrTransitions == EMainOrTransitions::Transitions ? Chunk.Settings.TransitionsMask : 0));
+
+	if (Chunk.bNoSurface)
+	{
+		// No need to go through the pool, but still use the callback queue so that the chunk is processed like the others
+		Task->FinishWithEmptyChunk(Settings);
+		TasksCallbacksQueue.Enqueue({ Task->TaskId, Chunk.Id, MainOrTransitions == EMainOrTransitions::Transitions });
+		NumTasksSkippedNoSurface++;
+		return;
+	}
+
 	QueuedTasks[Chunk.Settings.bVisible][Chunk.Settings.bEnableCollisions].Emplace(Task.Get());
 }
 
@@ -1164,111 +1214,205 @@ void FVoxelDefaultRenderer::ProcessChunksToRemoveOrShow()
 void FVoxelDefaultRenderer::ProcessMeshUpdates(double MaxTime)
 {
 	VOXEL_FUNCTION_COUNTER();
-	
-	FVoxelTaskCallback Callback;
-	while ( // First check the time, else dequeued elements aren't processed!
-		FPlatformTime::Seconds() < MaxTime &&
-		TasksCallbacksQueue.Dequeue(Callback))
+
 	{
-		FChunk* Chunk = ChunksMap.Find(Callback.ChunkId);
-		if (!Chunk) continue;
-
-		auto& Tasks = Chunk->Tasks;
-		auto& Task = Callback.bIsTransitionTask ? Tasks.TransitionsTask : Tasks.MainTask;
-		if (!Task.IsValid() || Task->TaskId != Callback.TaskId) continue; // If task was canceled
-		if (!ensure(Task->IsDone())) continue; // Must be done if we're in the callback
-
-		// Move built data
-		auto& BuiltData = Chunk->BuiltData;
-		const auto PreviousBuiltData = BuiltData;
-		if (Callback.bIsTransitionTask)
+		VOXEL_SCOPE_COUNTER("Dequeue callbacks");
+		FVoxelTaskCallback Callback;
+		while (TasksCallbacksQueue.Dequeue(Callback))
 		{
-			ensure(Task->TransitionsMask == Chunk->Settings.TransitionsMask); // Should have been canceled
-			BuiltData.TransitionsMask = Task->TransitionsMask;
-			BuiltData.TransitionsChunk = Task->Chunk;
-			BuiltData.TransitionsChunkCreationTime = Task->CreationTime;
+			PendingMeshUpdates.Add({ Callback });
 		}
-		else
+	}
+
+	if (PendingMeshUpdates.Num() == 0)
+	{
+		return;
+	}
+	
+	const bool bPrioritize = CVarPrioritizeMeshUpdates.GetValueOnGameThread() != 0;
+	if (bPrioritize)
+	{
+		VOXEL_SCOPE_COUNTER("Sort pending mesh updates");
+
+		const auto FindTask = [&](const FPendingMeshUpdate& Update) -> const TUniquePtr<FVoxelMesherAsyncWork, TVoxelAsyncWorkDelete<FVoxelMesherAsyncWork>>*
 		{
-			BuiltData.MainChunk = Task->Chunk;
-			BuiltData.MainChunkCreationTime = Task->CreationTime;
-		}
+			const FChunk* Chunk = ChunksMap.Find(Update.Callback.ChunkId);
+			const auto* Task = Chunk ? &(Update.Callback.bIsTransitionTask ? Chunk->Tasks.TransitionsTask : Chunk->Tasks.MainTask) : nullptr;
+			return Task && Task->IsValid() && (*Task)->TaskId == Update.Callback.TaskId ? Task : nullptr;
+		};
 
-		// Finally, delete the task
-		Task.Reset();
+		// Drop canceled tasks. Don't swap: the arrival order is kept for chunks at the same distance
+		PendingMeshUpdates.RemoveAll([&](const FPendingMeshUpdate& Update) { return !FindTask(Update); });
 
-		// Do nothing while the main chunk isn't valid - we don't want to have unneeded updates for transitions then main
-		if (BuiltData.MainChunk.IsValid())
+		// Use the same priority as the pool so that near chunks are applied first
+		const TVoxelSharedRef<FInvokerPositionsArray> InvokersPositions = GetInvokersPositionsForPriorities();
+		for (FPendingMeshUpdate& Update : PendingMeshUpdates)
 		{
-			auto& MeshId = Chunk->MeshId;
-			const auto Update = [&]()
+			const FChunk& Chunk = ChunksMap.FindChecked(Update.Callback.ChunkId);
+			const auto* Task = FindTask(Update);
+
+			Update.Priority = FVoxelPriorityHandler(Chunk.Bounds, InvokersPositions).GetPriority();
+			Update.NumVertices = 0;
+			if ((*Task)->Chunk.IsValid())
 			{
-				if (!MeshId.IsValid())
-				{
-					MeshId = MeshHandler->AddChunk(Chunk->LOD, Chunk->Bounds.Min);
-				}
-				MeshHandler->UpdateChunk(MeshId, Chunk->Settings, *BuiltData.MainChunk, BuiltData.TransitionsChunk.Get(), BuiltData.TransitionsMask);
+				(*Task)->Chunk->IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffers) { Update.NumVertices += Buffers.GetNumVertices(); });
+			}
+		}
+		
+		// Stable: keep the arrival order for chunks at the same distance
+		PendingMeshUpdates.StableSort([](const FPendingMeshUpdate& A, const FPendingMeshUpdate& B) { return A.Priority > B.Priority; });
+	}
 
-				if (Settings.bStaticWorld)
-				{
-					// Free up memory ASAP
-					BuiltData.MainChunk.Reset();
-					BuiltData.TransitionsChunk.Reset();
-				}
-			};
+	int32 NumProcessed = 0;
+	while (NumProcessed < PendingMeshUpdates.Num())
+	{
+		const double Time = FPlatformTime::Seconds();
+		if (Time >= MaxTime)
+		{
+			break;
+		}
+		
+		const FPendingMeshUpdate& Update = PendingMeshUpdates[NumProcessed];
+		
+		// Don't start an update that is expected to overshoot the budget: it'll be the first one applied next tick
+		// Always apply at least one update per tick so that big updates are never starved
+		if (bPrioritize &&
+			NumProcessed > 0 &&
+			Time + Update.NumVertices * MeshUpdateSecondsPerVertex > MaxTime)
+		{
+			break;
+		}
+
+		ProcessMeshUpdate(Update.Callback);
+		NumProcessed++;
 
-			const bool bTransitionsChunkIsBuilt =
-				BuiltData.TransitionsChunk.IsValid() ||
-				Chunk->Settings.TransitionsMask == 0 ||
-				Settings.RenderType == EVoxelRenderType::SurfaceNets;
+		if (bPrioritize && Update.NumVertices > 0)
+		{
+			const double SecondsPerVertex = (FPlatformTime::Seconds() - Time) / Update.NumVertices;
+			MeshUpdateSecondsPerVertex = MeshUpdateSecondsPerVertex == 0
+				? SecondsPerVertex
+				: FMath::Lerp(MeshUpdateSecondsPerVertex, SecondsPerVertex, 0.1);
+		}
+	}
+	PendingMeshUpdates.RemoveAt(0, NumProcessed, false);
+}
 
-			if (BuiltData.MainChunk->IsEmpty() && (!BuiltData.TransitionsChunk.IsValid() || BuiltData.TransitionsChunk->IsEmpty()))
+void FVoxelDefaultRenderer::ProcessMeshUpdate(const FVoxelTaskCallback& Callback)
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	FChunk* Chunk = ChunksMap.Find(Callback.ChunkId);
+	if (!Chunk) return;
+
+	auto& Tasks = Chunk->Tasks;
+	auto& Task = Callback.bIsTransitionTask ? Tasks.TransitionsTask : Tasks.MainTask;
+	if (!Task.IsValid() || Task->TaskId != Callback.TaskId) return; // If task was canceled
+	if (!ensure(Task->IsDone())) return; // Must be done if we're in the callback
+
+	// Move built data
+	auto& BuiltData = Chunk->BuiltData;
+	const auto PreviousBuiltData = BuiltData;
+	if (Callback.bIsTransitionTask)
+	{
+		ensure(Task->TransitionsMask == Chunk->Settings.TransitionsMask); // Should have been canceled
+		BuiltData.TransitionsMask = Task->TransitionsMask;
+		BuiltData.TransitionsChunk = Task->Chunk;
+		BuiltData.TransitionsChunkCreationTime = Task->CreationTime;
+	}
+	else
+	{
+		BuiltData.MainChunk = Task->Chunk;
+		BuiltData.MainChunkCreationTime = Task->CreationTime;
+
+		if (Chunk->VisibleRequestTime > 0)
+		{
+			if (Chunk->Settings.bVisible)
 			{
-				// Both empty, remove mesh if existing
-				if (MeshId.IsValid())
+				const float Latency = FPlatformTime::Seconds() - Chunk->VisibleRequestTime;
+				LatencyStats.VisibleLatencies.Add(Latency);
+				if (Chunk->LOD == 0)
 				{
-					MeshHandler->RemoveChunk(MeshId);
-					MeshId = {};
+					LatencyStats.LOD0VisibleLatencies.Add(Latency);
 				}
 			}
-			else
+			Chunk->VisibleRequestTime = 0;
+		}
+	}
+
+	// Finally, delete the task
+	Task.Reset();
+
+	// Do nothing while the main chunk isn't valid - we don't want to have unneeded updates for transitions then main
+	if (BuiltData.MainChunk.IsValid())
+	{
+		auto& MeshId = Chunk->MeshId;
+		const auto Update = [&]()
+		{
+			if (!MeshId.IsValid())
 			{
-				Update();
-				
-				ensure(MeshId.IsValid());
+				MeshId = MeshHandler->AddChunk(Chunk->LOD, Chunk->Bounds.Min);
+			}
+			MeshHandler->UpdateChunk(MeshId, Chunk->Settings, *BuiltData.MainChunk, BuiltData.TransitionsChunk.Get(), BuiltData.TransitionsMask);
 
-				// Dither in if first update
-				// If first load and LOD 0, don't dither as it doesn't look nice to have the world dithering under the player
-				if (Settings.bDitherChunks &&
-					!PreviousBuiltData.MainChunk.IsValid() && 
-					!(UpdateIndex == 1 && Chunk->LOD == 0))
-				{
-					// Can be a first update if:
-					// - we are a showed new chunks that's dithering in
-					// - we are a hidden chunk that's updated for the first time. If so don't dither in
-					ensure(Chunk->GetState() == EChunkState::Hidden || Chunk->GetState() == EChunkState::DitheringIn);
-					if (Chunk->GetState() == EChunkState::DitheringIn)
-					{
-						DitherInChunk(*Chunk, Chunk->PreviousChunks);
-					}
-				}
+			if (Settings.bStaticWorld)
+			{
+				// Free up memory ASAP
+				BuiltData.MainChunk.Reset();
+				BuiltData.TransitionsChunk.Reset();
 			}
+		};
+
+		const bool bTransitionsChunkIsBuilt =
+			BuiltData.TransitionsChunk.IsValid() ||
+			Chunk->Settings.TransitionsMask == 0 ||
+			Settings.RenderType == EVoxelRenderType::SurfaceNets;
 
-			// Dither out/remove previous chunks only once transitions are built too
-			// Note: bTransitionsChunkIsBuilt is always true for surface nets
-			if (bTransitionsChunkIsBuilt)
+		if (BuiltData.MainChunk->IsEmpty() && (!BuiltData.TransitionsChunk.IsValid() || BuiltData.TransitionsChunk->IsEmpty()))
+		{
+			// Both empty, remove mesh if existing
+			if (MeshId.IsValid())
 			{
-				ClearPreviousChunks(*Chunk);
+				MeshHandler->RemoveChunk(MeshId);
+				MeshId = {};
 			}
 		}
 		else
 		{
-			ensure(!Chunk->MeshId.IsValid());
+			Update();
+			
+			ensure(MeshId.IsValid());
+
+			// Dither in if first update
+			// If first load and LOD 0, don't dither as it doesn't look nice to have the world dithering under the player
+			if (Settings.bDitherChunks &&
+				!PreviousBuiltData.MainChunk.IsValid() && 
+				!(UpdateIndex == 1 && Chunk->LOD == 0))
+			{
+				// Can be a first update if:
+				// - we are a showed new chunks that's dithering in
+				// - we are a hidden chunk that's updated for the first time. If so don't dither in
+				ensure(Chunk->GetState() == EChunkState::Hidden || Chunk->GetState() == EChunkState::DitheringIn);
+				if (Chunk->GetState() == EChunkState::DitheringIn)
+				{
+					DitherInChunk(*Chunk, Chunk->PreviousChunks);
+				}
+			}
 		}
 
-		// Start new tasks as needed
-		CheckPendingUpdates(*Chunk);
+		// Dither out/remove previous chunks only once transitions are built too
+		// Note: bTransitionsChunkIsBuilt is always true for surface nets
+		if (bTransitionsChunkIsBuilt)
+		{
+			ClearPreviousChunks(*Chunk);
+		}
 	}
+	else
+	{
+		ensure(!Chunk->MeshId.IsValid());
+	}
+
+	// Start new tasks as needed
+	CheckPendingUpdates(*Chunk);
 }
 
 void FVoxelDefaultRenderer::FlushQueuedTasks()
@@ -1281,6 +1425,7 @@ void FVoxelDefaultRenderer::FlushQueuedTasks()
 		if (Tasks.Num() > 0)
 		{
 			TaskCount.Add(Tasks.Num());
+			NumQueuedTasks += Tasks.Num();
 			const auto TaskType =
 				bVisible
 				? bHasCollisions
@@ -1322,6 +1467,58 @@ void FVoxelDefaultRenderer::DestroyChunk(FChunk& Chunk)
 	ensure(ChunksMap.Remove(Chunk.Id) == 1);
 }
 
+void FVoxelDefaultRenderer::LogLatencies()
+{
+	const float Interval = CVarLogLatencies.GetValueOnGameThread();
+	if (Interval <= 0)
+	{
+		LatencyStats = {};
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds();
+	if (LatencyStats.LastLogTime == 0)
+	{
+		LatencyStats.LastLogTime = Time;
+	}
+	if (Time - LatencyStats.LastLogTime < Interval)
+	{
+		return;
+	}
+	LatencyStats.LastLogTime = Time;
+
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto Percentiles = [](TArray<float>& Values)
+	{
+		if (Values.Num() == 0)
+		{
+			return FString(TEXT("no samples"));
+		}
+		Values.Sort();
+		const auto Get = [&](float Percentile) { return Values[FMath::Min(Values.Num() - 1, FMath::FloorToInt(Percentile * Values.Num()))] * 1000; };
+		const FString Result = FString::Printf(TEXT("%d samples, p50 %.1fms, p90 %.1fms, p99 %.1fms, max %.1fms"),
+			Values.Num(),
+			Get(0.5f),
+			Get(0.9f),
+			Get(0.99f),
+			Values.Last() * 1000);
+		Values.Reset();
+		return Result;
+	};
+
+	const int32 NumTicks = LatencyStats.ProcessMeshUpdatesTimes.Num();
+	const double AverageNumPendingMeshUpdates = NumTicks > 0 ? double(LatencyStats.NumPendingMeshUpdates) / NumTicks : 0;
+	LatencyStats.NumPendingMeshUpdates = 0;
+
+	LOG_VOXEL(Log, TEXT("Chunk visible latency: %s. LOD 0: %s"), *Percentiles(LatencyStats.VisibleLatencies), *Percentiles(LatencyStats.LOD0VisibleLatencies));
+	LOG_VOXEL(Log, TEXT("Mesh updates per tick (voxel.renderer.PrioritizeMeshUpdates %d, budget %.1fms): %s. %.1f updates left pending on average"),
+		CVarPrioritizeMeshUpdates.GetValueOnGameThread(),
+		Settings.MeshUpdatesBudget,
+		*Percentiles(LatencyStats.ProcessMeshUpdatesTimes),
+		AverageNumPendingMeshUpdates);
+}
+
 void FVoxelDefaultRenderer::UpdateAllocatedSize()
 {
 	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelRenderer, AllocatedSize);
@@ -126,6 +126,10 @@ private:
 		FVoxelChunkSettings PendingSettings{};
 		// Current settings
 		FVoxelChunkSettings Settings{};
+		// Set by the LOD manager if range analysis proved there's no surface, reset when the chunk is edited
+		bool bNoSurface = false;
+		// Time at which the chunk turned visible without a mesh, 0 once its first mesh is applied. See voxel.renderer.LogLatencies
+		double VisibleRequestTime = 0;
 
 		struct FPendingUpdate
 		{
@@ -195,6 +199,26 @@ private:
 	uint64 UpdateIndex = 0;
 	bool OnWorldLoadedFired = false;
 
+	// Reported once the world is loaded
+	double FirstUpdateLODsTime = 0;
+	int32 NumQueuedTasks = 0;
+	int32 NumTasksSkippedNoSurface = 0;
+
+	// Reported by voxel.renderer.LogLatencies
+	struct FLatencyStats
+	{
+		double LastLogTime = 0;
+		// Time between a chunk turning visible and its first mesh being applied
+		TArray<float> VisibleLatencies;
+		TArray<float> LOD0VisibleLatencies;
+		// Time spent in ProcessMeshUpdates, and number of updates left for the next ticks
+		TArray<float> ProcessMeshUpdatesTimes;
+		int64 NumPendingMeshUpdates = 0;
+	};
+	FLatencyStats LatencyStats;
+
+	void LogLatencies();
+
 #if VOXEL_DEBUG
 	TMap<uint64, FVoxelChunkSettings> DebugChunks;
 #endif
@@ -216,5 +240,18 @@ private:
 	};
 	TVoxelQueueWithNum<FVoxelTaskCallback, EQueueMode::Mpsc> TasksCallbacksQueue;
 
+	struct FPendingMeshUpdate
+	{
+		FVoxelTaskCallback Callback;
+		uint32 Priority = 0;
+		int32 NumVertices = 0;
+	};
+	// Callbacks dequeued from TasksCallbacksQueue but not applied yet because of MeshUpdatesBudget
+	TArray<FPendingMeshUpdate> PendingMeshUpdates;
+	// Running estimate of the game thread cost of applying a mesh update
+	double MeshUpdateSecondsPerVertex = 0;
+
+	void ProcessMeshUpdate(const FVoxelTaskCallback& Callback);
+
 	void CancelTask(TUniquePtr<FVoxelMesherAsyncWork, TVoxelAsyncWorkDelete<FVoxelMesherAsyncWork>>& Task);
 };
\ No newline at end of file
@@ -116,6 +116,17 @@ void FVoxelMesherAsyncWork::PostDoWork()
 	}
 }
 
+void FVoxelMesherAsyncWork::FinishWithEmptyChunk(const FVoxelRendererSettings& Settings)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+	check(!IsDone());
+
+	CreationTime = FPlatformTime::Seconds();
+	Chunk = GetMesher(Settings, LOD, ChunkPosition, bIsTransitionTask, TransitionsMask)->CreateEmptyChunk();
+	SetIsDone(true);
+}
+
 uint32 FVoxelMesherAsyncWork::GetPriority() const
 {
 	return PriorityHandler.GetPriority();
@@ -13,6 +13,34 @@
 
 #include "Async/Async.h"
 
+static TAutoConsoleVariable<int32> CVarIncrementalClusterMerge(
+	TEXT("voxel.renderer.IncrementalClusterMerge"),
+	0,
+	TEXT("If true, the buffers of each chunk of a cluster will be kept, so that only the chunks that changed need to be merged again when updating a cluster. ")
+	TEXT("This keeps a second CPU copy of the merged buffers of every cluster, roughly doubling their memory: see the Voxel Cluster Merge Cache Memory stat"),
+	ECVF_Default);
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelClusterMergeCacheMemory);
+
+void FVoxelRendererClusteredMeshHandler::FClusterMergeCache::UpdateAllocatedSize()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelClusterMergeCacheMemory, AllocatedSize);
+
+	AllocatedSize = Chunks.GetAllocatedSize();
+	for (auto& ChunkIt : Chunks)
+	{
+		for (auto& MeshIt : ChunkIt.Value.Buffers)
+		{
+			for (auto& SectionIt : MeshIt.Value)
+			{
+				AllocatedSize += SectionIt.Value->GetAllocatedSize();
+			}
+		}
+	}
+
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelClusterMergeCacheMemory, AllocatedSize);
+}
+
 class FVoxelClusteredMeshMergeWork : public FVoxelAsyncWork
 {
 public:
@@ -27,7 +55,8 @@ public:
 			Cluster->Position,
 			Handler,
 			Cluster->UpdateIndex.ToSharedRef(),
-			Cluster->ChunkMeshesToBuild);
+			Cluster->ChunkMeshesToBuild,
+			Cluster->MergeCache);
 	}
 
 private:
@@ -37,6 +66,7 @@ private:
 	const TVoxelWeakPtr<FVoxelRendererClusteredMeshHandler> Handler;
 
 	const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>> MeshesToBuild;
+	const TVoxelSharedRef<FVoxelRendererClusteredMeshHandler::FClusterMergeCache> MergeCache;
 	const TVoxelSharedRef<FThreadSafeCounter> UpdateIndexPtr;
 	const int32 UpdateIndex;
 	
@@ -45,13 +75,15 @@ private:
 		const FIntVector& Position,
 		FVoxelRendererClusteredMeshHandler& Handler,
 		const TVoxelSharedRef<FThreadSafeCounter>& UpdateIndexPtr,
-		const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>>& MeshesToBuild)
+		const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>>& MeshesToBuild,
+		const TVoxelSharedRef<FVoxelRendererClusteredMeshHandler::FClusterMergeCache>& MergeCache)
 		: FVoxelAsyncWork(STATIC_FNAME("FVoxelClusteredMeshMergeWork"), 1e9, true)
 		, ClusterRef(ClusterRef)
 		, Position(Position)
 		, RendererSettings(static_cast<const FVoxelRendererSettingsBase&>(Handler.Renderer.Settings))
 		, Handler(StaticCastVoxelSharedRef<FVoxelRendererClusteredMeshHandler>(Handler.AsShared()))
 		, MeshesToBuild(MeshesToBuild)
+		, MergeCache(MergeCache)
 		, UpdateIndexPtr(UpdateIndexPtr)
 		, UpdateIndex(UpdateIndexPtr->GetValue())
 	{
@@ -69,6 +101,33 @@ private:
 			// Canceled
 			return;
 		}
+		
+		auto BuiltMeshes = CVarIncrementalClusterMerge.GetValueOnAnyThread() != 0 ? BuildMeshesIncrementally() : BuildMeshes();
+		if (!BuiltMeshes.IsValid())
+		{
+			// Canceled
+			return;
+		}
+		auto HandlerPinned = Handler.Pin();
+		if (HandlerPinned.IsValid())
+		{
+			// Queue callback
+			HandlerPinned->MeshMergeCallback(ClusterRef, UpdateIndex, MoveTemp(BuiltMeshes));
+			FVoxelUtilities::DeleteOnGameThread_AnyThread(HandlerPinned);
+		}
+	}
+
+	TUniquePtr<FVoxelBuiltChunkMeshes> BuildMeshes() const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+		
+		{
+			// Invalidate the cache, as we're not keeping it up to date
+			FScopeLock Lock(&MergeCache->Section);
+			MergeCache->Chunks.Reset();
+			MergeCache->UpdateAllocatedSize();
+		}
+		
 		FVoxelChunkMeshesToBuild RealMap;
 		for (auto& ChunkIt : MeshesToBuild)
 		{
@@ -82,19 +141,103 @@ private:
 				}
 			}
 		}
-		auto BuiltMeshes = FVoxelRenderUtilities::BuildMeshes_AnyThread(RealMap, RendererSettings, Position, *UpdateIndexPtr, UpdateIndex);
-		if (!BuiltMeshes.IsValid())
+		return FVoxelRenderUtilities::BuildMeshes_AnyThread(RealMap, RendererSettings, Position, *UpdateIndexPtr, UpdateIndex);
+	}
+	
+	TUniquePtr<FVoxelBuiltChunkMeshes> BuildMeshesIncrementally() const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		FScopeLock Lock(&MergeCache->Section);
+		auto& CachedChunks = MergeCache->Chunks;
+
+		// Remove chunks that left the cluster
+		for (auto It = CachedChunks.CreateIterator(); It; ++It)
 		{
-			// Canceled
-			return;
+			if (!MeshesToBuild.Contains(It.Key()))
+			{
+				It.RemoveCurrent();
+			}
 		}
-		auto HandlerPinned = Handler.Pin();
-		if (HandlerPinned.IsValid())
+
+		// Build the buffers of the chunks that changed
+		for (auto& ChunkIt : MeshesToBuild)
 		{
-			// Queue callback
-			HandlerPinned->MeshMergeCallback(ClusterRef, UpdateIndex, MoveTemp(BuiltMeshes));
-			FVoxelUtilities::DeleteOnGameThread_AnyThread(HandlerPinned);
+			if (UpdateIndexPtr->GetValue() > UpdateIndex)
+			{
+				// Canceled. Fine to leave the cache as is, as each chunk is always fully updated
+				MergeCache->UpdateAllocatedSize();
+				return {};
+			}
+
+			auto& ChunkBuffers = CachedChunks.FindOrAdd(ChunkIt.Key);
+			if (ChunkBuffers.Source == ChunkIt.Value)
+			{
+				continue;
+			}
+
+			VOXEL_ASYNC_SCOPE_COUNTER("Build Chunk Buffers");
+			
+			ChunkBuffers.Source.Reset();
+			ChunkBuffers.Buffers.Reset();
+			for (auto& MeshIt : *ChunkIt.Value)
+			{
+				for (auto& SectionIt : MeshIt.Value)
+				{
+					// Else MergeSections_AnyThread would raise an ensure
+					const bool bHasVertices = SectionIt.Value.ContainsByPredicate([](const FVoxelChunkMeshSection& Section)
+					{
+						return
+							(Section.MainChunk.IsValid() && Section.MainChunk->GetNumVertices() > 0) ||
+							(Section.TransitionChunk.IsValid() && Section.TransitionChunk->GetNumVertices() > 0);
+					});
+					if (!bHasVertices)
+					{
+						continue;
+					}
+					
+					// Don't cancel: the buffers must always be valid
+					auto Buffers = FVoxelRenderUtilities::MergeSections_AnyThread(RendererSettings, SectionIt.Value, Position);
+					if (Buffers.IsValid())
+					{
+						ChunkBuffers.Buffers.FindOrAdd(MeshIt.Key).Add(SectionIt.Key, MoveTemp(Buffers));
+					}
+				}
+			}
+			ChunkBuffers.Source = ChunkIt.Value;
+		}
+		MergeCache->UpdateAllocatedSize();
+
+		// Concatenate the buffers of all the chunks
+		TMap<FVoxelMeshConfig, TMap<FVoxelProcMeshSectionSettings, TArray<const FVoxelProcMeshBuffers*>>> BuffersToConcatenate;
+		for (auto& ChunkIt : CachedChunks)
+		{
+			for (auto& MeshIt : ChunkIt.Value.Buffers)
+			{
+				auto& MeshMap = BuffersToConcatenate.FindOrAdd(MeshIt.Key);
+				for (auto& SectionIt : MeshIt.Value)
+				{
+					MeshMap.FindOrAdd(SectionIt.Key).Add(SectionIt.Value.Get());
+				}
+			}
+		}
+
+		auto BuiltMeshesPtr = MakeUnique<FVoxelBuiltChunkMeshes>();
+		for (auto& MeshIt : BuffersToConcatenate)
+		{
+			TArray<TPair<FVoxelProcMeshSectionSettings, TUniquePtr<FVoxelProcMeshBuffers>>> BuiltSections;
+			for (auto& SectionIt : MeshIt.Value)
+			{
+				auto BuiltSection = FVoxelRenderUtilities::ConcatenateBuffers_AnyThread(RendererSettings, SectionIt.Value, *UpdateIndexPtr, UpdateIndex);
+				if (UpdateIndexPtr->GetValue() > UpdateIndex)
+				{
+					return {};
+				}
+				BuiltSections.Emplace(SectionIt.Key, MoveTemp(BuiltSection));
+			}
+			BuiltMeshesPtr->Emplace(MeshIt.Key, MoveTemp(BuiltSections));
 		}
+		return BuiltMeshesPtr;
 	}
 };
 
@@ -9,6 +9,8 @@
 #include "VoxelRender/VoxelRenderUtilities.h"
 #include "VoxelRendererMeshHandler.h"
 
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Cluster Merge Cache Memory"), STAT_VoxelClusterMergeCacheMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
 class FVoxelRendererClusteredMeshHandler : public IVoxelRendererMeshHandler
 {
 public:
@@ -25,6 +27,32 @@ public:
 private:
 	DEFINE_TYPED_VOXEL_SPARSE_ARRAY_ID(FClusterId);
 	
+	// Buffers of each chunk of a cluster, in their final format
+	// Used to only rebuild the chunks that changed when re-merging a cluster
+	// This is a second CPU copy of the cluster buffers: its size is reported in STAT_VoxelClusterMergeCacheMemory
+	struct FClusterMergeCache
+	{
+		struct FChunkBuffers
+		{
+			// Meshes these buffers were built from, to detect changes
+			TVoxelSharedPtr<const FVoxelChunkMeshesToBuild> Source;
+			TMap<FVoxelMeshConfig, TMap<FVoxelProcMeshSectionSettings, TUniquePtr<FVoxelProcMeshBuffers>>> Buffers;
+		};
+		
+		// Tasks for the same cluster can overlap when they are canceled
+		FCriticalSection Section;
+		// Chunk unique id -> its buffers
+		TMap<uint64, FChunkBuffers> Chunks;
+		int64 AllocatedSize = 0;
+
+		~FClusterMergeCache()
+		{
+			DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelClusterMergeCacheMemory, AllocatedSize);
+		}
+		// Section must be locked
+		void UpdateAllocatedSize();
+	};
+	
 	struct FClusterBuiltData
 	{
 		int32 UpdateIndex = -1;
@@ -54,6 +82,9 @@ private:
 		// Shared ptr: used by build task
 		TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>> ChunkMeshesToBuild;
 
+		// Shared ptr: used by build task
+		TVoxelSharedRef<FClusterMergeCache> MergeCache = MakeVoxelShared<FClusterMergeCache>();
+
 		static FCluster Create(
 			int32 LOD,
 			const FIntVector& Position)
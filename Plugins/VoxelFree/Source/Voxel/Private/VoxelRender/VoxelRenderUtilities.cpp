@@ -446,6 +446,134 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 	return ProcMeshBuffersPtr;
 }
 
+TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::ConcatenateBuffers_AnyThread(
+	const FVoxelRendererSettingsBase& RendererSettings,
+	const TArray<const FVoxelProcMeshBuffers*>& Buffers,
+	const FThreadSafeCounter& CancelCounter,
+	int32 CancelThreshold)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (!ensure(Buffers.Num() > 0)) return {};
+
+	auto ProcMeshBuffersPtr = MakeUnique<FVoxelProcMeshBuffers>();
+	auto& ProcMeshBuffers = *ProcMeshBuffersPtr;
+
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	int32 NumAdjacencyIndices = 0;
+	const int32 NumTextureCoordinates = Buffers[0]->VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+	for (const FVoxelProcMeshBuffers* Buffer : Buffers)
+	{
+		NumVertices += Buffer->GetNumVertices();
+		NumIndices += Buffer->GetNumIndices();
+		NumAdjacencyIndices += Buffer->AdjacencyIndexBuffer.GetNumIndices();
+		
+		if (!ensure(int32(Buffer->VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords()) == NumTextureCoordinates)) return {};
+	}
+	if (!ensure(NumVertices > 0)) return {};
+	
+	auto& PositionBuffer = ProcMeshBuffers.VertexBuffers.PositionVertexBuffer;
+	auto& StaticMeshBuffer = ProcMeshBuffers.VertexBuffers.StaticMeshVertexBuffer;
+	auto& ColorBuffer = ProcMeshBuffers.VertexBuffers.ColorVertexBuffer;
+	auto& IndexBuffer = ProcMeshBuffers.IndexBuffer;
+	auto& AdjacencyIndexBuffer = ProcMeshBuffers.AdjacencyIndexBuffer;
+	
+	CHECK_CANCEL();
+	PositionBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
+	CHECK_CANCEL();
+	if (RendererSettings.bRenderWorld)
+	{
+		StaticMeshBuffer.SetUseFullPrecisionUVs(!RendererSettings.bHalfPrecisionCoordinates);
+		StaticMeshBuffer.Init(NumVertices, NumTextureCoordinates, FVoxelProcMeshBuffers::bNeedsCPUAccess);
+		CHECK_CANCEL();
+		ColorBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
+	}
+	CHECK_CANCEL();
+	IndexBuffer.AllocateData(NumIndices);
+	CHECK_CANCEL();
+	AdjacencyIndexBuffer.AllocateData(NumAdjacencyIndices);
+	CHECK_CANCEL();
+
+	int32 VerticesOffset = 0;
+	int32 IndicesOffset = 0;
+	int32 AdjacencyIndicesOffset = 0;
+	uint32 TangentsOffset = 0;
+	uint32 TextureCoordinatesOffset = 0;
+
+	const auto CopyData = [](void* Dest, uint32 DestOffset, const void* Source, uint32 Size)
+	{
+		FMemory::Memcpy(static_cast<uint8*>(Dest) + DestOffset, Source, Size);
+	};
+	
+	for (const FVoxelProcMeshBuffers* Buffer : Buffers)
+	{
+		CHECK_CANCEL();
+		
+		// Buffers only expose non-const accessors to their data
+		auto& Source = const_cast<FVoxelProcMeshBuffers&>(*Buffer);
+		const int32 SourceNumVertices = Source.GetNumVertices();
+		
+		ProcMeshBuffers.Guids.Append(Source.Guids);
+		ProcMeshBuffers.LocalBounds += Source.LocalBounds;
+
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("CopyPositions");
+			CopyData(
+				PositionBuffer.GetVertexData(),
+				VerticesOffset * PositionBuffer.GetStride(),
+				Source.VertexBuffers.PositionVertexBuffer.GetVertexData(),
+				SourceNumVertices * PositionBuffer.GetStride());
+		}
+		if (RendererSettings.bRenderWorld)
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("CopyStaticMeshAndColors");
+			
+			auto& SourceStaticMeshBuffer = Source.VertexBuffers.StaticMeshVertexBuffer;
+			check(SourceStaticMeshBuffer.GetUseFullPrecisionUVs() == StaticMeshBuffer.GetUseFullPrecisionUVs());
+			check(SourceStaticMeshBuffer.GetUseHighPrecisionTangentBasis() == StaticMeshBuffer.GetUseHighPrecisionTangentBasis());
+			
+			CopyData(StaticMeshBuffer.GetTangentData(), TangentsOffset, SourceStaticMeshBuffer.GetTangentData(), SourceStaticMeshBuffer.GetTangentSize());
+			CopyData(StaticMeshBuffer.GetTexCoordData(), TextureCoordinatesOffset, SourceStaticMeshBuffer.GetTexCoordData(), SourceStaticMeshBuffer.GetTexCoordSize());
+			TangentsOffset += SourceStaticMeshBuffer.GetTangentSize();
+			TextureCoordinatesOffset += SourceStaticMeshBuffer.GetTexCoordSize();
+
+			CopyData(
+				ColorBuffer.GetVertexData(),
+				VerticesOffset * ColorBuffer.GetStride(),
+				Source.VertexBuffers.ColorVertexBuffer.GetVertexData(),
+				SourceNumVertices * ColorBuffer.GetStride());
+		}
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("CopyIndices");
+			for (int32 Index = 0; Index < Source.IndexBuffer.GetNumIndices(); Index++)
+			{
+				IndexBuffer.SetIndex(IndicesOffset + Index, VerticesOffset + Source.IndexBuffer.GetIndex(Index));
+			}
+			for (int32 Index = 0; Index < Source.AdjacencyIndexBuffer.GetNumIndices(); Index++)
+			{
+				AdjacencyIndexBuffer.SetIndex(AdjacencyIndicesOffset + Index, VerticesOffset + Source.AdjacencyIndexBuffer.GetIndex(Index));
+			}
+		}
+
+		VerticesOffset += SourceNumVertices;
+		IndicesOffset += Source.IndexBuffer.GetNumIndices();
+		AdjacencyIndicesOffset += Source.AdjacencyIndexBuffer.GetNumIndices();
+	}
+
+	check(VerticesOffset == NumVertices);
+	check(IndicesOffset == NumIndices);
+	check(AdjacencyIndicesOffset == NumAdjacencyIndices);
+
+	// Note: LocalBounds are already extended by the individual buffers
+
+	ProcMeshBuffers.UpdateStats();
+
+	CHECK_CANCEL();
+
+	return ProcMeshBuffersPtr;
+}
+
 TUniquePtr<FVoxelBuiltChunkMeshes> FVoxelRenderUtilities::BuildMeshes_AnyThread(
 	const FVoxelChunkMeshesToBuild& ChunkMeshesToBuild,
 	const FVoxelRendererSettingsBase& RendererSettings,
@@ -93,6 +93,13 @@ namespace FVoxelRenderUtilities
 		const FIntVector& CenterPosition,
 		const FThreadSafeCounter& CancelCounter = FThreadSafeCounter(),
 		int32 CancelThreshold = 0);
+	// Concatenates buffers built by MergeSections_AnyThread with the same settings
+	// Much faster than merging the sections again, as the vertex data is already in its final format and can be memcpy'd
+	TUniquePtr<FVoxelProcMeshBuffers> ConcatenateBuffers_AnyThread(
+		const FVoxelRendererSettingsBase& RendererSettings,
+		const TArray<const FVoxelProcMeshBuffers*>& Buffers,
+		const FThreadSafeCounter& CancelCounter = FThreadSafeCounter(),
+		int32 CancelThreshold = 0);
 	TUniquePtr<FVoxelBuiltChunkMeshes> BuildMeshes_AnyThread(
 		const FVoxelChunkMeshesToBuild& ChunkMeshesToBuild,
 		const FVoxelRendererSettingsBase& RendererSettings,
@@ -0,0 +1,250 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelRender/VoxelRenderUtilities.h"
+#include "VoxelRender/Meshers/VoxelMarchingCubeMesher.h"
+#include "VoxelRender/Meshers/VoxelCubicMesher.h"
+#include "VoxelRender/Meshers/VoxelSurfaceNetMesher.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+// Meshes the data of a voxel world with all the meshers, without touching the renderer
+// Can be run headless, eg: -nullrhi -ExecCmds="voxel.renderer.Benchmark 2 2"
+namespace FVoxelRendererBenchmark
+{
+	struct FStageTime
+	{
+		double Time = 0;
+
+		struct FScope
+		{
+			FStageTime& Stage;
+			const double StartTime = FPlatformTime::Seconds();
+
+			explicit FScope(FStageTime& Stage)
+				: Stage(Stage)
+			{
+			}
+			~FScope()
+			{
+				Stage.Time += FPlatformTime::Seconds() - StartTime;
+			}
+		};
+	};
+
+	template<typename TMesher>
+	TSharedRef<FJsonObject> RunMesher(const FVoxelRendererSettings& Settings, int32 LOD, int32 Radius)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		FStageTime MesherTime;
+		FStageTime MergeTime;
+		FStageTime OptimizeIndicesTime;
+
+		int32 NumChunks = 0;
+		int32 NumEmptyChunks = 0;
+		int64 NumVertices = 0;
+		int64 NumTriangles = 0;
+
+		const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
+
+		TArray<FVoxelChunkMeshSection> Sections;
+		for (int32 X = -Radius; X < Radius; X++)
+		{
+			for (int32 Y = -Radius; Y < Radius; Y++)
+			{
+				for (int32 Z = -Radius; Z < Radius; Z++)
+				{
+					const FIntVector ChunkPosition = FIntVector(X, Y, Z) * ChunkSize;
+
+					TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
+					{
+						FStageTime::FScope Scope(MesherTime);
+						Chunk = MakeUnique<TMesher>(LOD, ChunkPosition, Settings)->CreateFullChunk();
+					}
+					NumChunks++;
+
+					if (!Chunk.IsValid() || Chunk->IsEmpty())
+					{
+						NumEmptyChunks++;
+						continue;
+					}
+
+					Chunk->IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffers)
+					{
+						if (Buffers.GetNumVertices() == 0)
+						{
+							return;
+						}
+						NumVertices += Buffers.GetNumVertices();
+						NumTriangles += Buffers.Indices.Num() / 3;
+
+						{
+							// Copy to not alter the merged buffers
+							FVoxelChunkMeshBuffers BuffersCopy;
+							BuffersCopy.Indices = Buffers.Indices;
+							BuffersCopy.Positions = Buffers.Positions;
+
+							FStageTime::FScope Scope(OptimizeIndicesTime);
+							BuffersCopy.OptimizeIndices();
+						}
+
+						// The section only keeps a const ref to the buffers, which are owned by the chunk
+						FVoxelChunkMeshSection Section(LOD, ChunkPosition, false, false, 0);
+						Section.MainChunk = TVoxelSharedPtr<const FVoxelChunkMeshBuffers>(Chunk, &Buffers);
+						Sections.Add(Section);
+					});
+				}
+			}
+		}
+
+		int32 NumMergedVertices = 0;
+		if (Sections.Num() > 0)
+		{
+			FStageTime::FScope Scope(MergeTime);
+			const auto MergedBuffers = FVoxelRenderUtilities::MergeSections_AnyThread(Settings, Sections, FIntVector(0));
+			NumMergedVertices = MergedBuffers.IsValid() ? MergedBuffers->GetNumVertices() : 0;
+		}
+
+		const int64 NumVoxels = int64(NumChunks) * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE;
+
+		const auto Result = MakeShared<FJsonObject>();
+		Result->SetNumberField(TEXT("LOD"), LOD);
+		Result->SetNumberField(TEXT("Chunks"), NumChunks);
+		Result->SetNumberField(TEXT("EmptyChunks"), NumEmptyChunks);
+		Result->SetNumberField(TEXT("Voxels"), NumVoxels);
+		Result->SetNumberField(TEXT("Vertices"), NumVertices);
+		Result->SetNumberField(TEXT("Triangles"), NumTriangles);
+		Result->SetNumberField(TEXT("MergedVertices"), NumMergedVertices);
+		Result->SetNumberField(TEXT("MesherTimeMs"), MesherTime.Time * 1000);
+		Result->SetNumberField(TEXT("MesherTimePerVoxelNs"), NumVoxels > 0 ? MesherTime.Time / NumVoxels * 1e9 : 0);
+		Result->SetNumberField(TEXT("MergeSectionsTimeMs"), MergeTime.Time * 1000);
+		Result->SetNumberField(TEXT("OptimizeIndicesTimeMs"), OptimizeIndicesTime.Time * 1000);
+		return Result;
+	}
+
+	// Runs Lambda once with the console variable set to 0 and once with it set to 1, then restores it
+	template<typename T>
+	TSharedRef<FJsonObject> CompareConsoleVariable(const TCHAR* Name, const TCHAR* MesherName, T Lambda)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+		check(Variable);
+		const FString OldValue = Variable->GetString();
+
+		const auto Result = MakeShared<FJsonObject>();
+		Result->SetStringField(TEXT("Mesher"), MesherName);
+
+		for (const int32 Value : { 0, 1 })
+		{
+			Variable->Set(Value, ECVF_SetByConsole);
+			const TArray<TSharedPtr<FJsonValue>> Values = Lambda();
+
+			double MesherTimeMs = 0;
+			int64 NumTriangles = 0;
+			for (const TSharedPtr<FJsonValue>& LODValue : Values)
+			{
+				MesherTimeMs += LODValue->AsObject()->GetNumberField(TEXT("MesherTimeMs"));
+				NumTriangles += int64(LODValue->AsObject()->GetNumberField(TEXT("Triangles")));
+			}
+			LOG_VOXEL(Log, TEXT("%s %d: %s mesher time %.2fms, %lld triangles"), Name, Value, MesherName, MesherTimeMs, NumTriangles);
+
+			Result->SetArrayField(Value ? TEXT("On") : TEXT("Off"), Values);
+		}
+
+		Variable->Set(*OldValue, ECVF_SetByConsole);
+		return Result;
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 Radius = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2;
+		const int32 MaxLOD = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 0, 8) : 2;
+		const FString Path = Args.Num() > 2
+			? Args[2]
+			: FPaths::ProjectSavedDir() / TEXT("VoxelBenchmarks") / FString::Printf(TEXT("Renderer_%s_%s.json"), *World.GetName(), *FDateTime::Now().ToString());
+
+		const FVoxelRendererSettings& Settings = World.GetRenderer().Settings;
+
+		const auto RunAllLODs = [&](auto Lambda)
+		{
+			TArray<TSharedPtr<FJsonValue>> Values;
+			for (int32 LOD = 0; LOD <= MaxLOD; LOD++)
+			{
+				Values.Add(MakeShared<FJsonValueObject>(Lambda(LOD)));
+			}
+			return Values;
+		};
+
+		const auto Meshers = MakeShared<FJsonObject>();
+		Meshers->SetArrayField(TEXT("MarchingCubes"), RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelMarchingCubeMesher>(Settings, LOD, Radius); }));
+		Meshers->SetArrayField(TEXT("Cubic"), RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelCubicMesher>(Settings, LOD, Radius); }));
+		Meshers->SetArrayField(TEXT("SurfaceNets"), RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelSurfaceNetMesher>(Settings, LOD, Radius); }));
+
+		// The mesher paths gated by a console variable, measured with the variable off and on
+		const auto ConsoleVariables = MakeShared<FJsonObject>();
+		ConsoleVariables->SetObjectField(TEXT("voxel.mesher.GridGradientNormals"), CompareConsoleVariable(TEXT("voxel.mesher.GridGradientNormals"), TEXT("MarchingCubes"), [&]()
+		{
+			return RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelMarchingCubeMesher>(Settings, LOD, Radius); });
+		}));
+		ConsoleVariables->SetObjectField(TEXT("voxel.mesher.GreedyCubicMeshing"), CompareConsoleVariable(TEXT("voxel.mesher.GreedyCubicMeshing"), TEXT("Cubic"), [&]()
+		{
+			return RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelCubicMesher>(Settings, LOD, Radius); });
+		}));
+		ConsoleVariables->SetObjectField(TEXT("voxel.mesher.BatchedMaterials"), CompareConsoleVariable(TEXT("voxel.mesher.BatchedMaterials"), TEXT("MarchingCubes"), [&]()
+		{
+			return RunAllLODs([&](int32 LOD) { return RunMesher<FVoxelMarchingCubeMesher>(Settings, LOD, Radius); });
+		}));
+
+		const auto Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("World"), World.GetName());
+		Root->SetStringField(TEXT("Generator"), World.Generator.GetObject() ? World.Generator.GetObject()->GetName() : TEXT("None"));
+		Root->SetNumberField(TEXT("ChunkSize"), RENDER_CHUNK_SIZE);
+		Root->SetNumberField(TEXT("Radius"), Radius);
+		// Grid gradient normals only change anything with gradient normals
+		Root->SetStringField(TEXT("NormalConfig"), UEnum::GetValueAsString(Settings.NormalConfig));
+		Root->SetObjectField(TEXT("Meshers"), Meshers);
+		Root->SetObjectField(TEXT("ConsoleVariables"), ConsoleVariables);
+
+		FString Json;
+		const auto Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		if (FFileHelper::SaveStringToFile(Json, *Path))
+		{
+			LOG_VOXEL(Log, TEXT("Renderer benchmark written to %s"), *Path);
+		}
+		else
+		{
+			LOG_VOXEL(Error, TEXT("Failed to write renderer benchmark to %s"), *Path);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RendererBenchmarkCmd(
+	TEXT("voxel.renderer.Benchmark"),
+	TEXT("Mesh the data of all the voxel worlds in the scene with all the meshers, and with the mesher console variables off and on, and write the timings as JSON. Args: [Radius in chunks = 2] [Max LOD = 2] [Output path]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelRendererBenchmark::Run(**It, Args);
+			}
+		}
+	}));
@@ -602,23 +602,27 @@ void UVoxelAssetTools::ImportDataAssetFastAsync(
 
 void UVoxelAssetTools::InvertDataAssetImpl(const FVoxelDataAssetData& AssetData, FVoxelDataAssetData& InvertedAssetData)
 {
-	VOXEL_TOOL_FUNCTION_COUNTER(AssetData.GetSize().X * AssetData.GetSize().Y * AssetData.GetSize().Z);
-
-	InvertedAssetData.SetSize(AssetData.GetSize(), AssetData.HasMaterials());
-	const int32 Num = AssetData.GetRawValues().Num();
-#if VOXEL_DEBUG
-	const auto& Src = AssetData.GetRawValues();
-	auto& Dst = InvertedAssetData.GetRawValues();
-#else
-	const auto* RESTRICT Src = AssetData.GetRawValues().GetData();
-	auto* RESTRICT Dst = InvertedAssetData.GetRawValues().GetData();
-#endif
-	for (int32 Index = 0; Index < Num; Index++)
-	{
-		Dst[Index] = Src[Index].GetInverse();
-	}
+	const FIntVector Size = AssetData.GetSize();
+	VOXEL_TOOL_FUNCTION_COUNTER(Size.X * Size.Y * Size.Z);
+
+	const bool bHasMaterials = AssetData.HasMaterials();
+	InvertedAssetData.SetSize(Size, bHasMaterials);
 
-	InvertedAssetData.GetRawMaterials() = AssetData.GetRawMaterials();
+	// AssetData might be bricked: read it voxel by voxel instead of converting it to dense
+	for (int32 Z = 0; Z < Size.Z; Z++)
+	{
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				InvertedAssetData.SetValue(X, Y, Z, AssetData.GetValueUnsafe(X, Y, Z).GetInverse());
+				if (bHasMaterials)
+				{
+					InvertedAssetData.SetMaterial(X, Y, Z, AssetData.GetMaterialUnsafe(X, Y, Z));
+				}
+			}
+		}
+	}
 }
 
 void UVoxelAssetTools::InvertDataAsset(UVoxelDataAsset* Asset, UVoxelDataAsset*& InvertedAsset)
@@ -647,19 +651,22 @@ void UVoxelAssetTools::SetDataAssetMaterialImpl(
 	FVoxelDataAssetData& NewAssetData,
 	FVoxelMaterial Material)
 {
-	VOXEL_TOOL_FUNCTION_COUNTER(AssetData.GetSize().X * AssetData.GetSize().Y * AssetData.GetSize().Z);
-
-	NewAssetData.SetSize(AssetData.GetSize(), true);
-	NewAssetData.GetRawValues() = AssetData.GetRawValues();
-	const int32 Num = AssetData.GetRawValues().Num();
-#if VOXEL_DEBUG
-	auto& Ptr = NewAssetData.GetRawMaterials();
-#else
-	auto* RESTRICT Ptr = NewAssetData.GetRawMaterials().GetData();
-#endif
-	for (int32 Index = 0; Index < Num; Index++)
-	{
-		Ptr[Index] = Material;
+	const FIntVector Size = AssetData.GetSize();
+	VOXEL_TOOL_FUNCTION_COUNTER(Size.X * Size.Y * Size.Z);
+
+	NewAssetData.SetSize(Size, true);
+
+	// AssetData might be bricked: read it voxel by voxel instead of converting it to dense
+	for (int32 Z = 0; Z < Size.Z; Z++)
+	{
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				NewAssetData.SetValue(X, Y, Z, AssetData.GetValueUnsafe(X, Y, Z));
+				NewAssetData.SetMaterial(X, Y, Z, Material);
+			}
+		}
 	}
 }
 
@@ -82,71 +82,200 @@ FVoxelSurfaceEditsVoxels UVoxelSurfaceTools::FindSurfaceVoxelsImpl(
 	
 	const FIntVector Size = Bounds.Size();
 
-	const TArray<FVoxelValue> Values = Data.GetValues(Bounds);
+	FVoxelSurfaceEditsVoxels EditsVoxels;
+	EditsVoxels.Info.bHasValues = true;
+	EditsVoxels.Info.bHasNormals = bComputeNormals_Dynamic;
+
+	if (Size.X < 3 || Size.Y < 3 || Size.Z < 3)
+	{
+		return EditsVoxels;
+	}
+
+	// Small queries aren't worth the threading overhead
+	const bool bMultiThreaded = Size.Z >= 16 && Bounds.Count() >= 32 * 32 * 32;
+	
+	const TArray<FVoxelValue> Values = bMultiThreaded ? Data.ParallelGet<FVoxelValue>(Bounds) : Data.GetValues(Bounds);
 	
-	const auto GetValue = [&](int32 X, int32 Y, int32 Z)
+	const auto GetIndex = [&](int32 X, int32 Y, int32 Z)
 	{
 		checkVoxelSlow(0 <= X && X < Size.X);
 		checkVoxelSlow(0 <= Y && Y < Size.Y);
 		checkVoxelSlow(0 <= Z && Z < Size.Z);
-		const int32 Index = X + Y * Size.X + Z * Size.X * Size.Y;
-		return Values.GetData()[Index];
+		return X + Y * Size.X + Z * Size.X * Size.Y;
 	};
 
-	TArray<FVoxelSurfaceEditsVoxelBase> OutVoxels;
-	OutVoxels.Reserve(Bounds.Count());
+	///////////////////////////////////////////////////////////////////////////////
+
+	// Find the data chunks that can't contain any surface voxel: single value leaves whose face neighbors are single value leaves
+	// with the same emptiness. Neighbors outside of Bounds don't matter, as the border voxels are never outputted.
+	const FIntVector ChunksMin = FVoxelUtilities::DivideFloor(Bounds.Min, DATA_CHUNK_SIZE);
+	const FIntVector ChunksSize = FVoxelUtilities::DivideCeil(Bounds.Max, DATA_CHUNK_SIZE) - ChunksMin;
+	const auto GetChunkIndex = [&](int32 X, int32 Y, int32 Z)
+	{
+		return X + Y * ChunksSize.X + Z * ChunksSize.X * ChunksSize.Y;
+	};
 
+	enum class EChunkState : uint8
+	{
+		Unknown,
+		Empty,
+		Full
+	};
+	
+	TArray<EChunkState> ChunkStates;
+	ChunkStates.SetNumZeroed(ChunksSize.X * ChunksSize.Y * ChunksSize.Z);
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Find single value chunks");
+		FVoxelOctreeUtilities::IterateLeavesInBounds(Data.GetOctree(), Bounds, [&](FVoxelDataOctreeLeaf& Leaf)
+		{
+			const auto& DataHolder = Leaf.GetData<FVoxelValue>();
+			if (!DataHolder.IsSingleValue())
+			{
+				return;
+			}
+			
+			const FIntVector Chunk = FVoxelUtilities::DivideFloor(Leaf.GetMin(), DATA_CHUNK_SIZE) - ChunksMin;
+			checkVoxelSlow(0 <= Chunk.X && Chunk.X < ChunksSize.X);
+			checkVoxelSlow(0 <= Chunk.Y && Chunk.Y < ChunksSize.Y);
+			checkVoxelSlow(0 <= Chunk.Z && Chunk.Z < ChunksSize.Z);
+			ChunkStates[GetChunkIndex(Chunk.X, Chunk.Y, Chunk.Z)] = DataHolder.GetSingleValue().IsEmpty() ? EChunkState::Empty : EChunkState::Full;
+		});
+	}
+
+	TArray<bool> SkippableChunks;
+	SkippableChunks.SetNumZeroed(ChunkStates.Num());
+	for (int32 Z = 0; Z < ChunksSize.Z; Z++)
+	{
+		for (int32 Y = 0; Y < ChunksSize.Y; Y++)
+		{
+			for (int32 X = 0; X < ChunksSize.X; X++)
+			{
+				const EChunkState State = ChunkStates[GetChunkIndex(X, Y, Z)];
+				if (State == EChunkState::Unknown)
+				{
+					continue;
+				}
+
+				const auto IsSameState = [&](int32 DX, int32 DY, int32 DZ)
+				{
+					const int32 NX = X + DX;
+					const int32 NY = Y + DY;
+					const int32 NZ = Z + DZ;
+					if (NX < 0 || NY < 0 || NZ < 0 || NX >= ChunksSize.X || NY >= ChunksSize.Y || NZ >= ChunksSize.Z)
+					{
+						return true;
+					}
+					return ChunkStates[GetChunkIndex(NX, NY, NZ)] == State;
+				};
+
+				SkippableChunks[GetChunkIndex(X, Y, Z)] =
+					IsSameState(-1, 0, 0) && IsSameState(1, 0, 0) &&
+					IsSameState(0, -1, 0) && IsSameState(0, 1, 0) &&
+					IsSameState(0, 0, -1) && IsSameState(0, 0, 1);
+			}
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+
+	// Iterate in memory order, one Z slice per task. Each slice writes to its own buffer so that the output order is deterministic.
+	const int32 NumSlices = Size.Z - 2;
+	TArray<TArray<FVoxelSurfaceEditsVoxelBase>> SliceVoxels;
+	SliceVoxels.SetNum(NumSlices);
+	
 	FVoxelUtilities::StaticBranch(bComputeNormals_Dynamic, bOnlyOutputNonEmptyVoxels_Dynamic, [&](auto bComputeNormals_Static, auto bOnlyOutputNonEmptyVoxels_Static)
 	{
-		for (int32 X = 1; X < Size.X - 1; X++)
+		ParallelFor(NumSlices, [&](int32 SliceIndex)
 		{
+			const int32 Z = SliceIndex + 1;
+			const int32 ChunkZ = FVoxelUtilities::DivideFloor(Bounds.Min.Z + Z, DATA_CHUNK_SIZE) - ChunksMin.Z;
+
+			TArray<FVoxelSurfaceEditsVoxelBase>& OutVoxels = SliceVoxels[SliceIndex];
+			
 			for (int32 Y = 1; Y < Size.Y - 1; Y++)
 			{
-				for (int32 Z = 1; Z < Size.Z - 1; Z++)
+				const int32 ChunkY = FVoxelUtilities::DivideFloor(Bounds.Min.Y + Y, DATA_CHUNK_SIZE) - ChunksMin.Y;
+				
+				int32 X = 1;
+				while (X < Size.X - 1)
 				{
-					const FVoxelValue Value = GetValue(X, Y, Z);
-					if (bOnlyOutputNonEmptyVoxels_Static && Value.IsEmpty())
+					const int32 ChunkX = FVoxelUtilities::DivideFloor(Bounds.Min.X + X, DATA_CHUNK_SIZE) - ChunksMin.X;
+					const int32 SpanEnd = FMath::Min((ChunksMin.X + ChunkX + 1) * DATA_CHUNK_SIZE - Bounds.Min.X, Size.X - 1);
+					checkVoxelSlow(X < SpanEnd);
+
+					if (SkippableChunks[GetChunkIndex(ChunkX, ChunkY, ChunkZ)])
 					{
+						X = SpanEnd;
 						continue;
 					}
-					
-					bool bAdd = false;
-					const auto GetOtherValue = [&](uint8 Direction, int32 DX, int32 DY, int32 DZ)
+
+					for (; X < SpanEnd; X++)
 					{
-						const FVoxelValue OtherValue = GetValue(X + DX, Y + DY, Z + DZ);
-						if (!DirectionMask || (!Value.IsEmpty() && (Direction & DirectionMask)))
+						const int32 Index = GetIndex(X, Y, Z);
+						const FVoxelValue Value = Values.GetData()[Index];
+						if (bOnlyOutputNonEmptyVoxels_Static && Value.IsEmpty())
 						{
-							bAdd |= Value.IsEmpty() != OtherValue.IsEmpty();
+							continue;
 						}
-						return OtherValue.ToFloat();
-					};
-					
-					// Note: if bComputeNormals = false, could be faster by not computing other values once bAdd = true
-					const float GradientX = GetOtherValue(EVoxelDirectionFlag::XMax, 1, 0, 0) - GetOtherValue(EVoxelDirectionFlag::XMin, -1, 0, 0);
-					const float GradientY = GetOtherValue(EVoxelDirectionFlag::YMax, 0, 1, 0) - GetOtherValue(EVoxelDirectionFlag::YMin, 0, -1, 0);
-					const float GradientZ = GetOtherValue(EVoxelDirectionFlag::ZMax, 0, 0, 1) - GetOtherValue(EVoxelDirectionFlag::ZMin, 0, 0, -1);
-
-					if (bAdd)
-					{
-						FVector Normal;
-						if (bComputeNormals_Static)
+
+						bool bAdd = false;
+						const auto GetOtherValue = [&](uint8 Direction, int32 Offset)
 						{
-							Normal = FVector(GradientX, GradientY, GradientZ).GetSafeNormal();
-						}
-						else
+							if (!bComputeNormals_Static && bAdd)
+							{
+								// Result is only used for the normal
+								return 0.f;
+							}
+							
+							const FVoxelValue OtherValue = Values.GetData()[Index + Offset];
+							if (!DirectionMask || (!Value.IsEmpty() && (Direction & DirectionMask)))
+							{
+								bAdd |= Value.IsEmpty() != OtherValue.IsEmpty();
+							}
+							return OtherValue.ToFloat();
+						};
+
+						const int32 OffsetY = Size.X;
+						const int32 OffsetZ = Size.X * Size.Y;
+						
+						const float GradientX = GetOtherValue(EVoxelDirectionFlag::XMax, 1) - GetOtherValue(EVoxelDirectionFlag::XMin, -1);
+						const float GradientY = GetOtherValue(EVoxelDirectionFlag::YMax, OffsetY) - GetOtherValue(EVoxelDirectionFlag::YMin, -OffsetY);
+						const float GradientZ = GetOtherValue(EVoxelDirectionFlag::ZMax, OffsetZ) - GetOtherValue(EVoxelDirectionFlag::ZMin, -OffsetZ);
+
+						if (bAdd)
 						{
-							Normal = FVector(ForceInit);
+							FVector Normal;
+							if (bComputeNormals_Static)
+							{
+								Normal = FVector(GradientX, GradientY, GradientZ).GetSafeNormal();
+							}
+							else
+							{
+								Normal = FVector(ForceInit);
+							}
+							OutVoxels.Add({ Bounds.Min + FIntVector(X, Y, Z), Normal, Value.ToFloat() });
 						}
-						OutVoxels.Add({ Bounds.Min + FIntVector(X, Y, Z), Normal, Value.ToFloat() });
 					}
 				}
 			}
-		}
+		}, !bMultiThreaded);
 	});
 
-	FVoxelSurfaceEditsVoxels EditsVoxels;
-	EditsVoxels.Info.bHasValues = true;
-	EditsVoxels.Info.bHasNormals = bComputeNormals_Dynamic;
+	TArray<FVoxelSurfaceEditsVoxelBase> OutVoxels;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Merge slices");
+		
+		int32 NumVoxels = 0;
+		for (auto& Slice : SliceVoxels)
+		{
+			NumVoxels += Slice.Num();
+		}
+		OutVoxels.Reserve(NumVoxels);
+		for (auto& Slice : SliceVoxels)
+		{
+			OutVoxels.Append(Slice);
+		}
+	}
 
 	EditsVoxels.Voxels = MakeVoxelSharedCopy(MoveTemp(OutVoxels));
 	
@@ -154,6 +283,7 @@ FVoxelSurfaceEditsVoxels UVoxelSurfaceTools::FindSurfaceVoxelsImpl(
 }
 
 template VOXEL_API FVoxelSurfaceEditsVoxels UVoxelSurfaceTools::FindSurfaceVoxelsImpl<0>(FVoxelData&, const FVoxelIntBox&, bool, bool);
+template VOXEL_API FVoxelSurfaceEditsVoxels UVoxelSurfaceTools::FindSurfaceVoxelsImpl<EVoxelDirectionFlag::ZMax>(FVoxelData&, const FVoxelIntBox&, bool, bool);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -180,8 +310,8 @@ FVoxelSurfaceEditsVoxels UVoxelSurfaceTools::FindSurfaceVoxelsFromDistanceFieldI
 	TArray<float> Distances;
 	TArray<FVector3f> SurfacePositions;
 	FVoxelDistanceFieldUtilities::GetSurfacePositionsFromDensities(Size, Values, Distances, SurfacePositions);
-	FVoxelDistanceFieldUtilities::JumpFlood(Size, SurfacePositions, ComputeDevice);
-	FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(Size, SurfacePositions, Distances);
+	FVoxelDistanceFieldUtilities::JumpFlood(Size, SurfacePositions, ComputeDevice, bMultiThreaded);
+	FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(Size, SurfacePositions, Distances, bMultiThreaded);
 	
 	VOXEL_ASYNC_SCOPE_COUNTER("Create OutVoxels");
 	TArray<FVoxelSurfaceEditsVoxelBase> OutVoxels;
@@ -0,0 +1,188 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelTools/VoxelSurfaceTools.h"
+#include "VoxelData/VoxelDataIncludes.h"
+#include "VoxelDirection.h"
+#include "VoxelWorld.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+// Checks FindSurfaceVoxelsImpl against the previous implementation, and compares their timings
+namespace FVoxelSurfaceToolsBenchmark
+{
+	// FindSurfaceVoxelsImpl before it was made cache friendly and parallel: X outermost, every neighbor sampled
+	template<uint8 DirectionMask>
+	TArray<FVoxelSurfaceEditsVoxelBase> FindSurfaceVoxelsReference(FVoxelData& Data, const FVoxelIntBox& Bounds, bool bComputeNormals, bool bOnlyOutputNonEmptyVoxels)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FIntVector Size = Bounds.Size();
+		const TArray<FVoxelValue> Values = Data.GetValues(Bounds);
+
+		const auto GetValue = [&](int32 X, int32 Y, int32 Z)
+		{
+			return Values.GetData()[X + Y * Size.X + Z * Size.X * Size.Y];
+		};
+
+		TArray<FVoxelSurfaceEditsVoxelBase> OutVoxels;
+		for (int32 X = 1; X < Size.X - 1; X++)
+		{
+			for (int32 Y = 1; Y < Size.Y - 1; Y++)
+			{
+				for (int32 Z = 1; Z < Size.Z - 1; Z++)
+				{
+					const FVoxelValue Value = GetValue(X, Y, Z);
+					if (bOnlyOutputNonEmptyVoxels && Value.IsEmpty())
+					{
+						continue;
+					}
+
+					bool bAdd = false;
+					const auto GetOtherValue = [&](uint8 Direction, int32 DX, int32 DY, int32 DZ)
+					{
+						const FVoxelValue OtherValue = GetValue(X + DX, Y + DY, Z + DZ);
+						if (!DirectionMask || (!Value.IsEmpty() && (Direction & DirectionMask)))
+						{
+							bAdd |= Value.IsEmpty() != OtherValue.IsEmpty();
+						}
+						return OtherValue.ToFloat();
+					};
+
+					const float GradientX = GetOtherValue(EVoxelDirectionFlag::XMax, 1, 0, 0) - GetOtherValue(EVoxelDirectionFlag::XMin, -1, 0, 0);
+					const float GradientY = GetOtherValue(EVoxelDirectionFlag::YMax, 0, 1, 0) - GetOtherValue(EVoxelDirectionFlag::YMin, 0, -1, 0);
+					const float GradientZ = GetOtherValue(EVoxelDirectionFlag::ZMax, 0, 0, 1) - GetOtherValue(EVoxelDirectionFlag::ZMin, 0, 0, -1);
+
+					if (bAdd)
+					{
+						const FVector Normal = bComputeNormals ? FVector(GradientX, GradientY, GradientZ).GetSafeNormal() : FVector(ForceInit);
+						OutVoxels.Add({ Bounds.Min + FIntVector(X, Y, Z), Normal, Value.ToFloat() });
+					}
+				}
+			}
+		}
+		return OutVoxels;
+	}
+
+	// The implementations output the voxels in different orders
+	void SortVoxels(TArray<FVoxelSurfaceEditsVoxelBase>& Voxels)
+	{
+		Voxels.Sort([](const FVoxelSurfaceEditsVoxelBase& A, const FVoxelSurfaceEditsVoxelBase& B)
+		{
+			if (A.Position.X != B.Position.X) return A.Position.X < B.Position.X;
+			if (A.Position.Y != B.Position.Y) return A.Position.Y < B.Position.Y;
+			return A.Position.Z < B.Position.Z;
+		});
+	}
+
+	// Returns the number of voxels that differ
+	int32 Compare(TArray<FVoxelSurfaceEditsVoxelBase> Voxels, TArray<FVoxelSurfaceEditsVoxelBase> ReferenceVoxels)
+	{
+		SortVoxels(Voxels);
+		SortVoxels(ReferenceVoxels);
+
+		int32 NumDifferent = FMath::Abs(Voxels.Num() - ReferenceVoxels.Num());
+		for (int32 Index = 0; Index < FMath::Min(Voxels.Num(), ReferenceVoxels.Num()); Index++)
+		{
+			const FVoxelSurfaceEditsVoxelBase& Voxel = Voxels[Index];
+			const FVoxelSurfaceEditsVoxelBase& ReferenceVoxel = ReferenceVoxels[Index];
+			NumDifferent +=
+				Voxel.Position != ReferenceVoxel.Position ||
+				Voxel.Value != ReferenceVoxel.Value ||
+				Voxel.Normal != ReferenceVoxel.Normal;
+		}
+		return NumDifferent;
+	}
+
+	template<uint8 DirectionMask>
+	void RunCase(FVoxelData& Data, const FVoxelIntBox& Bounds, bool bComputeNormals, bool bOnlyOutputNonEmptyVoxels, int32 Iterations, bool& bOutFailed)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TArray<FVoxelSurfaceEditsVoxelBase> Voxels;
+		TArray<FVoxelSurfaceEditsVoxelBase> ReferenceVoxels;
+
+		double Time = 0;
+		double ReferenceTime = 0;
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				Voxels = *UVoxelSurfaceTools::FindSurfaceVoxelsImpl<DirectionMask>(Data, Bounds, bComputeNormals, bOnlyOutputNonEmptyVoxels).Voxels;
+				Time += FPlatformTime::Seconds() - StartTime;
+			}
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				ReferenceVoxels = FindSurfaceVoxelsReference<DirectionMask>(Data, Bounds, bComputeNormals, bOnlyOutputNonEmptyVoxels);
+				ReferenceTime += FPlatformTime::Seconds() - StartTime;
+			}
+		}
+		Time /= Iterations;
+		ReferenceTime /= Iterations;
+
+		const int32 NumDifferent = Compare(Voxels, ReferenceVoxels);
+		bOutFailed |= NumDifferent > 0;
+
+		const FIntVector Size = Bounds.Size();
+		LOG_VOXEL(Log, TEXT("%dx%dx%d, direction mask %d, normals %d, only non empty %d: %d voxels. New: %.2fms. Previous: %.2fms. Speedup: %.2fx. %s"),
+			Size.X,
+			Size.Y,
+			Size.Z,
+			DirectionMask,
+			bComputeNormals,
+			bOnlyOutputNonEmptyVoxels,
+			Voxels.Num(),
+			Time * 1000,
+			ReferenceTime * 1000,
+			Time > 0 ? ReferenceTime / Time : 0,
+			NumDifferent > 0 ? *FString::Printf(TEXT("FAILED: %d voxels differ"), NumDifferent) : TEXT("Identical"));
+	}
+
+	void Run(AVoxelWorld& World, const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3;
+
+		FVoxelData& Data = World.GetData();
+
+		bool bFailed = false;
+		for (const int32 Size : { 128, 256 })
+		{
+			// Centered on the world origin, where most generators have a surface
+			const FVoxelIntBox Bounds(FIntVector(-Size / 2), FIntVector(Size / 2));
+
+			FVoxelReadScopeLock Lock(Data, Bounds, FUNCTION_FNAME);
+			for (const bool bComputeNormals : { false, true })
+			{
+				for (const bool bOnlyOutputNonEmptyVoxels : { false, true })
+				{
+					RunCase<0>(Data, Bounds, bComputeNormals, bOnlyOutputNonEmptyVoxels, Iterations, bFailed);
+				}
+			}
+			// Used by FlattenSurface
+			RunCase<EVoxelDirectionFlag::ZMax>(Data, Bounds, true, false, Iterations, bFailed);
+		}
+
+		if (bFailed)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.surface.Benchmark: FindSurfaceVoxelsImpl output differs from the previous implementation"));
+		}
+	}
+}
+
+// eg: voxel.surface.Benchmark 5
+static FAutoConsoleCommandWithWorldAndArgs SurfaceToolsBenchmarkCmd(
+	TEXT("voxel.surface.Benchmark"),
+	TEXT("Find the surface voxels of 128^3 and 256^3 boxes at the origin of all the voxel worlds in the scene, check the result against the previous implementation and log the timings of both. Args: [Iterations = 3]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			if (It->IsCreated())
+			{
+				FVoxelSurfaceToolsBenchmark::Run(**It, Args);
+			}
+		}
+	}));
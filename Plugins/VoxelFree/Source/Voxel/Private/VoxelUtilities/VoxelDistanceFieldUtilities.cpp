@@ -7,6 +7,12 @@
 
 #include "Async/ParallelFor.h"
 
+static TAutoConsoleVariable<int32> CVarUseExactCPUDistanceTransform(
+	TEXT("voxel.distancefield.UseExactCPUTransform"),
+	0,
+	TEXT("If true, CPU distance fields will be computed using an exact separable distance transform instead of jump flooding"),
+	ECVF_Default);
+
 FColor FVoxelDistanceFieldUtilities::GetDistanceFieldColor(float Value)
 {
 	// Credit for this snippet goes to Inigo Quilez
@@ -39,57 +45,69 @@ void FVoxelDistanceFieldUtilities::JumpFlood(const FIntVector& Size, TArray<FVec
 
 		InOutSurfacePositions = MoveTemp(*DataPtr);
 	}
+	else if (CVarUseExactCPUDistanceTransform.GetValueOnAnyThread() != 0)
+	{
+		ExactDistanceTransform_CPU(Size, InOutSurfacePositions, bMultiThreaded);
+	}
 	else
 	{
-		bool bUseTempAsSrc = false;
-		
-		TArray<FVector3f> Temp;
-		Temp.Empty(InOutSurfacePositions.Num());
-		Temp.SetNumUninitialized(InOutSurfacePositions.Num());
-		
-		const int32 PowerOfTwo = FMath::CeilLogTwo(Size.GetMax());
-		for (int32 Pass = 0; Pass < PowerOfTwo; Pass++)
-		{
-			if (MaxPasses_Debug == Pass)
-			{
-				break;
-			}
-			
-			// -1: we want to start with half the size
-			const int32 Step = 1 << (PowerOfTwo - 1 - Pass);
-			JumpFloodStep_CPU(
-				Size, 
-				bUseTempAsSrc ? Temp : InOutSurfacePositions,
-				bUseTempAsSrc ? InOutSurfacePositions : Temp,
-				Step,
-				bMultiThreaded);
-
-			bUseTempAsSrc = !bUseTempAsSrc;
-		}
+		JumpFlood_CPU(Size, InOutSurfacePositions, bMultiThreaded, MaxPasses_Debug);
+	}
+}
 
-		if (bUseTempAsSrc)
+void FVoxelDistanceFieldUtilities::JumpFlood_CPU(const FIntVector& Size, TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded, int32 MaxPasses_Debug)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	bool bUseTempAsSrc = false;
+	
+	TArray<FVector3f> Temp;
+	Temp.Empty(InOutSurfacePositions.Num());
+	Temp.SetNumUninitialized(InOutSurfacePositions.Num());
+	
+	const int32 PowerOfTwo = FMath::CeilLogTwo(Size.GetMax());
+	for (int32 Pass = 0; Pass < PowerOfTwo; Pass++)
+	{
+		if (MaxPasses_Debug == Pass)
 		{
-			InOutSurfacePositions = MoveTemp(Temp);
+			break;
 		}
+		
+		// -1: we want to start with half the size
+		const int32 Step = 1 << (PowerOfTwo - 1 - Pass);
+		JumpFloodStep_CPU(
+			Size, 
+			bUseTempAsSrc ? Temp : InOutSurfacePositions,
+			bUseTempAsSrc ? InOutSurfacePositions : Temp,
+			Step,
+			bMultiThreaded);
+
+		bUseTempAsSrc = !bUseTempAsSrc;
+	}
+
+	if (bUseTempAsSrc)
+	{
+		InOutSurfacePositions = MoveTemp(Temp);
 	}
 }
 
-void FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector3f> SurfacePositions, TArrayView<float> InOutDistances)
+void FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector3f> SurfacePositions, TArrayView<float> InOutDistances, bool bMultiThreaded)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 	
 	check(SurfacePositions.Num() == InOutDistances.Num());
 	check(SurfacePositions.Num() == Size.X * Size.Y * Size.Z);
 	
-	for (int32 X = 0; X < Size.X; X++)
+	ParallelFor(Size.Z, [&](int32 Z)
 	{
 		for (int32 Y = 0; Y < Size.Y; Y++)
 		{
-			for (int32 Z = 0; Z < Size.Z; Z++)
+			const int32 RowIndex = FVoxelUtilities::Get3DIndex(Size, 0, Y, Z);
+			for (int32 X = 0; X < Size.X; X++)
 			{
-				float& Distance = FVoxelUtilities::Get3D(InOutDistances, Size, X, Y, Z);
+				float& Distance = FVoxelUtilities::Get(InOutDistances, RowIndex + X);
 
-				const FVector3f SurfacePosition = FVoxelUtilities::Get3D(SurfacePositions, Size, X, Y, Z);
+				const FVector3f SurfacePosition = FVoxelUtilities::Get(SurfacePositions, RowIndex + X);
 				ensureVoxelSlow(IsSurfacePositionValid(SurfacePosition));
 				
 				// Keep sign
@@ -97,7 +115,7 @@ void FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(const FIntVe
 				ensureVoxelSlow(FMath::Abs(Distance) < Size.Size() * 2);
 			}
 		}
-	}
+	}, !bMultiThreaded);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -135,7 +153,8 @@ void FVoxelDistanceFieldUtilities::DownSample(
 	TArrayView<float> OutDistances, 
 	TArrayView<FVector3f> OutSurfacePositions, 
 	int32 Divisor,
-	bool bShrink)
+	bool bShrink,
+	bool bMultiThreaded)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 	
@@ -145,11 +164,11 @@ void FVoxelDistanceFieldUtilities::DownSample(
 
 	const FIntVector LowSize = FVoxelUtilities::DivideCeil(Size, Divisor);
 
-	for (int32 LowX = 0; LowX < LowSize.X; LowX++)
+	ParallelFor(LowSize.Z, [&](int32 LowZ)
 	{
 		for (int32 LowY = 0; LowY < LowSize.Y; LowY++)
 		{
-			for (int32 LowZ = 0; LowZ < LowSize.Z; LowZ++)
+			for (int32 LowX = 0; LowX < LowSize.X; LowX++)
 			{
 				float BestDistance = MAX_flt;
 				FVector3f BestSurfacePosition = MakeInvalidSurfacePosition();
@@ -183,7 +202,7 @@ void FVoxelDistanceFieldUtilities::DownSample(
 				FVoxelUtilities::Get3D(OutDistances, LowSize, LowX, LowY, LowZ) = Sign;
 			}
 		}
-	}
+	}, !bMultiThreaded);
 }
 
 void FVoxelDistanceFieldUtilities::DownSample(
@@ -191,7 +210,8 @@ void FVoxelDistanceFieldUtilities::DownSample(
 	TArray<float>& Distances,
 	TArray<FVector3f>& SurfacePositions,
 	int32 Divisor,
-	bool bShrink)
+	bool bShrink,
+	bool bMultiThreaded)
 {
 	ensure(Divisor >= 1);
 	if (Divisor <= 1)
@@ -210,7 +230,7 @@ void FVoxelDistanceFieldUtilities::DownSample(
 	NewSurfacePositions.Empty(NewSize);
 	NewSurfacePositions.SetNumUninitialized(NewSize);
 
-	DownSample(Size, Distances, SurfacePositions, NewDistances, NewSurfacePositions, Divisor, bShrink);
+	DownSample(Size, Distances, SurfacePositions, NewDistances, NewSurfacePositions, Divisor, bShrink, bMultiThreaded);
 
 	Size = LowSize;
 	Distances = MoveTemp(NewDistances);
@@ -227,64 +247,181 @@ void FVoxelDistanceFieldUtilities::JumpFloodStep_CPU(const FIntVector& Size, TAr
 
 	check(InData.Num() == OutData.Num());
 	check(InData.Num() == Size.X * Size.Y * Size.Z);
-	
-	const auto DoWork = [&](int32 X)
+
+	// Each Z slab is independent: rows are processed X-contiguous, one neighbor row at a time,
+	// so that the inner loop has no bound checks nor branches and can be vectorized.
+	// Invalid surface positions don't need to be skipped: they are so far away that any valid position will be closer,
+	// and if there's none we'll end up with an invalid position anyways.
+	// Neighbors are visited in DX, DY, DZ order, ties between equidistant positions going to the first one
+	ParallelFor(Size.Z, [&](int32 Z)
 	{
+		TArray<float> BestDistances;
+		BestDistances.SetNumUninitialized(Size.X);
+
 		for (int32 Y = 0; Y < Size.Y; Y++)
 		{
-			for (int32 Z = 0; Z < Size.Z; Z++)
+			float* RESTRICT const BestDistancesRow = BestDistances.GetData();
+			FVector3f* RESTRICT const OutRow = &FVoxelUtilities::Get(OutData, FVoxelUtilities::Get3DIndex(Size, 0, Y, Z));
+
+			for (int32 X = 0; X < Size.X; X++)
 			{
-				const FIntVector Position(X, Y, Z);
+				BestDistancesRow[X] = MAX_flt;
+				OutRow[X] = MakeInvalidSurfacePosition();
+			}
 
-				float BestDistance = MAX_flt;
-				FVector3f BestSurfacePosition = MakeInvalidSurfacePosition();
+			for (int32 DX = -1; DX <= 1; DX++)
+			{
+				const int32 Offset = DX * Step;
+				const int32 StartX = FMath::Max(0, -Offset);
+				const int32 EndX = FMath::Min(Size.X, Size.X - Offset);
 
-				for (int32 DX = -1; DX <= 1; ++DX)
+				for (int32 DY = -1; DY <= 1; DY++)
 				{
-					for (int32 DY = -1; DY <= 1; ++DY)
+					const int32 NeighborY = Y + DY * Step;
+					if (NeighborY < 0 || NeighborY >= Size.Y)
 					{
-						for (int32 DZ = -1; DZ <= 1; ++DZ)
+						continue;
+					}
+
+					for (int32 DZ = -1; DZ <= 1; DZ++)
+					{
+						const int32 NeighborZ = Z + DZ * Step;
+						if (NeighborZ < 0 || NeighborZ >= Size.Z)
 						{
-							const FIntVector NeighborPosition = Position + FIntVector(DX, DY, DZ) * Step;
-
-							if (NeighborPosition.X < 0 ||
-								NeighborPosition.Y < 0 ||
-								NeighborPosition.Z < 0 ||
-								NeighborPosition.X >= Size.X ||
-								NeighborPosition.Y >= Size.Y ||
-								NeighborPosition.Z >= Size.Z)
-							{
-								continue;
-							}
+							continue;
+						}
 
-							const FVector3f NeighborSurfacePosition = FVoxelUtilities::Get3D(InData, Size, NeighborPosition);
+						const FVector3f* RESTRICT const InRow = &FVoxelUtilities::Get(InData, FVoxelUtilities::Get3DIndex(Size, 0, NeighborY, NeighborZ));
 
-							if (IsSurfacePositionValid(NeighborSurfacePosition))
-							{
-								const float Distance = (NeighborSurfacePosition - FVector3f(Position)).SizeSquared();
-								if (Distance < BestDistance)
-								{
-									BestDistance = Distance;
-									BestSurfacePosition = NeighborSurfacePosition;
-								}
-							}
+						for (int32 X = StartX; X < EndX; X++)
+						{
+							const FVector3f NeighborSurfacePosition = InRow[X + Offset];
+
+							const float DistanceX = NeighborSurfacePosition.X - X;
+							const float DistanceY = NeighborSurfacePosition.Y - Y;
+							const float DistanceZ = NeighborSurfacePosition.Z - Z;
+							const float Distance = DistanceX * DistanceX + DistanceY * DistanceY + DistanceZ * DistanceZ;
+
+							const bool bIsCloser = Distance < BestDistancesRow[X];
+							BestDistancesRow[X] = bIsCloser ? Distance : BestDistancesRow[X];
+							OutRow[X] = bIsCloser ? NeighborSurfacePosition : OutRow[X];
 						}
 					}
 				}
-				FVoxelUtilities::Get3D(OutData, Size, Position) = BestSurfacePosition;
 			}
 		}
-	};
+	}, !bMultiThreaded);
+}
 
-	if (bMultiThreaded)
+void FVoxelDistanceFieldUtilities::ExactDistanceTransform_CPU(const FIntVector& Size, TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const int32 Num = Size.X * Size.Y * Size.Z;
+	check(InOutSurfacePositions.Num() == Num);
+
+	// Large enough to never be reached, small enough to not overflow when subtracting
+	constexpr float Infinity = 1e20f;
+	
+	// Squared distance to the closest seed along the axes processed so far, and the index of that seed
+	// Seeds are the voxels with a valid surface position
+	TArray<float> Distances;
+	TArray<int32> Seeds;
+	Distances.SetNumUninitialized(Num);
+	Seeds.SetNumUninitialized(Num);
+
+	for (int32 Index = 0; Index < Num; Index++)
 	{
-		ParallelFor(Size.X, DoWork);
+		const bool bIsSeed = IsSurfacePositionValid(InOutSurfacePositions[Index]);
+		Distances[Index] = bIsSeed ? 0.f : Infinity;
+		Seeds[Index] = bIsSeed ? Index : -1;
 	}
-	else
+
+	// Felzenszwalb & Huttenlocher lower envelope of parabolas, applied along each axis
+	const auto DoPass = [&](int32 Axis)
 	{
-		for (int32 X = 0; X < Size.X; X++)
+		VOXEL_ASYNC_SCOPE_COUNTER("Pass");
+		
+		const int32 Length = Size[Axis];
+		const int32 Stride = Axis == 0 ? 1 : Axis == 1 ? Size.X : Size.X * Size.Y;
+		
+		// The two other axes: the outer one is split across threads
+		const int32 InnerAxis = Axis == 0 ? 1 : 0;
+		const int32 OuterAxis = Axis == 2 ? 1 : 2;
+
+		ParallelFor(Size[OuterAxis], [&](int32 Outer)
 		{
-			DoWork(X);
-		}
-	}
-}
\ No newline at end of file
+			TArray<float> LineDistances;
+			TArray<int32> LineSeeds;
+			TArray<int32> Vertices;
+			TArray<float> Boundaries;
+			LineDistances.SetNumUninitialized(Length);
+			LineSeeds.SetNumUninitialized(Length);
+			Vertices.SetNumUninitialized(Length);
+			Boundaries.SetNumUninitialized(Length + 1);
+
+			for (int32 Inner = 0; Inner < Size[InnerAxis]; Inner++)
+			{
+				FIntVector Start(ForceInit);
+				Start[OuterAxis] = Outer;
+				Start[InnerAxis] = Inner;
+				const int32 StartIndex = FVoxelUtilities::Get3DIndex(Size, Start);
+				
+				for (int32 Q = 0; Q < Length; Q++)
+				{
+					LineDistances[Q] = Distances[StartIndex + Q * Stride];
+					LineSeeds[Q] = Seeds[StartIndex + Q * Stride];
+				}
+
+				const auto Intersection = [&](int32 Q, int32 V)
+				{
+					return ((LineDistances[Q] + Q * Q) - (LineDistances[V] + V * V)) / float(2 * Q - 2 * V);
+				};
+
+				int32 K = 0;
+				Vertices[0] = 0;
+				Boundaries[0] = -Infinity;
+				Boundaries[1] = Infinity;
+				for (int32 Q = 1; Q < Length; Q++)
+				{
+					float S = Intersection(Q, Vertices[K]);
+					while (K > 0 && S <= Boundaries[K])
+					{
+						K--;
+						S = Intersection(Q, Vertices[K]);
+					}
+					K++;
+					Vertices[K] = Q;
+					Boundaries[K] = S;
+					Boundaries[K + 1] = Infinity;
+				}
+
+				K = 0;
+				for (int32 Q = 0; Q < Length; Q++)
+				{
+					while (Boundaries[K + 1] < Q)
+					{
+						K++;
+					}
+					const int32 V = Vertices[K];
+					Distances[StartIndex + Q * Stride] = FMath::Min(Infinity, FMath::Square(float(Q - V)) + LineDistances[V]);
+					Seeds[StartIndex + Q * Stride] = LineSeeds[V];
+				}
+			}
+		}, !bMultiThreaded);
+	};
+
+	DoPass(0);
+	DoPass(1);
+	DoPass(2);
+
+	// The transform is exact for the seed voxels: the final positions are the surface positions of these seeds
+	const TArray<FVector3f> SeedSurfacePositions = MoveTemp(InOutSurfacePositions);
+	InOutSurfacePositions.SetNumUninitialized(Num);
+	
+	ParallelFor(Num, [&](int32 Index)
+	{
+		const int32 Seed = Seeds[Index];
+		InOutSurfacePositions[Index] = Seed == -1 ? MakeInvalidSurfacePosition() : SeedSurfacePositions[Seed];
+	}, !bMultiThreaded);
+}
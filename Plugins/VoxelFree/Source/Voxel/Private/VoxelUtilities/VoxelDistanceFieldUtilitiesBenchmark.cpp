@@ -0,0 +1,408 @@
+// Copyright 2020 Phyronnaz
+
+#include "CoreMinimal.h"
+#include "VoxelUtilities/VoxelDistanceFieldUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+// Checks the CPU distance field passes against their previous implementations and the multithreaded passes against the single threaded ones,
+// compares their timings, and reports the error of the jump flood against the exact transform
+class FVoxelDistanceFieldUtilitiesBenchmark
+{
+public:
+	// JumpFloodStep_CPU before it was made X-contiguous and parallel over Z: X outermost, neighbors visited in DX, DY, DZ order
+	static void JumpFloodStepReference(const FIntVector& Size, TArrayView<const FVector3f> InData, TArrayView<FVector3f> OutData, int32 Step, bool bMultiThreaded)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const auto DoWork = [&](int32 X)
+		{
+			for (int32 Y = 0; Y < Size.Y; Y++)
+			{
+				for (int32 Z = 0; Z < Size.Z; Z++)
+				{
+					const FIntVector Position(X, Y, Z);
+
+					float BestDistance = MAX_flt;
+					FVector3f BestSurfacePosition = FVoxelDistanceFieldUtilities::MakeInvalidSurfacePosition();
+
+					for (int32 DX = -1; DX <= 1; ++DX)
+					{
+						for (int32 DY = -1; DY <= 1; ++DY)
+						{
+							for (int32 DZ = -1; DZ <= 1; ++DZ)
+							{
+								const FIntVector NeighborPosition = Position + FIntVector(DX, DY, DZ) * Step;
+
+								if (NeighborPosition.X < 0 ||
+									NeighborPosition.Y < 0 ||
+									NeighborPosition.Z < 0 ||
+									NeighborPosition.X >= Size.X ||
+									NeighborPosition.Y >= Size.Y ||
+									NeighborPosition.Z >= Size.Z)
+								{
+									continue;
+								}
+
+								const FVector3f NeighborSurfacePosition = FVoxelUtilities::Get3D(InData, Size, NeighborPosition);
+
+								if (FVoxelDistanceFieldUtilities::IsSurfacePositionValid(NeighborSurfacePosition))
+								{
+									const float Distance = (NeighborSurfacePosition - FVector3f(Position)).SizeSquared();
+									if (Distance < BestDistance)
+									{
+										BestDistance = Distance;
+										BestSurfacePosition = NeighborSurfacePosition;
+									}
+								}
+							}
+						}
+					}
+					FVoxelUtilities::Get3D(OutData, Size, Position) = BestSurfacePosition;
+				}
+			}
+		};
+
+		if (bMultiThreaded)
+		{
+			ParallelFor(Size.X, DoWork);
+		}
+		else
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				DoWork(X);
+			}
+		}
+	}
+
+	static void JumpFloodReference(const FIntVector& Size, TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		bool bUseTempAsSrc = false;
+
+		TArray<FVector3f> Temp;
+		Temp.SetNumUninitialized(InOutSurfacePositions.Num());
+
+		const int32 PowerOfTwo = FMath::CeilLogTwo(Size.GetMax());
+		for (int32 Pass = 0; Pass < PowerOfTwo; Pass++)
+		{
+			const int32 Step = 1 << (PowerOfTwo - 1 - Pass);
+			JumpFloodStepReference(
+				Size,
+				bUseTempAsSrc ? Temp : InOutSurfacePositions,
+				bUseTempAsSrc ? InOutSurfacePositions : Temp,
+				Step,
+				bMultiThreaded);
+
+			bUseTempAsSrc = !bUseTempAsSrc;
+		}
+
+		if (bUseTempAsSrc)
+		{
+			InOutSurfacePositions = MoveTemp(Temp);
+		}
+	}
+
+	// Previous GetDistancesFromSurfacePositions: single threaded, X outermost
+	static void GetDistancesFromSurfacePositionsReference(const FIntVector& Size, TArrayView<const FVector3f> SurfacePositions, TArrayView<float> InOutDistances)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			for (int32 Y = 0; Y < Size.Y; Y++)
+			{
+				for (int32 Z = 0; Z < Size.Z; Z++)
+				{
+					float& Distance = FVoxelUtilities::Get3D(InOutDistances, Size, X, Y, Z);
+
+					const FVector3f SurfacePosition = FVoxelUtilities::Get3D(SurfacePositions, Size, X, Y, Z);
+
+					// Keep sign
+					Distance = FVector3f::Distance(FVector3f(X, Y, Z), SurfacePosition) * FMath::Sign(Distance);
+				}
+			}
+		}
+	}
+
+	// Previous DownSample: single threaded, LowX outermost
+	static void DownSampleReference(
+		const FIntVector& Size,
+		TArrayView<const float> InDistances,
+		TArrayView<const FVector3f> InSurfacePositions,
+		TArrayView<float> OutDistances,
+		TArrayView<FVector3f> OutSurfacePositions,
+		int32 Divisor)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FIntVector LowSize = FVoxelUtilities::DivideCeil(Size, Divisor);
+
+		for (int32 LowX = 0; LowX < LowSize.X; LowX++)
+		{
+			for (int32 LowY = 0; LowY < LowSize.Y; LowY++)
+			{
+				for (int32 LowZ = 0; LowZ < LowSize.Z; LowZ++)
+				{
+					float BestDistance = MAX_flt;
+					FVector3f BestSurfacePosition = FVoxelDistanceFieldUtilities::MakeInvalidSurfacePosition();
+					float Sign = FVoxelUtilities::Get3D(InDistances, Size, LowX * Divisor, LowY * Divisor, LowZ * Divisor);
+
+					for (int32 HighX = LowX * Divisor; HighX < FMath::Min(Size.X, (LowX + 1) * Divisor); HighX++)
+					{
+						for (int32 HighY = LowY * Divisor; HighY < FMath::Min(Size.Y, (LowY + 1) * Divisor); HighY++)
+						{
+							for (int32 HighZ = LowZ * Divisor; HighZ < FMath::Min(Size.Z, (LowZ + 1) * Divisor); HighZ++)
+							{
+								FVector3f NeighborSurfacePosition = FVoxelUtilities::Get3D(InSurfacePositions, Size, HighX, HighY, HighZ);
+
+								if (FVoxelDistanceFieldUtilities::IsSurfacePositionValid(NeighborSurfacePosition))
+								{
+									NeighborSurfacePosition /= Divisor;
+									const float Distance = (NeighborSurfacePosition - FVector3f(LowX, LowY, LowZ)).SizeSquared();
+									if (Distance < BestDistance)
+									{
+										BestDistance = Distance;
+										BestSurfacePosition = NeighborSurfacePosition;
+										Sign = FVoxelUtilities::Get3D(InDistances, Size, HighX, HighY, HighZ);
+									}
+								}
+							}
+						}
+					}
+
+					FVoxelUtilities::Get3D(OutSurfacePositions, LowSize, LowX, LowY, LowZ) = BestSurfacePosition;
+					FVoxelUtilities::Get3D(OutDistances, LowSize, LowX, LowY, LowZ) = Sign;
+				}
+			}
+		}
+	}
+
+	// Wobbly sphere, so that the surface isn't aligned with the voxels
+	static void MakeDistanceField(const FIntVector& Size, TArray<float>& OutDistances, TArray<FVector3f>& OutSurfacePositions)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const FIntVector DensitiesSize = Size + 2;
+		const FVector3f Center = FVector3f(Size) / 2.f;
+		const float Radius = Size.GetMin() / 3.f;
+
+		TArray<float> Densities;
+		Densities.SetNumUninitialized(DensitiesSize.X * DensitiesSize.Y * DensitiesSize.Z);
+		for (int32 Z = 0; Z < DensitiesSize.Z; Z++)
+		{
+			for (int32 Y = 0; Y < DensitiesSize.Y; Y++)
+			{
+				for (int32 X = 0; X < DensitiesSize.X; X++)
+				{
+					const FVector3f Position = FVector3f(X - 1, Y - 1, Z - 1);
+					const float Noise = 4.f * FMath::Sin(Position.X * 0.21f) * FMath::Cos(Position.Y * 0.17f) * FMath::Sin(Position.Z * 0.13f);
+					FVoxelUtilities::Get3D(Densities, DensitiesSize, X, Y, Z) = (Position - Center).Size() - Radius + Noise;
+				}
+			}
+		}
+
+		const int32 Num = Size.X * Size.Y * Size.Z;
+		OutDistances.SetNumUninitialized(Num);
+		OutSurfacePositions.SetNumUninitialized(Num);
+		FVoxelDistanceFieldUtilities::GetSurfacePositionsFromDensities(Size, Densities, OutDistances, OutSurfacePositions);
+	}
+
+	template<typename T>
+	static int32 CountDifferences(const TArray<T>& A, const TArray<T>& B)
+	{
+		int32 NumDifferent = FMath::Abs(A.Num() - B.Num());
+		for (int32 Index = 0; Index < FMath::Min(A.Num(), B.Num()); Index++)
+		{
+			NumDifferent += A[Index] != B[Index];
+		}
+		return NumDifferent;
+	}
+
+	template<typename T, typename TLambda>
+	static double Time(const TArray<T>& Input, TLambda Lambda, TArray<T>& OutResult)
+	{
+		OutResult = Input;
+
+		const double StartTime = FPlatformTime::Seconds();
+		Lambda(OutResult);
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	/**
+	 * Times ReferenceLambda, the previous implementation, and Lambda, single threaded then multithreaded,
+	 * and checks that Lambda outputs the same values as ReferenceLambda single threaded.
+	 * The lambdas are called with a copy of Input, so that allocations aren't timed
+	 */
+	template<typename T, typename TReferenceLambda, typename TLambda>
+	static void TimePass(const TCHAR* Name, const FIntVector& Size, const TArray<T>& Input, TReferenceLambda ReferenceLambda, TLambda Lambda, TArray<T>& OutResult, bool& bOutFailed)
+	{
+		TArray<T> Reference;
+		TArray<T> Result;
+
+		const double ReferenceMultiThreadedTime = Time(Input, [&](TArray<T>& Data) { ReferenceLambda(Data, true); }, Result);
+		const double ReferenceTime = Time(Input, [&](TArray<T>& Data) { ReferenceLambda(Data, false); }, Reference);
+
+		const double SingleThreadedTime = Time(Input, [&](TArray<T>& Data) { Lambda(Data, false); }, Result);
+		int32 NumDifferent = CountDifferences(Reference, Result);
+
+		const double MultiThreadedTime = Time(Input, [&](TArray<T>& Data) { Lambda(Data, true); }, Result);
+		NumDifferent += CountDifferences(Reference, Result);
+
+		bOutFailed |= NumDifferent > 0;
+
+		LOG_VOXEL(Log, TEXT("%dx%dx%d %s: previous: %.2fms single threaded, %.2fms multithreaded. New: %.2fms single threaded, %.2fms multithreaded. Speedup: %.1fx single threaded, %.1fx multithreaded. %s"),
+			Size.X,
+			Size.Y,
+			Size.Z,
+			Name,
+			ReferenceTime * 1000,
+			ReferenceMultiThreadedTime * 1000,
+			SingleThreadedTime * 1000,
+			MultiThreadedTime * 1000,
+			SingleThreadedTime > 0 ? ReferenceTime / SingleThreadedTime : 0,
+			MultiThreadedTime > 0 ? ReferenceMultiThreadedTime / MultiThreadedTime : 0,
+			NumDifferent > 0 ? *FString::Printf(TEXT("FAILED: %d values differ from the previous implementation"), NumDifferent) : TEXT("Identical"));
+
+		OutResult = MoveTemp(Result);
+	}
+
+	static void RunCase(const FIntVector& Size, int32 Divisor, bool& bOutFailed)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TArray<float> Distances;
+		TArray<FVector3f> SurfacePositions;
+		MakeDistanceField(Size, Distances, SurfacePositions);
+
+		// DownSample and GetDistancesFromSurfacePositions used to be single threaded only:
+		// their previous multithreaded timings are of the single threaded code
+		{
+			const FIntVector LowSize = FVoxelUtilities::DivideCeil(Size, Divisor);
+			const int32 LowNum = LowSize.X * LowSize.Y * LowSize.Z;
+
+			TArray<float> LowDistances;
+			TimePass(TEXT("DownSample distances"), Size, TArray<float>(), [&](TArray<float>& OutDistances, bool bMultiThreaded)
+			{
+				TArray<FVector3f> LowSurfacePositions;
+				OutDistances.SetNumUninitialized(LowNum);
+				LowSurfacePositions.SetNumUninitialized(LowNum);
+				DownSampleReference(Size, Distances, SurfacePositions, OutDistances, LowSurfacePositions, Divisor);
+			}, [&](TArray<float>& OutDistances, bool bMultiThreaded)
+			{
+				TArray<FVector3f> LowSurfacePositions;
+				OutDistances.SetNumUninitialized(LowNum);
+				LowSurfacePositions.SetNumUninitialized(LowNum);
+				FVoxelDistanceFieldUtilities::DownSample(Size, Distances, SurfacePositions, OutDistances, LowSurfacePositions, Divisor, false, bMultiThreaded);
+			}, LowDistances, bOutFailed);
+
+			TArray<FVector3f> LowSurfacePositions;
+			TimePass(TEXT("DownSample surface positions"), Size, TArray<FVector3f>(), [&](TArray<FVector3f>& OutSurfacePositions, bool bMultiThreaded)
+			{
+				TArray<float> UnusedDistances;
+				UnusedDistances.SetNumUninitialized(LowNum);
+				OutSurfacePositions.SetNumUninitialized(LowNum);
+				DownSampleReference(Size, Distances, SurfacePositions, UnusedDistances, OutSurfacePositions, Divisor);
+			}, [&](TArray<FVector3f>& OutSurfacePositions, bool bMultiThreaded)
+			{
+				TArray<float> UnusedDistances;
+				UnusedDistances.SetNumUninitialized(LowNum);
+				OutSurfacePositions.SetNumUninitialized(LowNum);
+				FVoxelDistanceFieldUtilities::DownSample(Size, Distances, SurfacePositions, UnusedDistances, OutSurfacePositions, Divisor, false, bMultiThreaded);
+			}, LowSurfacePositions, bOutFailed);
+		}
+
+		TArray<FVector3f> JumpFloodPositions;
+		TimePass(TEXT("JumpFlood"), Size, SurfacePositions, [&](TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded)
+		{
+			JumpFloodReference(Size, InOutSurfacePositions, bMultiThreaded);
+		}, [&](TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded)
+		{
+			FVoxelDistanceFieldUtilities::JumpFlood_CPU(Size, InOutSurfacePositions, bMultiThreaded);
+		}, JumpFloodPositions, bOutFailed);
+
+		// The exact transform has no previous implementation: only check the multithreaded result against the single threaded one
+		TArray<FVector3f> ExactPositions;
+		{
+			TArray<FVector3f> MultiThreadedExactPositions;
+			const double SingleThreadedTime = Time(SurfacePositions, [&](TArray<FVector3f>& Data) { FVoxelDistanceFieldUtilities::ExactDistanceTransform_CPU(Size, Data, false); }, ExactPositions);
+			const double MultiThreadedTime = Time(SurfacePositions, [&](TArray<FVector3f>& Data) { FVoxelDistanceFieldUtilities::ExactDistanceTransform_CPU(Size, Data, true); }, MultiThreadedExactPositions);
+
+			const int32 NumDifferent = CountDifferences(ExactPositions, MultiThreadedExactPositions);
+			bOutFailed |= NumDifferent > 0;
+
+			LOG_VOXEL(Log, TEXT("%dx%dx%d ExactDistanceTransform: %.2fms single threaded, %.2fms multithreaded. %s"),
+				Size.X,
+				Size.Y,
+				Size.Z,
+				SingleThreadedTime * 1000,
+				MultiThreadedTime * 1000,
+				NumDifferent > 0 ? *FString::Printf(TEXT("FAILED: %d values differ between the single threaded and multithreaded results"), NumDifferent) : TEXT("Identical"));
+		}
+
+		TArray<float> JumpFloodDistances;
+		TimePass(TEXT("GetDistancesFromSurfacePositions"), Size, Distances, [&](TArray<float>& InOutDistances, bool bMultiThreaded)
+		{
+			GetDistancesFromSurfacePositionsReference(Size, JumpFloodPositions, InOutDistances);
+		}, [&](TArray<float>& InOutDistances, bool bMultiThreaded)
+		{
+			FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(Size, JumpFloodPositions, InOutDistances, bMultiThreaded);
+		}, JumpFloodDistances, bOutFailed);
+
+		TArray<float> ExactDistances = Distances;
+		FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(Size, ExactPositions, ExactDistances, true);
+
+		// Jump flooding is approximate: report how far it is from the exact transform
+		double MaxError = 0;
+		double SumError = 0;
+		int32 NumWrong = 0;
+		for (int32 Index = 0; Index < ExactDistances.Num(); Index++)
+		{
+			const double Error = FMath::Abs(JumpFloodDistances[Index] - ExactDistances[Index]);
+			MaxError = FMath::Max(MaxError, Error);
+			SumError += Error;
+			NumWrong += Error > 1e-3;
+		}
+
+		LOG_VOXEL(Log, TEXT("%dx%dx%d JumpFlood vs ExactDistanceTransform: %d/%d voxels differ. Mean error: %f voxels. Max error: %f voxels"),
+			Size.X,
+			Size.Y,
+			Size.Z,
+			NumWrong,
+			ExactDistances.Num(),
+			SumError / FMath::Max(1, ExactDistances.Num()),
+			MaxError);
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int32 MaxSize = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 64, 256) : 256;
+		const int32 Divisor = Args.Num() > 1 ? FMath::Max(2, FCString::Atoi(*Args[1])) : 2;
+
+		bool bFailed = false;
+		for (int32 Size = 64; Size <= MaxSize; Size *= 2)
+		{
+			RunCase(FIntVector(Size), Divisor, bFailed);
+		}
+
+		if (bFailed)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.distancefield.Benchmark: results differ from the previous implementation or between single threaded and multithreaded runs"));
+		}
+	}
+};
+
+// eg: voxel.distancefield.Benchmark 128 4
+static FAutoConsoleCommand DistanceFieldBenchmarkCmd(
+	TEXT("voxel.distancefield.Benchmark"),
+	TEXT("Build 64^3 to N^3 distance fields on the CPU single threaded and multithreaded, check the results against the previous implementation and log the timings of DownSample, JumpFlood, ExactDistanceTransform and GetDistancesFromSurfacePositions, along with the jump flood error. Args: [Max size = 256] [DownSample divisor = 2]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelDistanceFieldUtilitiesBenchmark::Run(Args);
+	}));
@@ -3,6 +3,9 @@
 #include "VoxelWorldRootComponent.h"
 #include "VoxelMinimal.h"
 #include "PhysXIncludes.h"
+#if WITH_CHAOS
+#include "Chaos/TriangleMeshImplicitObject.h"
+#endif
 #include "PrimitiveSceneProxy.h"
 #include "Engine/Engine.h"
 #include "Materials/Material.h"
@@ -221,6 +224,23 @@ void UVoxelWorldRootComponent::SetCookedTriMeshes(const TArray<physx::PxTriangle
 
 	UMRMeshComponent::FinishCreatingPhysicsMeshes(BodySetup, {}, {}, TriMeshes);
 }
+#elif WITH_CHAOS
+void UVoxelWorldRootComponent::SetCookedTriMeshes(const TArray<TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>>& TriMeshes)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Create body setup
+	GetBodySetup();
+
+	// Force trimesh collisions off, same as FVoxelAsyncPhysicsCooker_Chaos
+	for (auto& TriMesh : TriMeshes)
+	{
+		TriMesh->SetDoCollide(false);
+	}
+
+	BodySetup->ChaosTriMeshes = TriMeshes;
+	BodySetup->bCreatedPhysicsMeshes = true;
+}
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
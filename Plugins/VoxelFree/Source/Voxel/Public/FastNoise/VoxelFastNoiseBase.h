@@ -200,6 +200,34 @@ private:
 	template<typename T>
 	v_flt FractalRigidMulti_3D_Deriv(T GetNoise, v_flt x, v_flt y, v_flt z, int32 octaves, v_flt& outDx, v_flt& outDy, v_flt& outDz) const;
 
+protected:
+	// Batch versions: evaluate Num points stored as separate X/Y/Z arrays
+	// Octaves are evaluated for a whole block of points at once, so that the fractal type switch is only done once per block
+	// Results are identical to the single point versions, as the operations are done in the same order
+	static constexpr int32 NoiseBatchSize = 64;
+	
+	template<typename T>
+	void Fractal_3D_Batch(T GetNoise, int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out) const;
+	template<typename T>
+	void Fractal_3D_Deriv_Batch(T GetNoise, int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const;
+
+private:
+	// x, y and z are already multiplied by the frequency, and are modified
+	template<typename T>
+	void FractalFBM_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const;
+	template<typename T>
+	void FractalFBM_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const;
+	
+	template<typename T>
+	void FractalBillow_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const;
+	template<typename T>
+	void FractalBillow_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const;
+	
+	template<typename T>
+	void FractalRigidMulti_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const;
+	template<typename T>
+	void FractalRigidMulti_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const;
+
 private:
 	void CalculateFractalBounding(int32 Octaves);
 
@@ -287,4 +315,40 @@ private:
 	FN_FORCEINLINE v_flt Get ## FunctionName ## Fractal_3D_Deriv(v_flt x, v_flt y, v_flt z, v_flt frequency, int32 octaves, v_flt& outDx, v_flt& outDy, v_flt& outDz) const \
 	{ \
 		return This().Fractal_3D_Deriv(FLambda_ ## Single ## FunctionName ## _3D_Deriv { *this }, x, y, z, frequency, octaves, outDx, outDy, outDz); \
-	}
\ No newline at end of file
+	}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define GENERATED_VOXEL_NOISE_FUNCTION_3D_BATCH(FunctionName) \
+	FN_FORCEINLINE void Get ## FunctionName ## _3D_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, v_flt* RESTRICT out) const \
+	{ \
+		for (int32 Index = 0; Index < Num; Index++) \
+		{ \
+			out[Index] = Single ## FunctionName ## _3D(0, x[Index] * frequency, y[Index] * frequency, z[Index] * frequency); \
+		} \
+	}
+
+#define GENERATED_VOXEL_NOISE_FUNCTION_3D_DERIV_BATCH(FunctionName) \
+	FN_FORCEINLINE void Get ## FunctionName ## _3D_Deriv_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const \
+	{ \
+		for (int32 Index = 0; Index < Num; Index++) \
+		{ \
+			out[Index] = Single ## FunctionName ## _3D_Deriv(0, x[Index] * frequency, y[Index] * frequency, z[Index] * frequency, outDx[Index], outDy[Index], outDz[Index]); \
+		} \
+	}
+
+// Must be after the matching GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D, as it uses its lambda
+#define GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_BATCH(ClassName, FunctionName) \
+	FN_FORCEINLINE void Get ## FunctionName ## Fractal_3D_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out) const \
+	{ \
+		This().Fractal_3D_Batch(FLambda_ ## Single ## FunctionName ## _3D { *this }, Num, x, y, z, frequency, octaves, out); \
+	}
+
+// Must be after the matching GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_DERIV, as it uses its lambda
+#define GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_DERIV_BATCH(ClassName, FunctionName) \
+	FN_FORCEINLINE void Get ## FunctionName ## Fractal_3D_Deriv_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const \
+	{ \
+		This().Fractal_3D_Deriv_Batch(FLambda_ ## Single ## FunctionName ## _3D_Deriv { *this }, Num, x, y, z, frequency, octaves, out, outDx, outDy, outDz); \
+	}
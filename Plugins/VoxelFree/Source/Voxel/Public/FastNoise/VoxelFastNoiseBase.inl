@@ -541,4 +541,278 @@ FN_FORCEINLINE v_flt FVoxelFastNoiseBase::FractalRigidMulti_3D_Deriv(T GetNoise,
 	outDy *= FractalBounding;
 	outDz *= FractalBounding;
 	return sum;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::Fractal_3D_Batch(T GetNoise, int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out) const
+{
+	v_flt bx[NoiseBatchSize];
+	v_flt by[NoiseBatchSize];
+	v_flt bz[NoiseBatchSize];
+	
+	for (int32 Start = 0; Start < Num; Start += NoiseBatchSize)
+	{
+		const int32 Count = FMath::Min(Num - Start, NoiseBatchSize);
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			bx[Index] = x[Start + Index] * frequency;
+			by[Index] = y[Start + Index] * frequency;
+			bz[Index] = z[Start + Index] * frequency;
+		}
+		
+#define Macro(Type) Fractal##Type##_3D_Batch(GetNoise, Count, bx, by, bz, octaves, out + Start); break;
+		switch (This().FractalType)
+		{
+		default: ensureVoxelSlow(false);
+		case EVoxelNoiseFractalType::FBM: Macro(FBM)
+		case EVoxelNoiseFractalType::Billow: Macro(Billow)
+		case EVoxelNoiseFractalType::RigidMulti: Macro(RigidMulti)
+		}
+#undef Macro
+	}
+}
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::Fractal_3D_Deriv_Batch(T GetNoise, int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const
+{
+	v_flt bx[NoiseBatchSize];
+	v_flt by[NoiseBatchSize];
+	v_flt bz[NoiseBatchSize];
+	
+	for (int32 Start = 0; Start < Num; Start += NoiseBatchSize)
+	{
+		const int32 Count = FMath::Min(Num - Start, NoiseBatchSize);
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			bx[Index] = x[Start + Index] * frequency;
+			by[Index] = y[Start + Index] * frequency;
+			bz[Index] = z[Start + Index] * frequency;
+		}
+		
+#define Macro(Type) Fractal##Type##_3D_Deriv_Batch(GetNoise, Count, bx, by, bz, octaves, out + Start, outDx + Start, outDy + Start, outDz + Start); break;
+		switch (This().FractalType)
+		{
+		default: ensureVoxelSlow(false);
+		case EVoxelNoiseFractalType::FBM: Macro(FBM)
+		case EVoxelNoiseFractalType::Billow: Macro(Billow)
+		case EVoxelNoiseFractalType::RigidMulti: Macro(RigidMulti)
+		}
+#undef Macro
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalFBM_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] = GetNoise(Perm[0], x[Index], y[Index], z[Index]);
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			out[Index] += GetNoise(Perm[i], x[Index], y[Index], z[Index]) * amp;
+		}
+	}
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] *= FractalBounding;
+	}
+}
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalFBM_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] = GetNoise(Perm[0], x[Index], y[Index], z[Index], outDx[Index], outDy[Index], outDz[Index]);
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			v_flt dx, dy, dz;
+			out[Index] += GetNoise(Perm[i], x[Index], y[Index], z[Index], dx, dy, dz) * amp;
+
+			outDx[Index] += amp * dx;
+			outDy[Index] += amp * dy;
+			outDz[Index] += amp * dz;
+		}
+	}
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		outDx[Index] *= FractalBounding;
+		outDy[Index] *= FractalBounding;
+		outDz[Index] *= FractalBounding;
+		out[Index] *= FractalBounding;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalBillow_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] = FNoiseMath::FastAbs(GetNoise(Perm[0], x[Index], y[Index], z[Index])) * 2 - 1;
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			out[Index] += (FNoiseMath::FastAbs(GetNoise(Perm[i], x[Index], y[Index], z[Index])) * 2 - 1) * amp;
+		}
+	}
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] *= FractalBounding;
+	}
+}
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalBillow_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		v_flt dx, dy, dz;
+		const v_flt value = GetNoise(Perm[0], x[Index], y[Index], z[Index], dx, dy, dz);
+
+		out[Index] = FNoiseMath::FastAbs(value) * 2 - 1;
+		outDx[Index] = FNoiseMath::FastAbsDeriv(value, dx) * 2;
+		outDy[Index] = FNoiseMath::FastAbsDeriv(value, dy) * 2;
+		outDz[Index] = FNoiseMath::FastAbsDeriv(value, dz) * 2;
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			v_flt dx, dy, dz;
+			const v_flt value = GetNoise(Perm[i], x[Index], y[Index], z[Index], dx, dy, dz);
+
+			out[Index] += (FNoiseMath::FastAbs(value) * 2 - 1) * amp;
+			outDx[Index] += FNoiseMath::FastAbsDeriv(value, dx) * 2 * amp;
+			outDy[Index] += FNoiseMath::FastAbsDeriv(value, dy) * 2 * amp;
+			outDz[Index] += FNoiseMath::FastAbsDeriv(value, dz) * 2 * amp;
+		}
+	}
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		outDx[Index] *= FractalBounding;
+		outDy[Index] *= FractalBounding;
+		outDz[Index] *= FractalBounding;
+		out[Index] *= FractalBounding;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalRigidMulti_3D_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		out[Index] = 1 - FNoiseMath::FastAbs(GetNoise(Perm[0], x[Index], y[Index], z[Index]));
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			out[Index] -= (1 - FNoiseMath::FastAbs(GetNoise(Perm[i], x[Index], y[Index], z[Index]))) * amp;
+		}
+	}
+}
+
+template<typename T>
+FN_FORCEINLINE void FVoxelFastNoiseBase::FractalRigidMulti_3D_Deriv_Batch(T GetNoise, int32 Num, v_flt* RESTRICT x, v_flt* RESTRICT y, v_flt* RESTRICT z, int32 octaves, v_flt* RESTRICT out, v_flt* RESTRICT outDx, v_flt* RESTRICT outDy, v_flt* RESTRICT outDz) const
+{
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		v_flt dx, dy, dz;
+		const v_flt value = GetNoise(Perm[0], x[Index], y[Index], z[Index], dx, dy, dz);
+
+		out[Index] = 1 - FNoiseMath::FastAbs(value);
+		outDx[Index] = -FNoiseMath::FastAbsDeriv(value, dx);
+		outDy[Index] = -FNoiseMath::FastAbsDeriv(value, dy);
+		outDz[Index] = -FNoiseMath::FastAbsDeriv(value, dz);
+	}
+
+	v_flt amp = 1;
+	for (int32 i = 1; i < octaves; i++)
+	{
+		amp *= Gain;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			x[Index] *= Lacunarity;
+			y[Index] *= Lacunarity;
+			z[Index] *= Lacunarity;
+
+			v_flt dx, dy, dz;
+			const v_flt value = GetNoise(Perm[i], x[Index], y[Index], z[Index], dx, dy, dz);
+
+			out[Index] -= (1 - FNoiseMath::FastAbs(value)) * amp;
+			outDx[Index] -= -FNoiseMath::FastAbsDeriv(value, dx) * amp;
+			outDy[Index] -= -FNoiseMath::FastAbsDeriv(value, dy) * amp;
+			outDz[Index] -= -FNoiseMath::FastAbsDeriv(value, dz) * amp;
+		}
+	}
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		outDx[Index] *= FractalBounding;
+		outDy[Index] *= FractalBounding;
+		outDz[Index] *= FractalBounding;
+	}
+}
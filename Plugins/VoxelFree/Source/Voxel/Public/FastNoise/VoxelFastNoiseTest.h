@@ -75,4 +75,127 @@ public:
 
 		UE_DEBUG_BREAK();
 	}
+
+	// Compares the 3D batch functions and their derivatives against the single point ones, and logs the time per point of both
+	// Called by voxel.noise.TestBatch3D
+	static void TestBatch_3D()
+	{
+		FVoxelFastNoiseTest FastNoise;
+		FastNoise.SetSeed(0);
+
+		constexpr int32 Num = 32 * 32 * 32;
+		constexpr int32 NumLoops = 10;
+
+		TArray<v_flt> X, Y, Z;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			X.Add(Index % 32 + 0.5f);
+			Y.Add(Index / 32 % 32 + 0.25f);
+			Z.Add(Index / 32 / 32 - 0.75f);
+		}
+
+		// Allocated once, outside of the timed loops
+		TArray<v_flt> SingleResults[4];
+		TArray<v_flt> BatchResults[4];
+		for (int32 Index = 0; Index < 4; Index++)
+		{
+			SingleResults[Index].SetNumZeroed(Num);
+			BatchResults[Index].SetNumZeroed(Num);
+		}
+
+		bool bFailed = false;
+
+		// Single is called with the output and its derivatives, Batch with the arrays of the outputs and of the derivatives
+		// Functions without derivatives leave them to 0
+		const auto Run = [&](const TCHAR* Name, auto Single, auto Batch)
+		{
+			for (int32 Output = 0; Output < 4; Output++)
+			{
+				FMemory::Memzero(SingleResults[Output].GetData(), Num * sizeof(v_flt));
+				FMemory::Memzero(BatchResults[Output].GetData(), Num * sizeof(v_flt));
+			}
+
+			double SingleTime = 0;
+			double BatchTime = 0;
+			for (int32 LoopIndex = 0; LoopIndex < NumLoops; LoopIndex++)
+			{
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					for (int32 Index = 0; Index < Num; Index++)
+					{
+						SingleResults[0][Index] = Single(X[Index], Y[Index], Z[Index], SingleResults[1][Index], SingleResults[2][Index], SingleResults[3][Index]);
+					}
+					SingleTime += FPlatformTime::Seconds() - StartTime;
+				}
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					Batch(X.GetData(), Y.GetData(), Z.GetData(), BatchResults[0].GetData(), BatchResults[1].GetData(), BatchResults[2].GetData(), BatchResults[3].GetData());
+					BatchTime += FPlatformTime::Seconds() - StartTime;
+				}
+			}
+
+			int32 NumDifferent = 0;
+			for (int32 Output = 0; Output < 4; Output++)
+			{
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					NumDifferent += !FMath::IsNearlyEqual(SingleResults[Output][Index], BatchResults[Output][Index], v_flt(KINDA_SMALL_NUMBER));
+				}
+			}
+			bFailed |= NumDifferent > 0;
+
+			LOG_VOXEL(Log, TEXT("%s: single %fns, batch %fns%s"),
+				Name,
+				SingleTime / (Num * NumLoops) * 1e9,
+				BatchTime / (Num * NumLoops) * 1e9,
+				NumDifferent > 0 ? *FString::Printf(TEXT(". FAILED: %d values or derivatives differ"), NumDifferent) : TEXT(""));
+		};
+
+		const v_flt Frequency = 0.02f;
+
+		Run(TEXT("Perlin_3D"),
+			[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetPerlin_3D(x, y, z, Frequency); },
+			[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetPerlin_3D_Batch(Num, x, y, z, Frequency, out); });
+		Run(TEXT("Perlin_3D_Deriv"),
+			[&](v_flt x, v_flt y, v_flt z, v_flt& dx, v_flt& dy, v_flt& dz) { return FastNoise.GetPerlin_3D_Deriv(x, y, z, Frequency, dx, dy, dz); },
+			[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt* dx, v_flt* dy, v_flt* dz) { FastNoise.GetPerlin_3D_Deriv_Batch(Num, x, y, z, Frequency, out, dx, dy, dz); });
+		Run(TEXT("Simplex_3D"),
+			[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetSimplex_3D(x, y, z, Frequency); },
+			[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetSimplex_3D_Batch(Num, x, y, z, Frequency, out); });
+		Run(TEXT("Cellular_3D"),
+			[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetCellular_3D(x, y, z, Frequency); },
+			[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetCellular_3D_Batch(Num, x, y, z, Frequency, out); });
+		Run(TEXT("Crater_3D"),
+			[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetCrater_3D(x, y, z, Frequency); },
+			[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetCrater_3D_Batch(Num, x, y, z, Frequency, out); });
+
+		for (const EVoxelNoiseFractalType FractalType : { EVoxelNoiseFractalType::FBM, EVoxelNoiseFractalType::Billow, EVoxelNoiseFractalType::RigidMulti })
+		{
+			FastNoise.SetFractalType(FractalType);
+			
+			for (const int32 Octaves : { 1, 3, 6 })
+			{
+				FastNoise.SetFractalOctavesAndGain(Octaves, 0.5f);
+
+				const FString Suffix = FString::Printf(TEXT(" %s %d octaves"), *UEnum::GetValueAsString(FractalType), Octaves);
+				Run(*(TEXT("PerlinFractal_3D") + Suffix),
+					[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetPerlinFractal_3D(x, y, z, Frequency, Octaves); },
+					[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetPerlinFractal_3D_Batch(Num, x, y, z, Frequency, Octaves, out); });
+				Run(*(TEXT("PerlinFractal_3D_Deriv") + Suffix),
+					[&](v_flt x, v_flt y, v_flt z, v_flt& dx, v_flt& dy, v_flt& dz) { return FastNoise.GetPerlinFractal_3D_Deriv(x, y, z, Frequency, Octaves, dx, dy, dz); },
+					[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt* dx, v_flt* dy, v_flt* dz) { FastNoise.GetPerlinFractal_3D_Deriv_Batch(Num, x, y, z, Frequency, Octaves, out, dx, dy, dz); });
+				Run(*(TEXT("SimplexFractal_3D") + Suffix),
+					[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetSimplexFractal_3D(x, y, z, Frequency, Octaves); },
+					[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetSimplexFractal_3D_Batch(Num, x, y, z, Frequency, Octaves, out); });
+				Run(*(TEXT("CraterFractal_3D") + Suffix),
+					[&](v_flt x, v_flt y, v_flt z, v_flt&, v_flt&, v_flt&) { return FastNoise.GetCraterFractal_3D(x, y, z, Frequency, Octaves); },
+					[&](const v_flt* x, const v_flt* y, const v_flt* z, v_flt* out, v_flt*, v_flt*, v_flt*) { FastNoise.GetCraterFractal_3D_Batch(Num, x, y, z, Frequency, Octaves, out); });
+			}
+		}
+
+		if (bFailed)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.noise.TestBatch3D: batch results differ from the single point ones"));
+		}
+	}
 };
\ No newline at end of file
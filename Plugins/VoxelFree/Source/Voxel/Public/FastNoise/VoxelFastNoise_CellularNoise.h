@@ -14,6 +14,7 @@ public:
 public:
 	v_flt GetCellular_2D(v_flt x, v_flt y, v_flt frequency) const;
 	v_flt GetCellular_3D(v_flt x, v_flt y, v_flt z, v_flt frequency) const;
+	void GetCellular_3D_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, v_flt* RESTRICT out) const;
 	
 	void GetVoronoi_2D(v_flt x, v_flt y, v_flt m_jitter, v_flt& out_x, v_flt& out_y) const;
 	void GetVoronoiNeighbors_2D(
@@ -28,6 +29,8 @@ public:
 	GENERATED_VOXEL_NOISE_FUNCTION_3D(Crater)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_2D(Cellular, Crater)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D(Cellular, Crater)
+	GENERATED_VOXEL_NOISE_FUNCTION_3D_BATCH(Crater)
+	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_BATCH(Cellular, Crater)
 	
 	FN_FORCEINLINE v_flt GetGavoronoi_2D(v_flt x, v_flt y, v_flt frequency, v_flt dirX, v_flt dirY, v_flt dirVariation) const
 	{
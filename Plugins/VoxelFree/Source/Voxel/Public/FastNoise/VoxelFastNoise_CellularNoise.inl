@@ -101,6 +101,44 @@ FN_FORCEINLINE v_flt TVoxelFastNoise_CellularNoise<T>::GetCellular_3D(v_flt x, v
 	}
 }
 
+template<typename T>
+FN_FORCEINLINE void TVoxelFastNoise_CellularNoise<T>::GetCellular_3D_Batch(int32 Num, const v_flt* RESTRICT x, const v_flt* RESTRICT y, const v_flt* RESTRICT z, v_flt frequency, v_flt* RESTRICT out) const
+{
+	// Same as GetCellular_3D, but with the switches outside of the loop
+	const auto Loop = [&](auto GetNoise)
+	{
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			out[Index] = GetNoise(x[Index] * frequency, y[Index] * frequency, z[Index] * frequency);
+		}
+	};
+	
+	switch (This().CellularReturnType)
+	{
+	case EVoxelCellularReturnType::CellValue:
+	case EVoxelCellularReturnType::Distance:
+	{
+		switch (This().CellularDistanceFunction)
+		{
+		default: ensureVoxelSlow(false);
+#define Macro(Enum) case Enum: return Loop([&](v_flt in_x, v_flt in_y, v_flt in_z) { return SingleCellular_3D<Enum>(in_x, in_y, in_z); });
+			FOREACH_ENUM_EVOXELCELLULARDISTANCEFUNCTION(Macro)
+#undef Macro
+		}
+	}
+	default:
+	{
+		switch (This().CellularDistanceFunction)
+		{
+		default: ensureVoxelSlow(false);
+#define Macro(Enum) case Enum: return Loop([&](v_flt in_x, v_flt in_y, v_flt in_z) { return SingleCellular2Edge_3D<Enum>(in_x, in_y, in_z); });
+			FOREACH_ENUM_EVOXELCELLULARDISTANCEFUNCTION(Macro)
+#undef Macro
+		}
+	}
+	}
+}
+
 template<typename T>
 FN_FORCEINLINE void TVoxelFastNoise_CellularNoise<T>::GetVoronoi_2D(v_flt x, v_flt y, v_flt m_jitter, v_flt& out_x, v_flt& out_y) const
 {
@@ -18,6 +18,10 @@ public:
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_2D_DERIV(Perlin, Perlin)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D(Perlin, Perlin)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_DERIV(Perlin, Perlin)
+	GENERATED_VOXEL_NOISE_FUNCTION_3D_BATCH(Perlin)
+	GENERATED_VOXEL_NOISE_FUNCTION_3D_DERIV_BATCH(Perlin)
+	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_BATCH(Perlin, Perlin)
+	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_DERIV_BATCH(Perlin, Perlin)
 
 protected:
 	v_flt SinglePerlin_2D(uint8 offset, v_flt x, v_flt y) const;
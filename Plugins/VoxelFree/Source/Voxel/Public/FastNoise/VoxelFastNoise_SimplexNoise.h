@@ -14,6 +14,8 @@ public:
 	GENERATED_VOXEL_NOISE_FUNCTION_3D(Simplex)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_2D(Simplex, Simplex)
 	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D(Simplex, Simplex)
+	GENERATED_VOXEL_NOISE_FUNCTION_3D_BATCH(Simplex)
+	GENERATED_VOXEL_NOISE_FUNCTION_FRACTAL_3D_BATCH(Simplex, Simplex)
 
 protected:
 	static constexpr v_flt SQRT3 = v_flt(1.7320508075688772935274463415059);
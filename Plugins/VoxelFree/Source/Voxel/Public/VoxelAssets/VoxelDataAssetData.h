@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "VoxelValue.h"
 #include "VoxelMaterial.h"
+#include "VoxelRange.h"
+#include "VoxelIntBox.h"
 
 class AVoxelWorld;
 class UTexture2D;
@@ -31,6 +33,7 @@ namespace FVoxelDataAssetDataVersion
 		SHARED_AddUserFlagsToSaves,
 		SHARED_StoreSpawnerMatricesRelativeToComponent,
 		SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage,
+		BrickedStorage,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -38,14 +41,52 @@ namespace FVoxelDataAssetDataVersion
 	};
 };
 
+/**
+ * Data assets have two storages:
+ * - a dense one, used to create and edit the data (SetSize, SetValue, non const GetRaw*)
+ * - a bricked one, used once loaded: the data is split in BrickSize^3 bricks, bricks with a single value are collapsed,
+ *   and the value range of each brick is stored to answer GetValueRange without sampling the voxels
+ */
 struct VOXEL_API FVoxelDataAssetData
 {
+	static constexpr int32 BrickSize = 8;
+	static constexpr int32 BrickSizeLog2 = 3;
+	static constexpr int32 BrickNumVoxels = BrickSize * BrickSize * BrickSize;
+	static_assert(1 << BrickSizeLog2 == BrickSize, "");
+
+	template<typename T>
+	struct TBricks
+	{
+		// For each brick: index of its first voxel in Data, or -1 if all its voxels are Uniforms[Brick]
+		TNoGrowArray<int32> Indices;
+		TNoGrowArray<T> Uniforms;
+		TNoGrowArray<T> Data;
+
+		int64 GetAllocatedSize() const
+		{
+			return Indices.GetAllocatedSize() + Uniforms.GetAllocatedSize() + Data.GetAllocatedSize();
+		}
+		void Empty()
+		{
+			Indices.Empty();
+			Uniforms.Empty();
+			Data.Empty();
+		}
+	};
+	struct FBrickRange
+	{
+		FVoxelValue Min;
+		FVoxelValue Max;
+	};
+	
 	FVoxelDataAssetData() = default;
 	~FVoxelDataAssetData()
 	{
 		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataAssetMemory, AllocatedSize);
 	}
 
+	UE_NONCOPYABLE(FVoxelDataAssetData);
+
 public:
 	FORCEINLINE FIntVector GetSize() const
 	{
@@ -56,12 +97,21 @@ public:
 
 	FORCEINLINE bool HasMaterials() const
 	{
-		return Materials.Num() > 0;
+		return bBricked ? MaterialBricks.Indices.Num() > 0 : Materials.Num() > 0;
 	}
 	FORCEINLINE bool IsEmpty() const
 	{
-		return Values.Num() <= 1 && Materials.Num() <= 1;
+		return !bBricked && Values.Num() <= 1 && Materials.Num() <= 1;
 	}
+	FORCEINLINE bool IsBricked() const
+	{
+		return bBricked;
+	}
+
+	// Not thread safe: must be called before the data is shared
+	void ConvertToBricks();
+	// Not thread safe: must be called before the data is shared
+	void ConvertToDense();
 	
 public:
 	FORCEINLINE int32 GetIndex(int32 X, int32 Y, int32 Z) const
@@ -84,11 +134,13 @@ public:
 
 	FORCEINLINE void SetValue(int32 X, int32 Y, int32 Z, const FVoxelValue& NewValue)
 	{
+		checkVoxelSlow(!bBricked);
 		checkVoxelSlow(Values.IsValidIndex(GetIndex(X, Y, Z)));
 		Values.GetData()[GetIndex(X, Y, Z)] = NewValue;
 	}
 	FORCEINLINE void SetMaterial(int32 X, int32 Y, int32 Z, const FVoxelMaterial& NewMaterial)
 	{
+		checkVoxelSlow(!bBricked);
 		checkVoxelSlow(Materials.IsValidIndex(GetIndex(X, Y, Z)));
 		Materials.GetData()[GetIndex(X, Y, Z)] = NewMaterial;
 	}
@@ -97,6 +149,10 @@ public:
 	FORCEINLINE FVoxelValue GetValueUnsafe(T X, T Y, T Z) const
 	{
 		static_assert(TIsSame<T, int32>::Value, "should be int32");
+		if (bBricked)
+		{
+			return GetBrickedVoxel(ValueBricks, X, Y, Z);
+		}
 		checkVoxelSlow(Values.IsValidIndex(GetIndex(X, Y, Z)));
 		return Values.GetData()[GetIndex(X, Y, Z)];
 	}
@@ -104,6 +160,10 @@ public:
 	FORCEINLINE FVoxelMaterial GetMaterialUnsafe(T X, T Y, T Z) const
 	{
 		static_assert(TIsSame<T, int32>::Value, "should be int32");
+		if (bBricked)
+		{
+			return GetBrickedVoxel(MaterialBricks, X, Y, Z);
+		}
 		checkVoxelSlow(Materials.IsValidIndex(GetIndex(X, Y, Z)));
 		return Materials.GetData()[GetIndex(X, Y, Z)];
 	}
@@ -120,24 +180,23 @@ public:
 	float GetInterpolatedValue(float X, float Y, float Z, FVoxelValue DefaultValue, float Tolerance = 0.0001f) const;
 	FVoxelMaterial GetInterpolatedMaterial(float X, float Y, float Z, float Tolerance = 0.0001f) const;
 
+	// Bounds are in voxels, relative to the asset origin. Conservative: the whole -1 1 range is returned if not bricked
+	TVoxelRange<v_flt> GetValueRange(const FVoxelIntBox& Bounds, FVoxelValue DefaultValue) const;
+
 public:
 	void Serialize(FArchive& Ar, uint32 ValueConfigFlag, uint32 MaterialConfigFlag, FVoxelDataAssetDataVersion::Type Version);
 
 public:
+	// Will convert the data back to dense
 	TNoGrowArray<FVoxelValue>& GetRawValues()
 	{
+		ConvertToDense();
 		return Values;
 	}
+	// Will convert the data back to dense
 	TNoGrowArray<FVoxelMaterial>& GetRawMaterials()
 	{
-		return Materials;
-	}
-	const TNoGrowArray<FVoxelValue>& GetRawValues() const
-	{
-		return Values;
-	}
-	const TNoGrowArray<FVoxelMaterial>& GetRawMaterials() const
-	{
+		ConvertToDense();
 		return Materials;
 	}
 
@@ -154,5 +213,46 @@ private:
 	TNoGrowArray<FVoxelMaterial> Materials = { FVoxelMaterial::Default() };
 	mutable int64 AllocatedSize = 0;
 
+	bool bBricked = false;
+	FIntVector NumBricks = FIntVector(1, 1, 1);
+	TBricks<FVoxelValue> ValueBricks;
+	TBricks<FVoxelMaterial> MaterialBricks;
+	TNoGrowArray<FBrickRange> BrickRanges;
+
 	void UpdateStats() const;
+	
+	void BuildBrickRanges();
+	void SerializeBricks(FArchive& Ar, uint32 ValueConfigFlag, uint32 MaterialConfigFlag);
+
+	template<typename T>
+	void BuildBricks(const TNoGrowArray<T>& Dense, TBricks<T>& Bricks) const;
+	template<typename T>
+	void BuildDense(const TBricks<T>& Bricks, TNoGrowArray<T>& Dense) const;
+	template<typename T>
+	bool AreBricksValid(const TBricks<T>& Bricks) const;
+
+	FORCEINLINE int32 GetBrickIndex(int32 BrickX, int32 BrickY, int32 BrickZ) const
+	{
+		checkVoxelSlow(0 <= BrickX && BrickX < NumBricks.X);
+		checkVoxelSlow(0 <= BrickY && BrickY < NumBricks.Y);
+		checkVoxelSlow(0 <= BrickZ && BrickZ < NumBricks.Z);
+		return BrickX + NumBricks.X * BrickY + NumBricks.X * NumBricks.Y * BrickZ;
+	}
+	FORCEINLINE static int32 GetIndexInBrick(int32 X, int32 Y, int32 Z)
+	{
+		return (X & (BrickSize - 1)) + BrickSize * (Y & (BrickSize - 1)) + BrickSize * BrickSize * (Z & (BrickSize - 1));
+	}
+	template<typename T>
+	FORCEINLINE T GetBrickedVoxel(const TBricks<T>& Bricks, int32 X, int32 Y, int32 Z) const
+	{
+		checkVoxelSlow(IsValidIndex(X, Y, Z));
+		const int32 Brick = GetBrickIndex(X >> BrickSizeLog2, Y >> BrickSizeLog2, Z >> BrickSizeLog2);
+		const int32 DataIndex = Bricks.Indices.GetData()[Brick];
+		if (DataIndex < 0)
+		{
+			return Bricks.Uniforms.GetData()[Brick];
+		}
+		checkVoxelSlow(Bricks.Data.IsValidIndex(DataIndex + GetIndexInBrick(X, Y, Z)));
+		return Bricks.Data.GetData()[DataIndex + GetIndexInBrick(X, Y, Z)];
+	}
 };
\ No newline at end of file
@@ -85,8 +85,6 @@ inline FVoxelMaterial FVoxelDataAssetData::GetInterpolatedMaterial(float X, floa
 	Y = FMath::Clamp<float>(Y, 0, Size.Y - 1);
 	Z = FMath::Clamp<float>(Z, 0, Size.Z - 1);
 
-	auto* RESTRICT const ValuesPtr = Values.GetData();
-	auto* RESTRICT const MaterialsPtr = Materials.GetData();
 	const int32 MinX = FMath::FloorToInt(X);
 	const int32 MinY = FMath::FloorToInt(Y);
 	const int32 MinZ = FMath::FloorToInt(Z);
@@ -100,13 +98,10 @@ inline FVoxelMaterial FVoxelDataAssetData::GetInterpolatedMaterial(float X, floa
 			for (int32 ItZ = MinZ; ItZ <= MaxZ; ItZ++)
 			{
 				checkVoxelSlow(IsValidIndex(ItX, ItY, ItZ));
-				const int32 Index = GetIndex(ItX, ItY, ItZ);
-				checkVoxelSlow(Values.IsValidIndex(Index));
-				checkVoxelSlow(Materials.IsValidIndex(Index));
-				if (ValuesPtr[Index].IsEmpty()) continue;
-				return MaterialsPtr[Index];
+				if (GetValueUnsafe(ItX, ItY, ItZ).IsEmpty()) continue;
+				return GetMaterialUnsafe(ItX, ItY, ItZ);
 			}
 		}
 	}
-	return MaterialsPtr[GetIndex(MinX, MinY, MinZ)];
+	return GetMaterialUnsafe(MinX, MinY, MinZ);
 }
\ No newline at end of file
@@ -62,14 +62,15 @@ public:
 	
 	TVoxelRange<v_flt> GetValueRangeImpl(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const
 	{
-		if (Bounds.Intersect(GetLocalBounds()))
-		{
-			return { -1, 1 };
-		}
-		else
+		if (!Bounds.Intersect(GetLocalBounds()))
 		{
 			return bSubtractiveAsset ? -1 : 1;
 		}
+
+		// Extend by 1 to account for the interpolation
+		return Data->GetValueRange(
+			Bounds.Extend(1).Translate(-PositionOffset),
+			bSubtractiveAsset ? FVoxelValue::Full() : FVoxelValue::Empty());
 	}
 	FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override final
 	{
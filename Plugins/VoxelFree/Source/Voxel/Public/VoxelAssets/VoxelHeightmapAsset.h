@@ -102,7 +102,9 @@ private:
 	UPROPERTY()
 	uint32 MaterialConfigFlag;
 
-	TArray<uint8> CompressedData;
+	// Since TiledStorage, the pages are compressed individually and the data keeps a reference to this to page them in
+	// Never modified in place: a new array is created on save
+	TVoxelSharedRef<TArray<uint8>> CompressedData = MakeVoxelShared<TArray<uint8>>();
 
 private:
 #if WITH_EDITORONLY_DATA
@@ -5,8 +5,21 @@
 #include "CoreMinimal.h"
 #include "VoxelMaterial.h"
 #include "VoxelRange.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "VoxelUtilities/VoxelLRUCache.h"
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Heightmap Assets Memory"), STAT_VoxelHeightmapAssetMemory, STATGROUP_VoxelMemory, VOXEL_API);
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Heightmap Assets Resident Pages Memory"), STAT_VoxelHeightmapAssetPagesMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+namespace FVoxelHeightmapAssetPaging
+{
+	// voxel.heightmap.PagesBudgetMB, in bytes
+	VOXEL_API int64 GetMaxResidentPagesSize();
+	// Called when pages are decompressed/evicted, for stats
+	VOXEL_API void OnPageIn();
+	VOXEL_API void OnPagesEvicted(int32 NumPages);
+}
 
 namespace FVoxelHeightmapAssetDataVersion
 {
@@ -29,6 +42,7 @@ namespace FVoxelHeightmapAssetDataVersion
 		SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage,
 		UseTArray64,
 		SerializeHeightRangeMips,
+		TiledStorage,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -81,11 +95,11 @@ public:
 public:
 	bool HasMaterials() const
 	{
-		return Materials.Num() > 0;
+		return bPaged ? Paged->bHasMaterials : Materials.Num() > 0;
 	}
 	bool IsEmpty() const
 	{
-		return Heights.Num() <= 4 && Materials.Num() == 0;
+		return !bPaged && Heights.Num() <= 4 && Materials.Num() == 0;
 	}
 	int64 GetAllocatedSize() const
 	{
@@ -137,14 +151,24 @@ public:
 
 	FORCEINLINE T GetHeightUnsafe(int64 X, int64 Y) const
 	{
+		if (bPaged)
+		{
+			return GetPagedHeight(X, Y);
+		}
 		return GetHeightUnsafe(GetIndex(X, Y));
 	}
 	FORCEINLINE FVoxelMaterial GetMaterialUnsafe(int64 X, int64 Y) const
 	{
+		if (bPaged)
+		{
+			return GetPagedMaterial(X, Y);
+		}
 		return GetMaterialUnsafe(GetIndex(X, Y));
 	}
+	// Only valid if the data isn't paged
 	FORCEINLINE T GetHeightUnsafe(int64 Index) const
 	{
+		checkVoxelSlow(!bPaged);
 		return Heights[Index];
 	}
 	FVoxelMaterial GetMaterialUnsafe(int64 Index) const;
@@ -169,13 +193,39 @@ public:
 	FVoxelMaterial GetMaterial(float X, float Y, EVoxelSamplerMode Mode) const;
 
 public:
+	// Empty if the data is paged
 	const auto& GetRawHeights() const
 	{
+		ensureVoxelSlowNoSideEffects(!bPaged);
 		return Heights;
 	}
 
 public:
+	// Legacy format: the whole data in a single archive, compressed by the asset as one blob
 	void Serialize(FArchive& Ar, uint32 MaterialConfigFlag, FVoxelHeightmapAssetDataVersion::Type Version, bool& bNeedToSave);
+
+	/**
+	 * Tiled format: a small header with the size and the height range mips, followed by pages of PageSize * PageSize pixels compressed individually
+	 * LoadPaged only reads the header: pages are decompressed when first sampled, and evicted when over voxel.heightmap.PagesBudgetMB
+	 * Blob must not be modified after that
+	 */
+	void SavePaged(TArray<uint8>& OutBlob) const;
+	bool LoadPaged(const TVoxelSharedRef<const TArray<uint8>>& Blob);
+
+	bool IsPaged() const
+	{
+		return bPaged;
+	}
+	// Decompress all the pages into flat arrays. Done automatically before any edit
+	void Unpage();
+
+	int64 GetResidentPagesSize() const
+	{
+		return bPaged ? Paged->Pages.GetValuesAllocatedSize() : 0;
+	}
+
+public:
+	static constexpr int64 PageSize = 256;
 	
 private:
 	TNoGrowArray64<T> Heights;
@@ -217,6 +267,87 @@ private:
 		}
 	};
 	TArray<FHeightRangeMip, TInlineAllocator<16>> HeightRangeMips;
+
+private:
+	struct FPageData
+	{
+		int64 Width = 0;
+		int64 NumPixels = 0;
+		// Heights followed by materials, as compressed
+		TArray<uint8> Bytes;
+
+		FORCEINLINE const T* GetHeights() const
+		{
+			return reinterpret_cast<const T*>(Bytes.GetData());
+		}
+		FORCEINLINE const uint8* GetMaterials() const
+		{
+			return Bytes.GetData() + NumPixels * sizeof(T);
+		}
+		int64 GetAllocatedSize() const
+		{
+			return sizeof(*this) + Bytes.GetAllocatedSize();
+		}
+	};
+
+public:
+	// Keeps a reference to the last page sampled, so that sampling many pixels of the same page only looks it up once
+	// Owned by the caller, eg for the duration of a query. Must not be shared between threads, nor kept around:
+	// it keeps its page alive even once it's evicted
+	struct FPageCache
+	{
+		const void* Storage = nullptr;
+		int64 PageIndex = -1;
+		TVoxelSharedPtr<const FPageData> Page;
+	};
+
+	float GetHeight(float X, float Y, EVoxelSamplerMode Mode, FPageCache& Cache) const;
+	FVoxelMaterial GetMaterial(float X, float Y, EVoxelSamplerMode Mode, FPageCache& Cache) const;
+
+private:
+	struct FPagedStorage
+	{
+		TVoxelSharedPtr<const TArray<uint8>> Blob;
+		// Start of the pages in Blob, after the header
+		int64 PagesStart = 0;
+		bool bHasMaterials = false;
+		int64 NumPagesX = 0;
+		int64 NumPagesY = 0;
+		// Offsets of the compressed pages in Blob, NumPages + 1 entries
+		TArray<int64> PageOffsets;
+
+		// Resident pages, by page index
+		TVoxelLRUCache<int64, FPageData> Pages;
+
+		~FPagedStorage()
+		{
+			DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetPagesMemory, Pages.GetValuesAllocatedSize());
+		}
+	};
+	// Kept alive until the data is resized or loaded again, so that Unpage is safe to call while other threads are sampling
+	TUniquePtr<FPagedStorage> Paged;
+	bool bPaged = false;
+
+	TVoxelSharedRef<const FPageData> GetPage(int64 PageX, int64 PageY) const;
+	const FPageData& GetPage(int64 PageX, int64 PageY, FPageCache& Cache) const;
+	TVoxelSharedRef<FPageData> DecompressPage(int64 PageIndex) const;
+	void ResetPages();
+	
+	T GetPagedHeight(int64 X, int64 Y, FPageCache& Cache) const;
+	FVoxelMaterial GetPagedMaterial(int64 X, int64 Y, FPageCache& Cache) const;
+	FORCEINLINE T GetPagedHeight(int64 X, int64 Y) const
+	{
+		FPageCache Cache;
+		return GetPagedHeight(X, Y, Cache);
+	}
+	FORCEINLINE FVoxelMaterial GetPagedMaterial(int64 X, int64 Y) const
+	{
+		FPageCache Cache;
+		return GetPagedMaterial(X, Y, Cache);
+	}
+
+	int64 GetMaterialSize() const;
+	static FVoxelMaterial GetMaterialFromBytes(const uint8* RESTRICT MaterialBytes, int64 Index, EVoxelMaterialConfig MaterialConfig);
 	
 private:
 	int64 AllocatedSize = 0;
@@ -8,6 +8,11 @@
 #include "VoxelAssets/VoxelHeightmapAssetData.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
 
+#include "Misc/Compression.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetSize(int64 NewWidth, int64 NewHeight, bool bCreateMaterials, EVoxelMaterialConfig InMaterialConfig)
 {
@@ -15,6 +20,8 @@ void TVoxelHeightmapAssetData<T>::SetSize(int64 NewWidth, int64 NewHeight, bool
 
 	check(NewWidth > 0 && NewHeight > 0);
 
+	ResetPages();
+
 	const int64 NumHeights = NewWidth * NewHeight;
 	Heights.Empty(NumHeights);
 	Heights.SetNumUninitialized(NumHeights);
@@ -55,6 +62,11 @@ void TVoxelHeightmapAssetData<T>::SetAllHeightsTo(T NewHeight)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
+	if (bPaged)
+	{
+		Unpage();
+	}
+
 	for (auto& HeightIt : Heights)
 	{
 		HeightIt = NewHeight;
@@ -257,6 +269,11 @@ void TVoxelHeightmapAssetData<T>::InitializeHeightRangeMips()
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetHeight(int64 X, int64 Y, T NewHeight)
 {
+	if (bPaged)
+	{
+		Unpage();
+	}
+
 	Heights[GetIndex(X, Y)] = NewHeight;
 
 	MaxHeight = FMath::Max(MaxHeight, NewHeight);
@@ -281,6 +298,11 @@ void TVoxelHeightmapAssetData<T>::SetHeight(int64 X, int64 Y, T NewHeight)
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_RGB(int64 X, int64 Y, FColor Color)
 {
+	if (bPaged)
+	{
+		Unpage();
+	}
+
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::RGB);
 	const int64 Index = GetIndex(X, Y);
 
@@ -293,6 +315,11 @@ void TVoxelHeightmapAssetData<T>::SetMaterial_RGB(int64 X, int64 Y, FColor Color
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_SingleIndex(int64 X, int64 Y, uint8 SingleIndex)
 {
+	if (bPaged)
+	{
+		Unpage();
+	}
+
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::SingleIndex);
 	Materials[GetIndex(X, Y)] = SingleIndex;
 }
@@ -300,6 +327,11 @@ void TVoxelHeightmapAssetData<T>::SetMaterial_SingleIndex(int64 X, int64 Y, uint
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_MultiIndex(int64 X, int64 Y, const FVoxelMaterial& Material)
 {
+	if (bPaged)
+	{
+		Unpage();
+	}
+
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::MultiIndex);
 	const int64 Index = GetIndex(X, Y);
 
@@ -318,33 +350,52 @@ void TVoxelHeightmapAssetData<T>::SetMaterial_MultiIndex(int64 X, int64 Y, const
 
 template<typename T>
 FORCEINLINE FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterialUnsafe(int64 Index) const
+{
+	checkVoxelSlow(!bPaged);
+	return GetMaterialFromBytes(Materials.GetData(), Index, MaterialConfig);
+}
+
+template<typename T>
+FORCEINLINE FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterialFromBytes(const uint8* RESTRICT MaterialBytes, int64 Index, EVoxelMaterialConfig MaterialConfig)
 {
 	FVoxelMaterial Material(ForceInit);
 	switch (MaterialConfig)
 	{
 	case EVoxelMaterialConfig::RGB:
-		Material.SetR(Materials[4 * Index + 0]);
-		Material.SetG(Materials[4 * Index + 1]);
-		Material.SetB(Materials[4 * Index + 2]);
-		Material.SetA(Materials[4 * Index + 3]);
+		Material.SetR(MaterialBytes[4 * Index + 0]);
+		Material.SetG(MaterialBytes[4 * Index + 1]);
+		Material.SetB(MaterialBytes[4 * Index + 2]);
+		Material.SetA(MaterialBytes[4 * Index + 3]);
 		break;
 	case EVoxelMaterialConfig::SingleIndex:
-		Material.SetSingleIndex(Materials[Index]);
+		Material.SetSingleIndex(MaterialBytes[Index]);
 		break;
 	case EVoxelMaterialConfig::MultiIndex:
 	default:
-		Material.SetMultiIndex_Blend0(Materials[7 * Index + 0]);
-		Material.SetMultiIndex_Blend1(Materials[7 * Index + 1]);
-		Material.SetMultiIndex_Blend2(Materials[7 * Index + 2]);
-		Material.SetMultiIndex_Index0(Materials[7 * Index + 3]);
-		Material.SetMultiIndex_Index1(Materials[7 * Index + 4]);
-		Material.SetMultiIndex_Index2(Materials[7 * Index + 5]);
-		Material.SetMultiIndex_Index3(Materials[7 * Index + 6]);
+		Material.SetMultiIndex_Blend0(MaterialBytes[7 * Index + 0]);
+		Material.SetMultiIndex_Blend1(MaterialBytes[7 * Index + 1]);
+		Material.SetMultiIndex_Blend2(MaterialBytes[7 * Index + 2]);
+		Material.SetMultiIndex_Index0(MaterialBytes[7 * Index + 3]);
+		Material.SetMultiIndex_Index1(MaterialBytes[7 * Index + 4]);
+		Material.SetMultiIndex_Index2(MaterialBytes[7 * Index + 5]);
+		Material.SetMultiIndex_Index3(MaterialBytes[7 * Index + 6]);
 		break;
 	}
 	return Material;
 }
 
+template<typename T>
+int64 TVoxelHeightmapAssetData<T>::GetMaterialSize() const
+{
+	switch (MaterialConfig)
+	{
+	case EVoxelMaterialConfig::RGB: return 4;
+	case EVoxelMaterialConfig::SingleIndex: return 1;
+	case EVoxelMaterialConfig::MultiIndex: return 7;
+	default: return 0;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -405,6 +456,20 @@ FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterial(int64 X, int64 Y, EVoxel
 
 template<typename T>
 float TVoxelHeightmapAssetData<T>::GetHeight(float X, float Y, EVoxelSamplerMode Mode) const
+{
+	FPageCache Cache;
+	return GetHeight(X, Y, Mode, Cache);
+}
+
+template<typename T>
+FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterial(float X, float Y, EVoxelSamplerMode Mode) const
+{
+	FPageCache Cache;
+	return GetMaterial(X, Y, Mode, Cache);
+}
+
+template<typename T>
+float TVoxelHeightmapAssetData<T>::GetHeight(float X, float Y, EVoxelSamplerMode Mode, FPageCache& Cache) const
 {
 	const int64 MinX = FMath::FloorToInt(X);
 	const int64 MinY = FMath::FloorToInt(Y);
@@ -415,6 +480,33 @@ float TVoxelHeightmapAssetData<T>::GetHeight(float X, float Y, EVoxelSamplerMode
 	const float AlphaX = X - MinX;
 	const float AlphaY = Y - MinY;
 
+	if (bPaged)
+	{
+		int64 FixedMinX = MinX;
+		int64 FixedMinY = MinY;
+		int64 FixedMaxX = MaxX;
+		int64 FixedMaxY = MaxY;
+		if (Mode == EVoxelSamplerMode::Tile)
+		{
+			TileCoordinates(FixedMinX, FixedMinY);
+			TileCoordinates(FixedMaxX, FixedMaxY);
+		}
+		else
+		{
+			ClampCoordinates(FixedMinX, FixedMinY);
+			ClampCoordinates(FixedMaxX, FixedMaxY);
+		}
+
+		// The cache only looks up the page again when the pixels are on a page border
+		return FVoxelUtilities::BilinearInterpolation<float>(
+			GetPagedHeight(FixedMinX, FixedMinY, Cache),
+			GetPagedHeight(FixedMaxX, FixedMinY, Cache),
+			GetPagedHeight(FixedMinX, FixedMaxY, Cache),
+			GetPagedHeight(FixedMaxX, FixedMaxY, Cache),
+			AlphaX,
+			AlphaY);
+	}
+
 	return FVoxelUtilities::BilinearInterpolation<float>(
 		GetHeight(MinX, MinY, Mode),
 		GetHeight(MaxX, MinY, Mode),
@@ -425,16 +517,29 @@ float TVoxelHeightmapAssetData<T>::GetHeight(float X, float Y, EVoxelSamplerMode
 }
 
 template<typename T>
-FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterial(float X, float Y, EVoxelSamplerMode Mode) const
+FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterial(float X, float Y, EVoxelSamplerMode Mode, FPageCache& Cache) const
 {
-	if (HasMaterials())
+	if (!HasMaterials())
+	{
+		return FVoxelMaterial::Default();
+	}
+	if (!bPaged)
 	{
 		return GetMaterial(FMath::RoundToInt(X), FMath::RoundToInt(Y), Mode);
 	}
+
+	int64 FixedX = FMath::RoundToInt(X);
+	int64 FixedY = FMath::RoundToInt(Y);
+	if (Mode == EVoxelSamplerMode::Tile)
+	{
+		TileCoordinates(FixedX, FixedY);
+	}
 	else
 	{
-		return FVoxelMaterial::Default();
+		ClampCoordinates(FixedX, FixedY);
 	}
+	return GetPagedMaterial(FixedX, FixedY, Cache);
+}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -447,6 +552,15 @@ void TVoxelHeightmapAssetData<T>::Serialize(FArchive& Ar, uint32 MaterialConfigF
 	VOXEL_FUNCTION_COUNTER();
 	
 	FVoxelScopedSlowTask Serializing(3.f);
+
+	if (Ar.IsLoading())
+	{
+		ResetPages();
+	}
+	else if (bPaged)
+	{
+		Unpage();
+	}
 	
 	Serializing.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Serializing heights"));
 	if (Version < FVoxelHeightmapAssetDataVersion::UseTArray64)
@@ -603,6 +717,327 @@ void TVoxelHeightmapAssetData<T>::Serialize(FArchive& Ar, uint32 MaterialConfigF
 	UpdateStats();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+void TVoxelHeightmapAssetData<T>::SavePaged(TArray<uint8>& OutBlob) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const bool bHasMaterials = HasMaterials();
+
+	TArray<int64> PageOffsets;
+	TArray<uint8> PagesData;
+	if (bPaged)
+	{
+		// Nothing changed since the pages were loaded, copy them as is
+		PageOffsets = Paged->PageOffsets;
+		PagesData.Append(Paged->Blob->GetData() + Paged->PagesStart, Paged->Blob->Num() - Paged->PagesStart);
+	}
+	else
+	{
+		const int64 MaterialSize = bHasMaterials ? GetMaterialSize() : 0;
+		const int64 NumPagesX = FVoxelUtilities::DivideCeil64(Width, PageSize);
+		const int64 NumPagesY = FVoxelUtilities::DivideCeil64(Height, PageSize);
+
+		FVoxelScopedSlowTask Compressing(NumPagesY, VOXEL_LOCTEXT("Compressing heightmap pages"));
+
+		TArray<uint8> UncompressedPage;
+		TArray<uint8> CompressedPage;
+		for (int64 PageY = 0; PageY < NumPagesY; PageY++)
+		{
+			Compressing.EnterProgressFrame();
+			for (int64 PageX = 0; PageX < NumPagesX; PageX++)
+			{
+				PageOffsets.Add(PagesData.Num());
+
+				const int64 StartX = PageX * PageSize;
+				const int64 StartY = PageY * PageSize;
+				const int64 SizeX = FMath::Min(PageSize, Width - StartX);
+				const int64 SizeY = FMath::Min(PageSize, Height - StartY);
+				const int64 NumPixels = SizeX * SizeY;
+
+				UncompressedPage.SetNumUninitialized(NumPixels * (sizeof(T) + MaterialSize));
+				uint8* RESTRICT PageHeights = UncompressedPage.GetData();
+				uint8* RESTRICT PageMaterials = UncompressedPage.GetData() + NumPixels * sizeof(T);
+
+				for (int64 LocalY = 0; LocalY < SizeY; LocalY++)
+				{
+					const int64 Index = GetIndex(StartX, StartY + LocalY);
+					FMemory::Memcpy(PageHeights + LocalY * SizeX * sizeof(T), &Heights[Index], SizeX * sizeof(T));
+					if (MaterialSize > 0)
+					{
+						FMemory::Memcpy(PageMaterials + LocalY * SizeX * MaterialSize, &Materials[Index * MaterialSize], SizeX * MaterialSize);
+					}
+				}
+
+				int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedPage.Num());
+				CompressedPage.SetNumUninitialized(CompressedSize);
+				verify(FCompression::CompressMemory(NAME_Zlib, CompressedPage.GetData(), CompressedSize, UncompressedPage.GetData(), UncompressedPage.Num()));
+
+				PagesData.Append(CompressedPage.GetData(), CompressedSize);
+			}
+		}
+		PageOffsets.Add(PagesData.Num());
+	}
+
+	OutBlob.Reset();
+	FMemoryWriter Writer(OutBlob);
+
+	int32 SerializedPageSize = PageSize;
+	int64 SerializedWidth = Width;
+	int64 SerializedHeight = Height;
+	T SerializedMaxHeight = MaxHeight;
+	T SerializedMinHeight = MinHeight;
+	EVoxelMaterialConfig SerializedMaterialConfig = MaterialConfig;
+	bool bSerializedHasMaterials = bHasMaterials;
+
+	Writer << SerializedPageSize;
+	Writer << SerializedWidth;
+	Writer << SerializedHeight;
+	Writer << SerializedMaxHeight;
+	Writer << SerializedMinHeight;
+	Writer << SerializedMaterialConfig;
+	Writer << bSerializedHasMaterials;
+	Writer << const_cast<TVoxelHeightmapAssetData<T>&>(*this).HeightRangeMips;
+	Writer << PageOffsets;
+
+	OutBlob.Append(PagesData);
+}
+
+template<typename T>
+bool TVoxelHeightmapAssetData<T>::LoadPaged(const TVoxelSharedRef<const TArray<uint8>>& Blob)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	ResetPages();
+
+	FMemoryReader Reader(*Blob);
+
+	int32 SerializedPageSize = 0;
+	bool bHasMaterials = false;
+	TArray<int64> PageOffsets;
+
+	Reader << SerializedPageSize;
+	Reader << Width;
+	Reader << Height;
+	Reader << MaxHeight;
+	Reader << MinHeight;
+	Reader << MaterialConfig;
+	Reader << bHasMaterials;
+	Reader << HeightRangeMips;
+	Reader << PageOffsets;
+
+	if (Reader.IsError() ||
+		SerializedPageSize != PageSize ||
+		Width <= 0 ||
+		Height <= 0)
+	{
+		return false;
+	}
+
+	const int64 NumPagesX = FVoxelUtilities::DivideCeil64(Width, PageSize);
+	const int64 NumPagesY = FVoxelUtilities::DivideCeil64(Height, PageSize);
+	const int64 PagesStart = Reader.Tell();
+
+	if (PageOffsets.Num() != NumPagesX * NumPagesY + 1 ||
+		PagesStart + PageOffsets.Last() != Blob->Num())
+	{
+		return false;
+	}
+
+	Heights.Empty();
+	Materials.Empty();
+
+	Paged = MakeUnique<FPagedStorage>();
+	Paged->Blob = Blob;
+	Paged->PagesStart = PagesStart;
+	Paged->bHasMaterials = bHasMaterials;
+	Paged->NumPagesX = NumPagesX;
+	Paged->NumPagesY = NumPagesY;
+	Paged->PageOffsets = MoveTemp(PageOffsets);
+
+	bPaged = true;
+
+	UpdateStats();
+	return true;
+}
+
+template<typename T>
+void TVoxelHeightmapAssetData<T>::Unpage()
+{
+	if (!bPaged)
+	{
+		return;
+	}
+
+	VOXEL_FUNCTION_COUNTER();
+
+	const int64 MaterialSize = Paged->bHasMaterials ? GetMaterialSize() : 0;
+
+	TNoGrowArray64<T> NewHeights;
+	NewHeights.Empty(Width * Height);
+	NewHeights.SetNumUninitialized(Width * Height);
+
+	TNoGrowArray64<uint8> NewMaterials;
+	if (MaterialSize > 0)
+	{
+		NewMaterials.Empty(Width * Height * MaterialSize);
+		NewMaterials.SetNumUninitialized(Width * Height * MaterialSize);
+	}
+
+	for (int64 PageY = 0; PageY < Paged->NumPagesY; PageY++)
+	{
+		for (int64 PageX = 0; PageX < Paged->NumPagesX; PageX++)
+		{
+			// Don't go through the cache, we don't want to evict everything
+			const auto Page = DecompressPage(PageX + Paged->NumPagesX * PageY);
+
+			const int64 StartX = PageX * PageSize;
+			const int64 StartY = PageY * PageSize;
+			const int64 SizeY = Page->NumPixels / Page->Width;
+
+			for (int64 LocalY = 0; LocalY < SizeY; LocalY++)
+			{
+				const int64 Index = GetIndex(StartX, StartY + LocalY);
+				FMemory::Memcpy(&NewHeights[Index], Page->GetHeights() + LocalY * Page->Width, Page->Width * sizeof(T));
+				if (MaterialSize > 0)
+				{
+					FMemory::Memcpy(&NewMaterials[Index * MaterialSize], Page->GetMaterials() + LocalY * Page->Width * MaterialSize, Page->Width * MaterialSize);
+				}
+			}
+		}
+	}
+
+	Heights = MoveTemp(NewHeights);
+	Materials = MoveTemp(NewMaterials);
+
+	// Other threads might still be sampling the pages: only switch once the flat arrays are ready, and keep the paged storage alive
+	FPlatformMisc::MemoryBarrier();
+	bPaged = false;
+
+	{
+		const auto Changes = Paged->Pages.Empty();
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetPagesMemory, Changes.RemovedSize);
+	}
+
+	UpdateStats();
+}
+
+template<typename T>
+void TVoxelHeightmapAssetData<T>::ResetPages()
+{
+	bPaged = false;
+	Paged.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+TVoxelSharedRef<const typename TVoxelHeightmapAssetData<T>::FPageData> TVoxelHeightmapAssetData<T>::GetPage(int64 PageX, int64 PageY) const
+{
+	checkVoxelSlow(bPaged);
+	checkVoxelSlow(0 <= PageX && PageX < Paged->NumPagesX);
+	checkVoxelSlow(0 <= PageY && PageY < Paged->NumPagesY);
+
+	FPagedStorage& Storage = *Paged;
+	const int64 PageIndex = PageX + Storage.NumPagesX * PageY;
+
+	if (const TVoxelSharedPtr<const FPageData> Page = Storage.Pages.Find(PageIndex))
+	{
+		return Page.ToSharedRef();
+	}
+
+	const TVoxelSharedRef<const FPageData> NewPage = DecompressPage(PageIndex);
+
+	TVoxelLRUCache<int64, FPageData>::FChanges Changes;
+	const TVoxelSharedRef<const FPageData> Page = Storage.Pages.Add(PageIndex, NewPage, FVoxelHeightmapAssetPaging::GetMaxResidentPagesSize(), Changes);
+
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetPagesMemory, Changes.AddedSize);
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetPagesMemory, Changes.RemovedSize);
+	if (Changes.AddedSize > 0)
+	{
+		FVoxelHeightmapAssetPaging::OnPageIn();
+	}
+	FVoxelHeightmapAssetPaging::OnPagesEvicted(Changes.NumEvicted);
+
+	return Page;
+}
+
+template<typename T>
+FORCEINLINE const typename TVoxelHeightmapAssetData<T>::FPageData& TVoxelHeightmapAssetData<T>::GetPage(int64 PageX, int64 PageY, FPageCache& Cache) const
+{
+	const int64 PageIndex = PageX + Paged->NumPagesX * PageY;
+	if (Cache.Storage != Paged.Get() || Cache.PageIndex != PageIndex)
+	{
+		Cache.Storage = Paged.Get();
+		Cache.PageIndex = PageIndex;
+		Cache.Page = GetPage(PageX, PageY);
+	}
+	return *Cache.Page;
+}
+
+template<typename T>
+TVoxelSharedRef<typename TVoxelHeightmapAssetData<T>::FPageData> TVoxelHeightmapAssetData<T>::DecompressPage(int64 PageIndex) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const FPagedStorage& Storage = *Paged;
+
+	const int64 PageX = PageIndex % Storage.NumPagesX;
+	const int64 PageY = PageIndex / Storage.NumPagesX;
+	const int64 SizeX = FMath::Min(PageSize, Width - PageX * PageSize);
+	const int64 SizeY = FMath::Min(PageSize, Height - PageY * PageSize);
+	const int64 MaterialSize = Storage.bHasMaterials ? GetMaterialSize() : 0;
+
+	const auto Page = MakeVoxelShared<FPageData>();
+	Page->Width = SizeX;
+	Page->NumPixels = SizeX * SizeY;
+	Page->Bytes.SetNumUninitialized(Page->NumPixels * (sizeof(T) + MaterialSize));
+
+	const int64 CompressedStart = Storage.PagesStart + Storage.PageOffsets[PageIndex];
+	const int64 CompressedSize = Storage.PageOffsets[PageIndex + 1] - Storage.PageOffsets[PageIndex];
+
+	if (!ensureMsgf(FCompression::UncompressMemory(NAME_Zlib, Page->Bytes.GetData(), Page->Bytes.Num(), Storage.Blob->GetData() + CompressedStart, CompressedSize),
+		TEXT("Failed to decompress heightmap page %lld, data is corrupted"), PageIndex))
+	{
+		T* RESTRICT PageHeights = reinterpret_cast<T*>(Page->Bytes.GetData());
+		for (int64 Index = 0; Index < Page->NumPixels; Index++)
+		{
+			PageHeights[Index] = MinHeight;
+		}
+		FMemory::Memzero(Page->Bytes.GetData() + Page->NumPixels * sizeof(T), Page->NumPixels * MaterialSize);
+	}
+
+	return Page;
+}
+
+template<typename T>
+T TVoxelHeightmapAssetData<T>::GetPagedHeight(int64 X, int64 Y, FPageCache& Cache) const
+{
+	const int64 PageX = X / PageSize;
+	const int64 PageY = Y / PageSize;
+	const FPageData& Page = GetPage(PageX, PageY, Cache);
+	return Page.GetHeights()[(X - PageX * PageSize) + Page.Width * (Y - PageY * PageSize)];
+}
+
+template<typename T>
+FVoxelMaterial TVoxelHeightmapAssetData<T>::GetPagedMaterial(int64 X, int64 Y, FPageCache& Cache) const
+{
+	const int64 PageX = X / PageSize;
+	const int64 PageY = Y / PageSize;
+	const FPageData& Page = GetPage(PageX, PageY, Cache);
+	return GetMaterialFromBytes(Page.GetMaterials(), (X - PageX * PageSize) + Page.Width * (Y - PageY * PageSize), MaterialConfig);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 template<typename T>
 void TVoxelHeightmapAssetData<T>::UpdateStats()
 {
@@ -612,5 +1047,10 @@ void TVoxelHeightmapAssetData<T>::UpdateStats()
 	{
 		AllocatedSize += Mip.Data.GetAllocatedSize();
 	}
+	if (Paged.IsValid())
+	{
+		// The blob itself is owned by the asset
+		AllocatedSize += Paged->PageOffsets.GetAllocatedSize();
+	}
 	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetMemory, AllocatedSize);
 }
\ No newline at end of file
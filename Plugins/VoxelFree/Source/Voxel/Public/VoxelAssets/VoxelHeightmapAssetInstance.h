@@ -94,11 +94,14 @@ public:
 	}
 	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override final
 	{
+		// Queries are small compared to pages: most of them only look up a single page
+		typename TVoxelHeightmapAssetSamplerWrapper<T>::FPageCache PageCache;
+		
 		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				const float Height = Wrapper.GetHeight(X + Wrapper.GetWidth() / 2, Y + Wrapper.GetHeight() / 2, EVoxelSamplerMode::Clamp);
+				const float Height = Wrapper.GetHeight(X + Wrapper.GetWidth() / 2, Y + Wrapper.GetHeight() / 2, EVoxelSamplerMode::Clamp, PageCache);
 
 				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 				{
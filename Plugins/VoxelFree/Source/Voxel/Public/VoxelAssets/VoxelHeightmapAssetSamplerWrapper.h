@@ -14,6 +14,8 @@ struct TVoxelHeightmapAssetSamplerWrapper
 	const float HeightOffset;
 	const TVoxelSharedRef<TVoxelHeightmapAssetData<T>> Data;
 
+	using FPageCache = typename TVoxelHeightmapAssetData<T>::FPageCache;
+
 	explicit VOXEL_API TVoxelHeightmapAssetSamplerWrapper(UVoxelHeightmapAsset* Asset);
 
 	float GetHeight(v_flt X, v_flt Y, EVoxelSamplerMode SamplerMode) const
@@ -24,6 +26,16 @@ struct TVoxelHeightmapAssetSamplerWrapper
 	{
 		return Data->GetMaterial(float(X / Scale), float(Y / Scale), SamplerMode);
 	}
+	
+	// Use when sampling many positions in a row, eg in a query
+	float GetHeight(v_flt X, v_flt Y, EVoxelSamplerMode SamplerMode, FPageCache& Cache) const
+	{
+		return HeightOffset + HeightScale * Data->GetHeight(float(X / Scale), float(Y / Scale), SamplerMode, Cache);
+	}
+	FVoxelMaterial GetMaterial(v_flt X, v_flt Y, EVoxelSamplerMode SamplerMode, FPageCache& Cache) const
+	{
+		return Data->GetMaterial(float(X / Scale), float(Y / Scale), SamplerMode, Cache);
+	}
 
 	TVoxelRange<float> GetHeightRange(TVoxelRange<v_flt> X, TVoxelRange<v_flt> Y, EVoxelSamplerMode SamplerMode) const
 	{
@@ -28,6 +28,7 @@ namespace FVoxelCookedDataVersion
 		SHARED_AddUserFlagsToSaves,
 		SHARED_StoreSpawnerMatricesRelativeToComponent,
 		SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage,
+		AddChunkPositionsAndFormat,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -35,6 +36,12 @@ namespace FVoxelCookedDataVersion
 	};
 };
 
+enum class EVoxelCookedDataFormat : uint8
+{
+	PhysX,
+	Chaos
+};
+
 struct VOXEL_API FVoxelCookedDataImpl
 {
 	FVoxelCookedDataImpl() = default;
@@ -51,13 +58,9 @@ struct VOXEL_API FVoxelCookedDataImpl
 public:
 	struct FChunk
 	{
+		// Render chunk Bounds.Min
+		FIntVector Position = FIntVector(ForceInit);
 		TArray<uint8> Data;
-
-		friend FArchive& operator<<(FArchive& Ar, FChunk& Chunk)
-		{
-			Chunk.Data.BulkSerialize(Ar);
-			return Ar;
-		}
 	};
 	
 	void SetNumChunks(int32 Num)
@@ -68,6 +71,10 @@ public:
 	{
 		return Chunks[Index];
 	}
+	void AddChunk(const FChunk& Chunk)
+	{
+		Chunks.Add(Chunk);
+	}
 	void RemoveEmptyChunks();
 
 	const TArray<FChunk>& GetChunks() const
@@ -78,10 +85,25 @@ public:
 	{
 		return Chunks.Num() == 0;
 	}
+
+	EVoxelCookedDataFormat GetFormat() const
+	{
+		return Format;
+	}
+	void SetFormat(EVoxelCookedDataFormat NewFormat)
+	{
+		Format = NewFormat;
+	}
+	// Older cooked data doesn't store the chunk positions, and can't be incrementally updated
+	bool HasChunkPositions() const
+	{
+		return Version >= FVoxelCookedDataVersion::AddChunkPositionsAndFormat;
+	}
 	
 private:
-	int32 Version;
+	int32 Version = FVoxelCookedDataVersion::LatestVersion;
 	FGuid Guid;
+	EVoxelCookedDataFormat Format = EVoxelCookedDataFormat::PhysX;
 
 	TArray<FChunk> Chunks;
 
@@ -47,7 +47,8 @@ class VOXEL_API UVoxelCookingLibrary : public UBlueprintFunctionLibrary
 	GENERATED_BODY()
 
 public:
-	static FVoxelCookedData CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save = nullptr);
+	// If PreviousCookedData is set, only the chunks intersecting the save edits will be cooked, and the others copied from it
+	static FVoxelCookedData CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save = nullptr, const FVoxelCookedDataImpl* PreviousCookedData = nullptr);
 
 	// Cook collision meshes and save the result to VoxelCookedData
 	// Can then be loaded using LoadCookedVoxelData
@@ -65,7 +66,23 @@ public:
 	{
 		return CookVoxelDataImpl(Settings, &Save.Const());
 	}
+	// Only re-cook the chunks intersecting the save edits, and copy the others from PreviousCookedData
+	// PreviousCookedData must have been cooked with the same settings and a subset of the edits of Save
+	// Note: a save holds all the edits of the world, not the ones made since the previous cook: every chunk edited since the world
+	// was created is re-cooked, not only the ones edited since PreviousCookedData
+	// Useful to quickly update cooked data after small edits
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking")
+	static FVoxelCookedData CookVoxelDataIncremental(FVoxelCookingSettings Settings, FVoxelUncompressedWorldSave Save, FVoxelCookedData PreviousCookedData)
+	{
+		return CookVoxelDataImpl(Settings, &Save.Const(), &PreviousCookedData.Const());
+	}
 	
+	// Run the generator of World over its whole bounds, and save its values and materials to the world Generator Snapshot Path
+	// The world will then read them instead of running the generator once recreated
+	// Must be baked again when the generator is edited
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking", meta = (DefaultToSelf = "World"))
+	static bool BakeGeneratorSnapshot(AVoxelWorld* World, int32 ThreadCount = 2);
+
 	UFUNCTION(BlueprintPure, Category = "Voxel|Cooking", meta = (DefaultToSelf = "World"))
 	static FVoxelCookingSettings MakeVoxelCookingSettingsFromVoxelWorld(AVoxelWorld* World, int32 ThreadCount = 2);
 
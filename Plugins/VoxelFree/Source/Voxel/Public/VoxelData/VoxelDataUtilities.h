@@ -110,4 +110,11 @@ namespace FVoxelDataUtilities
 
 	template<typename T>
 	void ScaleWorldData(const FVoxelData& SourceData, FVoxelData& DestData, const FVoxelVector& Scale);
+
+	/**
+	 * Find the closest voxel to Position that is empty if bSearchEmpty, or not empty otherwise
+	 * Data chunks are visited by increasing distance, and are skipped entirely if their value range proves they can't match
+	 * Requires read lock in FVoxelIntBox(Position).Extend(SearchRange)
+	 */
+	VOXEL_API TOptional<FIntVector> FindClosestVoxel(const FVoxelData& Data, const FVoxelVector& Position, int32 SearchRange, bool bSearchEmpty);
 }
\ No newline at end of file
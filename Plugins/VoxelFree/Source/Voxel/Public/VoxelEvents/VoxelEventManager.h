@@ -106,6 +106,9 @@ protected:
 	//~ End FVoxelTickable Interface
 	
 private:
+	// Drives UpdateInvokers directly, see voxel.events.Benchmark
+	friend class FVoxelEventManagerBenchmark;
+
 	struct FEventKey
 	{
 		int32 ChunkSize = -1;
@@ -146,6 +149,31 @@ private:
 		{
 		}
 	};
+	// Chunks within the activation radius of an invoker, stored as a Z range per XY column
+	struct FInvokerChunks
+	{
+		// Columns range, Max is exclusive
+		FIntPoint Min = FIntPoint(0, 0);
+		FIntPoint Max = FIntPoint(0, 0);
+		// Z range of each column, Y is exclusive. Empty if X >= Y
+		TArray<FIntPoint> ZRanges;
+
+		FInvokerChunks() = default;
+		FInvokerChunks(const FIntVector& Position, int32 ChunkSize, int32 DistanceInChunks, const FVoxelIntBox& WorldBounds);
+
+		inline int32 NumColumns() const
+		{
+			return (Max.X - Min.X) * (Max.Y - Min.Y);
+		}
+		inline FIntPoint GetZRange(int32 X, int32 Y) const
+		{
+			if (X < Min.X || X >= Max.X || Y < Min.Y || Y >= Max.Y)
+			{
+				return FIntPoint(0, 0);
+			}
+			return ZRanges[(X - Min.X) + (Y - Min.Y) * (Max.X - Min.X)];
+		}
+	};
 	struct FEventInfo
 	{
 		const int32 ChunkSize;
@@ -154,6 +182,11 @@ private:
 		FChunkMulticastDelegate OnActivate;
 		FChunkMulticastDelegate OnDeactivate;
 		TSet<FIntVector> ActiveOrGeneratedChunks; // If generation event this is the list of already generated chunks
+		
+		// Number of invokers having each chunk in their activation radius
+		TMap<FIntVector, int32> ChunkRefCounts;
+		// The invoker chunks currently accounted for in ChunkRefCounts
+		TArray<FInvokerChunks> InvokersChunks;
 
 		FEventInfo(int32 ChunkSize, int32 Distance, uint32 Flags)
 			: ChunkSize(ChunkSize)
@@ -163,7 +196,15 @@ private:
 		}
 
 		inline bool IsBound() const { return OnActivate.IsBound() || OnDeactivate.IsBound(); }
-		inline uint32 GetAllocatedSize() const { return sizeof(*this) + ActiveOrGeneratedChunks.GetAllocatedSize(); }
+		inline uint32 GetAllocatedSize() const
+		{
+			uint32 AllocatedSize = sizeof(*this) + ActiveOrGeneratedChunks.GetAllocatedSize() + ChunkRefCounts.GetAllocatedSize() + InvokersChunks.GetAllocatedSize();
+			for (auto& InvokerChunks : InvokersChunks)
+			{
+				AllocatedSize += InvokerChunks.ZRanges.GetAllocatedSize();
+			}
+			return AllocatedSize;
+		}
 	};
 
 	double LastUpdateTime = 0;
@@ -174,6 +215,8 @@ private:
 
 	void Update();
 	void UpdateInvokers(const TArray<TPair<FEventKey, TArray<FIntVector>>>& InvokersToUpdate);
+	// Add the chunks that are in New but not in Old to Added, and the ones in Old but not in New to Removed
+	static void GetInvokerChunksDelta(const FInvokerChunks& Old, const FInvokerChunks& New, TArray<FIntVector>& Added, TArray<FIntVector>& Removed);
 	void ClearOldInvokerComponents();
 
 private:
@@ -11,6 +11,7 @@
 
 class UVoxelGeneratorInstanceWrapper;
 class UVoxelTransformableGeneratorInstanceWrapper;
+class FVoxelGeneratorInstanceCache;
 
 UCLASS(BlueprintType)
 class VOXEL_API UVoxelGeneratorCache : public UObject
@@ -19,6 +20,8 @@ public:
 	GENERATED_BODY()
 
 public:
+	UVoxelGeneratorCache();
+	
 	/**
 	 * Creates (or reuse if possible) a new generator instance
 	 *
@@ -35,17 +38,30 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	UVoxelTransformableGeneratorInstanceWrapper* MakeTransformableGeneratorInstance(FVoxelTransformableGeneratorPicker Picker) const;
 
+	/**
+	 * Removes the instances created from this generator, so that new ones are created on the next use
+	 * Instances already in use are not affected
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	void InvalidateGenerator(UObject* Generator);
+
 public:
-	void SetGeneratorInit(const FVoxelGeneratorInit& NewInit)
+	// Thread safe, and can be kept by worker threads. The instance wrappers returned above share its instances
+	const TVoxelSharedRef<FVoxelGeneratorInstanceCache>& GetInstanceCache() const
 	{
-		GeneratorInit = NewInit;
-	}
-	void ClearCache()
-	{
-		Cache.Reset();
+		return InstanceCache;
 	}
 
+	void SetGeneratorInit(const FVoxelGeneratorInit& NewInit);
+	void ClearCache();
+
+	//~ Begin UObject Interface
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ End UObject Interface
+
 private:
+	TVoxelSharedRef<FVoxelGeneratorInstanceCache> InstanceCache;
+	
 	UPROPERTY()
 	FVoxelGeneratorInit GeneratorInit;
 	
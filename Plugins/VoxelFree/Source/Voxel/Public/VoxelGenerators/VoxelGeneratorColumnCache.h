@@ -0,0 +1,112 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelUtilities/VoxelLRUCache.h"
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Generator Column Cache Memory"), STAT_VoxelGeneratorColumnCacheMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+/**
+ * Caches per column data of a generator instance, eg the XY stage of a graph, so that it isn't recomputed
+ * for every chunk stacked vertically or for every refinement of the same area
+ * Columns are stored by tiles of TileSize * TileSize, and the least recently used tiles are evicted once
+ * the cache is over voxel.generator.ColumnCache.SizeMB
+ * Thread safe
+ */
+class VOXEL_API FVoxelGeneratorColumnCache
+{
+public:
+	static constexpr int32 TileSize = 8;
+
+	struct FKey
+	{
+		// Position of the tile, in TileSize * Step units
+		FIntPoint Tile;
+		int32 Step = 1;
+		int32 LOD = 0;
+		// Used to store different data in the same cache, eg one per graph target
+		uint32 Type = 0;
+
+		bool operator==(const FKey& Other) const
+		{
+			return
+				Tile == Other.Tile &&
+				Step == Other.Step &&
+				LOD == Other.LOD &&
+				Type == Other.Type;
+		}
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.Tile), GetTypeHash(Key.Step)), HashCombine(GetTypeHash(Key.LOD), GetTypeHash(Key.Type)));
+		}
+	};
+
+	struct FTile
+	{
+		virtual ~FTile() = default;
+		virtual uint32 GetAllocatedSize() const = 0;
+	};
+	template<typename T>
+	struct TTile : FTile
+	{
+		// Indexed by X + TileSize * Y
+		TArray<T, TFixedAllocator<TileSize * TileSize>> Columns;
+
+		virtual uint32 GetAllocatedSize() const override
+		{
+			return sizeof(*this);
+		}
+	};
+
+	struct FStats
+	{
+		uint64 Hits = 0;
+		uint64 Misses = 0;
+		uint64 Evictions = 0;
+		int32 NumTiles = 0;
+		int64 AllocatedSize = 0;
+	};
+
+public:
+	FVoxelGeneratorColumnCache() = default;
+	~FVoxelGeneratorColumnCache();
+
+	UE_NONCOPYABLE(FVoxelGeneratorColumnCache);
+
+	// voxel.generator.ColumnCache
+	static bool IsEnabled();
+
+	/**
+	 * Compute is called outside of the lock, with the tile to fill: void Compute(TTile<T>& Tile)
+	 * Two threads missing the same tile at the same time will both compute it, the first one being kept
+	 */
+	template<typename T, typename TCompute>
+	TVoxelSharedRef<const TTile<T>> FindOrCompute(const FKey& Key, TCompute Compute)
+	{
+		const TVoxelSharedPtr<const FTile> ExistingTile = Find(Key);
+		if (ExistingTile.IsValid())
+		{
+			return StaticCastVoxelSharedRef<const TTile<T>>(ExistingTile.ToSharedRef());
+		}
+
+		const TVoxelSharedRef<TTile<T>> Tile = MakeVoxelShared<TTile<T>>();
+		Tile->Columns.SetNum(TileSize * TileSize);
+		Compute(*Tile);
+
+		return StaticCastVoxelSharedRef<const TTile<T>>(Add(Key, Tile));
+	}
+
+	void Clear();
+	FStats GetStats() const;
+
+private:
+	TVoxelLRUCache<FKey, FTile> Tiles;
+	FThreadSafeCounter64 Hits;
+	FThreadSafeCounter64 Misses;
+	FThreadSafeCounter64 Evictions;
+
+	TVoxelSharedPtr<const FTile> Find(const FKey& Key);
+	TVoxelSharedRef<const FTile> Add(const FKey& Key, const TVoxelSharedRef<const FTile>& Tile);
+};
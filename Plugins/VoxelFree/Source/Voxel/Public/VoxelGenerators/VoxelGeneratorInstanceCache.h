@@ -0,0 +1,84 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelGenerators/VoxelGeneratorInit.h"
+#include "VoxelGenerators/VoxelGeneratorPicker.h"
+
+class FVoxelGeneratorInstance;
+class FVoxelTransformableGeneratorInstance;
+
+/**
+ * Thread safe cache of generator instances, keyed by picker
+ * The entries are split in NumShards shards each with its own read/write lock, so that concurrent lookups
+ * only take a shared lock and don't contend unless they miss
+ * Instances are refcounted: invalidating an entry doesn't affect the callers still using the instance
+ */
+class VOXEL_API FVoxelGeneratorInstanceCache
+{
+public:
+	static constexpr int32 NumShards = 16;
+
+	struct FStats
+	{
+		int32 NumInstances = 0;
+		int32 NumTransformableInstances = 0;
+	};
+
+public:
+	explicit FVoxelGeneratorInstanceCache(const FVoxelGeneratorInit& GeneratorInit);
+
+	UE_NONCOPYABLE(FVoxelGeneratorInstanceCache);
+
+	const FVoxelGeneratorInit& GetGeneratorInit() const
+	{
+		return GeneratorInit;
+	}
+
+	/**
+	 * On miss the instance is created and initialized outside of the locks. This uses the generator UObjects,
+	 * so misses must happen on the game thread: worker threads should use FindInstance on warmed up pickers
+	 */
+	TVoxelSharedRef<FVoxelGeneratorInstance> GetInstance(const FVoxelGeneratorPicker& Picker);
+	TVoxelSharedRef<FVoxelTransformableGeneratorInstance> GetTransformableInstance(const FVoxelTransformableGeneratorPicker& Picker);
+
+	// Any thread. Returns null if the instance wasn't created yet
+	TVoxelSharedPtr<FVoxelGeneratorInstance> FindInstance(const FVoxelGeneratorPicker& Picker) const;
+	TVoxelSharedPtr<FVoxelTransformableGeneratorInstance> FindTransformableInstance(const FVoxelTransformableGeneratorPicker& Picker) const;
+
+	// Game thread only. Create the instances that worker threads will look up with FindInstance
+	void WarmUp(const TArray<FVoxelGeneratorPicker>& Pickers);
+
+	// Remove all the instances created from Generator, eg because its parameters changed
+	void Invalidate(const UObject* Generator);
+	void Clear();
+
+	FStats GetStats() const;
+	// The generators used as keys, to keep them alive
+	void GetReferencedObjects(TArray<UObject*>& OutObjects) const;
+
+private:
+	template<typename TPicker>
+	struct TShard
+	{
+		mutable FRWLock Lock;
+		TMap<TPicker, TVoxelSharedRef<typename TPicker::FGeneratorInstance>> Instances;
+	};
+
+	const FVoxelGeneratorInit GeneratorInit;
+
+	TShard<FVoxelGeneratorPicker> Shards[NumShards];
+	TShard<FVoxelTransformableGeneratorPicker> TransformableShards[NumShards];
+
+	// Incremented on invalidation, so that instances created before it aren't added after it
+	FThreadSafeCounter Generation;
+
+	template<typename TPicker>
+	TVoxelSharedRef<typename TPicker::FGeneratorInstance> GetInstanceImpl(TShard<TPicker>* InShards, const TPicker& Picker);
+	template<typename TPicker>
+	static TVoxelSharedPtr<typename TPicker::FGeneratorInstance> FindInstanceImpl(const TShard<TPicker>* InShards, const TPicker& Picker);
+	template<typename TPicker>
+	static void InvalidateShards(TShard<TPicker>* InShards, const UObject* Generator);
+};
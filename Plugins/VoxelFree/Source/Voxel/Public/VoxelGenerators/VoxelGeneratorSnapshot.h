@@ -0,0 +1,265 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelValue.h"
+#include "VoxelMaterial.h"
+#include "VoxelIntBox.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.h"
+#include "VoxelUtilities/VoxelLRUCache.h"
+#include "Templates/IntegerSequence.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FVoxelGeneratorPicker;
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Generator Snapshot Leaves Memory"), STAT_VoxelGeneratorSnapshotLeavesMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+/**
+ * Values and materials of a generator baked over the world bounds, by leaves of DATA_CHUNK_SIZE^3 voxels
+ * Leaves that the generator range analysis proves empty or full are only stored as a 2 bits state: the other leaves are compressed individually
+ * The file is memory mapped when the platform supports it, so opening it only reads the header: leaves are decompressed when first queried,
+ * and the least recently used ones are evicted once over voxel.snapshot.CacheSizeMB
+ * Thread safe
+ */
+class VOXEL_API FVoxelGeneratorSnapshot
+{
+public:
+	enum class ELeafState : uint8
+	{
+		Empty = 0,
+		Full = 1,
+		// Has a FLeafEntry
+		Baked = 2
+	};
+
+	// Written as is: snapshots can only be loaded on platforms with the same endianness and with the same voxel config
+	struct FHeader
+	{
+		uint32 Magic = 0;
+		int32 Version = 0;
+		uint32 GeneratorHash = 0;
+		uint32 ValueConfigFlag = 0;
+		uint32 MaterialConfigFlag = 0;
+		int32 LeafEntrySize = 0;
+		// In leaves
+		FIntVector GridMin = FIntVector(ForceInit);
+		FIntVector GridSize = FIntVector(ForceInit);
+		int64 NumEntries = 0;
+		int64 StatesOffset = 0;
+		int64 EntriesOffset = 0;
+	};
+	// One per baked leaf, sorted by LeafIndex
+	struct FLeafEntry
+	{
+		int64 LeafIndex = 0;
+		// From the start of the file
+		int64 PayloadOffset = 0;
+		// 0 if both the values and the materials are uniform
+		int32 PayloadSize = 0;
+		int32 UncompressedPayloadSize = 0;
+		FVoxelValue UniformValue = FVoxelValue(ForceInit);
+		FVoxelMaterial UniformMaterial = FVoxelMaterial(ForceInit);
+		uint8 bUniformValue = false;
+		uint8 bUniformMaterial = false;
+	};
+
+	struct FLeafData
+	{
+		// Empty if uniform
+		TArray<FVoxelValue> Values;
+		TArray<FVoxelMaterial> Materials;
+
+		FVoxelValue UniformValue;
+		FVoxelMaterial UniformMaterial;
+
+		FORCEINLINE void Get(int32 Index, FVoxelValue& OutValue) const
+		{
+			OutValue = Values.Num() > 0 ? Values.GetData()[Index] : UniformValue;
+		}
+		FORCEINLINE void Get(int32 Index, FVoxelMaterial& OutMaterial) const
+		{
+			OutMaterial = Materials.Num() > 0 ? Materials.GetData()[Index] : UniformMaterial;
+		}
+		int64 GetAllocatedSize() const
+		{
+			return sizeof(*this) + Values.GetAllocatedSize() + Materials.GetAllocatedSize();
+		}
+	};
+
+	struct FBakeStats
+	{
+		int64 NumLeaves = 0;
+		int64 NumEmptyLeaves = 0;
+		int64 NumFullLeaves = 0;
+		int64 NumBakedLeaves = 0;
+		int64 FileSize = 0;
+		double Time = 0;
+	};
+
+public:
+	// Use Load
+	FVoxelGeneratorSnapshot();
+	~FVoxelGeneratorSnapshot();
+
+	UE_NONCOPYABLE(FVoxelGeneratorSnapshot);
+
+	/**
+	 * Hash of the generator object path and properties, its parameters and the generator init
+	 * Game thread only, as the generator properties are serialized
+	 */
+	static uint32 ComputeGeneratorHash(const FVoxelGeneratorPicker& Picker, const FVoxelGeneratorInit& Init);
+
+	/**
+	 * Run Generator over Bounds on a pool of ThreadCount threads, and write the result to Path
+	 * Generator must be initialized
+	 */
+	static bool Bake(const FVoxelGeneratorInstance& Generator, uint32 GeneratorHash, const FVoxelIntBox& Bounds, int32 ThreadCount, const FString& Path, FBakeStats& OutStats);
+
+	// Returns null if the file is missing, corrupted or baked with another voxel config
+	static TVoxelSharedPtr<FVoxelGeneratorSnapshot> Load(const FString& Path);
+
+	/**
+	 * Wrap Generator so that it reads from the snapshot at Path
+	 * Returns Generator as is if the snapshot can't be loaded or was baked from another generator
+	 */
+	static TVoxelSharedRef<FVoxelGeneratorInstance> CreateInstance(const TVoxelSharedRef<FVoxelGeneratorInstance>& Generator, uint32 GeneratorHash, const FString& Path);
+
+	// Relative paths are relative to the project directory
+	static FString GetFullPath(const FString& Path);
+
+public:
+	uint32 GetGeneratorHash() const
+	{
+		return Header.GeneratorHash;
+	}
+	// In voxels
+	const FVoxelIntBox& GetBounds() const
+	{
+		return Bounds;
+	}
+	bool IsMapped() const
+	{
+		return MappedRegion.IsValid();
+	}
+	int64 GetNumBakedLeaves() const
+	{
+		return Header.NumEntries;
+	}
+	int64 GetFileSize() const
+	{
+		return FileSize;
+	}
+	int64 GetResidentLeavesSize() const
+	{
+		return CachedLeaves.GetValuesAllocatedSize();
+	}
+
+	// Leaf is in DATA_CHUNK_SIZE units
+	FORCEINLINE bool IsInGrid(const FIntVector& Leaf) const
+	{
+		return
+			Header.GridMin.X <= Leaf.X && Leaf.X < Header.GridMin.X + Header.GridSize.X &&
+			Header.GridMin.Y <= Leaf.Y && Leaf.Y < Header.GridMin.Y + Header.GridSize.Y &&
+			Header.GridMin.Z <= Leaf.Z && Leaf.Z < Header.GridMin.Z + Header.GridSize.Z;
+	}
+	FORCEINLINE ELeafState GetLeafState(const FIntVector& Leaf) const
+	{
+		checkVoxelSlow(IsInGrid(Leaf));
+		const int64 LeafIndex = GetLeafIndex(Leaf);
+		return ELeafState((States[LeafIndex >> 2] >> (2 * (LeafIndex & 3))) & 0x3);
+	}
+	// Leaf must be baked
+	TVoxelSharedRef<const FLeafData> GetLeaf(const FIntVector& Leaf) const;
+
+	FORCEINLINE static int32 GetIndexInLeaf(int32 X, int32 Y, int32 Z)
+	{
+		return X + DATA_CHUNK_SIZE * Y + DATA_CHUNK_SIZE * DATA_CHUNK_SIZE * Z;
+	}
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// Used if the file can't be mapped
+	TArray64<uint8> LoadedFile;
+
+	const uint8* FileData = nullptr;
+	int64 FileSize = 0;
+
+	FHeader Header;
+	FVoxelIntBox Bounds;
+	// 2 bits per leaf, in FileData
+	const uint8* States = nullptr;
+
+	// Decompressed leaves, by entry index
+	mutable TVoxelLRUCache<int64, FLeafData> CachedLeaves;
+
+	FORCEINLINE int64 GetLeafIndex(const FIntVector& Leaf) const
+	{
+		const FIntVector Local = Leaf - Header.GridMin;
+		return Local.X + Header.GridSize.X * (Local.Y + int64(Header.GridSize.Y) * Local.Z);
+	}
+
+	FLeafEntry GetEntry(int64 EntryIndex) const;
+	int64 FindEntry(int64 LeafIndex) const;
+	TVoxelSharedRef<FLeafData> DecompressLeaf(const FLeafEntry& Entry) const;
+
+	bool InitFromFileData(const FString& Path);
+};
+
+/**
+ * Generator instance reading values and materials from a snapshot, and forwarding to the generator it was baked from:
+ * - queries with data items, or outside of the snapshot bounds
+ * - materials of the leaves proven empty or full, as they aren't baked
+ * - single voxel queries, range analysis, up vectors and custom outputs
+ * Values queried at LOD > 0 are the LOD 0 values: generators lowering their details based on LOD will have full details instead
+ */
+class VOXEL_API FVoxelGeneratorSnapshotInstance : public FVoxelGeneratorInstance
+{
+public:
+	// The function pointers of the source generator can't be called on this instance:
+	// custom outputs are forwarded by a fixed number of functions each reading the name of their output
+	static constexpr int32 MaxForwardedCustomOutputs = 32;
+
+	const TVoxelSharedRef<FVoxelGeneratorInstance> Source;
+	const TVoxelSharedRef<const FVoxelGeneratorSnapshot> Snapshot;
+
+	FVoxelGeneratorSnapshotInstance(const TVoxelSharedRef<FVoxelGeneratorInstance>& Source, const TVoxelSharedRef<const FVoxelGeneratorSnapshot>& Snapshot);
+
+	//~ Begin FVoxelGeneratorInstance Interface
+	virtual void Init(const FVoxelGeneratorInit& InitStruct) override;
+	virtual void InitArea(const FVoxelIntBox& Bounds, int32 LOD) override;
+	virtual void SetupMaterialInstance(int32 ChunkLOD, const FVoxelIntBox& ChunkBounds, UMaterialInstanceDynamic* Instance) override;
+	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override;
+	virtual void GetMaterials(TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override;
+	virtual FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override;
+	//~ End FVoxelGeneratorInstance Interface
+
+private:
+	TArray<FName> FloatOutputs;
+	TArray<FName> IntOutputs;
+	TArray<FName> ColorOutputs;
+	TArray<FName> FloatRangeOutputs;
+
+	v_flt GetValueImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const;
+	FVoxelMaterial GetMaterialImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const;
+	TVoxelRange<v_flt> GetValueRangeImpl(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const;
+
+	template<typename T>
+	void GetFromSnapshot(TVoxelQueryZone<T>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const;
+
+	template<typename T>
+	const TArray<FName>& GetForwardedOutputs() const;
+	template<typename T, int32 Index>
+	T ForwardCustomOutput(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const;
+	template<int32 Index>
+	TVoxelRange<v_flt> ForwardCustomOutputRange(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const;
+
+	template<typename T, int32... Indices>
+	static void AddForwardedOutputs(const TMap<FName, TOutputFunctionPtr<T>>& SourcePtrs, TMap<FName, TOutputFunctionPtr<T>>& OutPtrs, TIntegerSequence<int32, Indices...>);
+	template<int32... Indices>
+	static void AddForwardedRangeOutputs(const TMap<FName, TRangeOutputFunctionPtr<v_flt>>& SourcePtrs, TMap<FName, TRangeOutputFunctionPtr<v_flt>>& OutPtrs, TIntegerSequence<int32, Indices...>);
+	static FCustomFunctionPtrs MakeCustomPtrs(const FVoxelGeneratorInstance& Source);
+};
@@ -50,4 +50,6 @@ struct FVoxelChunkUpdate
 	FVoxelChunkSettings OldSettings;
 	FVoxelChunkSettings NewSettings;
 	TArray<uint64, TInlineAllocator<8>> PreviousChunks;
+	// Set if range analysis proved that the values are all empty or all full: no need to mesh the chunk
+	bool bNoSurface = false;
 };
\ No newline at end of file
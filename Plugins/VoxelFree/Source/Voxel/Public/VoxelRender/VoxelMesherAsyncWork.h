@@ -36,6 +36,10 @@ public:
 		bool bIsTransitionTask,
 		uint8 TransitionsMask);
 
+	// Used when the chunk is known to have no surface: sets an empty chunk without going through the pool
+	// Caller must queue the callback
+	void FinishWithEmptyChunk(const FVoxelRendererSettings& Settings);
+
 	static void CreateGeometry_AnyThread(
 		const FVoxelDefaultRenderer& Renderer,
 		int32 LOD,
@@ -22,9 +22,13 @@ public:
 	static FColor GetDistanceFieldColor(float Value);
 
 public:
+	// On CPU, voxel.distancefield.UseExactCPUTransform can be used to use ExactDistanceTransform_CPU instead
 	static void JumpFlood(const FIntVector& Size, TArray<FVector3f>& InOutPackedPositions, EVoxelComputeDevice Device, bool bMultiThreaded = false, int32 MaxPasses_Debug = -1);
+	// Alternative to JumpFlood: finds the exact closest voxel having a valid surface position, using a separable distance transform
+	// The result is then the surface position of that voxel
+	static void ExactDistanceTransform_CPU(const FIntVector& Size, TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded = false);
 	// Only the InOutDistances sign will be used, not their actual values
-	static void GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector3f> SurfacePositions, TArrayView<float> InOutDistances);
+	static void GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector3f> SurfacePositions, TArrayView<float> InOutDistances, bool bMultiThreaded = false);
 	
 public:
 	// OutDistances will only have the signs of the values
@@ -53,15 +57,20 @@ public:
 		TArrayView<float> OutDistances, 
 		TArrayView<FVector3f> OutSurfacePositions,
 		int32 Divisor,
-		bool bShrink);
+		bool bShrink,
+		bool bMultiThreaded = false);
 	
 	static void DownSample(
 		FIntVector& Size, 
 		TArray<float>& Distances, 
 		TArray<FVector3f>& SurfacePositions,
 		int32 Divisor,
-		bool bShrink);
+		bool bShrink,
+		bool bMultiThreaded = false);
 
 private:
+	friend class FVoxelDistanceFieldUtilitiesBenchmark;
+	
+	static void JumpFlood_CPU(const FIntVector& Size, TArray<FVector3f>& InOutSurfacePositions, bool bMultiThreaded, int32 MaxPasses_Debug = -1);
 	static void JumpFloodStep_CPU(const FIntVector& Size, TArrayView<const FVector3f> InData, TArrayView<FVector3f> OutData, int32 Step, bool bMultiThreaded);
 };
\ No newline at end of file
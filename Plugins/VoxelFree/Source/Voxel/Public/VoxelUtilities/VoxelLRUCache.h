@@ -0,0 +1,151 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+/**
+ * Thread safe cache of shared values, evicting the least recently used ones once their total size goes over a budget
+ * Hits only take a read lock. Values are refcounted: evicting one doesn't affect the callers still using it
+ * TValue must have a GetAllocatedSize() const function
+ */
+template<typename TKey, typename TValue>
+class TVoxelLRUCache
+{
+public:
+	// Returned by Add and Empty so that the owner can update its memory stats
+	struct FChanges
+	{
+		int64 AddedSize = 0;
+		int64 RemovedSize = 0;
+		int32 NumEvicted = 0;
+	};
+
+public:
+	TVoxelLRUCache() = default;
+
+	UE_NONCOPYABLE(TVoxelLRUCache);
+
+	// Returns null on miss
+	TVoxelSharedPtr<const TValue> Find(const TKey& Key) const
+	{
+		FReadScopeLock Lock(CacheLock);
+
+		FEntry* Entry = Entries.Find(Key);
+		if (!Entry)
+		{
+			return nullptr;
+		}
+
+		// The counter is only incremented on add: we don't want every hit to write to the same cache line
+		const int64 Access = AccessCounter.GetValue();
+		if (Entry->LastAccess != Access)
+		{
+			FPlatformAtomics::InterlockedExchange(&Entry->LastAccess, Access);
+		}
+		return Entry->Value;
+	}
+
+	/**
+	 * If another thread added Key in the meantime, its value is kept and returned instead
+	 * If the total size is then above MaxSize, the least recently used values are evicted down to 3/4 of it,
+	 * so that we don't sort on every add. The value just added is never evicted
+	 */
+	TVoxelSharedRef<const TValue> Add(const TKey& Key, const TVoxelSharedRef<const TValue>& Value, int64 MaxSize, FChanges& OutChanges)
+	{
+		FWriteScopeLock Lock(CacheLock);
+
+		FEntry& Entry = Entries.FindOrAdd(Key);
+		if (Entry.Value.IsValid())
+		{
+			return Entry.Value.ToSharedRef();
+		}
+
+		Entry.Value = Value;
+		Entry.LastAccess = AccessCounter.Increment();
+
+		OutChanges.AddedSize += Value->GetAllocatedSize();
+		AllocatedSize += Value->GetAllocatedSize();
+
+		if (AllocatedSize > MaxSize)
+		{
+			Evict(Key, MaxSize / 4 * 3, OutChanges);
+		}
+
+		return Value;
+	}
+
+	FChanges Empty()
+	{
+		FWriteScopeLock Lock(CacheLock);
+
+		FChanges Changes;
+		Changes.RemovedSize = AllocatedSize;
+
+		Entries.Empty();
+		AllocatedSize = 0;
+
+		return Changes;
+	}
+
+	int32 Num() const
+	{
+		FReadScopeLock Lock(CacheLock);
+		return Entries.Num();
+	}
+	// Sum of the allocated sizes of the values
+	int64 GetValuesAllocatedSize() const
+	{
+		FReadScopeLock Lock(CacheLock);
+		return AllocatedSize;
+	}
+
+private:
+	struct FEntry
+	{
+		TVoxelSharedPtr<const TValue> Value;
+		// Atomically updated under a read lock
+		volatile int64 LastAccess = 0;
+	};
+
+	mutable FRWLock CacheLock;
+	mutable TMap<TKey, FEntry> Entries;
+	mutable FThreadSafeCounter64 AccessCounter;
+	int64 AllocatedSize = 0;
+
+	// Requires CacheLock to be write locked
+	void Evict(const TKey& KeyToKeep, int64 TargetSize, FChanges& OutChanges)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TArray<TPair<int64, TKey>> AccessesAndKeys;
+		AccessesAndKeys.Reserve(Entries.Num());
+		for (auto& It : Entries)
+		{
+			AccessesAndKeys.Emplace(It.Value.LastAccess, It.Key);
+		}
+		AccessesAndKeys.Sort([](const TPair<int64, TKey>& A, const TPair<int64, TKey>& B) { return A.Key < B.Key; });
+
+		for (const auto& It : AccessesAndKeys)
+		{
+			if (AllocatedSize <= TargetSize)
+			{
+				break;
+			}
+			if (It.Value == KeyToKeep)
+			{
+				continue;
+			}
+
+			FEntry Entry;
+			verify(Entries.RemoveAndCopyValue(It.Value, Entry));
+
+			const int64 ValueAllocatedSize = Entry.Value->GetAllocatedSize();
+			AllocatedSize -= ValueAllocatedSize;
+			OutChanges.RemovedSize += ValueAllocatedSize;
+			OutChanges.NumEvicted++;
+		}
+	}
+};
@@ -162,6 +162,12 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel - General", meta = (Recreate))
 	FVoxelGeneratorPicker Generator;
 
+	// If set, the generator values and materials are read from this snapshot instead of being computed, when possible
+	// Bake it using voxel.snapshot.Bake or BakeGeneratorSnapshot. Ignored if baked from another generator or with other settings
+	// Relative to the project directory. In packaged games, it must be staged as a non UFS file to be memory mapped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - General", meta = (Recreate, FilePathFilter = "voxelsnapshot"))
+	FFilePath GeneratorSnapshotPath;
+
 	// Will be automatically created if not set
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel - General", Instanced, meta = (Recreate))
 	UVoxelPlaceableItemManager* PlaceableItemManager = nullptr;
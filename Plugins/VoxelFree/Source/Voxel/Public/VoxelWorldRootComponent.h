@@ -7,6 +7,11 @@
 #include "Components/PrimitiveComponent.h"
 #include "VoxelWorldRootComponent.generated.h"
 
+namespace Chaos
+{
+	class FTriangleMeshImplicitObject;
+}
+
 UCLASS(editinlinenew)
 class VOXEL_API UVoxelWorldRootComponent : public UPrimitiveComponent
 {
@@ -31,6 +36,8 @@ public:
 #if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 	void UpdateConvexCollision(uint64 Id, const FBox& Bounds, TArray<FKConvexElem>&& ConvexElements, TArray<physx::PxConvexMesh*>&& ConvexMeshes);
 	void SetCookedTriMeshes(const TArray<physx::PxTriangleMesh*>& TriMeshes);
+#elif WITH_CHAOS
+	void SetCookedTriMeshes(const TArray<TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>>& TriMeshes);
 #endif
 
 private:
@@ -55,6 +55,7 @@ public class Voxel : ModuleRules
                 "Projects",
                 "Slate",
                 "SlateCore",
+                "Json",
                 //"VHACD", // Not used, too slow
             }
         );
@@ -195,6 +195,10 @@ public:
 		{
 			Function0_XYZWithoutCache_Compute(Context, Outputs);
 		}
+		void ComputeXYZRow(const FVoxelContext& Context, const FBufferX& BufferX, const FBufferXY& BufferXY, const v_flt* RESTRICT Z, int32 Num, FOutputs* RESTRICT Outputs) const
+		{
+			Function0_XYZRow_Compute(Context, BufferX, BufferXY, Z, Num, Outputs);
+		}
 		
 		inline FBufferX GetBufferX() const { return {}; }
 		inline FBufferXY GetBufferXY() const { return {}; }
@@ -641,6 +645,62 @@ public:
 			Outputs.Value = Variable_56;
 		}
 		
+		// Not generated: Function0_XYZWithCache_Compute ported by hand to a Z row, with the same operations in the same order
+		// The XYZ stage of this graph only depends on Z, so LocalZ/WorldZ are not needed
+		void Function0_XYZRow_Compute(const FVoxelContext& Context, const FBufferX& BufferX, const FBufferXY& BufferXY, const v_flt* RESTRICT Z, int32 Num, FOutputs* RESTRICT Outputs) const
+		{
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				// Z
+				const v_flt Variable_8 = Z[Index];
+				const v_flt Variable_17 = Z[Index];
+				const v_flt Variable_11 = Z[Index];
+				
+				// -
+				const v_flt Variable_10 = BufferXY.Variable_6 - Variable_11;
+				const v_flt Variable_9 = Variable_8 - BufferXY.Variable_7;
+				const v_flt Variable_18 = Variable_17 - BufferXY.Variable_22;
+				
+				// Smooth Union
+				const v_flt Variable_58 = Variable_10 - Variable_9;
+				const v_flt Variable_59 = Variable_58 / BufferConstant.Variable_24;
+				const v_flt Variable_60 = Variable_59 * v_flt(0.5f);
+				const v_flt Variable_61 = Variable_60 + v_flt(0.5f);
+				const v_flt Variable_62 = FVoxelNodeFunctions::Clamp(Variable_61, v_flt(0.0f), v_flt(1.0f));
+				const v_flt Variable_63 = FVoxelNodeFunctions::Lerp(Variable_10, Variable_9, Variable_62);
+				const v_flt Variable_66 = 1 - Variable_62;
+				const v_flt Variable_65 = BufferConstant.Variable_24 * Variable_62 * Variable_66;
+				const v_flt Variable_64 = Variable_63 - Variable_65;
+				
+				// +
+				const v_flt Variable_35 = Variable_64 + BufferConstant.Variable_37;
+				
+				// Smooth Union
+				const v_flt Variable_41 = BufferXY.Variable_14 - Variable_35;
+				const v_flt Variable_42 = Variable_41 / BufferConstant.Variable_25;
+				const v_flt Variable_43 = Variable_42 * v_flt(0.5f);
+				const v_flt Variable_44 = Variable_43 + v_flt(0.5f);
+				const v_flt Variable_45 = FVoxelNodeFunctions::Clamp(Variable_44, v_flt(0.0f), v_flt(1.0f));
+				const v_flt Variable_49 = 1 - Variable_45;
+				const v_flt Variable_46 = FVoxelNodeFunctions::Lerp(BufferXY.Variable_14, Variable_35, Variable_45);
+				const v_flt Variable_48 = BufferConstant.Variable_25 * Variable_45 * Variable_49;
+				const v_flt Variable_47 = Variable_46 - Variable_48;
+				
+				// Smooth Intersection
+				const v_flt Variable_57 = Variable_18 - Variable_47;
+				const v_flt Variable_50 = Variable_57 / BufferConstant.Variable_26;
+				const v_flt Variable_51 = Variable_50 * v_flt(0.5f);
+				const v_flt Variable_16 = v_flt(0.5f) - Variable_51;
+				const v_flt Variable_52 = FVoxelNodeFunctions::Clamp(Variable_16, v_flt(0.0f), v_flt(1.0f));
+				const v_flt Variable_55 = 1 - Variable_52;
+				const v_flt Variable_53 = FVoxelNodeFunctions::Lerp(Variable_18, Variable_47, Variable_52);
+				const v_flt Variable_54 = BufferConstant.Variable_26 * Variable_52 * Variable_55;
+				const v_flt Variable_56 = Variable_53 + Variable_54;
+				
+				Outputs[Index].Value = Variable_56;
+			}
+		}
+		
 		void Function0_XYZWithoutCache_Compute(const FVoxelContext& Context, FOutputs& Outputs) const
 		{
 			// Z
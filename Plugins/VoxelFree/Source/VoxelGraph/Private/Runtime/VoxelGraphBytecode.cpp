@@ -0,0 +1,426 @@
+// Copyright 2020 Phyronnaz
+
+#include "Runtime/VoxelGraphBytecode.h"
+#include "VoxelGraphGenerator.h"
+#include "VoxelGraphOutputs.h"
+#include "VoxelNodes/VoxelMathNodes.h"
+#include "VoxelNodes/VoxelExecNodes.h"
+#include "VoxelNodes/VoxelSeedNodes.h"
+#include "VoxelNodes/VoxelNoiseNodes.h"
+#include "VoxelNodes/VoxelParameterNodes.h"
+#include "VoxelNodes/VoxelCoordinatesNodes.h"
+
+class FVoxelGraphBytecodeCompiler
+{
+public:
+	FVoxelGraphProgram& Program;
+	const TMap<FName, FString>& Parameters;
+	FString Error;
+
+	FVoxelGraphBytecodeCompiler(FVoxelGraphProgram& Program, const TMap<FName, FString>& Parameters)
+		: Program(Program)
+		, Parameters(Parameters)
+	{
+	}
+
+	void Compile(const UVoxelGraphGenerator& Generator)
+	{
+#if ENABLE_VOXELGRAPH_NODE_STATS
+		GraphName = Generator.GetFName();
+#endif
+
+		// Follow the exec flow from the start node. Branches aren't supported, so it's a single chain
+		const UVoxelNode* Node = Generator.FirstNode;
+		TSet<const UVoxelNode*> VisitedExecNodes;
+		while (Node && Error.IsEmpty())
+		{
+			if (VisitedExecNodes.Contains(Node))
+			{
+				Fail(*Node, "exec loop");
+				break;
+			}
+			VisitedExecNodes.Add(Node);
+
+			if (auto* SetNode = Cast<UVoxelNode_SetNode>(Node))
+			{
+				if (SetNode->GetOutputIndex() == FVoxelGraphOutputsIndices::ValueIndex)
+				{
+					Program.ValueRegister = GetInput(*SetNode, 1);
+				}
+				// Other outputs can't be queried from the interpreter
+			}
+			else if (Node->IsA<UVoxelNode_MaterialSetter>())
+			{
+				// Materials are left to their default value
+			}
+			else if (!Node->IsA<UVoxelNode_FunctionSeparator>())
+			{
+				Fail(*Node, "exec node not supported");
+				break;
+			}
+
+			const UVoxelNode* NextNode = nullptr;
+			for (const FVoxelPin& Pin : Node->OutputPins)
+			{
+				if (Pin.PinCategory == EVoxelPinCategory::Exec && Pin.OtherNodes.Num() > 0)
+				{
+					NextNode = Pin.OtherNodes[0];
+					break;
+				}
+			}
+			Node = NextNode;
+		}
+
+		if (!Error.IsEmpty())
+		{
+			return;
+		}
+
+		// Registers computed before the XYZ stage and read by it
+		TSet<uint16> RowInputs;
+		for (const FVoxelGraphInstruction& Instruction : Program.Stages[int32(EVoxelAxisDependencies::XYZ)])
+		{
+			for (int32 Index = 0; Index < GetNumInputs(Instruction.Opcode); Index++)
+			{
+				const uint16 Input = Instruction.Inputs[Index];
+				if (RegisterDependencies[Input] != EVoxelAxisDependencies::XYZ)
+				{
+					RowInputs.Add(Input);
+				}
+			}
+		}
+		if (Program.ValueRegister != -1 && RegisterDependencies[Program.ValueRegister] != EVoxelAxisDependencies::XYZ)
+		{
+			RowInputs.Add(Program.ValueRegister);
+		}
+		Program.RowInputs = RowInputs.Array();
+	}
+
+private:
+	TMap<TPair<const UVoxelNode*, int32>, uint16> OutputRegisters;
+	TArray<uint8> RegisterFlags;
+	TArray<EVoxelAxisDependencies> RegisterDependencies;
+	TSet<const UVoxelNode*> NodesInStack;
+
+#if ENABLE_VOXELGRAPH_NODE_STATS
+	FName GraphName;
+	// The node instructions are emitted for
+	const UVoxelNode* CurrentNode = nullptr;
+#endif
+
+	static int32 GetNumInputs(EVoxelGraphOpcode Opcode)
+	{
+		switch (Opcode)
+		{
+		case EVoxelGraphOpcode::Constant:
+		case EVoxelGraphOpcode::X:
+		case EVoxelGraphOpcode::Y:
+		case EVoxelGraphOpcode::Z:
+			return 0;
+		case EVoxelGraphOpcode::Add:
+		case EVoxelGraphOpcode::Subtract:
+		case EVoxelGraphOpcode::Multiply:
+		case EVoxelGraphOpcode::Divide:
+		case EVoxelGraphOpcode::Min:
+		case EVoxelGraphOpcode::Max:
+			return 2;
+		case EVoxelGraphOpcode::Clamp:
+		case EVoxelGraphOpcode::Lerp:
+		case EVoxelGraphOpcode::SafeLerp:
+		case EVoxelGraphOpcode::SmoothStep:
+		case EVoxelGraphOpcode::VectorLength:
+		case EVoxelGraphOpcode::Noise2D:
+			return 3;
+		case EVoxelGraphOpcode::Noise3D:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	uint16 Fail(const UVoxelNode& Node, const FString& Message)
+	{
+		if (Error.IsEmpty())
+		{
+			Error = FString::Printf(TEXT("%s: %s"), *Node.GetTitle().ToString(), *Message);
+		}
+		return 0;
+	}
+
+	uint16 Emit(EVoxelGraphOpcode Opcode, std::initializer_list<uint16> Inputs, int32 Payload = 0, uint8 ExtraFlags = 0)
+	{
+		check(int32(Inputs.size()) == GetNumInputs(Opcode));
+
+		if (!Error.IsEmpty())
+		{
+			// Inputs are invalid
+			return 0;
+		}
+
+		FVoxelGraphInstruction Instruction;
+		Instruction.Opcode = Opcode;
+		Instruction.Payload = Payload;
+
+		uint8 Flags = ExtraFlags;
+		int32 Index = 0;
+		for (uint16 Input : Inputs)
+		{
+			Instruction.Inputs[Index++] = Input;
+			Flags |= RegisterFlags[Input];
+		}
+
+		if (Program.NumRegisters >= MAX_uint16)
+		{
+			Error = "too many registers";
+			return 0;
+		}
+		Instruction.Dest = Program.NumRegisters++;
+		RegisterFlags.Add(Flags);
+		RegisterDependencies.Add(FVoxelAxisDependencies::GetVoxelAxisDependenciesFromFlag(Flags));
+
+		Program.Stages[int32(RegisterDependencies.Last())].Add(Instruction);
+#if ENABLE_VOXELGRAPH_NODE_STATS
+		const FString NodeName = CurrentNode ? FString::Printf(TEXT("%s (%s)"), *CurrentNode->GetTitle().ToString(), *CurrentNode->GetName()) : TEXT("Graph");
+		Program.InstructionStats[int32(RegisterDependencies.Last())].Add(&FVoxelGraphNodeStats::Get(GraphName, NodeName));
+#endif
+		return Instruction.Dest;
+	}
+	uint16 EmitConstant(v_flt Value)
+	{
+		return Emit(EVoxelGraphOpcode::Constant, {}, Program.Constants.Add(Value));
+	}
+
+	template<typename T>
+	T GetParameter(const UVoxelExposedNode& Node, T Value) const
+	{
+		if (const FString* ParameterValue = Parameters.Find(Node.UniqueName))
+		{
+			LexFromString(Value, **ParameterValue);
+		}
+		return Value;
+	}
+
+	uint16 GetInput(const UVoxelNode& Node, int32 PinIndex)
+	{
+		if (!Node.InputPins.IsValidIndex(PinIndex))
+		{
+			return Fail(Node, "invalid pin");
+		}
+
+		const FVoxelPin& Pin = Node.InputPins[PinIndex];
+		if (Pin.OtherNodes.Num() == 0)
+		{
+			return EmitConstant(FCString::Atod(*Pin.DefaultValue));
+		}
+
+		UVoxelNode& OtherNode = *Pin.OtherNodes[0];
+		const int32 OtherPinIndex = OtherNode.GetOutputPinIndex(Pin.OtherPinIds[0]);
+		if (OtherPinIndex == -1)
+		{
+			return Fail(Node, "invalid link");
+		}
+
+		const TPair<const UVoxelNode*, int32> Key(&OtherNode, OtherPinIndex);
+		if (const uint16* Register = OutputRegisters.Find(Key))
+		{
+			return *Register;
+		}
+
+		if (NodesInStack.Contains(&OtherNode))
+		{
+			return Fail(OtherNode, "loop");
+		}
+		NodesInStack.Add(&OtherNode);
+		CompileNode(OtherNode, OtherPinIndex);
+		NodesInStack.Remove(&OtherNode);
+
+		if (!Error.IsEmpty())
+		{
+			return 0;
+		}
+		return OutputRegisters.FindChecked(Key);
+	}
+
+	int32 GetSeed(const UVoxelNode& Node, int32 PinIndex)
+	{
+		const FVoxelPin& Pin = Node.InputPins[PinIndex];
+		if (Pin.OtherNodes.Num() == 0)
+		{
+			return FCString::Atoi(*Pin.DefaultValue);
+		}
+		if (auto* SeedNode = Cast<UVoxelNode_Seed>(Pin.OtherNodes[0]))
+		{
+			return GetParameter(*SeedNode, SeedNode->DefaultValue);
+		}
+		return Fail(Node, "only Seed nodes can be used as seeds");
+	}
+
+	uint16 CompileNoise(const UVoxelNode_NoiseNode& Node, EVoxelGraphNoiseType Type)
+	{
+		const int32 Dimension = Node.GetDimension();
+		if (Node.IsDerivative() || Node.OutputPins.Num() != 1 || Node.InputPins.Num() != Dimension + 2)
+		{
+			return Fail(Node, "noise derivatives and custom pins are not supported");
+		}
+
+		const uint16 X = GetInput(Node, 0);
+		const uint16 Y = GetInput(Node, 1);
+		const uint16 Z = Dimension == 3 ? GetInput(Node, 2) : 0;
+		const uint16 Frequency = GetInput(Node, Dimension);
+		const int32 Seed = GetSeed(Node, Dimension + 1);
+		if (!Error.IsEmpty())
+		{
+			return 0;
+		}
+		if (RegisterDependencies[Frequency] != EVoxelAxisDependencies::Constant)
+		{
+			return Fail(Node, "the frequency must be constant");
+		}
+
+		FVoxelGraphNoise& Noise = Program.Noises.Emplace_GetRef();
+		Noise.Type = Type;
+		Noise.Noise.SetSeed(Seed);
+		Noise.Noise.SetInterpolation(Node.Interpolation);
+		for (int32 LOD = 0; LOD < 32; LOD++)
+		{
+			Noise.LODToOctaves[LOD] = 1;
+		}
+		if (Node.OutputRanges.Num() > 0)
+		{
+			Noise.Range = { v_flt(Node.OutputRanges[0].Min), v_flt(Node.OutputRanges[0].Max) };
+		}
+
+		if (auto* FractalNode = Cast<UVoxelNode_NoiseNodeFractal>(&Node))
+		{
+			Noise.bFractal = true;
+			Noise.Noise.SetFractalOctavesAndGain(FractalNode->FractalOctaves, FractalNode->FractalGain);
+			Noise.Noise.SetFractalLacunarity(FractalNode->FractalLacunarity);
+			Noise.Noise.SetFractalType(FractalNode->FractalType);
+
+			// The map keys are the first LOD using their octaves
+			for (int32 LOD = 0; LOD < 32; LOD++)
+			{
+				int32 BestLOD = -1;
+				Noise.LODToOctaves[LOD] = FractalNode->FractalOctaves;
+				for (auto& It : FractalNode->LODToOctavesMap)
+				{
+					const int32 MapLOD = TCString<TCHAR>::Atoi(*It.Key);
+					if (BestLOD < MapLOD && MapLOD <= LOD)
+					{
+						BestLOD = MapLOD;
+						Noise.LODToOctaves[LOD] = It.Value;
+					}
+				}
+			}
+		}
+
+		// The octaves depend on the LOD, so like in the generated code the noise is at least an X dependency
+		const int32 NoiseIndex = Program.Noises.Num() - 1;
+		return Dimension == 2
+			? Emit(EVoxelGraphOpcode::Noise2D, { X, Y, Frequency }, NoiseIndex, EVoxelAxisDependenciesFlags::X)
+			: Emit(EVoxelGraphOpcode::Noise3D, { X, Y, Z, Frequency }, NoiseIndex, EVoxelAxisDependenciesFlags::X);
+	}
+
+	void CompileNode(const UVoxelNode& Node, int32 OutputIndex)
+	{
+#if ENABLE_VOXELGRAPH_NODE_STATS
+		TGuardValue<const UVoxelNode*> CurrentNodeGuard(CurrentNode, &Node);
+#endif
+
+		const auto Unary = [&](EVoxelGraphOpcode Opcode)
+		{
+			return Emit(Opcode, { GetInput(Node, 0) });
+		};
+		const auto Binary = [&](EVoxelGraphOpcode Opcode)
+		{
+			const uint16 A = GetInput(Node, 0);
+			const uint16 B = GetInput(Node, 1);
+			return Emit(Opcode, { A, B });
+		};
+		const auto Ternary = [&](EVoxelGraphOpcode Opcode)
+		{
+			const uint16 A = GetInput(Node, 0);
+			const uint16 B = GetInput(Node, 1);
+			const uint16 C = GetInput(Node, 2);
+			return Emit(Opcode, { A, B, C });
+		};
+		const auto Fold = [&](EVoxelGraphOpcode Opcode)
+		{
+			uint16 Result = GetInput(Node, 0);
+			for (int32 Index = 1; Index < Node.InputPins.Num(); Index++)
+			{
+				Result = Emit(Opcode, { Result, GetInput(Node, Index) });
+			}
+			return Result;
+		};
+
+		uint16 Result = 0;
+
+#define CASE(Class, Expression) else if (Node.IsA<Class>()) { Result = Expression; }
+#define NOISE_CASE(Class, Type) else if (Node.GetClass() == Class::StaticClass()) { Result = CompileNoise(*CastChecked<UVoxelNode_NoiseNode>(&Node), EVoxelGraphNoiseType::Type); }
+
+		if (false) {}
+		CASE(UVoxelNode_XF, Emit(EVoxelGraphOpcode::X, {}, 0, EVoxelAxisDependenciesFlags::X))
+		CASE(UVoxelNode_YF, Emit(EVoxelGraphOpcode::Y, {}, 0, EVoxelAxisDependenciesFlags::Y))
+		CASE(UVoxelNode_ZF, Emit(EVoxelGraphOpcode::Z, {}, 0, EVoxelAxisDependenciesFlags::Z))
+		CASE(UVoxelNode_FloatParameter, EmitConstant(GetParameter(*CastChecked<UVoxelNode_FloatParameter>(&Node), CastChecked<UVoxelNode_FloatParameter>(&Node)->Value)))
+		CASE(UVoxelNode_Pi, EmitConstant(PI))
+		CASE(UVoxelNode_FAdd, Fold(EVoxelGraphOpcode::Add))
+		CASE(UVoxelNode_FMultiply, Fold(EVoxelGraphOpcode::Multiply))
+		CASE(UVoxelNode_FMin, Fold(EVoxelGraphOpcode::Min))
+		CASE(UVoxelNode_FMax, Fold(EVoxelGraphOpcode::Max))
+		CASE(UVoxelNode_FSubstract, Binary(EVoxelGraphOpcode::Subtract))
+		CASE(UVoxelNode_FDivide, Binary(EVoxelGraphOpcode::Divide))
+		CASE(UVoxelNode_MinusX, Unary(EVoxelGraphOpcode::Negate))
+		CASE(UVoxelNode_FAbs, Unary(EVoxelGraphOpcode::Abs))
+		CASE(UVoxelNode_Sqrt, Unary(EVoxelGraphOpcode::Sqrt))
+		CASE(UVoxelNode_1MinusX, Unary(EVoxelGraphOpcode::OneMinus))
+		CASE(UVoxelNode_OneOverX, Unary(EVoxelGraphOpcode::OneOver))
+		CASE(UVoxelNode_Sin, Unary(EVoxelGraphOpcode::Sin))
+		CASE(UVoxelNode_Cos, Unary(EVoxelGraphOpcode::Cos))
+		CASE(UVoxelNode_Clamp, Ternary(EVoxelGraphOpcode::Clamp))
+		CASE(UVoxelNode_Lerp, Ternary(EVoxelGraphOpcode::Lerp))
+		CASE(UVoxelNode_SafeLerp, Ternary(EVoxelGraphOpcode::SafeLerp))
+		CASE(UVoxelNode_SmoothStep, Ternary(EVoxelGraphOpcode::SmoothStep))
+		CASE(UVoxelNode_VectorLength, Ternary(EVoxelGraphOpcode::VectorLength))
+		NOISE_CASE(UVoxelNode_2DPerlinNoise, Perlin)
+		NOISE_CASE(UVoxelNode_2DPerlinNoiseFractal, Perlin)
+		NOISE_CASE(UVoxelNode_2DSimplexNoise, Simplex)
+		NOISE_CASE(UVoxelNode_2DSimplexNoiseFractal, Simplex)
+		NOISE_CASE(UVoxelNode_3DPerlinNoise, Perlin)
+		NOISE_CASE(UVoxelNode_3DPerlinNoiseFractal, Perlin)
+		NOISE_CASE(UVoxelNode_3DSimplexNoise, Simplex)
+		NOISE_CASE(UVoxelNode_3DSimplexNoiseFractal, Simplex)
+		else
+		{
+			Fail(Node, "node not supported by the interpreter");
+		}
+
+#undef NOISE_CASE
+#undef CASE
+
+		if (Error.IsEmpty())
+		{
+			OutputRegisters.Add({ &Node, OutputIndex }, Result);
+		}
+	}
+
+};
+
+bool FVoxelGraphBytecode::Compile(const UVoxelGraphGenerator& Generator, const TMap<FName, FString>& Parameters, FVoxelGraphProgram& OutProgram, FString& OutError)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	OutProgram = {};
+
+	FVoxelGraphBytecodeCompiler Compiler(OutProgram, Parameters);
+	Compiler.Compile(Generator);
+
+	if (!Compiler.Error.IsEmpty())
+	{
+		OutError = Compiler.Error;
+		OutProgram = {};
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,495 @@
+// Copyright 2020 Phyronnaz
+
+#include "Runtime/VoxelGraphInterpreter.h"
+#include "VoxelGraphGenerator.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "NodeFunctions/VoxelNodeFunctions.h"
+#include "NodeFunctions/VoxelMathNodeFunctions.h"
+#include "FastNoise/VoxelFastNoise.inl"
+
+#include "UObject/UObjectGlobals.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace FVoxelGraphInterpreter
+{
+	template<typename T>
+	struct TCoordinates
+	{
+		T X = 0;
+		T Y = 0;
+		const T* RESTRICT Z = nullptr;
+	};
+
+	FORCEINLINE void ComputeNoise2D(const FVoxelGraphNoise& Noise, int32 LOD, int32 Num, const v_flt* RESTRICT X, const v_flt* RESTRICT Y, v_flt Frequency, v_flt* RESTRICT Out)
+	{
+		const int32 Octaves = Noise.GetOctaves(LOD);
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			if (Noise.Type == EVoxelGraphNoiseType::Perlin)
+			{
+				Out[Index] = Noise.bFractal
+					? Noise.Noise.GetPerlinFractal_2D(X[Index], Y[Index], Frequency, Octaves)
+					: Noise.Noise.GetPerlin_2D(X[Index], Y[Index], Frequency);
+			}
+			else
+			{
+				Out[Index] = Noise.bFractal
+					? Noise.Noise.GetSimplexFractal_2D(X[Index], Y[Index], Frequency, Octaves)
+					: Noise.Noise.GetSimplex_2D(X[Index], Y[Index], Frequency);
+			}
+		}
+	}
+	FORCEINLINE void ComputeNoise3D(const FVoxelGraphNoise& Noise, int32 LOD, int32 Num, const v_flt* RESTRICT X, const v_flt* RESTRICT Y, const v_flt* RESTRICT Z, v_flt Frequency, v_flt* RESTRICT Out)
+	{
+		// Whole rows at once
+		const int32 Octaves = Noise.GetOctaves(LOD);
+		if (Noise.Type == EVoxelGraphNoiseType::Perlin)
+		{
+			if (Noise.bFractal)
+			{
+				Noise.Noise.GetPerlinFractal_3D_Batch(Num, X, Y, Z, Frequency, Octaves, Out);
+			}
+			else
+			{
+				Noise.Noise.GetPerlin_3D_Batch(Num, X, Y, Z, Frequency, Out);
+			}
+		}
+		else
+		{
+			if (Noise.bFractal)
+			{
+				Noise.Noise.GetSimplexFractal_3D_Batch(Num, X, Y, Z, Frequency, Octaves, Out);
+			}
+			else
+			{
+				Noise.Noise.GetSimplex_3D_Batch(Num, X, Y, Z, Frequency, Out);
+			}
+		}
+	}
+
+	FORCEINLINE void ComputeNoise2D(const FVoxelGraphNoise& Noise, int32 LOD, int32 Num, const TVoxelRange<v_flt>* X, const TVoxelRange<v_flt>* Y, const TVoxelRange<v_flt>& Frequency, TVoxelRange<v_flt>* Out)
+	{
+		Out[0] = Noise.Range;
+	}
+	FORCEINLINE void ComputeNoise3D(const FVoxelGraphNoise& Noise, int32 LOD, int32 Num, const TVoxelRange<v_flt>* X, const TVoxelRange<v_flt>* Y, const TVoxelRange<v_flt>* Z, const TVoxelRange<v_flt>& Frequency, TVoxelRange<v_flt>* Out)
+	{
+		Out[0] = Noise.Range;
+	}
+
+	// Runs a stage on Num lanes. Lane I of register R is Registers[R * Stride + I]
+	// T is v_flt for values, TVoxelRange<v_flt> for range analysis
+	template<typename T>
+	void Execute(const FVoxelGraphProgram& Program, EVoxelAxisDependencies Stage, T* RESTRICT Registers, int32 Stride, int32 Num, int32 LOD, const TCoordinates<T>& Coordinates)
+	{
+		const TArray<FVoxelGraphInstruction>& Instructions = Program.GetStage(Stage);
+		for (int32 InstructionIndex = 0; InstructionIndex < Instructions.Num(); InstructionIndex++)
+		{
+			const FVoxelGraphInstruction& Instruction = Instructions[InstructionIndex];
+#if ENABLE_VOXELGRAPH_NODE_STATS
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+#endif
+
+			T* RESTRICT const Dest = Registers + Instruction.Dest * Stride;
+			const T* RESTRICT const A = Registers + Instruction.Inputs[0] * Stride;
+			const T* RESTRICT const B = Registers + Instruction.Inputs[1] * Stride;
+			const T* RESTRICT const C = Registers + Instruction.Inputs[2] * Stride;
+			const T* RESTRICT const D = Registers + Instruction.Inputs[3] * Stride;
+
+#define LOOP(Expression) for (int32 Index = 0; Index < Num; Index++) { Dest[Index] = Expression; } break;
+
+			switch (Instruction.Opcode)
+			{
+			case EVoxelGraphOpcode::Constant: LOOP(T(Program.Constants[Instruction.Payload]))
+			case EVoxelGraphOpcode::X: LOOP(Coordinates.X)
+			case EVoxelGraphOpcode::Y: LOOP(Coordinates.Y)
+			case EVoxelGraphOpcode::Z: LOOP(Coordinates.Z[Index])
+			case EVoxelGraphOpcode::Add: LOOP(A[Index] + B[Index])
+			case EVoxelGraphOpcode::Subtract: LOOP(A[Index] - B[Index])
+			case EVoxelGraphOpcode::Multiply: LOOP(A[Index] * B[Index])
+			case EVoxelGraphOpcode::Divide: LOOP(A[Index] / B[Index])
+			case EVoxelGraphOpcode::Min: LOOP(FVoxelNodeFunctions::Min<v_flt>(A[Index], B[Index]))
+			case EVoxelGraphOpcode::Max: LOOP(FVoxelNodeFunctions::Max<v_flt>(A[Index], B[Index]))
+			case EVoxelGraphOpcode::Negate: LOOP(-A[Index])
+			case EVoxelGraphOpcode::Abs: LOOP(FVoxelNodeFunctions::Abs(A[Index]))
+			case EVoxelGraphOpcode::Sqrt: LOOP(FVoxelNodeFunctions::Sqrt(A[Index]))
+			case EVoxelGraphOpcode::OneMinus: LOOP(v_flt(1) - A[Index])
+			case EVoxelGraphOpcode::OneOver: LOOP(FVoxelNodeFunctions::OneOverX(A[Index]))
+			case EVoxelGraphOpcode::Sin: LOOP(FVoxelNodeFunctions::Sin(A[Index]))
+			case EVoxelGraphOpcode::Cos: LOOP(FVoxelNodeFunctions::Cos(A[Index]))
+			case EVoxelGraphOpcode::Clamp: LOOP(FVoxelNodeFunctions::Clamp(A[Index], B[Index], C[Index]))
+			case EVoxelGraphOpcode::Lerp: LOOP(FVoxelNodeFunctions::Lerp(A[Index], B[Index], C[Index]))
+			case EVoxelGraphOpcode::SafeLerp: LOOP(FVoxelNodeFunctions::SafeLerp(A[Index], B[Index], C[Index]))
+			case EVoxelGraphOpcode::SmoothStep: LOOP(FVoxelMathNodeFunctions::SmoothStep(A[Index], B[Index], C[Index]))
+			case EVoxelGraphOpcode::VectorLength: LOOP(FVoxelNodeFunctions::VectorLength(A[Index], B[Index], C[Index]))
+			case EVoxelGraphOpcode::Noise2D:
+			{
+				// The frequency is always a constant
+				ComputeNoise2D(Program.Noises[Instruction.Payload], LOD, Num, A, B, C[0], Dest);
+				break;
+			}
+			case EVoxelGraphOpcode::Noise3D:
+			{
+				ComputeNoise3D(Program.Noises[Instruction.Payload], LOD, Num, A, B, C, D[0], Dest);
+				break;
+			}
+			default: checkVoxelSlow(false);
+			}
+
+#undef LOOP
+
+#if ENABLE_VOXELGRAPH_NODE_STATS
+			// Range analysis isn't timed
+			if (TIsSame<T, v_flt>::Value)
+			{
+				FVoxelGraphNodeStats& Stats = *Program.InstructionStats[int32(Stage)][InstructionIndex];
+				Stats.Cycles.Add(FPlatformTime::Cycles64() - StartCycles);
+				Stats.NumLanes.Add(Num);
+			}
+#endif
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelGraphInterpreterInstance::FVoxelGraphInterpreterInstance(const UVoxelGraphGenerator& Generator, FVoxelGraphProgram&& Program)
+	: Super(&Generator)
+	, Program(MoveTemp(Program))
+	, bEnableRangeAnalysis(Generator.bEnableRangeAnalysis)
+{
+}
+
+void FVoxelGraphInterpreterInstance::Init(const FVoxelGeneratorInit& InitStruct)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	ConstantRegisters.Reset();
+	ConstantRegisters.SetNumZeroed(Program.NumRegisters);
+	FVoxelGraphInterpreter::Execute<v_flt>(Program, EVoxelAxisDependencies::Constant, ConstantRegisters.GetData(), 1, 1, 0, {});
+}
+
+void FVoxelGraphInterpreterInstance::GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (Program.ValueRegister == -1)
+	{
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				{
+					QueryZone.Set(X, Y, Z, FVoxelValue(v_flt(1)));
+				}
+			}
+		}
+		return;
+	}
+
+	constexpr int32 BatchSize = FVoxelGraphProgram::BatchSize;
+
+	TArray<v_flt> Registers;
+	Registers.SetNumUninitialized(Program.NumRegisters * BatchSize);
+	for (int32 Register = 0; Register < Program.NumRegisters; Register++)
+	{
+		for (int32 Lane = 0; Lane < BatchSize; Lane++)
+		{
+			Registers[Register * BatchSize + Lane] = ConstantRegisters[Register];
+		}
+	}
+
+	v_flt Z[BatchSize];
+	FVoxelGraphInterpreter::TCoordinates<v_flt> Coordinates;
+	Coordinates.Z = Z;
+
+	const v_flt* RESTRICT const Values = Registers.GetData() + Program.ValueRegister * BatchSize;
+
+	for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+	{
+		Coordinates.X = X;
+		FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::X, Registers.GetData(), BatchSize, 1, LOD, Coordinates);
+
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+		{
+			Coordinates.Y = Y;
+			FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XY, Registers.GetData(), BatchSize, 1, LOD, Coordinates);
+
+			for (uint16 Register : Program.RowInputs)
+			{
+				v_flt* RESTRICT const Lanes = Registers.GetData() + Register * BatchSize;
+				for (int32 Lane = 1; Lane < BatchSize; Lane++)
+				{
+					Lanes[Lane] = Lanes[0];
+				}
+			}
+
+			const int32 Step = QueryZone.Step;
+			for (int32 RowStart = QueryZone.Bounds.Min.Z; RowStart < QueryZone.Bounds.Max.Z; RowStart += BatchSize * Step)
+			{
+				int32 Num = 0;
+				for (int32 RowZ = RowStart; RowZ < QueryZone.Bounds.Max.Z && Num < BatchSize; RowZ += Step)
+				{
+					Z[Num++] = RowZ;
+				}
+
+				FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XYZ, Registers.GetData(), BatchSize, Num, LOD, Coordinates);
+
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					QueryZone.Set(X, Y, int32(Z[Index]), FVoxelValue(Values[Index]));
+				}
+			}
+		}
+	}
+}
+
+v_flt FVoxelGraphInterpreterInstance::GetValue(v_flt X, v_flt Y, v_flt Z, int32 LOD) const
+{
+	if (Program.ValueRegister == -1)
+	{
+		return 1;
+	}
+
+	TArray<v_flt, TInlineAllocator<256>> Registers(ConstantRegisters);
+
+	FVoxelGraphInterpreter::TCoordinates<v_flt> Coordinates;
+	Coordinates.X = X;
+	Coordinates.Y = Y;
+	Coordinates.Z = &Z;
+
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::X, Registers.GetData(), 1, 1, LOD, Coordinates);
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XY, Registers.GetData(), 1, 1, LOD, Coordinates);
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XYZ, Registers.GetData(), 1, 1, LOD, Coordinates);
+
+	return Registers[Program.ValueRegister];
+}
+
+TVoxelRange<v_flt> FVoxelGraphInterpreterInstance::GetValueRange(const FVoxelIntBox& LocalBounds, int32 LOD) const
+{
+	if (Program.ValueRegister == -1)
+	{
+		return 1;
+	}
+	if (!bEnableRangeAnalysis)
+	{
+		return TVoxelRange<v_flt>::Infinite();
+	}
+
+	TArray<TVoxelRange<v_flt>, TInlineAllocator<256>> Registers;
+	Registers.Reserve(ConstantRegisters.Num());
+	for (v_flt Value : ConstantRegisters)
+	{
+		Registers.Add(Value);
+	}
+
+	const TVoxelRange<v_flt> Z = { v_flt(LocalBounds.Min.Z), v_flt(LocalBounds.Max.Z) };
+
+	FVoxelGraphInterpreter::TCoordinates<TVoxelRange<v_flt>> Coordinates;
+	Coordinates.X = { v_flt(LocalBounds.Min.X), v_flt(LocalBounds.Max.X) };
+	Coordinates.Y = { v_flt(LocalBounds.Min.Y), v_flt(LocalBounds.Max.Y) };
+	Coordinates.Z = &Z;
+
+	auto& RangeFailStatus = FVoxelRangeFailStatus::Get();
+
+	ensure(!RangeFailStatus.HasFailed());
+	RangeFailStatus.Reset();
+
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::X, Registers.GetData(), 1, 1, LOD, Coordinates);
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XY, Registers.GetData(), 1, 1, LOD, Coordinates);
+	FVoxelGraphInterpreter::Execute(Program, EVoxelAxisDependencies::XYZ, Registers.GetData(), 1, 1, LOD, Coordinates);
+
+	if (RangeFailStatus.HasFailed())
+	{
+		RangeFailStatus.Reset();
+		return TVoxelRange<v_flt>::Infinite();
+	}
+
+	return Registers[Program.ValueRegister];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the interpreter against a graph compiled to C++, eg the examples:
+// voxel.graph.BenchmarkInterpreter /Voxel/Examples/VoxelGraphs/Cave/VoxelExample_Cave VoxelExample_Cave
+static FAutoConsoleCommand BenchmarkInterpreterCmd(
+	TEXT("voxel.graph.BenchmarkInterpreter"),
+	TEXT("Query the values of a graph with the interpreter and with its compiled C++ class, and log the timings. Args: [Graph asset path] [Compiled generator class name] [Size = 32] [Iterations = 10]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2)
+		{
+			LOG_VOXEL(Error, TEXT("voxel.graph.BenchmarkInterpreter: needs a graph asset path and a compiled generator class name"));
+			return;
+		}
+
+		UVoxelGraphGenerator* Graph = LoadObject<UVoxelGraphGenerator>(nullptr, *Args[0]);
+		UClass* CompiledClass = FindObject<UClass>(ANY_PACKAGE, *Args[1]);
+		if (!Graph || !CompiledClass || !CompiledClass->IsChildOf<UVoxelGenerator>())
+		{
+			LOG_VOXEL(Error, TEXT("voxel.graph.BenchmarkInterpreter: invalid graph %s or class %s"), *Args[0], *Args[1]);
+			return;
+		}
+
+		const int32 Size = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 1, 256) : 32;
+		const int32 Iterations = Args.Num() > 3 ? FMath::Max(1, FCString::Atoi(*Args[3])) : 10;
+
+		FVoxelGraphProgram Program;
+		FString Error;
+		if (!FVoxelGraphBytecode::Compile(*Graph, {}, Program, Error))
+		{
+			LOG_VOXEL(Error, TEXT("voxel.graph.BenchmarkInterpreter: %s can't be interpreted: %s"), *Graph->GetName(), *Error);
+			return;
+		}
+		const int32 NumInstructions = Program.GetNumInstructions();
+
+		const TVoxelSharedRef<FVoxelGeneratorInstance> Interpreter = MakeVoxelShared<FVoxelGraphInterpreterInstance>(*Graph, MoveTemp(Program));
+		const TVoxelSharedRef<FVoxelGeneratorInstance> Compiled = NewObject<UVoxelGenerator>(GetTransientPackage(), CompiledClass)->GetInstance();
+		Interpreter->Init({});
+		Compiled->Init({});
+
+		const FVoxelIntBox Bounds(FIntVector(-Size / 2), FIntVector(Size - Size / 2));
+		const auto Run = [&](const FVoxelGeneratorInstance& Instance, TArray<FVoxelValue>& Values)
+		{
+			Values.SetNumUninitialized(int32(Bounds.Count()));
+			TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, Values);
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				Instance.GetValues(QueryZone, 0, FVoxelItemStack::Empty);
+			}
+			return (FPlatformTime::Seconds() - StartTime) / Iterations;
+		};
+
+		TArray<FVoxelValue> InterpreterValues;
+		TArray<FVoxelValue> CompiledValues;
+		const double InterpreterTime = Run(*Interpreter, InterpreterValues);
+		const double CompiledTime = Run(*Compiled, CompiledValues);
+
+		int32 NumDifferent = 0;
+		for (int32 Index = 0; Index < InterpreterValues.Num(); Index++)
+		{
+			NumDifferent += InterpreterValues[Index] != CompiledValues[Index];
+		}
+
+		const int64 NumVoxels = int64(Bounds.Count());
+		LOG_VOXEL(Log, TEXT("%s: %d instructions, %d^3 voxels. Interpreter: %fms (%fns/voxel). Compiled: %fms (%fns/voxel). Ratio: %fx. %d values differ"),
+			*Graph->GetName(),
+			NumInstructions,
+			Size,
+			InterpreterTime * 1000,
+			InterpreterTime / NumVoxels * 1e9,
+			CompiledTime * 1000,
+			CompiledTime / NumVoxels * 1e9,
+			CompiledTime > 0 ? InterpreterTime / CompiledTime : 0,
+			NumDifferent);
+	}));
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#if ENABLE_VOXELGRAPH_NODE_STATS
+static FCriticalSection GVoxelGraphNodeStatsSection;
+static TMap<TPair<FName, FString>, TUniquePtr<FVoxelGraphNodeStats>> GVoxelGraphNodeStats;
+
+FVoxelGraphNodeStats& FVoxelGraphNodeStats::Get(FName Graph, const FString& Node)
+{
+	FScopeLock Lock(&GVoxelGraphNodeStatsSection);
+
+	TUniquePtr<FVoxelGraphNodeStats>& Stats = GVoxelGraphNodeStats.FindOrAdd({ Graph, Node });
+	if (!Stats.IsValid())
+	{
+		Stats = MakeUnique<FVoxelGraphNodeStats>();
+		Stats->Graph = Graph;
+		Stats->Node = Node;
+	}
+	return *Stats;
+}
+
+// eg, after voxel.generator.Benchmark /Game/MyGraph: voxel.graph.NodeStats.Write
+static FAutoConsoleCommand WriteNodeStatsCmd(
+	TEXT("voxel.graph.NodeStats.Write"),
+	TEXT("Write the time spent in each node of the interpreted graphs since the last reset as JSON, and log the 10 most expensive ones. Args: [Output path]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.Num() > 0
+			? Args[0]
+			: FPaths::ProjectSavedDir() / TEXT("VoxelBenchmarks") / FString::Printf(TEXT("GraphNodes_%s.json"), *FDateTime::Now().ToString());
+
+		TArray<const FVoxelGraphNodeStats*> AllStats;
+		{
+			FScopeLock Lock(&GVoxelGraphNodeStatsSection);
+			for (auto& It : GVoxelGraphNodeStats)
+			{
+				if (It.Value->NumLanes.GetValue() > 0)
+				{
+					AllStats.Add(It.Value.Get());
+				}
+			}
+		}
+		AllStats.Sort([](const FVoxelGraphNodeStats& A, const FVoxelGraphNodeStats& B) { return A.Cycles.GetValue() > B.Cycles.GetValue(); });
+
+		TArray<TSharedPtr<FJsonValue>> Nodes;
+		for (int32 Index = 0; Index < AllStats.Num(); Index++)
+		{
+			const FVoxelGraphNodeStats& Stats = *AllStats[Index];
+			const double Time = FPlatformTime::ToSeconds64(Stats.Cycles.GetValue());
+			const int64 NumLanes = Stats.NumLanes.GetValue();
+
+			const auto Node = MakeShared<FJsonObject>();
+			Node->SetStringField(TEXT("Graph"), Stats.Graph.ToString());
+			Node->SetStringField(TEXT("Node"), Stats.Node);
+			Node->SetNumberField(TEXT("TimeMs"), Time * 1000);
+			Node->SetNumberField(TEXT("Voxels"), NumLanes);
+			Node->SetNumberField(TEXT("NsPerVoxel"), Time / NumLanes * 1e9);
+			Nodes.Add(MakeShared<FJsonValueObject>(Node));
+
+			if (Index < 10)
+			{
+				LOG_VOXEL(Log, TEXT("%s: %s: %.2fms, %.2fns/voxel"), *Stats.Graph.ToString(), *Stats.Node, Time * 1000, Time / NumLanes * 1e9);
+			}
+		}
+
+		const auto Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("Date"), FDateTime::Now().ToIso8601());
+		Root->SetArrayField(TEXT("Nodes"), Nodes);
+
+		FString Json;
+		const auto Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		if (FFileHelper::SaveStringToFile(Json, *Path))
+		{
+			LOG_VOXEL(Log, TEXT("Graph node stats written to %s"), *Path);
+		}
+		else
+		{
+			LOG_VOXEL(Error, TEXT("Failed to write graph node stats to %s"), *Path);
+		}
+	}));
+
+static FAutoConsoleCommand ResetNodeStatsCmd(
+	TEXT("voxel.graph.NodeStats.Reset"),
+	TEXT("Reset the time spent in each node of the interpreted graphs"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FScopeLock Lock(&GVoxelGraphNodeStatsSection);
+		for (auto& It : GVoxelGraphNodeStats)
+		{
+			It.Value->Cycles.Reset();
+			It.Value->NumLanes.Reset();
+		}
+	}));
+#endif
@@ -7,6 +7,7 @@
 #include "VoxelGraphOutputsConfig.h"
 #include "VoxelGraphConstants.h"
 #include "VoxelGraphErrorReporter.h"
+#include "Runtime/VoxelGraphInterpreter.h"
 
 #include "VoxelNodes/VoxelExecNodes.h"
 #include "VoxelNodes/VoxelSeedNodes.h"
@@ -176,7 +177,14 @@ TVoxelSharedRef<FVoxelTransformableGeneratorInstance> UVoxelGraphGenerator::GetT
 
 TVoxelSharedRef<FVoxelTransformableGeneratorInstance> UVoxelGraphGenerator::GetTransformableInstance(const TMap<FName, FString>& Parameters)
 {
-	FVoxelMessages::Info("Running Voxel Graphs require Voxel Plugin Pro");
+	FVoxelGraphProgram Program;
+	FString Error;
+	if (FVoxelGraphBytecode::Compile(*this, Parameters, Program, Error))
+	{
+		return MakeVoxelShared<FVoxelGraphInterpreterInstance>(*this, MoveTemp(Program));
+	}
+
+	FVoxelMessages::Info(FString::Printf(TEXT("%s can't be interpreted: %s. Running it compiled to C++ requires Voxel Plugin Pro"), *GetName(), *Error), this);
 	return MakeVoxelShared<FVoxelTransformableEmptyGeneratorInstance>();
 }
 
@@ -0,0 +1,88 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelGraphGeneratorHelpers.h"
+#include "VoxelGenerators/VoxelGenerator.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.h"
+
+#include "UObject/UObjectGlobals.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarRowEntryPoints(
+	TEXT("voxel.graph.RowEntryPoints"),
+	1,
+	TEXT("If true, the XYZ stage of graphs providing a ComputeXYZRow entry point is evaluated on whole Z rows. If false, it is evaluated voxel by voxel"),
+	ECVF_Default);
+
+bool FVoxelGraphRowEntryPoints::IsEnabled()
+{
+	return CVarRowEntryPoints.GetValueOnAnyThread() != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the row entry point of a compiled graph against the voxel by voxel path, eg:
+// voxel.graph.BenchmarkRowEntryPoints VoxelExample_Cave 32 10
+static FAutoConsoleCommand BenchmarkRowEntryPointsCmd(
+	TEXT("voxel.graph.BenchmarkRowEntryPoints"),
+	TEXT("Query the values of a compiled graph with voxel.graph.RowEntryPoints off and on, check that they are identical and log the timings. Args: [Compiled generator class name = VoxelExample_Cave] [Size = 32] [Iterations = 10]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString ClassName = Args.Num() > 0 ? Args[0] : TEXT("VoxelExample_Cave");
+		UClass* CompiledClass = FindObject<UClass>(ANY_PACKAGE, *ClassName);
+		if (!CompiledClass || !CompiledClass->IsChildOf<UVoxelGenerator>())
+		{
+			LOG_VOXEL(Error, TEXT("voxel.graph.BenchmarkRowEntryPoints: invalid class %s"), *ClassName);
+			return;
+		}
+
+		const int32 Size = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 256) : 32;
+		const int32 Iterations = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 10;
+
+		const TVoxelSharedRef<FVoxelGeneratorInstance> Instance = NewObject<UVoxelGenerator>(GetTransientPackage(), CompiledClass)->GetInstance();
+		Instance->Init({});
+
+		const FVoxelIntBox Bounds(FIntVector(-Size / 2), FIntVector(Size - Size / 2));
+		const auto Run = [&](int32 Value, TArray<FVoxelValue>& Values)
+		{
+			CVarRowEntryPoints->Set(Value, ECVF_SetByConsole);
+
+			// Allocated outside of the timed loop
+			Values.SetNumUninitialized(int32(Bounds.Count()));
+			TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, Values);
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				Instance->GetValues(QueryZone, 0, FVoxelItemStack::Empty);
+			}
+			return (FPlatformTime::Seconds() - StartTime) / Iterations;
+		};
+
+		const int32 OldValue = CVarRowEntryPoints.GetValueOnGameThread();
+
+		TArray<FVoxelValue> VoxelValues;
+		TArray<FVoxelValue> RowValues;
+		const double VoxelTime = Run(0, VoxelValues);
+		const double RowTime = Run(1, RowValues);
+
+		CVarRowEntryPoints->Set(OldValue, ECVF_SetByConsole);
+
+		int32 NumDifferent = 0;
+		for (int32 Index = 0; Index < VoxelValues.Num(); Index++)
+		{
+			NumDifferent += VoxelValues[Index] != RowValues[Index];
+		}
+
+		const int64 NumVoxels = int64(Bounds.Count());
+		LOG_VOXEL(Log, TEXT("%s: %d^3 voxels. Voxel by voxel: %fms (%fns/voxel). Rows: %fms (%fns/voxel). Speedup: %.2fx. %s"),
+			*ClassName,
+			Size,
+			VoxelTime * 1000,
+			VoxelTime / NumVoxels * 1e9,
+			RowTime * 1000,
+			RowTime / NumVoxels * 1e9,
+			RowTime > 0 ? VoxelTime / RowTime : 0,
+			NumDifferent > 0 ? *FString::Printf(TEXT("FAILED: %d values differ"), NumDifferent) : TEXT("Identical"));
+	}));
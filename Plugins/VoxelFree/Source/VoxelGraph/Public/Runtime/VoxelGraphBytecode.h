@@ -0,0 +1,137 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelGraphGlobals.h"
+#include "VoxelRange.h"
+#include "VoxelAxisDependencies.h"
+#include "FastNoise/VoxelFastNoise.h"
+#include "Containers/StaticArray.h"
+
+class UVoxelGraphGenerator;
+
+enum class EVoxelGraphOpcode : uint8
+{
+	// Dest = Constants[Payload]
+	Constant,
+
+	X,
+	Y,
+	Z,
+
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Min,
+	Max,
+
+	Negate,
+	Abs,
+	Sqrt,
+	OneMinus,
+	OneOver,
+	Sin,
+	Cos,
+
+	Clamp,
+	Lerp,
+	SafeLerp,
+	SmoothStep,
+	VectorLength,
+
+	// Dest = Noises[Payload](Inputs[0], Inputs[1], Frequency = Inputs[2])
+	Noise2D,
+	// Dest = Noises[Payload](Inputs[0], Inputs[1], Inputs[2], Frequency = Inputs[3])
+	Noise3D
+};
+
+struct FVoxelGraphInstruction
+{
+	EVoxelGraphOpcode Opcode;
+	uint16 Dest = 0;
+	uint16 Inputs[4] = {};
+	int32 Payload = 0;
+};
+
+enum class EVoxelGraphNoiseType : uint8
+{
+	Perlin,
+	Simplex
+};
+
+struct FVoxelGraphNoise
+{
+	FVoxelFastNoise Noise;
+	EVoxelGraphNoiseType Type = EVoxelGraphNoiseType::Perlin;
+	bool bFractal = false;
+	TStaticArray<uint8, 32> LODToOctaves;
+	// Used by range analysis
+	TVoxelRange<v_flt> Range = TVoxelRange<v_flt>::Infinite();
+
+	FORCEINLINE int32 GetOctaves(int32 LOD) const
+	{
+		return LODToOctaves[FMath::Clamp(LOD, 0, 31)];
+	}
+};
+
+#if ENABLE_VOXELGRAPH_NODE_STATS
+// Cost of a node of a graph, accumulated over all the instances and threads
+struct VOXELGRAPH_API FVoxelGraphNodeStats
+{
+	FName Graph;
+	FString Node;
+	FThreadSafeCounter64 Cycles;
+	// Number of voxels computed
+	FThreadSafeCounter64 NumLanes;
+
+	// Stats are never freed, so that programs can keep pointers to them
+	static FVoxelGraphNodeStats& Get(FName Graph, const FString& Node);
+};
+#endif
+
+/**
+ * Register based bytecode of a voxel graph value output
+ * The instructions are split by axis dependencies, the same way the generated C++ is:
+ * the Constant stage runs once on init, X once per X, XY once per column and XYZ on whole Z rows of up to BatchSize voxels
+ * Every register holds BatchSize lanes, only the first one being used by the stages below XYZ
+ */
+struct FVoxelGraphProgram
+{
+	static constexpr int32 BatchSize = 64;
+
+	// Indexed by EVoxelAxisDependencies
+	TArray<FVoxelGraphInstruction> Stages[4];
+
+	TArray<v_flt> Constants;
+	TArray<FVoxelGraphNoise> Noises;
+
+	int32 NumRegisters = 0;
+	// Registers computed before the XYZ stage and read by it, need to be broadcast to all the lanes
+	TArray<uint16> RowInputs;
+	// -1 if the value isn't set by the graph
+	int32 ValueRegister = -1;
+
+#if ENABLE_VOXELGRAPH_NODE_STATS
+	// Indexed like Stages: the stats of the node each instruction was emitted by
+	TArray<FVoxelGraphNodeStats*> InstructionStats[4];
+#endif
+
+	const TArray<FVoxelGraphInstruction>& GetStage(EVoxelAxisDependencies Dependencies) const
+	{
+		return Stages[int32(Dependencies)];
+	}
+	int32 GetNumInstructions() const
+	{
+		return Stages[0].Num() + Stages[1].Num() + Stages[2].Num() + Stages[3].Num();
+	}
+};
+
+namespace FVoxelGraphBytecode
+{
+	// Compile the value output of a graph. Only a subset of the nodes are supported: if the graph uses others, returns false and sets OutError
+	// Material setters and custom outputs are ignored
+	VOXELGRAPH_API bool Compile(const UVoxelGraphGenerator& Generator, const TMap<FName, FString>& Parameters, FVoxelGraphProgram& OutProgram, FString& OutError);
+}
@@ -0,0 +1,62 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "Runtime/VoxelGraphBytecode.h"
+#include "VoxelGenerators/VoxelGeneratorHelpers.h"
+
+class UVoxelGraphGenerator;
+
+// Runs the bytecode of a graph, so that graphs can be used without being compiled to C++
+// Only the value output is computed, materials are left to their default
+class VOXELGRAPH_API FVoxelGraphInterpreterInstance : public TVoxelTransformableGeneratorInstanceHelper<FVoxelGraphInterpreterInstance, UVoxelGraphGenerator>
+{
+public:
+	using Super = TVoxelTransformableGeneratorInstanceHelper<FVoxelGraphInterpreterInstance, UVoxelGraphGenerator>;
+
+	FVoxelGraphInterpreterInstance(const UVoxelGraphGenerator& Generator, FVoxelGraphProgram&& Program);
+
+	const FVoxelGraphProgram& GetProgram() const { return Program; }
+
+	//~ Begin FVoxelGeneratorInstance Interface
+	virtual void Init(const FVoxelGeneratorInit& InitStruct) override;
+	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override;
+	virtual FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override final
+	{
+		return FVector::UpVector;
+	}
+	//~ End FVoxelGeneratorInstance Interface
+
+	template<bool bCustomTransform>
+	v_flt GetValueImpl(const FTransform& LocalToWorld, v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		if (bCustomTransform)
+		{
+			const FVector Local = LocalToWorld.InverseTransformPosition(FVector(X, Y, Z));
+			return GetValue(Local.X, Local.Y, Local.Z, LOD);
+		}
+		return GetValue(X, Y, Z, LOD);
+	}
+	template<bool bCustomTransform>
+	FVoxelMaterial GetMaterialImpl(const FTransform& LocalToWorld, v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		return FVoxelMaterial::Default();
+	}
+	template<bool bCustomTransform>
+	TVoxelRange<v_flt> GetValueRangeImpl(const FTransform& LocalToWorld, const FVoxelIntBox& WorldBounds, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		return GetValueRange(bCustomTransform ? WorldBounds.ApplyTransform<EInverseTransform::True>(LocalToWorld, 1 << LOD) : WorldBounds, LOD);
+	}
+
+private:
+	const FVoxelGraphProgram Program;
+	const bool bEnableRangeAnalysis;
+
+	// Values of the registers computed by the Constant stage, set on init
+	TArray<v_flt> ConstantRegisters;
+
+	v_flt GetValue(v_flt X, v_flt Y, v_flt Z, int32 LOD) const;
+	TVoxelRange<v_flt> GetValueRange(const FVoxelIntBox& LocalBounds, int32 LOD) const;
+};
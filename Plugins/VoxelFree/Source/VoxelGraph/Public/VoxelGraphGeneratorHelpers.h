@@ -9,6 +9,8 @@
 #include "VoxelGraphConstants.h"
 #include "VoxelGenerators/VoxelGeneratorHelpers.h"
 #include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "VoxelGenerators/VoxelGeneratorColumnCache.h"
+#include "VoxelUtilities/VoxelBaseUtilities.h"
 #include "VoxelGraphGeneratorHelpers.generated.h"
 
 // See https://godbolt.org/z/4IzS-b
@@ -23,6 +25,12 @@ struct FVoxelGraphOutputsInit
 	EVoxelMaterialConfig MaterialConfig;
 };
 
+struct VOXELGRAPH_API FVoxelGraphRowEntryPoints
+{
+	// voxel.graph.RowEntryPoints: if false, targets with a ComputeXYZRow entry point are evaluated voxel by voxel
+	static bool IsEnabled();
+};
+
 template<typename TChild, typename UWorldObject>
 class TVoxelGraphGeneratorInstanceHelper : public TVoxelTransformableGeneratorInstanceHelper<TChild, UWorldObject>
 {
@@ -160,7 +168,11 @@ public:
 
 		FVoxelContext Context(LOD, Items, LocalToWorld, bCustomTransform);
 		
-		if (!bCustomTransform)
+		if (!bCustomTransform && CanUseColumnCache(Target, QueryZone, Items))
+		{
+			ComputeWithColumnCache<T, QueryZoneType, Index>(Target, Context, DefaultValue, QueryZone, LOD);
+		}
+		else if (!bCustomTransform)
 		{
 			// We can only use the dependencies analysis if we don't have a transform, or if it's only translation + scale
 			// (and thus not changing the axis). Not checking that second case though.
@@ -178,16 +190,7 @@ public:
 					auto BufferXY = Target.GetBufferXY();
 					Target.ComputeXYWithCache(Context, BufferX, BufferXY);
 
-					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
-					{
-						Context.LocalZ = Context.WorldZ = Z;
-
-						auto Outputs = Target.GetOutputs();
-						Outputs.Init(FVoxelGraphOutputsInit{ MaterialConfig });
-						Outputs.template Set<T, Index>(DefaultValue);
-						Target.ComputeXYZWithCache(Context, static_cast<const decltype(BufferX)&>(BufferX), static_cast<const decltype(BufferXY)&>(BufferXY), Outputs);
-						QueryZone.Set(X, Y, Z, QueryZoneType(Outputs.template Get<T, Index>()));
-					}
+					ComputeZ<T, QueryZoneType, Index>(Target, Context, static_cast<const decltype(BufferX)&>(BufferX), static_cast<const decltype(BufferXY)&>(BufferXY), DefaultValue, QueryZone, X, Y, 0);
 				}
 			}
 		}
@@ -266,6 +269,7 @@ public:
 	{
 		bInit = true;
 		MaterialConfig = InitStruct.MaterialConfig;
+		ColumnCache.Clear();
 		InitGraph(InitStruct);
 	}
 	
@@ -378,6 +382,9 @@ private:
 	bool bInit = false;
 	EVoxelMaterialConfig MaterialConfig = EVoxelMaterialConfig(-1);
 
+	// XY stage buffers, shared by all the queries of this instance
+	mutable FVoxelGeneratorColumnCache ColumnCache;
+
 	const TChild& This() const
 	{
 		return static_cast<const TChild&>(*this);
@@ -386,6 +393,155 @@ private:
 	{
 		return static_cast<TChild&>(*this);
 	}
+
+private:
+	// Number of voxels evaluated at once by the row targets
+	static constexpr int32 RowBatchSize = 64;
+
+	// Used when the target has a row entry point:
+	// void ComputeXYZRow(const FVoxelContext& Context, const FBufferX& BufferX, const FBufferXY& BufferXY, const v_flt* RESTRICT Z, int32 Num, FOutputs* RESTRICT Outputs) const
+	// The XYZ stage is then evaluated on a whole Z row at once, which lets the noise nodes use the batch noise functions
+	template<typename T, typename QueryZoneType, uint32 Index, typename TTarget, typename TBufferX, typename TBufferXY>
+	auto ComputeZ(const TTarget& Target, FVoxelContext& Context, const TBufferX& BufferX, const TBufferXY& BufferXY, T DefaultValue, TVoxelQueryZone<QueryZoneType>& QueryZone, int32 X, int32 Y, int32) const
+		-> decltype(Target.ComputeXYZRow(Context, BufferX, BufferXY, static_cast<const v_flt*>(nullptr), 0, static_cast<decltype(Target.GetOutputs())*>(nullptr)))
+	{
+		using FOutputs = decltype(Target.GetOutputs());
+
+		if (!FVoxelGraphRowEntryPoints::IsEnabled())
+		{
+			ComputeZ<T, QueryZoneType, Index>(Target, Context, BufferX, BufferXY, DefaultValue, QueryZone, X, Y, 0l);
+			return;
+		}
+
+		v_flt Z[RowBatchSize];
+		FOutputs Outputs[RowBatchSize];
+
+		for (int32 RowStart = QueryZone.Bounds.Min.Z; RowStart < QueryZone.Bounds.Max.Z; RowStart += RowBatchSize * QueryZone.Step)
+		{
+			int32 Num = 0;
+			for (int32 RowZ = RowStart; RowZ < QueryZone.Bounds.Max.Z && Num < RowBatchSize; RowZ += QueryZone.Step)
+			{
+				Z[Num] = RowZ;
+				Outputs[Num] = Target.GetOutputs();
+				Outputs[Num].Init(FVoxelGraphOutputsInit{ MaterialConfig });
+				Outputs[Num].template Set<T, Index>(DefaultValue);
+				Num++;
+			}
+
+			// LocalZ/WorldZ are left to the row function
+			Target.ComputeXYZRow(Context, BufferX, BufferXY, Z, Num, Outputs);
+
+			for (int32 RowIndex = 0; RowIndex < Num; RowIndex++)
+			{
+				QueryZone.Set(X, Y, int32(Z[RowIndex]), QueryZoneType(Outputs[RowIndex].template Get<T, Index>()));
+			}
+		}
+	}
+	// Fallback: evaluate the XYZ stage voxel by voxel
+	template<typename T, typename QueryZoneType, uint32 Index, typename TTarget, typename TBufferX, typename TBufferXY>
+	void ComputeZ(const TTarget& Target, FVoxelContext& Context, const TBufferX& BufferX, const TBufferXY& BufferXY, T DefaultValue, TVoxelQueryZone<QueryZoneType>& QueryZone, int32 X, int32 Y, long) const
+	{
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+		{
+			Context.LocalZ = Context.WorldZ = Z;
+
+			auto Outputs = Target.GetOutputs();
+			Outputs.Init(FVoxelGraphOutputsInit{ MaterialConfig });
+			Outputs.template Set<T, Index>(DefaultValue);
+			Target.ComputeXYZWithCache(Context, BufferX, BufferXY, Outputs);
+			QueryZone.Set(X, Y, Z, QueryZoneType(Outputs.template Get<T, Index>()));
+		}
+	}
+
+private:
+	template<typename TTarget, typename QueryZoneType>
+	static bool CanUseColumnCache(const TTarget& Target, const TVoxelQueryZone<QueryZoneType>& QueryZone, const FVoxelItemStack& Items)
+	{
+		using FBufferXY = decltype(Target.GetBufferXY());
+
+		const int32 Step = QueryZone.Step;
+		return
+			// Nothing to cache if the XY stage is empty
+			!std::is_empty<FBufferXY>::value &&
+			FVoxelGeneratorColumnCache::IsEnabled() &&
+			// Items and custom data can change the XY stage from one query to the other
+			Items.IsEmpty() &&
+			!Items.CustomData &&
+			Items.ItemHolder.NumItems() == 0 &&
+			// Tiles are aligned on Step
+			QueryZone.Bounds.Min.X % Step == 0 &&
+			QueryZone.Bounds.Min.Y % Step == 0;
+	}
+
+	// Same as the no transform path of GetOutput, but the XY buffers are read from the column cache,
+	// so that they aren't recomputed for every chunk of the same column
+	template<typename T, typename QueryZoneType, uint32 Index, typename TTarget>
+	void ComputeWithColumnCache(const TTarget& Target, FVoxelContext& Context, T DefaultValue, TVoxelQueryZone<QueryZoneType>& QueryZone, int32 LOD) const
+	{
+		using FBufferXY = decltype(Target.GetBufferXY());
+		constexpr int32 TileSize = FVoxelGeneratorColumnCache::TileSize;
+
+		const FVoxelIntBox& Bounds = QueryZone.Bounds;
+		const int32 Step = QueryZone.Step;
+		const int32 TileWorldSize = TileSize * Step;
+
+		const FIntPoint MinTile(FVoxelUtilities::DivideFloor(Bounds.Min.X, TileWorldSize), FVoxelUtilities::DivideFloor(Bounds.Min.Y, TileWorldSize));
+		const FIntPoint MaxTile(FVoxelUtilities::DivideFloor(Bounds.Max.X - 1, TileWorldSize), FVoxelUtilities::DivideFloor(Bounds.Max.Y - 1, TileWorldSize));
+
+		for (int32 TileX = MinTile.X; TileX <= MaxTile.X; TileX++)
+		{
+			for (int32 TileY = MinTile.Y; TileY <= MaxTile.Y; TileY++)
+			{
+				FVoxelGeneratorColumnCache::FKey Key;
+				Key.Tile = FIntPoint(TileX, TileY);
+				Key.Step = Step;
+				Key.LOD = LOD;
+				Key.Type = Index;
+
+				const FIntPoint TileMin = Key.Tile * TileWorldSize;
+
+				const auto Tile = ColumnCache.FindOrCompute<FBufferXY>(Key, [&](FVoxelGeneratorColumnCache::TTile<FBufferXY>& NewTile)
+				{
+					FVoxelContext TileContext = Context;
+					for (int32 LocalX = 0; LocalX < TileSize; LocalX++)
+					{
+						TileContext.LocalX = TileContext.WorldX = TileMin.X + LocalX * Step;
+
+						auto BufferX = Target.GetBufferX();
+						Target.ComputeX(TileContext, BufferX);
+
+						for (int32 LocalY = 0; LocalY < TileSize; LocalY++)
+						{
+							TileContext.LocalY = TileContext.WorldY = TileMin.Y + LocalY * Step;
+							Target.ComputeXYWithCache(TileContext, BufferX, NewTile.Columns[LocalX + TileSize * LocalY]);
+						}
+					}
+				});
+
+				const int32 StartX = FMath::Max(TileMin.X, Bounds.Min.X);
+				const int32 StartY = FMath::Max(TileMin.Y, Bounds.Min.Y);
+				const int32 EndX = FMath::Min(TileMin.X + TileWorldSize, Bounds.Max.X);
+				const int32 EndY = FMath::Min(TileMin.Y + TileWorldSize, Bounds.Max.Y);
+
+				for (int32 X = StartX; X < EndX; X += Step)
+				{
+					Context.LocalX = Context.WorldX = X;
+
+					// The XYZ stage can also read the X buffer
+					auto BufferX = Target.GetBufferX();
+					Target.ComputeX(Context, BufferX);
+
+					for (int32 Y = StartY; Y < EndY; Y += Step)
+					{
+						Context.LocalY = Context.WorldY = Y;
+
+						const FBufferXY& BufferXY = Tile->Columns[(X - TileMin.X) / Step + TileSize * ((Y - TileMin.Y) / Step)];
+						ComputeZ<T, QueryZoneType, Index>(Target, Context, static_cast<const decltype(BufferX)&>(BufferX), BufferXY, DefaultValue, QueryZone, X, Y, 0);
+					}
+				}
+			}
+		}
+	}
 };
 
 UCLASS(Abstract)
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 
 #define ENABLE_VOXELGRAPH_CHECKS 0
+// Time every node of the interpreted graphs, see voxel.graph.NodeStats.Write. Adds a timer per instruction: only for profiling
+#define ENABLE_VOXELGRAPH_NODE_STATS 0
 
 #define MAX_VOXELNODE_PINS 256
 #define MAX_VOXELFUNCTION_ARGS 256
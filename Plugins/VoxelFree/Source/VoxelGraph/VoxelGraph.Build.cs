@@ -26,5 +26,12 @@ public class VoxelGraph : ModuleRules
                 "Engine",
                 "Voxel"
             });
+
+        PrivateDependencyModuleNames.AddRange(
+            new string[]
+            {
+                // For voxel.graph.NodeStats.Write
+                "Json",
+            });
     }
 }